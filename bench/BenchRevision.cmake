@@ -0,0 +1,23 @@
+# About: Writes BenchRevision.h with the current git revision; run on every build of luna_bench.
+#
+# Usage: cmake -DSOURCE_DIR=<repo> -DOUTPUT=<header> -P BenchRevision.cmake
+# The header is rewritten only when the revision changes, so an unchanged tree
+# does not relink the benchmark.
+
+execute_process(
+    COMMAND git rev-parse --short HEAD
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE REVISION
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET)
+if(NOT REVISION)
+    set(REVISION "unknown")
+endif()
+
+set(CONTENT "// Generated by bench/BenchRevision.cmake\n#define LUNA_GIT_REVISION \"${REVISION}\"\n")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS)
+endif()
+if(NOT "${PREVIOUS}" STREQUAL "${CONTENT}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
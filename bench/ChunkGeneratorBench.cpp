@@ -0,0 +1,89 @@
+// About: Micro-benchmark comparing ChunkGenerator sampling modes per patch.
+
+#include "scene/ChunkGenerator.h"
+#include "sim/TerrainQuery.h"
+#include "util/Log.h"
+#include "util/Math.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using luna::scene::ChunkGenerator;
+using luna::scene::ChunkMeshData;
+using luna::scene::SampleMode;
+using luna::scene::unpackHeight;
+using luna::scene::unpackNormal;
+using luna::scene::unpackPosition;
+
+namespace {
+
+constexpr uint32_t PATCH_GRID = 17;  // matches CubesphereBody
+constexpr uint32_t DEPTH      = 8;   // patch size typical of low-orbit views
+
+// Generate `count` patches spread over all six faces; returns microseconds per patch
+double timePatches(SampleMode mode, uint32_t count, double& checksum) {
+    uint32_t tiles = 1u << DEPTH;
+    double size = 2.0 / tiles;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < count; n++) {
+        int face = static_cast<int>(n % 6);
+        uint32_t ix = (n * 7919u) % tiles;
+        uint32_t iy = (n * 104729u) % tiles;
+        double u0 = -1.0 + ix * size;
+        double v0 = -1.0 + iy * size;
+        ChunkMeshData data = ChunkGenerator::generate(face, u0, u0 + size, v0, v0 + size,
+                                                      luna::util::LUNAR_RADIUS, PATCH_GRID, mode);
+        checksum += unpackHeight(data.vertices[data.vertices.size() / 2]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / count;
+}
+
+// Largest position / normal difference between the two modes on one patch
+void compareModes(double& maxPosError, double& maxNormalError) {
+    double u0 = 0.25, v0 = -0.5, size = 2.0 / (1u << DEPTH);
+    auto a = ChunkGenerator::generate(0, u0, u0 + size, v0, v0 + size,
+                                      luna::util::LUNAR_RADIUS, PATCH_GRID, SampleMode::PerVertex);
+    auto b = ChunkGenerator::generate(0, u0, u0 + size, v0, v0 + size,
+                                      luna::util::LUNAR_RADIUS, PATCH_GRID, SampleMode::SharedGrid);
+    maxPosError = maxNormalError = 0.0;
+    for (size_t i = 0; i < a.vertices.size(); i++) {
+        maxPosError = std::max(maxPosError, static_cast<double>(
+            glm::length(unpackPosition(a.vertices[i], a.positionScale) -
+                        unpackPosition(b.vertices[i], b.positionScale))));
+        maxNormalError = std::max(maxNormalError, static_cast<double>(
+            glm::length(unpackNormal(a.vertices[i]) - unpackNormal(b.vertices[i]))));
+    }
+}
+
+} // anonymous namespace
+
+// Usage: luna_bench_chunkgen [heightmap.tif] [patch count]
+int main(int argc, char** argv) {
+    luna::util::Log::init();
+
+    const char* path = argc > 1 ? argv[1] : "assets/terrain/ldem_16.tif";
+    uint32_t count = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 2000;
+    if (count == 0) count = 1;
+    luna::sim::initTerrain(path);
+
+    double checksum = 0.0;
+    timePatches(SampleMode::SharedGrid, 50, checksum);  // warm caches and page in the heightmap
+    double perVertex = timePatches(SampleMode::PerVertex, count, checksum);
+    double shared    = timePatches(SampleMode::SharedGrid, count, checksum);
+
+    double posError, normalError;
+    compareModes(posError, normalError);
+
+    std::printf("ChunkGenerator %ux%u, %u patches at depth %u\n", PATCH_GRID, PATCH_GRID, count, DEPTH);
+    std::printf("  PerVertex  : %8.1f us/patch\n", perVertex);
+    std::printf("  SharedGrid : %8.1f us/patch  (%.2fx)\n", shared, perVertex / shared);
+    std::printf("  max |dpos| = %.3g m, max |dnormal| = %.3g  (checksum %.1f)\n",
+                posError, normalError, checksum);
+
+    luna::sim::shutdownTerrain();
+    return 0;
+}
@@ -0,0 +1,419 @@
+// About: Micro-benchmark suite for terrain and physics hot paths, with JSON output for tracking per commit.
+
+#include "scene/ChunkGenerator.h"
+#include "scene/CubesphereBody.h"
+#include "scene/QuadtreePool.h"
+#include "sim/Heightmap.h"
+#include "sim/Physics.h"
+#include "sim/TerrainQuery.h"
+#include "util/Log.h"
+#include "util/Math.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchRevision.h"  // LUNA_GIT_REVISION, written by the build
+
+using luna::scene::ChunkGenerator;
+using luna::scene::CubesphereBody;
+using luna::scene::NodeId;
+using luna::scene::QuadtreePool;
+using luna::scene::TerrainQuality;
+
+namespace {
+
+void usage() {
+    std::fprintf(stderr,
+        "usage: luna_bench [options]\n"
+        "  --terrain PATH     float32 TIFF heightmap (default assets/terrain/ldem_16.tif)\n"
+        "  --filter TEXT      run only benchmarks whose name contains TEXT\n"
+        "  --min-time S       seconds per sample (default 0.1)\n"
+        "  --samples N        samples per benchmark, median reported (default 5)\n"
+        "  --json PATH        also write the results as JSON\n");
+}
+
+struct Options {
+    std::string terrain = "assets/terrain/ldem_16.tif";
+    std::string filter;
+    std::string jsonPath;
+    double      minTime = 0.1;
+    uint32_t    samples = 5;
+};
+
+struct Result {
+    std::string name;
+    uint64_t    iterations;   // over all samples
+    double      nsPerOp;      // median sample
+    double      minNsPerOp;
+    double      maxNsPerOp;
+};
+
+// Writes into this keep the optimiser from dropping the measured work
+volatile double sink = 0.0;
+
+// Each call of `op` does `opsPerCall` operations. Calls are batched until a
+// sample has run for minTime; the batch size found on a warm-up pass is reused
+// so every sample does the same work.
+Result measure(const Options& opt, const std::string& name, uint64_t opsPerCall,
+               const std::function<void()>& op) {
+    using clock = std::chrono::steady_clock;
+    auto seconds = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+
+    uint64_t calls = 1;
+    for (;;) {
+        auto start = clock::now();
+        for (uint64_t i = 0; i < calls; i++) op();
+        double elapsed = seconds(clock::now() - start);
+        if (elapsed >= opt.minTime || calls >= (1ull << 30)) break;
+        calls = elapsed > 0.0
+            ? std::max(calls * 2, static_cast<uint64_t>(calls * opt.minTime / elapsed * 1.2))
+            : calls * 10;
+    }
+
+    std::vector<double> perOp;
+    for (uint32_t s = 0; s < opt.samples; s++) {
+        auto start = clock::now();
+        for (uint64_t i = 0; i < calls; i++) op();
+        perOp.push_back(seconds(clock::now() - start) * 1e9 / (calls * opsPerCall));
+    }
+    std::sort(perOp.begin(), perOp.end());
+
+    Result r{name, calls * opsPerCall * opt.samples, perOp[perOp.size() / 2],
+             perOp.front(), perOp.back()};
+    std::printf("  %-34s %14.1f ns/op   (min %.1f, max %.1f)\n",
+                r.name.c_str(), r.nsPerOp, r.minNsPerOp, r.maxNsPerOp);
+    std::fflush(stdout);
+    return r;
+}
+
+bool selected(const Options& opt, const std::string& name) {
+    return opt.filter.empty() || name.find(opt.filter) != std::string::npos;
+}
+
+// --- ChunkGenerator ---
+
+void benchChunkGenerator(const Options& opt, std::vector<Result>& results) {
+    // Depth-8 patches spread over all six faces, like a low-orbit view
+    constexpr uint32_t DEPTH = 8;
+    for (uint32_t grid : {9u, 17u, 33u}) {
+        std::string name = "chunkgen/generate/grid" + std::to_string(grid);
+        if (!selected(opt, name)) continue;
+        uint32_t tiles = 1u << DEPTH;
+        double size = 2.0 / tiles;
+        uint32_t n = 0;
+        results.push_back(measure(opt, name, 1, [&] {
+            int face = static_cast<int>(n % 6);
+            uint32_t ix = (n * 7919u) % tiles;
+            uint32_t iy = (n * 104729u) % tiles;
+            n++;
+            double u0 = -1.0 + ix * size;
+            double v0 = -1.0 + iy * size;
+            auto data = ChunkGenerator::generate(face, u0, u0 + size, v0, v0 + size,
+                                                 luna::util::LUNAR_RADIUS, grid);
+            sink = sink + data.positionScale;
+        }));
+    }
+}
+
+// --- Heightmap ---
+
+void benchHeightmap(const Options& opt, const luna::sim::Heightmap& map,
+                    std::vector<Result>& results) {
+    constexpr size_t POINTS = 4096;
+    std::vector<double> lat(POINTS), lon(POINTS);
+    std::vector<float>  out(POINTS);
+
+    // Random: uniform over the sphere, a cache miss per sample on a large map
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t i = 0; i < POINTS; i++) {
+        lat[i] = std::asin(2.0 * unit(rng) - 1.0);
+        lon[i] = (2.0 * unit(rng) - 1.0) * glm::pi<double>();
+    }
+    if (selected(opt, "heightmap/sample/random")) {
+        results.push_back(measure(opt, "heightmap/sample/random", POINTS, [&] {
+            double sum = 0.0;
+            for (size_t i = 0; i < POINTS; i++) sum += map.sample(lat[i], lon[i]);
+            sink = sink + sum;
+        }));
+    }
+
+    // Coherent: a 64x64 grid of points 100 m apart, the access pattern of a patch
+    double step = 100.0 / luna::util::LUNAR_RADIUS;
+    for (size_t i = 0; i < POINTS; i++) {
+        lat[i] = 0.3 + (i / 64) * step;
+        lon[i] = 1.1 + (i % 64) * step;
+    }
+    if (selected(opt, "heightmap/sample/coherent")) {
+        results.push_back(measure(opt, "heightmap/sample/coherent", POINTS, [&] {
+            double sum = 0.0;
+            for (size_t i = 0; i < POINTS; i++) sum += map.sample(lat[i], lon[i]);
+            sink = sink + sum;
+        }));
+    }
+    std::string batched = std::string("heightmap/sampleMany/coherent/") +
+                          luna::sim::Heightmap::batchKernelName();
+    if (selected(opt, batched)) {
+        results.push_back(measure(opt, batched, POINTS, [&] {
+            map.sampleMany(lat.data(), lon.data(), out.data(), POINTS);
+            sink = sink + out[POINTS / 2];
+        }));
+    }
+}
+
+void benchTiffLoad(const Options& opt, std::vector<Result>& results) {
+    if (!selected(opt, "tiff/load")) return;
+    // Whole-file loads are slow: one per sample is plenty
+    Options once = opt;
+    once.minTime = 0.0;
+    results.push_back(measure(once, "tiff/load", 1, [&] {
+        luna::sim::Heightmap map;
+        if (!map.load(opt.terrain)) std::exit(1);
+        sink = sink + map.levelCount();
+    }));
+}
+
+// --- LOD traversal ---
+
+// The "medium" preset, which luna3d runs without a quality file
+const TerrainQuality QUALITY;
+
+// A tree refined the way update() would refine it for a camera 2 km above the
+// surface: every patch over the split threshold split, down to MAX_DEPTH
+struct SyntheticTree {
+    QuadtreePool          nodes;
+    std::array<NodeId, 6> roots{};
+    uint32_t              leaves = 0;
+};
+
+void buildTree(SyntheticTree& tree, const glm::dvec3& camera, double pixelsPerRadian) {
+    double radius = luna::util::LUNAR_RADIUS;
+    auto init = [&](NodeId n, int face, double u0, double u1, double v0, double v1, uint32_t depth) {
+        auto& info = tree.nodes.info(n);
+        info.faceIndex = face;
+        info.u0 = u0; info.u1 = u1; info.v0 = v0; info.v1 = v1;
+        tree.nodes.depth(n) = static_cast<uint8_t>(depth);
+        CubesphereBody::patchBounds(face, u0, u1, v0, v1, radius,
+                                    tree.nodes.worldCenter(n), tree.nodes.boundingRadius(n));
+    };
+
+    // Six roots in two sibling blocks, as CubesphereBody allocates them
+    NodeId rootBlock[2] = {tree.nodes.allocateSiblings(), tree.nodes.allocateSiblings()};
+    std::vector<NodeId> stack;
+    for (int face = 0; face < 6; face++) {
+        tree.roots[face] = rootBlock[face / 4] + face % 4;
+        init(tree.roots[face], face, -1.0, 1.0, -1.0, 1.0, 0);
+        stack.push_back(tree.roots[face]);
+    }
+    while (!stack.empty()) {
+        NodeId n = stack.back();
+        stack.pop_back();
+        double error = CubesphereBody::projectedError(tree.nodes.worldCenter(n),
+                                                      tree.nodes.boundingRadius(n), camera,
+                                                      pixelsPerRadian, QUALITY.patchGrid);
+        if (tree.nodes.depth(n) >= CubesphereBody::MAX_DEPTH || error <= QUALITY.splitThreshold) {
+            tree.leaves++;
+            continue;
+        }
+        NodeId first = tree.nodes.allocateSiblings();
+        tree.nodes.firstChild(n) = first;
+        const auto info = tree.nodes.info(n);
+        uint32_t depth = tree.nodes.depth(n) + 1u;
+        double uMid = (info.u0 + info.u1) * 0.5;
+        double vMid = (info.v0 + info.v1) * 0.5;
+        for (int i = 0; i < 4; i++) {
+            init(first + i, info.faceIndex,
+                 (i & 1) ? uMid : info.u0, (i & 1) ? info.u1 : uMid,
+                 (i & 2) ? vMid : info.v0, (i & 2) ? info.v1 : vMid, depth);
+            stack.push_back(first + i);
+        }
+    }
+}
+
+void benchLodTraversal(const Options& opt, std::vector<Result>& results) {
+    const std::string name = "lod/collect_candidates";
+    if (!selected(opt, name)) return;
+
+    // Looking at the horizon from 2 km, 1080 px high at 60 degrees
+    double fovY = glm::radians(60.0);
+    double pixelsPerRadian = 1080.0 / (2.0 * std::tan(fovY * 0.5));
+    glm::dvec3 up = glm::normalize(glm::dvec3(0.3, -1.0, 0.2));
+    glm::dvec3 camera = up * (luna::util::LUNAR_RADIUS + 2000.0);
+    glm::dvec3 forward = glm::normalize(glm::cross(up, glm::dvec3(0.0, 0.0, 1.0)));
+
+    SyntheticTree tree;
+    buildTree(tree, camera, pixelsPerRadian);
+
+    glm::mat4 view = glm::mat4(glm::lookAt(glm::dvec3(0.0), forward, up));
+    glm::mat4 proj = glm::perspective(static_cast<float>(fovY), 16.0f / 9.0f, 0.5f, 2.0e6f);
+    glm::vec4 planes[6];
+    CubesphereBody::extractFrustumPlanes(proj * view, planes);
+
+    // The per-node work of collectCandidates: error, horizon and frustum tests,
+    // and the merge check on interior nodes whose children are all leaves
+    std::vector<NodeId> stack;
+    double occluder = luna::util::LUNAR_RADIUS - CubesphereBody::OCCLUDER_DEPTH;
+    std::printf("  (%u leaves, %u nodes)\n", tree.leaves, tree.nodes.liveCount());
+    results.push_back(measure(opt, name, 1, [&] {
+        uint32_t candidates = 0, merges = 0;
+        stack.assign(tree.roots.rbegin(), tree.roots.rend());
+        while (!stack.empty()) {
+            NodeId n = stack.back();
+            stack.pop_back();
+            const QuadtreePool& nodes = tree.nodes;
+            glm::dvec3 offset = nodes.worldCenter(n) - camera;
+            double r = nodes.boundingRadius(n);
+            double error = CubesphereBody::projectedError(nodes.worldCenter(n), r, camera,
+                                                          pixelsPerRadian, QUALITY.patchGrid);
+            bool hidden = CubesphereBody::sphereBehindHorizon(offset, r, -camera, occluder);
+            bool visible = !hidden && CubesphereBody::sphereInFrustum(
+                                          planes, glm::vec3(offset), static_cast<float>(r));
+            if (nodes.isLeaf(n)) {
+                if (visible && error > QUALITY.splitThreshold) candidates++;
+                continue;
+            }
+            NodeId first = nodes.firstChild(n);
+            bool allLeaves = true;
+            double maxChild = 0.0;
+            for (NodeId c = first; c < first + 4; c++) {
+                if (!nodes.isLeaf(c)) { allLeaves = false; break; }
+                maxChild = std::max(maxChild, CubesphereBody::projectedError(
+                    nodes.worldCenter(c), nodes.boundingRadius(c), camera, pixelsPerRadian,
+                    QUALITY.patchGrid));
+            }
+            if (allLeaves && (hidden || maxChild < QUALITY.mergeThreshold)) merges++;
+            for (NodeId c = first + 4; c-- > first;) stack.push_back(c);
+        }
+        sink = sink + candidates + merges;
+    }));
+}
+
+// --- Physics ---
+
+void benchPhysics(const Options& opt, std::vector<Result>& results) {
+    luna::sim::Physics physics;
+    physics.setTerrainQuery(luna::sim::sampleTerrainHeight, luna::sim::terrainGeneration);
+
+    // Powered descent from 15 km at 1 ms steps, as PhysicsThread runs it
+    luna::sim::SimState powered;
+    double r = luna::util::LUNAR_RADIUS + 15000.0;
+    powered.position = glm::dvec3(0.0, -r, 0.0);
+    powered.velocity = glm::dvec3(1600.0, 0.0, 0.0);
+    powered.throttle = 0.6;
+    powered.orientation = glm::angleAxis(glm::radians(80.0), glm::dvec3(0.0, 0.0, 1.0));
+
+    constexpr uint64_t STEPS = 1000;
+    if (selected(opt, "physics/step/powered_1ms")) {
+        results.push_back(measure(opt, "physics/step/powered_1ms", STEPS, [&] {
+            luna::sim::SimState s = powered;
+            for (uint64_t i = 0; i < STEPS; i++) physics.step(s, 0.001);
+            sink = sink + s.altitude;
+        }));
+    }
+
+    // Engine off in a 100 km orbit: one analytic Kepler step per call
+    luna::sim::SimState coast;
+    double orbitR = luna::util::LUNAR_RADIUS + 100'000.0;
+    coast.position = glm::dvec3(0.0, -orbitR, 0.0);
+    coast.velocity = glm::dvec3(std::sqrt(luna::util::LUNAR_GM / orbitR), 0.0, 0.0);
+    if (selected(opt, "physics/step/coast_60s")) {
+        results.push_back(measure(opt, "physics/step/coast_60s", STEPS, [&] {
+            luna::sim::SimState s = coast;
+            for (uint64_t i = 0; i < STEPS; i++) physics.step(s, 60.0);
+            sink = sink + s.altitude;
+        }));
+    }
+}
+
+// Quotes, backslashes and control characters escaped for a JSON string
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+bool writeJson(const Options& opt, const std::vector<Result>& results) {
+    std::FILE* f = std::fopen(opt.jsonPath.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "{\n  \"revision\": \"%s\",\n  \"terrain\": \"%s\",\n  \"samples\": %u,\n"
+                    "  \"results\": [\n",
+                 LUNA_GIT_REVISION, jsonEscape(opt.terrain).c_str(), opt.samples);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        std::fprintf(f, "    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, "
+                        "\"min_ns_per_op\": %.3f, \"max_ns_per_op\": %.3f}%s\n",
+                     r.name.c_str(), static_cast<unsigned long long>(r.iterations),
+                     r.nsPerOp, r.minNsPerOp, r.maxNsPerOp, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--terrain") == 0 && hasValue)        opt.terrain = argv[++i];
+        else if (std::strcmp(argv[i], "--filter") == 0 && hasValue)    opt.filter = argv[++i];
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue)      opt.jsonPath = argv[++i];
+        else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue)  opt.minTime = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--samples") == 0 && hasValue)
+            opt.samples = std::max(1, std::atoi(argv[++i]));
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    luna::util::Log::init();
+    // ChunkGenerator and Physics sample the global terrain; the heightmap cases
+    // use their own instance of the same file
+    if (!luna::sim::initTerrain(opt.terrain)) {
+        std::fprintf(stderr, "luna_bench: cannot load %s\n", opt.terrain.c_str());
+        return 1;
+    }
+    luna::sim::Heightmap map;
+    if (!map.load(opt.terrain)) {
+        std::fprintf(stderr, "luna_bench: cannot load %s\n", opt.terrain.c_str());
+        return 1;
+    }
+
+    std::printf("luna_bench %s — %s, %u samples of %.2f s\n", LUNA_GIT_REVISION,
+                opt.terrain.c_str(), opt.samples, opt.minTime);
+    std::vector<Result> results;
+    benchChunkGenerator(opt, results);
+    benchHeightmap(opt, map, results);
+    benchTiffLoad(opt, results);
+    benchLodTraversal(opt, results);
+    benchPhysics(opt, results);
+
+    luna::sim::shutdownTerrain();
+    if (!opt.jsonPath.empty() && !writeJson(opt, results)) {
+        std::fprintf(stderr, "luna_bench: cannot write %s\n", opt.jsonPath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -21,9 +21,13 @@ layout(push_constant) uniform PushConstants {
     float warningFlags;
     float progradeVisible;
     float tiltAngle;
-    float _pad0;
+    float timeWarp;
+    float profileFrameUs;
+    float profileGpuUs;
+    float profileLodUs;
+    float profileSplits;
+    float profileUploadKiB;
     float _pad1;
-    float _pad2;
 } pc;
 
 layout(location = 0) out vec4 outColor;
@@ -463,16 +467,47 @@ vec4 renderTTS(vec2 uv) {
 }
 
 // ============================================================
-// Full-screen overlay (cockpit frame, crosshair, prograde, warnings)
+// Profiler panel: frame, GPU and LOD update time (us), splits, upload KiB
 // ============================================================
 
-vec4 renderOverlay(vec2 uv) {
+vec4 renderProfile(vec2 uv) {
+    if (pc.profileFrameUs < 0.0) return vec4(0.0);
+    vec3 c = vec3(0.9, 0.9, 0.6);
+    float bgAlpha = 0.3;
+
+    // Five rows, top to bottom; label on the left, value on the right
+    int row = clamp(int(floor((1.0 - uv.y) * 5.0)), 0, 4);
+    vec2 rowUV = vec2(uv.x, fract(uv.y * 5.0));
+    rowUV.y = rowUV.y * 1.25 - 0.125;  // gap between rows
+    if (rowUV.y < 0.0 || rowUV.y > 1.0) return vec4(0.0, 0.0, 0.0, bgAlpha);
+
+    int chars[4];
+    float value;
+    if (row == 0)      { chars = int[4](CHAR_F, CHAR_R, CHAR_M, 0); value = pc.profileFrameUs; }
+    else if (row == 1) { chars = int[4](CHAR_G, CHAR_P, CHAR_U, 0); value = pc.profileGpuUs; }
+    else if (row == 2) { chars = int[4](CHAR_L, CHAR_O, CHAR_D, 0); value = pc.profileLodUs; }
+    else if (row == 3) { chars = int[4](CHAR_S, CHAR_P, CHAR_L, 0); value = pc.profileSplits; }
+    else               { chars = int[4](CHAR_U, CHAR_P, CHAR_L, 0); value = pc.profileUploadKiB; }
+
+    float labelSplit = 0.35;
+    float lit;
+    if (uv.x < labelSplit) {
+        lit = renderLabel(vec2(uv.x / labelSplit, rowUV.y), chars, 3) * 0.6;
+    } else {
+        vec2 numberUV = vec2((uv.x - labelSplit) / (1.0 - labelSplit), rowUV.y);
+        lit = renderNumber(numberUV, min(value + 0.5, 99999.0), 5, false);
+    }
+    return vec4(c * lit, bgAlpha + lit * 0.7);
+}
+
+// ============================================================
+// Overlay tiles (cockpit frame, crosshair, prograde, warnings) — all in screen UV
+// ============================================================
+
+vec4 renderFrame(vec2 uv) {
     float lit = 0.0;
     vec3 color = vec3(0.0);
 
-    // Aspect-corrected UV for circular shapes
-    vec2 auv = vec2((uv.x - 0.5) * pc.aspectRatio, uv.y - 0.5);
-
     // --- Cockpit frame: corner brackets ---
     float bracketLen = 0.06;
     float bracketThick = 0.002;
@@ -495,44 +530,47 @@ vec4 renderOverlay(vec2 uv) {
         color = vec3(0.4, 0.5, 0.4); lit = 1.0;
     }
 
-    // --- Center crosshair ---
+    if (lit > 0.0) return vec4(color, lit * 0.9);
+    return vec4(0.0);
+}
+
+vec4 renderCrosshair(vec2 uv) {
+    // Aspect-corrected UV for circular shapes
+    vec2 auv = vec2((uv.x - 0.5) * pc.aspectRatio, uv.y - 0.5);
+
     float chSize = 0.015;
     float chGap = 0.005;
     float chThick = 0.0015;
     float adx = abs(auv.x);
     float ady = abs(auv.y);
-    if (ady < chThick && adx > chGap && adx < chSize) {
-        color = vec3(0.0, 1.0, 0.3); lit = 1.0;
-    }
-    if (adx < chThick && ady > chGap && ady < chSize) {
-        color = vec3(0.0, 1.0, 0.3); lit = 1.0;
+    if ((ady < chThick && adx > chGap && adx < chSize) ||
+        (adx < chThick && ady > chGap && ady < chSize)) {
+        return vec4(0.0, 1.0, 0.3, 0.9);
     }
+    return vec4(0.0);
+}
 
-    // --- Prograde marker ---
-    if (pc.progradeVisible > 0.5) {
-        vec2 progPos = vec2(pc.progradeX * 0.5, -pc.progradeY * 0.5);
-        float progDist = length(auv - progPos);
-        float progRadius = 0.012;
+vec4 renderPrograde(vec2 uv) {
+    if (pc.progradeVisible < 0.5) return vec4(0.0);
 
-        if (abs(progDist - progRadius) < 0.0015) {
-            color = vec3(0.0, 1.0, 0.3); lit = 1.0;
-        }
-        if (progDist < 0.003) {
-            color = vec3(0.0, 1.0, 0.3); lit = 1.0;
-        }
-        float lineLen = 0.008;
-        if (abs(auv.x - progPos.x) < 0.001 && auv.y - progPos.y > progRadius && auv.y - progPos.y < progRadius + lineLen) {
-            color = vec3(0.0, 1.0, 0.3); lit = 1.0;
-        }
-        if (abs(auv.y - progPos.y) < 0.001 && progPos.x - auv.x > progRadius && progPos.x - auv.x < progRadius + lineLen) {
-            color = vec3(0.0, 1.0, 0.3); lit = 1.0;
-        }
-        if (abs(auv.y - progPos.y) < 0.001 && auv.x - progPos.x > progRadius && auv.x - progPos.x < progRadius + lineLen) {
-            color = vec3(0.0, 1.0, 0.3); lit = 1.0;
-        }
-    }
+    vec2 auv = vec2((uv.x - 0.5) * pc.aspectRatio, uv.y - 0.5);
+    vec2 progPos = vec2(pc.progradeX * 0.5, -pc.progradeY * 0.5);
+    float progDist = length(auv - progPos);
+    float progRadius = 0.012;
+    float lineLen = 0.008;
+
+    bool lit = abs(progDist - progRadius) < 0.0015 || progDist < 0.003;
+    if (abs(auv.x - progPos.x) < 0.001 && auv.y - progPos.y > progRadius && auv.y - progPos.y < progRadius + lineLen) lit = true;
+    if (abs(auv.y - progPos.y) < 0.001 && progPos.x - auv.x > progRadius && progPos.x - auv.x < progRadius + lineLen) lit = true;
+    if (abs(auv.y - progPos.y) < 0.001 && auv.x - progPos.x > progRadius && auv.x - progPos.x < progRadius + lineLen) lit = true;
+
+    return lit ? vec4(0.0, 1.0, 0.3, 0.9) : vec4(0.0);
+}
+
+vec4 renderWarnings(vec2 uv) {
+    float lit = 0.0;
+    vec3 color = vec3(0.0);
 
-    // --- Warning indicators ---
     int warnings = int(pc.warningFlags + 0.5);
     float flashRate = 3.0;
     bool flashOn = fract(pc.missionTime * flashRate) > 0.35;
@@ -668,7 +706,31 @@ void main() {
         color = renderTTS(fragUV);
     }
     else if (id == 10) {
-        color = renderOverlay(fragUV);
+        color = renderFrame(fragUV);
+    }
+    else if (id == 11) {
+        // Achieved time warp: grey at real time, white while warping
+        vec3 c = pc.timeWarp > 1.5 ? vec3(1.0) : vec3(0.5);
+        float lit;
+        if (inLabel) {
+            int chars[4] = int[4](CHAR_W, CHAR_R, CHAR_P, 0);
+            lit = renderLabel(labelUV, chars, 3) * 0.6;
+        } else {
+            lit = renderNumber(instrUV, pc.timeWarp + 0.5, 6, false);
+        }
+        color = vec4(c * lit, bgAlpha + lit * 0.7);
+    }
+    else if (id == 12) {
+        color = renderProfile(fragUV);
+    }
+    else if (id == 13) {
+        color = renderCrosshair(fragUV);
+    }
+    else if (id == 14) {
+        color = renderPrograde(fragUV);
+    }
+    else if (id == 15) {
+        color = renderWarnings(fragUV);
     }
 
     outColor = color;
@@ -22,20 +22,37 @@ layout(push_constant) uniform PushConstants {
     float warningFlags;
     float progradeVisible;
     float tiltAngle;
-    float _pad0;
+    float timeWarp;
+    float profileFrameUs;
+    float profileGpuUs;
+    float profileLodUs;
+    float profileSplits;
+    float profileUploadKiB;
     float _pad1;
-    float _pad2;
 } pc;
 
 layout(location = 0) out vec2 fragUV;
 layout(location = 1) out flat float fragInstrumentId;
 
 void main() {
+    int id = int(inInstrumentId + 0.5);
+
+    // Crosshair (13) and prograde marker (14) tiles are offsets in aspect-corrected
+    // units (screen height = 1) around their centre, the prograde one following the
+    // projected velocity as hud.frag draws it
+    vec2 screen = inPosition;
+    if (id == 13 || id == 14) {
+        vec2 center = vec2(0.5);
+        if (id == 14) center += vec2(pc.progradeX * 0.5 / pc.aspectRatio, -pc.progradeY * 0.5);
+        screen = center + vec2(inPosition.x / pc.aspectRatio, inPosition.y);
+    }
+
     // Screen UV (0-1, origin bottom-left) to Vulkan NDC (-1 to +1, Y-down)
-    vec2 ndc = inPosition * 2.0 - 1.0;
+    vec2 ndc = screen * 2.0 - 1.0;
     ndc.y = -ndc.y;
 
     gl_Position = vec4(ndc, 0.0, 1.0);
-    fragUV = inUV;
+    // Overlay tiles (10, 13-15) shade in screen UV, panels in their own
+    fragUV = (id == 10 || id >= 13) ? screen : inUV;
     fragInstrumentId = inInstrumentId;
 }
@@ -0,0 +1,10 @@
+#version 450
+
+// HUD layer cache, premultiplied, at the swapchain's resolution
+layout(set = 0, binding = 0) uniform sampler2D layers;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = texelFetch(layers, ivec2(gl_FragCoord.xy), 0);
+}
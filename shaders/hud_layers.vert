@@ -0,0 +1,11 @@
+#version 450
+
+// Composite quads of the HUD layer cache: screen UV only, no push constants
+layout(location = 0) in vec2 inPosition;
+
+void main() {
+    // Screen UV (0-1, origin bottom-left) to Vulkan NDC (-1 to +1, Y-down)
+    vec2 ndc = inPosition * 2.0 - 1.0;
+    ndc.y = -ndc.y;
+    gl_Position = vec4(ndc, 0.0, 1.0);
+}
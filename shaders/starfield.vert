@@ -10,8 +10,11 @@ layout(push_constant) uniform PushConstants {
 layout(location = 0) out float fragBrightness;
 
 void main() {
-    // Place star at large distance along direction (camera-relative, no translation)
+    // Place star at large distance along direction (camera-relative, no translation),
+    // then on the far plane (reversed-Z: depth 0), which the EQUAL depth test only
+    // passes where no terrain was drawn
     gl_Position = pc.viewProj * vec4(inDirection * 1000.0, 1.0);
+    gl_Position.z = 0.0;
     gl_PointSize = mix(1.0, 3.0, inBrightness);
     fragBrightness = inBrightness;
 }
@@ -4,18 +4,18 @@ layout(location = 0) in vec3 fragNormal;
 layout(location = 1) in float fragHeight;
 layout(location = 2) in vec3 fragSphereDir;
 
-layout(push_constant) uniform PushConstants {
+// Shared by every terrain pipeline at set 0 (CubesphereBody::frameSetLayout())
+layout(std140, set = 0, binding = 0) uniform FrameConstants {
     mat4 viewProj;
-    vec3 cameraOffset;
-    float _pad0;
     vec4 sunDirection;
-} pc;
+    vec3 cameraWorldPos;
+} frame;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
     vec3 normal = normalize(fragNormal);
-    vec3 sunDir = normalize(pc.sunDirection.xyz);
+    vec3 sunDir = normalize(frame.sunDirection.xyz);
 
     float diffuse = max(dot(normal, sunDir), 0.0);
     float ambient = 0.12;
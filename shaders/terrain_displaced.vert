@@ -0,0 +1,116 @@
+#version 450
+
+// GPU-displaced variant of terrain.vert: every patch draws the same flat grid and
+// the vertex is placed on the sphere and displaced by the heightmap here. Positions
+// are built relative to the patch origin from small UV differences, so they keep
+// float precision at Moon scale the way the CPU path's local offsets do.
+
+layout(location = 0) in vec2 inGrid;   // [0, 1]² across the patch, 0 and 1 exact
+
+// Written once per frame into the frame ring (CubesphereBody's TerrainFrame)
+layout(std140, set = 0, binding = 0) uniform FrameConstants {
+    mat4 viewProj;
+    vec4 sunDirection;
+    vec3 cameraWorldPos;
+} frame;
+
+layout(set = 1, binding = 0) uniform sampler2D heightmap;  // km, R32_SFLOAT mips
+
+layout(push_constant) uniform PushConstants {
+    vec3  originOffset;   // datum sphere point at the patch's centre UV, camera-relative
+    float radius;
+    vec2  uvCenter;
+    float uvHalfSize;
+    float gridSteps;      // quads per patch edge
+    uint  faceAndLevel;   // face | heightmap mip << 8 | boundary mip << 16
+} pc;
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out float fragHeight;
+layout(location = 2) out vec3 fragSphereDir;
+
+const float PI = 3.14159265358979;
+
+// Cube point (unnormalised) = faceNormal + u·faceU + v·faceV, as facePointToSphere
+void faceBasis(uint face, out vec3 n, out vec3 a, out vec3 b) {
+    if (face == 0u)      { n = vec3( 1, 0, 0); a = vec3( 0, 1, 0); b = vec3(0, 0,  1); }
+    else if (face == 1u) { n = vec3(-1, 0, 0); a = vec3( 0,-1, 0); b = vec3(0, 0,  1); }
+    else if (face == 2u) { n = vec3( 0, 1, 0); a = vec3( 1, 0, 0); b = vec3(0, 0, -1); }
+    else if (face == 3u) { n = vec3( 0,-1, 0); a = vec3( 1, 0, 0); b = vec3(0, 0,  1); }
+    else if (face == 4u) { n = vec3( 0, 0, 1); a = vec3( 1, 0, 0); b = vec3(0, 1,  0); }
+    else                 { n = vec3( 0, 0,-1); a = vec3(-1, 0, 0); b = vec3(0, 1,  0); }
+}
+
+// Bilinear height in meters, addressed exactly like Heightmap::sample
+float sampleHeight(vec3 dir, int level) {
+    ivec2 size = textureSize(heightmap, level);
+    float lat = asin(clamp(dir.y, -1.0, 1.0));
+    float lon = atan(dir.z, dir.x);
+    float py = clamp((0.5 - lat / PI) * float(size.y) - 0.5, 0.0, float(size.y - 1));
+    float px = (lon / (2.0 * PI) + 0.5) * float(size.x) - 0.5;
+    if (px < 0.0) px += float(size.x);
+    else if (px >= float(size.x)) px -= float(size.x);
+
+    int x0 = min(int(px), size.x - 1);
+    int y0 = int(py);
+    int x1 = (x0 + 1) % size.x;
+    int y1 = min(y0 + 1, size.y - 1);
+    float fx = px - float(x0);
+    float fy = py - float(y0);
+
+    float v00 = texelFetch(heightmap, ivec2(x0, y0), level).r;
+    float v10 = texelFetch(heightmap, ivec2(x1, y0), level).r;
+    float v01 = texelFetch(heightmap, ivec2(x0, y1), level).r;
+    float v11 = texelFetch(heightmap, ivec2(x1, y1), level).r;
+    return mix(mix(v00, v10, fx), mix(v01, v11, fx), fy) * 1000.0;
+}
+
+// Datum sphere point at local UV offset d from the patch centre, relative to the
+// patch origin: R·(c/|c| − cc/|cc|) expanded so only small terms are subtracted
+vec3 datumOffset(vec3 cc, float lc, vec3 d, out vec3 dir) {
+    vec3 c = cc + d;
+    float l = length(c);
+    dir = c / l;
+    float k = (2.0 * dot(cc, d) + dot(d, d)) / (l * lc * (l + lc));
+    return pc.radius * (d / l - cc * k);
+}
+
+// Displaced surface point for a local UV offset, relative to the patch origin
+vec3 surfacePoint(vec3 cc, float lc, vec3 a, vec3 b, vec2 uv, int level, out float height) {
+    vec3 dir;
+    vec3 p = datumOffset(cc, lc, uv.x * a + uv.y * b, dir);
+    height = sampleHeight(dir, level);
+    return p + dir * height;
+}
+
+void main() {
+    uint face = pc.faceAndLevel & 0xFFu;
+    int level = int((pc.faceAndLevel >> 8) & 0xFFu);
+    vec3 n, a, b;
+    faceBasis(face, n, a, b);
+    vec3 cc = n + pc.uvCenter.x * a + pc.uvCenter.y * b;
+    float lc = length(cc);
+
+    // Local UV offset from the patch centre; half a grid step for central differences
+    vec2 uv = (inGrid * 2.0 - 1.0) * pc.uvHalfSize;
+    float halfStep = pc.uvHalfSize / pc.gridSteps;
+
+    float height, unused;
+    vec3 p = surfacePoint(cc, lc, a, b, uv, level, height);
+    vec3 tangentU = surfacePoint(cc, lc, a, b, uv + vec2(halfStep, 0.0), level, unused)
+                  - surfacePoint(cc, lc, a, b, uv - vec2(halfStep, 0.0), level, unused);
+    vec3 tangentV = surfacePoint(cc, lc, a, b, uv + vec2(0.0, halfStep), level, unused)
+                  - surfacePoint(cc, lc, a, b, uv - vec2(0.0, halfStep), level, unused);
+    vec3 normal = normalize(cross(tangentU, tangentV));
+
+    // Boundary vertices use the level every depth shares, so neighbours agree on shared edges
+    if (any(equal(inGrid, vec2(0.0))) || any(equal(inGrid, vec2(1.0))))
+        p = surfacePoint(cc, lc, a, b, uv, int(pc.faceAndLevel >> 16), height);
+
+    vec3 viewPos = p + pc.originOffset;
+    gl_Position = frame.viewProj * vec4(viewPos, 1.0);
+    fragNormal = normal;
+    fragHeight = height;
+    // Reconstruct world position relative to Moon center for lat/lon gridlines
+    fragSphereDir = viewPos + frame.cameraWorldPos;
+}
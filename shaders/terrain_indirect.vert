@@ -0,0 +1,91 @@
+#version 450
+
+// GPU-driven variant of terrain.vert: the patch records are the culler's SSBO at
+// set 1, which terrain_cull.comp turned into indirect draws with matching firstInstance.
+
+// ChunkVertex: xyz quantised over ±positionScale, w is height over ±HEIGHT_RANGE;
+// inMorph is the parent patch's position and height, packed the same way
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal;
+layout(location = 2) in vec4 inMorph;
+
+const float HEIGHT_RANGE = 16384.0;
+
+struct PatchRecord {
+    uint  slot;           // indexes centers[]
+    float boundingRadius;
+    int   vertexOffset;
+    float positionScale;
+    float morph;
+    uint  indexRange;
+    uint  _pad[2];
+    vec4  edgeMorph;
+};
+
+// TerrainArena's PatchCenter, written once when the slot is filled
+struct PatchCenter {
+    vec4 high;
+    vec4 low;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer Patches { PatchRecord patches[]; };
+
+// Written once per frame into the frame ring (CubesphereBody's TerrainFrame)
+layout(std140, set = 0, binding = 0) uniform FrameConstants {
+    mat4 viewProj;
+    vec4 sunDirection;
+    vec3 cameraWorldPos;
+    uint patchGrid;       // vertices per patch edge (TerrainQuality::patchGrid)
+    vec4 cameraHigh;      // cameraWorldPos as a high/low float pair (xyz)
+    vec4 cameraLow;
+} frame;
+
+layout(std430, set = 0, binding = 2) readonly buffer Centers { PatchCenter centers[]; };
+
+// Matches ChunkGenerator's unpackNormal
+vec3 octDecode(vec2 e) {
+    e = max(e, vec2(-1.0));
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+// Boundary vertices blend by their edge's factor, which the neighbour across it
+// shares; corners are even vertices and never move
+float vertexMorph(int local, float patchMorph, vec4 edgeMorph) {
+    int grid = int(frame.patchGrid);
+    int i = local % grid;
+    int j = local / grid;
+    if (j == 0) return edgeMorph.x;
+    if (j == grid - 1) return edgeMorph.y;
+    if (i == 0) return edgeMorph.z;
+    if (i == grid - 1) return edgeMorph.w;
+    return patchMorph;
+}
+
+// Camera-relative patch centre: the halves are subtracted separately so the
+// offset keeps the pair's precision; precise stops the compiler reassociating it
+vec3 centerOffset(uint slot) {
+    precise vec3 high = centers[slot].high.xyz - frame.cameraHigh.xyz;
+    precise vec3 low  = centers[slot].low.xyz - frame.cameraLow.xyz;
+    precise vec3 offset = high + low;
+    return offset;
+}
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out float fragHeight;
+layout(location = 2) out vec3 fragSphereDir;
+
+void main() {
+    PatchRecord rec = patches[gl_InstanceIndex];
+    float morph = vertexMorph(gl_VertexIndex - rec.vertexOffset, rec.morph, rec.edgeMorph);
+    vec4 shape = mix(inPosition, inMorph, morph);
+    vec3 viewPos = (shape.xyz * 2.0 - 1.0) * rec.positionScale + centerOffset(rec.slot);
+    gl_Position = frame.viewProj * vec4(viewPos, 1.0);
+    fragNormal = octDecode(inNormal);
+    fragHeight = (shape.w * 2.0 - 1.0) * HEIGHT_RANGE;
+    // Reconstruct world position relative to Moon center for lat/lon gridlines
+    fragSphereDir = viewPos + frame.cameraWorldPos;
+}
@@ -0,0 +1,15 @@
+#version 450
+
+layout(location = 0) in float fragProgress;
+
+layout(push_constant) uniform PushConstants {
+    mat4 viewProj;
+    vec4 color;
+} pc;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // Fade toward the end of the prediction, where it is least certain
+    outColor = vec4(pc.color.rgb, pc.color.a * mix(1.0, 0.3, fragProgress));
+}
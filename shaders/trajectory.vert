@@ -0,0 +1,21 @@
+#version 450
+
+// Predicted flight path as a camera-relative line strip (Hud::updateTrajectory)
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in float inProgress;
+
+layout(push_constant) uniform PushConstants {
+    mat4 viewProj;  // rotation-only
+    vec4 color;
+} pc;
+
+layout(location = 0) out float fragProgress;
+
+void main() {
+    gl_Position = pc.viewProj * vec4(inPosition, 1.0);
+    // A full orbit reaches past the far plane; pin it there (reversed-Z depth 0)
+    // instead of clipping it, so the terrain still hides the part behind the Moon
+    gl_Position.z = max(gl_Position.z, 0.0);
+    fragProgress = inProgress;
+}
@@ -0,0 +1,37 @@
+#version 450
+
+// Scene color (SceneTarget), drawn into its top-left uvScale
+layout(set = 0, binding = 0) uniform sampler2D scene;
+
+layout(push_constant) uniform PushConstants {
+    vec2  uvScale;
+    vec2  texelSize;
+    float sharpness;
+} pc;
+
+layout(location = 0) in vec2 fragUV;
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // Bilinear taps stay half a texel inside the drawn extent: texels beyond it
+    // hold whatever a larger scale left there
+    vec2 lo = 0.5 * pc.texelSize;
+    vec2 hi = pc.uvScale - 0.5 * pc.texelSize;
+    vec2 uv = clamp(fragUV * pc.uvScale, lo, hi);
+    vec3 c = texture(scene, uv).rgb;
+
+    if (pc.sharpness > 0.0) {
+        // Unsharp mask against the four neighbours one scene texel away, held to
+        // their range so edges (the limb against black sky) do not ring
+        vec3 n = texture(scene, clamp(uv - vec2(0.0, pc.texelSize.y), lo, hi)).rgb;
+        vec3 s = texture(scene, clamp(uv + vec2(0.0, pc.texelSize.y), lo, hi)).rgb;
+        vec3 w = texture(scene, clamp(uv - vec2(pc.texelSize.x, 0.0), lo, hi)).rgb;
+        vec3 e = texture(scene, clamp(uv + vec2(pc.texelSize.x, 0.0), lo, hi)).rgb;
+        vec3 minC = min(c, min(min(n, s), min(w, e)));
+        vec3 maxC = max(c, max(max(n, s), max(w, e)));
+        vec3 sharpened = c + (4.0 * c - n - s - w - e) * (0.25 * pc.sharpness);
+        c = clamp(sharpened, minC, maxC);
+    }
+
+    outColor = vec4(c, 1.0);
+}
@@ -0,0 +1,11 @@
+#version 450
+
+// One triangle covering the framebuffer, no vertex buffer: UV (0,0), (2,0), (0,2)
+layout(location = 0) out vec2 fragUV;
+
+void main() {
+    vec2 uv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    fragUV = uv;
+    // UV origin top-left, as the scene image's rows
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
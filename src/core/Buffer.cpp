@@ -1,4 +1,4 @@
-// About: Buffer implementation — staging uploads, memory type selection, RAII cleanup.
+// About: Buffer implementation — staging uploads, direct-write memory, memory type selection, RAII cleanup.
 
 #include "core/Buffer.h"
 #include "core/VulkanContext.h"
@@ -12,11 +12,11 @@ namespace luna::core {
 Buffer::~Buffer() { cleanup(); }
 
 Buffer::Buffer(Buffer&& other) noexcept
-    : device_(other.device_), buffer_(other.buffer_),
-      memory_(other.memory_), size_(other.size_)
+    : device_(other.device_), buffer_(other.buffer_), heap_(other.heap_),
+      alloc_(other.alloc_), size_(other.size_)
 {
     other.buffer_ = VK_NULL_HANDLE;
-    other.memory_ = VK_NULL_HANDLE;
+    other.alloc_  = GpuAllocation{};
     other.size_   = 0;
 }
 
@@ -25,10 +25,11 @@ Buffer& Buffer::operator=(Buffer&& other) noexcept {
         cleanup();
         device_ = other.device_;
         buffer_ = other.buffer_;
-        memory_ = other.memory_;
+        heap_   = other.heap_;
+        alloc_  = other.alloc_;
         size_   = other.size_;
         other.buffer_ = VK_NULL_HANDLE;
-        other.memory_ = VK_NULL_HANDLE;
+        other.alloc_  = GpuAllocation{};
         other.size_   = 0;
     }
     return *this;
@@ -36,71 +37,72 @@ Buffer& Buffer::operator=(Buffer&& other) noexcept {
 
 void Buffer::cleanup() {
     if (buffer_) vkDestroyBuffer(device_, buffer_, nullptr);
-    if (memory_) vkFreeMemory(device_, memory_, nullptr);
+    if (heap_) heap_->free(alloc_);
     buffer_ = VK_NULL_HANDLE;
-    memory_ = VK_NULL_HANDLE;
 }
 
-uint32_t Buffer::findMemoryType(VkPhysicalDevice physDevice, uint32_t typeFilter,
-                                VkMemoryPropertyFlags properties) {
-    VkPhysicalDeviceMemoryProperties memProps;
-    vkGetPhysicalDeviceMemoryProperties(physDevice, &memProps);
-    for (uint32_t i = 0; i < memProps.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) &&
-            (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-            return i;
-    }
-    throw std::runtime_error("Failed to find suitable memory type");
-}
-
-Buffer Buffer::createRaw(VkDevice device, VkPhysicalDevice physDevice,
-                         VkDeviceSize size, VkBufferUsageFlags usage,
-                         VkMemoryPropertyFlags memProps) {
+Buffer Buffer::createUnbound(const VulkanContext& ctx,
+                             VkDeviceSize size, VkBufferUsageFlags usage,
+                             uint32_t familyCount, const uint32_t* families) {
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size        = size;
     bufferInfo.usage       = usage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (familyCount > 1) {
+        bufferInfo.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = familyCount;
+        bufferInfo.pQueueFamilyIndices   = families;
+    }
 
     Buffer buf;
-    buf.device_ = device;
+    buf.device_ = ctx.device();
+    buf.heap_   = &ctx.heap();
     buf.size_   = size;
 
-    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buf.buffer_) != VK_SUCCESS)
+    if (vkCreateBuffer(buf.device_, &bufferInfo, nullptr, &buf.buffer_) != VK_SUCCESS)
         throw std::runtime_error("Failed to create buffer");
+    return buf;
+}
 
-    VkMemoryRequirements memReqs;
-    vkGetBufferMemoryRequirements(device, buf.buffer_, &memReqs);
+void Buffer::bind(const GpuAllocation& alloc) {
+    alloc_ = alloc;
+    vkBindBufferMemory(device_, buffer_, alloc_.memory, alloc_.offset);
+}
 
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize  = memReqs.size;
-    allocInfo.memoryTypeIndex = Buffer::findMemoryType(physDevice, memReqs.memoryTypeBits, memProps);
+Buffer Buffer::createRaw(const VulkanContext& ctx,
+                         VkDeviceSize size, VkBufferUsageFlags usage,
+                         VkMemoryPropertyFlags memProps,
+                         uint32_t familyCount, const uint32_t* families) {
+    Buffer buf = createUnbound(ctx, size, usage, familyCount, families);
 
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &buf.memory_) != VK_SUCCESS)
-        throw std::runtime_error("Failed to allocate buffer memory");
+    VkMemoryRequirements memReqs;
+    vkGetBufferMemoryRequirements(buf.device_, buf.buffer_, &memReqs);
 
-    vkBindBufferMemory(device, buf.buffer_, buf.memory_, 0);
+    // Sub-allocated from a shared block — no vkAllocateMemory per buffer
+    buf.bind(buf.heap_->allocate(memReqs, memProps));
     return buf;
 }
 
 Buffer Buffer::createStatic(const VulkanContext& ctx, const CommandPool& cmdPool,
                             VkBufferUsageFlags usage, const void* data, VkDeviceSize size) {
+    if (auto direct = createDirect(ctx, usage, size); direct.handle()) {
+        std::memcpy(direct.map(), data, static_cast<size_t>(size));
+        return direct;
+    }
+
     // Create staging buffer
     auto staging = createRaw(
-        ctx.device(), ctx.physicalDevice(), size,
+        ctx, size,
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
     // Copy data to staging
-    void* mapped;
-    vkMapMemory(ctx.device(), staging.memory_, 0, size, 0, &mapped);
-    std::memcpy(mapped, data, static_cast<size_t>(size));
-    vkUnmapMemory(ctx.device(), staging.memory_);
+    std::memcpy(staging.map(), data, static_cast<size_t>(size));
 
     // Create device-local buffer
     auto buffer = createRaw(
-        ctx.device(), ctx.physicalDevice(), size,
+        ctx, size,
         usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
@@ -117,20 +119,37 @@ Buffer Buffer::createStatic(const VulkanContext& ctx, const CommandPool& cmdPool
 void StagingBatch::begin(const VulkanContext& ctx, VkDeviceSize cap) {
     capacity = cap;
     offset = 0;
+    base = 0;
     buffer = Buffer::createDynamic(ctx, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, cap);
+    handle = buffer.handle();
     mapped = buffer.map();
 }
 
+void StagingBatch::beginRegion(VkBuffer ring, void* ringMapped, VkDeviceSize start,
+                               VkDeviceSize cap) {
+    capacity = cap;
+    offset = 0;
+    base = start;
+    handle = ring;
+    mapped = static_cast<char*>(ringMapped) + start;
+}
+
 void StagingBatch::end() {
-    if (mapped) {
+    if (mapped && buffer.handle())
         buffer.unmap();
-        mapped = nullptr;
-    }
+    mapped = nullptr;
 }
 
 VkDeviceSize StagingBatch::write(const void* data, VkDeviceSize size) {
-    VkDeviceSize srcOffset = offset;
-    std::memcpy(static_cast<char*>(mapped) + offset, data, static_cast<size_t>(size));
+    VkDeviceSize srcOffset = reserve(size);
+    std::memcpy(at(srcOffset), data, static_cast<size_t>(size));
+    return srcOffset;
+}
+
+VkDeviceSize StagingBatch::reserve(VkDeviceSize size) {
+    if (offset + size > capacity)
+        throw std::runtime_error("Staging batch overflow");
+    VkDeviceSize srcOffset = base + offset;
     offset += size;
     return srcOffset;
 }
@@ -140,44 +159,73 @@ Buffer Buffer::createStaticBatch(const VulkanContext& ctx,
                                  VkBufferUsageFlags usage,
                                  const void* data, VkDeviceSize size,
                                  StagingBatch& staging) {
-    VkDeviceSize srcOffset = staging.write(data, size);
+    // Host writes before the frame's submit are visible to it, so there is no copy
+    // to wait for either
+    if (auto direct = createDirect(ctx, usage, size); direct.handle()) {
+        std::memcpy(direct.map(), data, static_cast<size_t>(size));
+        return direct;
+    }
 
-    auto buffer = createRaw(
-        ctx.device(), ctx.physicalDevice(), size,
+    auto buffer = createDeviceLocal(ctx, usage, size);
+    buffer.recordUpload(transferCmd, staging, data, size, 0);
+    return buffer;
+}
+
+Buffer Buffer::createDeviceLocal(const VulkanContext& ctx, VkBufferUsageFlags usage,
+                                 VkDeviceSize size) {
+    auto families = ctx.queueFamilies();
+    uint32_t familyIndices[] = { families.graphics, families.transfer };
+    return createRaw(
+        ctx, size,
         usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        families.hasDedicatedTransfer() ? 2u : 1u, familyIndices);
+}
 
-    VkBufferCopy copyRegion{};
-    copyRegion.srcOffset = srcOffset;
-    copyRegion.size = size;
-    vkCmdCopyBuffer(transferCmd, staging.buffer.handle(), buffer.handle(), 1, &copyRegion);
+Buffer Buffer::createDirect(const VulkanContext& ctx, VkBufferUsageFlags usage,
+                            VkDeviceSize size) {
+    auto families = ctx.queueFamilies();
+    uint32_t familyIndices[] = { families.graphics, families.transfer };
+    Buffer buf = createUnbound(ctx, size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                               families.hasDedicatedTransfer() ? 2u : 1u, familyIndices);
 
-    return buffer;
+    VkMemoryRequirements memReqs;
+    vkGetBufferMemoryRequirements(buf.device_, buf.buffer_, &memReqs);
+
+    uint32_t memoryType;
+    if (!buf.heap_->findDirectMemoryType(memReqs.memoryTypeBits, memReqs.size, memoryType))
+        return Buffer();  // `buf` destroys the unbound handle
+    buf.bind(buf.heap_->allocateType(memReqs, memoryType));
+    return buf;
+}
+
+void Buffer::recordUpload(VkCommandBuffer transferCmd, StagingBatch& staging,
+                          const void* data, VkDeviceSize size, VkDeviceSize dstOffset) {
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = staging.write(data, size);
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size      = size;
+    vkCmdCopyBuffer(transferCmd, staging.handle, buffer_, 1, &copyRegion);
 }
 
 Buffer Buffer::createDynamic(const VulkanContext& ctx, VkBufferUsageFlags usage,
                              VkDeviceSize size) {
     return createRaw(
-        ctx.device(), ctx.physicalDevice(), size, usage,
+        ctx, size, usage,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 }
 
 void* Buffer::map() {
-    void* data;
-    vkMapMemory(device_, memory_, 0, size_, 0, &data);
-    return data;
+    if (!alloc_.mapped)
+        throw std::runtime_error("Buffer::map on non-host-visible memory");
+    return alloc_.mapped;
 }
 
-void Buffer::unmap() {
-    vkUnmapMemory(device_, memory_);
-}
+void Buffer::unmap() {}
 
 void Buffer::release() {
-    if (buffer_) vkDestroyBuffer(device_, buffer_, nullptr);
-    if (memory_) vkFreeMemory(device_, memory_, nullptr);
-    buffer_ = VK_NULL_HANDLE;
-    memory_ = VK_NULL_HANDLE;
-    size_   = 0;
+    cleanup();
+    size_ = 0;
 }
 
 } // namespace luna::core
@@ -1,7 +1,8 @@
-// About: Vulkan buffer creation (static GPU-only, dynamic host-visible) and staging uploads.
+// About: Vulkan buffer creation (static GPU-only, direct-write device-local, dynamic host-visible) and staging uploads.
 
 #pragma once
 
+#include "core/GpuHeap.h"
 #include <vulkan/vulkan.h>
 #include <cstddef>
 
@@ -24,22 +25,47 @@ public:
     VkBuffer handle() const { return buffer_; }
     VkDeviceSize size() const { return size_; }
 
-    // Upload data to GPU-local memory via staging buffer (blocks until complete)
+    // Upload data to GPU-local memory via staging buffer (blocks until complete).
+    // Where createDirect() finds memory, the data is written in place instead.
     static Buffer createStatic(const VulkanContext& ctx, const CommandPool& cmdPool,
                                VkBufferUsageFlags usage, const void* data, VkDeviceSize size);
 
     // Record a staging copy into an existing command buffer using shared staging memory.
     // Caller must keep staging alive until the command buffer finishes execution.
+    // The buffer is shared between the graphics and transfer families, so the copy
+    // may run on the dedicated transfer queue without an ownership transfer.
+    // Where createDirect() finds memory, the data is written in place and nothing
+    // is recorded.
     static Buffer createStaticBatch(const VulkanContext& ctx,
                                     VkCommandBuffer transferCmd,
                                     VkBufferUsageFlags usage,
                                     const void* data, VkDeviceSize size,
                                     StagingBatch& staging);
 
+    // Device-local buffer with undefined contents, filled later via recordUpload().
+    // Shared with the transfer family like createStaticBatch.
+    static Buffer createDeviceLocal(const VulkanContext& ctx, VkBufferUsageFlags usage,
+                                    VkDeviceSize size);
+
+    // Device-local buffer the host writes through map(), so filling it needs no
+    // staging copy: resizable BAR or unified memory, see
+    // GpuHeap::findDirectMemoryType. Returns an empty buffer (null handle) when
+    // there is no such memory or its heap is too small; use createDeviceLocal then.
+    // Also accepts recordUpload, like createDeviceLocal.
+    static Buffer createDirect(const VulkanContext& ctx, VkBufferUsageFlags usage,
+                               VkDeviceSize size);
+
+    // Record a staging copy of `size` bytes into this buffer at dstOffset.
+    // Caller must keep staging alive until the command buffer finishes execution.
+    void recordUpload(VkCommandBuffer transferCmd, StagingBatch& staging,
+                      const void* data, VkDeviceSize size, VkDeviceSize dstOffset);
+
     // Host-visible buffer for per-frame updates
     static Buffer createDynamic(const VulkanContext& ctx, VkBufferUsageFlags usage,
                                 VkDeviceSize size);
 
+    // Host-visible buffers, dynamic or direct, live in persistently mapped heap
+    // blocks; map() returns that pointer and unmap() is a no-op kept for symmetry.
     void* map();
     void  unmap();
 
@@ -48,30 +74,50 @@ public:
     void release();
 
 private:
-    static Buffer createRaw(VkDevice device, VkPhysicalDevice physDevice,
+    // A buffer handle with no memory yet; bind() attaches it
+    static Buffer createUnbound(const VulkanContext& ctx,
+                                VkDeviceSize size, VkBufferUsageFlags usage,
+                                uint32_t familyCount, const uint32_t* families);
+    void bind(const GpuAllocation& alloc);
+    // familyCount > 1 creates the buffer with VK_SHARING_MODE_CONCURRENT across families
+    static Buffer createRaw(const VulkanContext& ctx,
                             VkDeviceSize size, VkBufferUsageFlags usage,
-                            VkMemoryPropertyFlags memProps);
-    static uint32_t findMemoryType(VkPhysicalDevice physDevice, uint32_t typeFilter,
-                                   VkMemoryPropertyFlags properties);
+                            VkMemoryPropertyFlags memProps,
+                            uint32_t familyCount = 0, const uint32_t* families = nullptr);
     void cleanup();
 
-    VkDevice       device_ = VK_NULL_HANDLE;
-    VkBuffer       buffer_ = VK_NULL_HANDLE;
-    VkDeviceMemory memory_ = VK_NULL_HANDLE;
-    VkDeviceSize   size_   = 0;
+    VkDevice      device_ = VK_NULL_HANDLE;
+    VkBuffer      buffer_ = VK_NULL_HANDLE;
+    GpuHeap*      heap_   = nullptr;
+    GpuAllocation alloc_;
+    VkDeviceSize  size_   = 0;
 };
 
-// Bump allocator over a single host-visible staging buffer.
-// Reduces per-batch staging allocations from N to 1, avoiding RADV BO-list limits.
+// Bump allocator over host-visible staging memory: a buffer of its own (begin), or
+// a region of a persistently mapped ring someone else owns (beginRegion).
+// Reduces per-batch staging allocations from N to 1, or to none for a ring region,
+// avoiding RADV BO-list limits.
 struct StagingBatch {
-    Buffer       buffer;
-    void*        mapped = nullptr;
-    VkDeviceSize offset = 0;
+    Buffer       buffer;                     // owned storage; empty for a ring region
+    VkBuffer     handle   = VK_NULL_HANDLE;  // copies read from here
+    void*        mapped   = nullptr;         // host address of `base`
+    VkDeviceSize base     = 0;               // start of the batch within handle
+    VkDeviceSize offset   = 0;               // bytes used
     VkDeviceSize capacity = 0;
 
     void begin(const VulkanContext& ctx, VkDeviceSize cap);
+    void beginRegion(VkBuffer ring, void* ringMapped, VkDeviceSize start, VkDeviceSize cap);
     void end();
+
+    // Both return the copy's source offset within `handle`. Overflowing the
+    // capacity throws, since a ring region is followed by other batches' data.
     VkDeviceSize write(const void* data, VkDeviceSize size);
+    // Claim `size` bytes without writing them; the caller fills at() before the
+    // batch is submitted
+    VkDeviceSize reserve(VkDeviceSize size);
+    void*        at(VkDeviceSize srcOffset) const {
+        return static_cast<char*>(mapped) + (srcOffset - base);
+    }
 };
 
 } // namespace luna::core
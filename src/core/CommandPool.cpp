@@ -2,27 +2,32 @@
 
 #include "core/CommandPool.h"
 #include "core/VulkanContext.h"
+#include "util/Profiler.h"
 
 #include <stdexcept>
 
 namespace luna::core {
 
-CommandPool::CommandPool(const VulkanContext& ctx, uint32_t count)
+CommandPool::CommandPool(const VulkanContext& ctx, uint32_t count, uint32_t queueFamily,
+                         VkCommandBufferLevel level)
     : device_(ctx.device())
 {
     VkCommandPoolCreateInfo poolInfo{};
     poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    poolInfo.queueFamilyIndex = ctx.queueFamilies().graphics;
+    poolInfo.queueFamilyIndex = (queueFamily != UINT32_MAX) ? queueFamily
+                                                            : ctx.queueFamilies().graphics;
 
     if (vkCreateCommandPool(device_, &poolInfo, nullptr, &pool_) != VK_SUCCESS)
         throw std::runtime_error("Failed to create command pool");
 
+    if (count == 0) return;
+
     buffers_.resize(count);
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.commandPool        = pool_;
-    allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.level              = level;
     allocInfo.commandBufferCount = count;
 
     if (vkAllocateCommandBuffers(device_, &allocInfo, buffers_.data()) != VK_SUCCESS)
@@ -33,6 +38,10 @@ CommandPool::~CommandPool() {
     if (pool_) vkDestroyCommandPool(device_, pool_, nullptr);
 }
 
+void CommandPool::reset() const {
+    vkResetCommandPool(device_, pool_, 0);
+}
+
 VkCommandBuffer CommandPool::beginOneShot() const {
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -52,6 +61,7 @@ VkCommandBuffer CommandPool::beginOneShot() const {
 }
 
 void CommandPool::endOneShot(VkCommandBuffer cmd, VkQueue queue) const {
+    PROFILE_SCOPE("endOneShot");
     vkEndCommandBuffer(cmd);
 
     VkFenceCreateInfo fenceInfo{};
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <cstdint>
 #include <vector>
 
 namespace luna::core {
@@ -11,7 +12,10 @@ class VulkanContext;
 
 class CommandPool {
 public:
-    CommandPool(const VulkanContext& ctx, uint32_t count);
+    // queueFamily defaults to the graphics family. SECONDARY buffers are recorded
+    // inside a render pass begun on a primary buffer (see ParallelRecorder).
+    CommandPool(const VulkanContext& ctx, uint32_t count, uint32_t queueFamily = UINT32_MAX,
+                VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
     ~CommandPool();
 
     CommandPool(const CommandPool&) = delete;
@@ -20,6 +24,9 @@ public:
     VkCommandPool    pool() const { return pool_; }
     VkCommandBuffer  buffer(uint32_t i) const { return buffers_[i]; }
 
+    // Return every buffer of the pool to the initial state in one call
+    void reset() const;
+
     VkCommandBuffer beginOneShot() const;
     void            endOneShot(VkCommandBuffer cmd, VkQueue queue) const;
 
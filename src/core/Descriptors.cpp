@@ -0,0 +1,184 @@
+// About: Descriptors implementation — layout/pool RAII and descriptor writes.
+
+#include "core/Descriptors.h"
+#include "core/VulkanContext.h"
+
+#include <stdexcept>
+
+namespace luna::core {
+
+// --- DescriptorSetLayout ---
+
+DescriptorSetLayout::DescriptorSetLayout(const VulkanContext& ctx,
+                                         const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+    : device_(ctx.device())
+{
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings    = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device_, &layoutInfo, nullptr, &layout_) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create descriptor set layout");
+}
+
+DescriptorSetLayout::~DescriptorSetLayout() {
+    if (layout_) vkDestroyDescriptorSetLayout(device_, layout_, nullptr);
+}
+
+DescriptorSetLayout::DescriptorSetLayout(DescriptorSetLayout&& other) noexcept
+    : device_(other.device_), layout_(other.layout_)
+{
+    other.layout_ = VK_NULL_HANDLE;
+}
+
+DescriptorSetLayout& DescriptorSetLayout::operator=(DescriptorSetLayout&& other) noexcept {
+    if (this != &other) {
+        if (layout_) vkDestroyDescriptorSetLayout(device_, layout_, nullptr);
+        device_ = other.device_;
+        layout_ = other.layout_;
+        other.layout_ = VK_NULL_HANDLE;
+    }
+    return *this;
+}
+
+VkDescriptorSetLayoutBinding DescriptorSetLayout::storageBuffer(uint32_t binding,
+                                                                VkShaderStageFlags stages) {
+    VkDescriptorSetLayoutBinding b{};
+    b.binding         = binding;
+    b.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    b.descriptorCount = 1;
+    b.stageFlags      = stages;
+    return b;
+}
+
+VkDescriptorSetLayoutBinding DescriptorSetLayout::uniformBufferDynamic(uint32_t binding,
+                                                                       VkShaderStageFlags stages) {
+    VkDescriptorSetLayoutBinding b{};
+    b.binding         = binding;
+    b.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    b.descriptorCount = 1;
+    b.stageFlags      = stages;
+    return b;
+}
+
+VkDescriptorSetLayoutBinding DescriptorSetLayout::storageBufferDynamic(uint32_t binding,
+                                                                       VkShaderStageFlags stages) {
+    VkDescriptorSetLayoutBinding b{};
+    b.binding         = binding;
+    b.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    b.descriptorCount = 1;
+    b.stageFlags      = stages;
+    return b;
+}
+
+VkDescriptorSetLayoutBinding DescriptorSetLayout::combinedImageSampler(uint32_t binding,
+                                                                       VkShaderStageFlags stages) {
+    VkDescriptorSetLayoutBinding b{};
+    b.binding         = binding;
+    b.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    b.descriptorCount = 1;
+    b.stageFlags      = stages;
+    return b;
+}
+
+// --- DescriptorPool ---
+
+DescriptorPool::DescriptorPool(const VulkanContext& ctx, uint32_t maxSets,
+                               const std::vector<VkDescriptorPoolSize>& sizes)
+    : device_(ctx.device())
+{
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets       = maxSets;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(sizes.size());
+    poolInfo.pPoolSizes    = sizes.data();
+
+    if (vkCreateDescriptorPool(device_, &poolInfo, nullptr, &pool_) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create descriptor pool");
+}
+
+DescriptorPool::~DescriptorPool() {
+    if (pool_) vkDestroyDescriptorPool(device_, pool_, nullptr);
+}
+
+DescriptorPool::DescriptorPool(DescriptorPool&& other) noexcept
+    : device_(other.device_), pool_(other.pool_)
+{
+    other.pool_ = VK_NULL_HANDLE;
+}
+
+DescriptorPool& DescriptorPool::operator=(DescriptorPool&& other) noexcept {
+    if (this != &other) {
+        if (pool_) vkDestroyDescriptorPool(device_, pool_, nullptr);
+        device_ = other.device_;
+        pool_   = other.pool_;
+        other.pool_ = VK_NULL_HANDLE;
+    }
+    return *this;
+}
+
+VkDescriptorSet DescriptorPool::allocate(VkDescriptorSetLayout layout) {
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool     = pool_;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts        = &layout;
+
+    VkDescriptorSet set;
+    if (vkAllocateDescriptorSets(device_, &allocInfo, &set) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate descriptor set");
+    return set;
+}
+
+void writeStorageBuffer(VkDevice device, VkDescriptorSet set, uint32_t binding, VkBuffer buffer) {
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range  = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet write{};
+    write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet          = set;
+    write.dstBinding      = binding;
+    write.descriptorCount = 1;
+    write.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo     = &bufferInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
+
+void writeDynamicBuffer(VkDevice device, VkDescriptorSet set, uint32_t binding,
+                        VkDescriptorType type, VkBuffer buffer, VkDeviceSize range) {
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range  = range;
+
+    VkWriteDescriptorSet write{};
+    write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet          = set;
+    write.dstBinding      = binding;
+    write.descriptorCount = 1;
+    write.descriptorType  = type;
+    write.pBufferInfo     = &bufferInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
+
+void writeCombinedImageSampler(VkDevice device, VkDescriptorSet set, uint32_t binding,
+                               VkImageView view, VkSampler sampler) {
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler     = sampler;
+    imageInfo.imageView   = view;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write{};
+    write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet          = set;
+    write.dstBinding      = binding;
+    write.descriptorCount = 1;
+    write.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo      = &imageInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
+
+} // namespace luna::core
@@ -0,0 +1,74 @@
+// About: Descriptor set layout and pool wrappers with buffer and image write helpers.
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+namespace luna::core {
+
+class VulkanContext;
+
+class DescriptorSetLayout {
+public:
+    DescriptorSetLayout() = default;
+    DescriptorSetLayout(const VulkanContext& ctx,
+                        const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+    ~DescriptorSetLayout();
+
+    DescriptorSetLayout(DescriptorSetLayout&& other) noexcept;
+    DescriptorSetLayout& operator=(DescriptorSetLayout&& other) noexcept;
+    DescriptorSetLayout(const DescriptorSetLayout&) = delete;
+    DescriptorSetLayout& operator=(const DescriptorSetLayout&) = delete;
+
+    VkDescriptorSetLayout handle() const { return layout_; }
+
+    // Single storage buffer binding visible to `stages`
+    static VkDescriptorSetLayoutBinding storageBuffer(uint32_t binding, VkShaderStageFlags stages);
+
+    // Dynamic uniform / storage buffer bindings, offset at bind time (see FrameRing)
+    static VkDescriptorSetLayoutBinding uniformBufferDynamic(uint32_t binding, VkShaderStageFlags stages);
+    static VkDescriptorSetLayoutBinding storageBufferDynamic(uint32_t binding, VkShaderStageFlags stages);
+
+    // Single combined image sampler binding visible to `stages`
+    static VkDescriptorSetLayoutBinding combinedImageSampler(uint32_t binding,
+                                                             VkShaderStageFlags stages);
+
+private:
+    VkDevice              device_ = VK_NULL_HANDLE;
+    VkDescriptorSetLayout layout_ = VK_NULL_HANDLE;
+};
+
+// Fixed-capacity pool; sets live until the pool is destroyed
+class DescriptorPool {
+public:
+    DescriptorPool() = default;
+    DescriptorPool(const VulkanContext& ctx, uint32_t maxSets,
+                   const std::vector<VkDescriptorPoolSize>& sizes);
+    ~DescriptorPool();
+
+    DescriptorPool(DescriptorPool&& other) noexcept;
+    DescriptorPool& operator=(DescriptorPool&& other) noexcept;
+    DescriptorPool(const DescriptorPool&) = delete;
+    DescriptorPool& operator=(const DescriptorPool&) = delete;
+
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+private:
+    VkDevice         device_ = VK_NULL_HANDLE;
+    VkDescriptorPool pool_   = VK_NULL_HANDLE;
+};
+
+// Point a storage buffer binding of `set` at the whole of `buffer`
+void writeStorageBuffer(VkDevice device, VkDescriptorSet set, uint32_t binding, VkBuffer buffer);
+
+// Point a dynamic buffer binding of `set` at `range` bytes of `buffer`; the offset
+// is supplied by vkCmdBindDescriptorSets
+void writeDynamicBuffer(VkDevice device, VkDescriptorSet set, uint32_t binding,
+                        VkDescriptorType type, VkBuffer buffer, VkDeviceSize range);
+
+// Point a combined image sampler binding of `set` at a shader-read-only image view
+void writeCombinedImageSampler(VkDevice device, VkDescriptorSet set, uint32_t binding,
+                               VkImageView view, VkSampler sampler);
+
+} // namespace luna::core
@@ -0,0 +1,113 @@
+// About: FramePacer implementation — deadline sleeps, present IDs, present and fence polling.
+
+#include "core/FramePacer.h"
+#include "core/VulkanContext.h"
+#include "util/Log.h"
+#include "util/Profiler.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace luna::core {
+
+FramePacer::FramePacer(const VulkanContext& ctx, const Sync& sync, const Settings& settings)
+    : device_(ctx.device()),
+      sync_(&sync),
+      waitForPresent_(settings.presentWait ? ctx.waitForPresent() : nullptr),
+      framesInFlight_(std::clamp(settings.framesInFlight, 1u, MAX_FRAMES_IN_FLIGHT)),
+      lowLatency_(settings.lowLatency) {
+    if (settings.fpsLimit > 0.0)
+        period_ = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / settings.fpsLimit));
+    if (settings.presentWait && !waitForPresent_)
+        LOG_WARN("VK_KHR_present_wait not supported; input latency is measured to GPU completion");
+
+    LOG_INFO("Frame pacing: %u frames in flight%s, %s, latency to %s", framesInFlight_,
+             lowLatency_ ? ", low latency" : "",
+             settings.fpsLimit > 0.0 ? "limited" : "unlimited",
+             waitForPresent_ ? "present" : "GPU completion");
+}
+
+void FramePacer::beginFrame(VkSwapchainKHR swapchain) {
+    swapchain_ = swapchain;
+
+    // Sleep to a fixed schedule rather than a fixed gap, so the rate holds however
+    // long frames take, up to the period
+    if (period_.count() > 0) {
+        Clock::time_point now = Clock::now();
+        if (now < nextFrame_) {
+            PROFILE_SCOPE("frame limiter");
+            std::this_thread::sleep_until(nextFrame_);
+        } else if (now - nextFrame_ > period_) {
+            nextFrame_ = now;  // fell behind: resume from here instead of catching up in a burst
+        }
+        nextFrame_ += period_;
+    }
+
+    if (waitForPresent_) {
+        // The frame about to start may overlap framesInFlight - 1 presents
+        if (lowLatency_ && lastPresentId_ >= framesInFlight_) {
+            uint64_t target = lastPresentId_ - (framesInFlight_ - 1);
+            if (target > lastReported_) {
+                PROFILE_SCOPE("present wait");
+                waitForPresent_(device_, swapchain_, target, PRESENT_TIMEOUT);
+            }
+        }
+        // Presents complete in order; a failed one (out of date, surface lost) stops
+        // being waited on
+        while (lastReported_ < lastPresentId_) {
+            uint64_t id = lastReported_ + 1;
+            VkResult result = waitForPresent_(device_, swapchain_, id, 0);
+            if (result == VK_TIMEOUT) break;
+            if (result == VK_SUCCESS) reportLatency(presentInput_[id % PRESENT_HISTORY]);
+            lastReported_ = id;
+        }
+    } else {
+        for (uint32_t frame = 0; frame < framesInFlight_; ++frame) {
+            if (slotInput_[frame] > 0.0 &&
+                vkGetFenceStatus(device_, sync_->inFlight(frame)) == VK_SUCCESS)
+                retire(frame);
+        }
+    }
+
+    frameInput_ = luna::util::Profiler::instance().now();
+}
+
+void FramePacer::frameRetired(uint32_t frame) {
+    if (!waitForPresent_) retire(frame);
+}
+
+void FramePacer::retire(uint32_t frame) {
+    if (slotInput_[frame] <= 0.0) return;
+    reportLatency(slotInput_[frame]);
+    slotInput_[frame] = 0.0;
+}
+
+void FramePacer::preparePresent(VkPresentInfoKHR& info, VkPresentIdKHR& id, uint32_t frame) {
+    slotInput_[frame] = frameInput_;
+    if (!waitForPresent_) return;
+
+    lastPresentId_++;
+    // Presents that never complete (a minimised window) are given up on
+    if (lastPresentId_ - lastReported_ > PRESENT_HISTORY)
+        lastReported_ = lastPresentId_ - PRESENT_HISTORY;
+    presentInput_[lastPresentId_ % PRESENT_HISTORY] = frameInput_;
+
+    id = {};
+    id.sType          = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+    id.pNext          = info.pNext;
+    id.swapchainCount = 1;
+    id.pPresentIds    = &lastPresentId_;
+    info.pNext = &id;
+}
+
+void FramePacer::resetSwapchain() {
+    lastReported_ = lastPresentId_;
+}
+
+void FramePacer::reportLatency(double inputTime) {
+    auto& profiler = luna::util::Profiler::instance();
+    profiler.counter("input latency", (profiler.now() - inputTime) * 1000.0);
+}
+
+} // namespace luna::core
@@ -0,0 +1,85 @@
+// About: Frame pacing — frames in flight, a sleeping frame limiter, present wait and input latency readout.
+
+#pragma once
+
+#include "core/Sync.h"
+#include <vulkan/vulkan.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace luna::core {
+
+class VulkanContext;
+
+// Decides when the main loop may start a frame, and measures how long input
+// sampled at that start takes to reach the screen. The latency goes to the
+// Profiler as the "input latency" counter (milliseconds), measured to the
+// present completing when VK_KHR_present_wait is available, otherwise to the
+// frame's fence being seen signalled, which leaves out the display queue.
+// Present completions are checked once per frame, so without low latency they
+// read up to a frame late.
+class FramePacer {
+public:
+    struct Settings {
+        uint32_t framesInFlight = 2;      // 1..MAX_FRAMES_IN_FLIGHT
+        double   fpsLimit       = 0.0;    // frames per second; 0 leaves the swapchain to pace
+        bool     lowLatency     = false;  // start a frame only once the last one is done
+        bool     presentWait    = true;   // use VK_KHR_present_wait where the device has it
+    };
+
+    // `sync` provides the frame fences; it must outlive the pacer
+    FramePacer(const VulkanContext& ctx, const Sync& sync, const Settings& settings);
+
+    uint32_t framesInFlight() const { return framesInFlight_; }
+    bool     lowLatency()     const { return lowLatency_; }
+    bool     usesPresentWait() const { return waitForPresent_ != nullptr; }
+
+    // Top of the frame, before input is sampled: sleep until the limiter's next
+    // slot and, in low-latency mode with present wait, until the frame
+    // framesInFlight - 1 presents ago is on screen. Reports finished presents.
+    void beginFrame(VkSwapchainKHR swapchain);
+
+    // `frame`'s fence has just been waited on. Without present wait, reports the
+    // latency of the frame that last used the slot; frames whose fence signalled
+    // while the CPU was busy are picked up by beginFrame() instead.
+    void frameRetired(uint32_t frame);
+
+    // Just before vkQueuePresentKHR of `frame`: tag the present with an ID.
+    // `id` must outlive the call and is chained into `info`.
+    void preparePresent(VkPresentInfoKHR& info, VkPresentIdKHR& id, uint32_t frame);
+
+    // After swapchain recreation: presents of the old swapchain are no longer waited on
+    void resetSwapchain();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Presents waited on or polled at most this far back
+    static constexpr uint32_t PRESENT_HISTORY = 8;
+    static constexpr uint64_t PRESENT_TIMEOUT = 100'000'000;  // ns, as the main loop's fence wait
+
+    void reportLatency(double inputTime);
+    void retire(uint32_t frame);
+
+    VkDevice                device_         = VK_NULL_HANDLE;
+    const Sync*             sync_;
+    PFN_vkWaitForPresentKHR waitForPresent_ = nullptr;
+    uint32_t                framesInFlight_;
+    bool                    lowLatency_;
+
+    Clock::duration   period_{0};
+    Clock::time_point nextFrame_{};
+
+    // Input time of the frame being built, then of the frame each slot holds
+    double                                      frameInput_ = 0.0;
+    std::array<double, MAX_FRAMES_IN_FLIGHT>    slotInput_{};
+
+    // Present IDs increase across swapchains; 0 is never used
+    VkSwapchainKHR                         swapchain_     = VK_NULL_HANDLE;
+    uint64_t                               lastPresentId_ = 0;
+    uint64_t                               lastReported_  = 0;  // every ID up to it is done
+    std::array<double, PRESENT_HISTORY>    presentInput_{};     // by ID % PRESENT_HISTORY
+};
+
+} // namespace luna::core
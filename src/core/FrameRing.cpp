@@ -0,0 +1,61 @@
+// About: FrameRing implementation — region layout, aligned bump allocation.
+
+#include "core/FrameRing.h"
+#include "core/VulkanContext.h"
+
+#include <algorithm>
+
+namespace luna::core {
+
+namespace {
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+FrameRing::FrameRing(const VulkanContext& ctx, VkDeviceSize bytesPerFrame, VkBufferUsageFlags usage)
+    : alignment_(offsetAlignment(ctx)),
+      regionSize_(alignUp(bytesPerFrame, alignment_))
+{
+    buffer_ = Buffer::createDynamic(ctx, usage, regionSize_ * MAX_FRAMES_IN_FLIGHT);
+    mapped_ = static_cast<uint8_t*>(buffer_.map());
+}
+
+VkDeviceSize FrameRing::offsetAlignment(const VulkanContext& ctx) {
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(ctx.physicalDevice(), &props);
+    // Both limits are powers of two, so the larger one satisfies either use
+    return std::max<VkDeviceSize>({props.limits.minUniformBufferOffsetAlignment,
+                                   props.limits.minStorageBufferOffsetAlignment, 16});
+}
+
+VkDeviceSize FrameRing::regionBytes(const VulkanContext& ctx,
+                                    std::initializer_list<VkDeviceSize> allocations) {
+    VkDeviceSize alignment = offsetAlignment(ctx);
+    VkDeviceSize total = 0;
+    for (VkDeviceSize size : allocations)
+        total += alignUp(size, alignment);
+    return total;
+}
+
+void FrameRing::begin(uint32_t frame) {
+    begin_  = regionSize_ * frame;
+    cursor_ = begin_;
+}
+
+void* FrameRing::allocate(VkDeviceSize size, uint32_t& offset) {
+    if (cursor_ + size > begin_ + regionSize_) return nullptr;
+    offset = static_cast<uint32_t>(cursor_);
+    void* ptr = mapped_ + cursor_;
+    cursor_ = std::min(alignUp(cursor_ + size, alignment_), begin_ + regionSize_);
+    return ptr;
+}
+
+void FrameRing::release() {
+    buffer_.release();
+    mapped_ = nullptr;
+}
+
+} // namespace luna::core
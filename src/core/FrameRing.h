@@ -0,0 +1,60 @@
+// About: Persistently mapped per-frame ring buffer for uniform and storage data written once per frame.
+
+#pragma once
+
+#include "core/Buffer.h"
+#include "core/Sync.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <initializer_list>
+
+namespace luna::core {
+
+class VulkanContext;
+
+// One host-visible buffer split into MAX_FRAMES_IN_FLIGHT equal regions. Each
+// frame resets its own region with begin() and bump-allocates from it; the frame
+// fence guarantees the GPU has finished reading a region before it is reused.
+// Allocations are aligned for use as dynamic uniform or storage buffer offsets,
+// so one descriptor set with dynamic bindings addresses every frame's data.
+class FrameRing {
+public:
+    FrameRing(const VulkanContext& ctx, VkDeviceSize bytesPerFrame, VkBufferUsageFlags usage);
+
+    FrameRing(FrameRing&&) = default;
+    FrameRing& operator=(FrameRing&&) = default;
+
+    VkBuffer     buffer()      const { return buffer_.handle(); }
+    VkDeviceSize regionSize()  const { return regionSize_; }
+    VkDeviceSize alignment()   const { return alignment_; }
+
+    // Start writing `frame`'s region; everything allocated from it before is dropped
+    void begin(uint32_t frame);
+
+    // Reserve `size` bytes of the current region. Returns the mapped pointer and sets
+    // `offset` (from the start of the buffer), or nullptr when the region is full.
+    void* allocate(VkDeviceSize size, uint32_t& offset);
+
+    template <typename T>
+    T* allocate(uint32_t count, uint32_t& offset) {
+        return static_cast<T*>(allocate(sizeof(T) * count, offset));
+    }
+
+    // Space the worst-case sequence of allocations of these sizes needs per frame
+    static VkDeviceSize regionBytes(const VulkanContext& ctx,
+                                    std::initializer_list<VkDeviceSize> allocations);
+
+    void release();
+
+private:
+    static VkDeviceSize offsetAlignment(const VulkanContext& ctx);
+
+    Buffer       buffer_;
+    uint8_t*     mapped_     = nullptr;
+    VkDeviceSize alignment_  = 0;
+    VkDeviceSize regionSize_ = 0;
+    VkDeviceSize begin_      = 0;  // start of the current frame's region
+    VkDeviceSize cursor_     = 0;  // next free byte in it
+};
+
+} // namespace luna::core
@@ -0,0 +1,216 @@
+// About: GpuHeap implementation — block creation, first-fit placement, free-list coalescing.
+
+#include "core/GpuHeap.h"
+#include "util/Log.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace luna::core {
+
+namespace {
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+} // anonymous namespace
+
+GpuHeap::GpuHeap(VkDevice device, VkPhysicalDevice physDevice)
+    : device_(device)
+{
+    vkGetPhysicalDeviceMemoryProperties(physDevice, &memProps_);
+}
+
+GpuHeap::~GpuHeap() {
+    uint32_t leaked = 0;
+    for (auto& typeBlocks : blocks_) {
+        for (auto& block : typeBlocks) {
+            leaked += block.liveCount;
+            destroyBlock(block);
+        }
+    }
+    if (leaked > 0)
+        LOG_WARN("GpuHeap destroyed with %u live allocations", leaked);
+}
+
+uint32_t GpuHeap::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0; i < memProps_.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) &&
+            (memProps_.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+    }
+    throw std::runtime_error("Failed to find suitable memory type");
+}
+
+bool GpuHeap::findDirectMemoryType(uint32_t typeFilter, VkDeviceSize size,
+                                   uint32_t& memoryType) const {
+    constexpr VkMemoryPropertyFlags DIRECT = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+                                           | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                           | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    for (uint32_t i = 0; i < memProps_.memoryTypeCount; i++) {
+        const VkMemoryType& type = memProps_.memoryTypes[i];
+        if (!(typeFilter & (1 << i)) || (type.propertyFlags & DIRECT) != DIRECT) continue;
+        VkDeviceSize heapSize = memProps_.memoryHeaps[type.heapIndex].size;
+        if (heapSize < MIN_DIRECT_HEAP_SIZE || heapSize / 4 < size) continue;
+        memoryType = i;
+        return true;
+    }
+    return false;
+}
+
+uint32_t GpuHeap::createBlock(uint32_t memoryType, VkDeviceSize size, bool dedicated) {
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize  = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    Block block;
+    block.size      = size;
+    block.dedicated = dedicated;
+    if (vkAllocateMemory(device_, &allocInfo, nullptr, &block.memory) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate GPU heap block");
+
+    if (memProps_.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        vkMapMemory(device_, block.memory, 0, VK_WHOLE_SIZE, 0, &block.mapped);
+
+    block.freeList.push_back({0, size});
+
+    // Reuse a slot left by a freed dedicated block so indices stay stable
+    auto& typeBlocks = blocks_[memoryType];
+    for (uint32_t i = 0; i < typeBlocks.size(); i++) {
+        if (typeBlocks[i].memory == VK_NULL_HANDLE) {
+            typeBlocks[i] = std::move(block);
+            return i;
+        }
+    }
+    typeBlocks.push_back(std::move(block));
+
+    if (!dedicated)
+        LOG_INFO("GpuHeap: block %zu created for memory type %u",
+                 typeBlocks.size() - 1, memoryType);
+    return static_cast<uint32_t>(typeBlocks.size() - 1);
+}
+
+void GpuHeap::destroyBlock(Block& block) {
+    if (block.memory == VK_NULL_HANDLE) return;
+    if (block.mapped) vkUnmapMemory(device_, block.memory);
+    vkFreeMemory(device_, block.memory, nullptr);
+    block = Block{};
+}
+
+bool GpuHeap::allocateFromBlock(Block& block, const VkMemoryRequirements& reqs,
+                                VkDeviceSize& offset) {
+    for (size_t i = 0; i < block.freeList.size(); i++) {
+        Range range = block.freeList[i];
+        VkDeviceSize aligned = alignUp(range.offset, reqs.alignment);
+        VkDeviceSize padding = aligned - range.offset;
+        if (padding + reqs.size > range.size) continue;
+
+        // Keep the alignment padding and the tail as separate free ranges
+        VkDeviceSize tailOffset = aligned + reqs.size;
+        VkDeviceSize tailSize   = range.offset + range.size - tailOffset;
+        block.freeList.erase(block.freeList.begin() + i);
+        if (tailSize > 0)
+            block.freeList.insert(block.freeList.begin() + i, {tailOffset, tailSize});
+        if (padding > 0)
+            block.freeList.insert(block.freeList.begin() + i, {range.offset, padding});
+
+        offset = aligned;
+        block.liveCount++;
+        return true;
+    }
+    return false;
+}
+
+GpuAllocation GpuHeap::allocate(const VkMemoryRequirements& reqs,
+                                VkMemoryPropertyFlags properties) {
+    return allocateType(reqs, findMemoryType(reqs.memoryTypeBits, properties));
+}
+
+GpuAllocation GpuHeap::allocateType(const VkMemoryRequirements& reqs, uint32_t memoryType) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& typeBlocks = blocks_[memoryType];
+
+    GpuAllocation alloc;
+    alloc.memoryType = memoryType;
+    alloc.size       = reqs.size;
+
+    bool found = false;
+    if (reqs.size > BLOCK_SIZE / 2) {
+        alloc.block = createBlock(memoryType, reqs.size, true);
+        found = allocateFromBlock(typeBlocks[alloc.block], reqs, alloc.offset);
+    } else {
+        for (uint32_t i = 0; i < typeBlocks.size() && !found; i++) {
+            Block& block = typeBlocks[i];
+            if (block.memory == VK_NULL_HANDLE || block.dedicated) continue;
+            if (allocateFromBlock(block, reqs, alloc.offset)) {
+                alloc.block = i;
+                found = true;
+            }
+        }
+        if (!found) {
+            alloc.block = createBlock(memoryType, BLOCK_SIZE, false);
+            found = allocateFromBlock(typeBlocks[alloc.block], reqs, alloc.offset);
+        }
+    }
+    if (!found)
+        throw std::runtime_error("GPU heap allocation failed");
+
+    const Block& block = typeBlocks[alloc.block];
+    alloc.memory = block.memory;
+    if (block.mapped)
+        alloc.mapped = static_cast<char*>(block.mapped) + alloc.offset;
+    bytesInUse_ += alloc.size;
+    return alloc;
+}
+
+void GpuHeap::free(GpuAllocation& alloc) {
+    if (!alloc.valid()) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Block& block = blocks_[alloc.memoryType][alloc.block];
+    bytesInUse_ -= alloc.size;
+    block.liveCount--;
+
+    if (block.dedicated) {
+        destroyBlock(block);
+        alloc = GpuAllocation{};
+        return;
+    }
+
+    // Insert in offset order, then merge with touching neighbours
+    auto& list = block.freeList;
+    auto it = std::lower_bound(list.begin(), list.end(), alloc.offset,
+                               [](const Range& r, VkDeviceSize off) { return r.offset < off; });
+    it = list.insert(it, {alloc.offset, alloc.size});
+
+    auto next = it + 1;
+    if (next != list.end() && it->offset + it->size == next->offset) {
+        it->size += next->size;
+        list.erase(next);
+    }
+    if (it != list.begin()) {
+        auto prev = it - 1;
+        if (prev->offset + prev->size == it->offset) {
+            prev->size += it->size;
+            list.erase(it);
+        }
+    }
+
+    alloc = GpuAllocation{};
+}
+
+uint32_t GpuHeap::blockCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t count = 0;
+    for (const auto& typeBlocks : blocks_)
+        for (const auto& block : typeBlocks)
+            if (block.memory != VK_NULL_HANDLE) count++;
+    return count;
+}
+
+VkDeviceSize GpuHeap::bytesInUse() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytesInUse_;
+}
+
+} // namespace luna::core
@@ -0,0 +1,88 @@
+// About: Block sub-allocator for buffer memory — 64 MB blocks per memory type with free lists.
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace luna::core {
+
+// A range inside one of GpuHeap's blocks. `mapped` points at `offset` when the
+// block is host-visible (blocks are mapped once for their whole lifetime).
+struct GpuAllocation {
+    VkDeviceMemory memory     = VK_NULL_HANDLE;
+    VkDeviceSize   offset     = 0;
+    VkDeviceSize   size       = 0;
+    void*          mapped     = nullptr;
+    uint32_t       memoryType = 0;
+    uint32_t       block      = 0;
+
+    bool valid() const { return memory != VK_NULL_HANDLE; }
+};
+
+// Allocations are first-fit from sorted free lists; freeing coalesces with
+// neighbours. Blocks are kept once created, so patch churn is pure offset
+// bookkeeping. Requests larger than half a block get a dedicated block that is
+// returned to the driver as soon as it is freed.
+class GpuHeap {
+public:
+    static constexpr VkDeviceSize BLOCK_SIZE = 64ull * 1024 * 1024;
+    // Smallest device-local, host-visible heap worth placing whole buffers in.
+    // Without resizable BAR a discrete GPU exposes a 256 MB window of VRAM this
+    // way; that stays with the driver and small per-frame data.
+    static constexpr VkDeviceSize MIN_DIRECT_HEAP_SIZE = 1ull << 30;
+
+    GpuHeap(VkDevice device, VkPhysicalDevice physDevice);
+    ~GpuHeap();
+
+    GpuHeap(const GpuHeap&) = delete;
+    GpuHeap& operator=(const GpuHeap&) = delete;
+
+    GpuAllocation allocate(const VkMemoryRequirements& reqs, VkMemoryPropertyFlags properties);
+    // Same, from a memory type the caller already picked
+    GpuAllocation allocateType(const VkMemoryRequirements& reqs, uint32_t memoryType);
+    void          free(GpuAllocation& alloc);
+
+    // Uses the memory properties cached at construction
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    // A coherent memory type that is both device-local and host-visible (resizable
+    // BAR, or an integrated GPU's unified memory), in a heap of at least
+    // MIN_DIRECT_HEAP_SIZE and four times `size`. False when there is none.
+    bool findDirectMemoryType(uint32_t typeFilter, VkDeviceSize size, uint32_t& memoryType) const;
+    const VkPhysicalDeviceMemoryProperties& memoryProperties() const { return memProps_; }
+
+    uint32_t     blockCount() const;
+    VkDeviceSize bytesInUse() const;
+
+private:
+    struct Range {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+
+    struct Block {
+        VkDeviceMemory     memory = VK_NULL_HANDLE;
+        VkDeviceSize       size   = 0;
+        void*              mapped = nullptr;
+        std::vector<Range> freeList;  // sorted by offset, never adjacent
+        uint32_t           liveCount = 0;
+        bool               dedicated = false;
+    };
+
+    bool     allocateFromBlock(Block& block, const VkMemoryRequirements& reqs,
+                               VkDeviceSize& offset);
+    uint32_t createBlock(uint32_t memoryType, VkDeviceSize size, bool dedicated);
+    void     destroyBlock(Block& block);
+
+    VkDevice                         device_;
+    VkPhysicalDeviceMemoryProperties memProps_{};
+
+    mutable std::mutex mutex_;
+    std::array<std::vector<Block>, VK_MAX_MEMORY_TYPES> blocks_;
+    VkDeviceSize bytesInUse_ = 0;
+};
+
+} // namespace luna::core
@@ -0,0 +1,146 @@
+// About: GpuTimer implementation — timestamp query pool, per-frame ranges, readback into the Profiler.
+
+#include "core/GpuTimer.h"
+#include "core/VulkanContext.h"
+#include "util/Log.h"
+#include "util/Profiler.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace luna::core {
+
+GpuTimer::GpuTimer(const VulkanContext& ctx) : device_(ctx.device()) {
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(ctx.physicalDevice(), &props);
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx.physicalDevice(), &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx.physicalDevice(), &familyCount, families.data());
+    uint32_t validBits = families[ctx.queueFamilies().graphics].timestampValidBits;
+
+    const VkPhysicalDeviceFeatures& features = ctx.enabledFeatures();
+    if (features.pipelineStatisticsQuery && features.inheritedQueries) {
+        VkQueryPoolCreateInfo statsInfo{};
+        statsInfo.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        statsInfo.queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        statsInfo.queryCount         = MAX_FRAMES_IN_FLIGHT;
+        statsInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+        if (vkCreateQueryPool(device_, &statsInfo, nullptr, &statsPool_) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create pipeline statistics query pool");
+    } else {
+        LOG_WARN("Pipeline statistics queries not supported; overdraw unavailable");
+    }
+
+    if (validBits == 0 || props.limits.timestampPeriod <= 0.0f) {
+        LOG_WARN("GPU timestamps not supported on the graphics queue; GPU pass times unavailable");
+        return;
+    }
+    nanosecondsPerTick_ = props.limits.timestampPeriod;
+    validMask_ = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = MAX_FRAMES_IN_FLIGHT * MAX_SCOPES * 2;
+    if (vkCreateQueryPool(device_, &poolInfo, nullptr, &pool_) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create timestamp query pool");
+}
+
+GpuTimer::~GpuTimer() {
+    release();
+}
+
+void GpuTimer::release() {
+    if (pool_)      vkDestroyQueryPool(device_, pool_, nullptr);
+    if (statsPool_) vkDestroyQueryPool(device_, statsPool_, nullptr);
+    pool_      = VK_NULL_HANDLE;
+    statsPool_ = VK_NULL_HANDLE;
+}
+
+void GpuTimer::beginFrame(VkCommandBuffer cmd, uint32_t frame, uint64_t profilerFrame) {
+    if (!pool_ && !statsPool_) return;
+    FrameQueries& queries = frames_[frame];
+    if (queries.count > 0) readBack(queries, frame);
+    if (queries.pixels > 0) readFragmentCount(queries, frame);
+
+    if (pool_)      vkCmdResetQueryPool(cmd, pool_, frame * MAX_SCOPES * 2, MAX_SCOPES * 2);
+    if (statsPool_) vkCmdResetQueryPool(cmd, statsPool_, frame, 1);
+    queries.profilerFrame = profilerFrame;
+    queries.cpuStart      = luna::util::Profiler::instance().now();
+    queries.count         = 0;
+    queries.pixels        = 0;
+    frame_ = frame;
+}
+
+void GpuTimer::readFragmentCount(const FrameQueries& queries, uint32_t frame) {
+    uint64_t result[2];
+    VkResult status = vkGetQueryPoolResults(
+        device_, statsPool_, frame, 1, sizeof(result), result, sizeof(result),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if ((status != VK_SUCCESS && status != VK_NOT_READY) || !result[1]) return;
+    luna::util::Profiler::instance().counterFor(
+        queries.profilerFrame, "overdraw", static_cast<double>(result[0]) / queries.pixels);
+}
+
+void GpuTimer::beginFragmentCount(VkCommandBuffer primary) const {
+    if (statsPool_) vkCmdBeginQuery(primary, statsPool_, frame_, 0);
+}
+
+void GpuTimer::endFragmentCount(VkCommandBuffer primary, uint32_t pixels) {
+    if (!statsPool_ || pixels == 0) return;
+    vkCmdEndQuery(primary, statsPool_, frame_);
+    frames_[frame_].pixels = pixels;
+}
+
+void GpuTimer::readBack(const FrameQueries& queries, uint32_t frame) {
+    // Value and availability per query: a scope left unrecorded costs only itself
+    uint64_t results[MAX_SCOPES * 2][2];
+    VkResult result = vkGetQueryPoolResults(
+        device_, pool_, frame * MAX_SCOPES * 2, queries.count * 2, sizeof(results), results,
+        sizeof(results[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) return;
+
+    uint64_t first = ~0ull;
+    for (uint32_t i = 0; i < queries.count; ++i)
+        if (results[2 * i][1]) first = std::min(first, results[2 * i][0] & validMask_);
+
+    auto&    profiler = luna::util::Profiler::instance();
+    uint64_t last     = first;
+    for (uint32_t i = 0; i < queries.count; ++i) {
+        if (!results[2 * i][1] || !results[2 * i + 1][1]) continue;
+        uint64_t begin = results[2 * i][0] & validMask_;
+        uint64_t end   = results[2 * i + 1][0] & validMask_;
+        double   offset   = static_cast<double>(begin - first) * nanosecondsPerTick_ * 1e-9;
+        double   duration = static_cast<double>((end - begin) & validMask_) * nanosecondsPerTick_ * 1e-9;
+        profiler.recordFor(queries.profilerFrame, queries.names[i], luna::util::Profiler::GPU_TRACK,
+                           queries.cpuStart + offset, duration);
+        last = std::max(last, end);
+    }
+    if (last >= first && first != ~0ull)
+        lastFrameMs_ = static_cast<double>(last - first) * nanosecondsPerTick_ * 1e-6;
+}
+
+uint32_t GpuTimer::scope(const char* name) {
+    if (!pool_) return INVALID_SCOPE;
+    FrameQueries& queries = frames_[frame_];
+    if (queries.count == MAX_SCOPES) return INVALID_SCOPE;
+    queries.names[queries.count] = name;
+    return queries.count++;
+}
+
+void GpuTimer::begin(VkCommandBuffer cmd, uint32_t scope) const {
+    if (scope == INVALID_SCOPE) return;
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pool_,
+                        (frame_ * MAX_SCOPES + scope) * 2);
+}
+
+void GpuTimer::end(VkCommandBuffer cmd, uint32_t scope) const {
+    if (scope == INVALID_SCOPE) return;
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pool_,
+                        (frame_ * MAX_SCOPES + scope) * 2 + 1);
+}
+
+} // namespace luna::core
@@ -0,0 +1,88 @@
+// About: GPU pass timing with timestamp queries and a fragment count, read back frames later into the Profiler.
+
+#pragma once
+
+#include "core/Sync.h"
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+
+namespace luna::core {
+
+class VulkanContext;
+
+// One query range per frame in flight, two timestamps per scope. Results are
+// read when the frame's fence has been waited on, MAX_FRAMES_IN_FLIGHT frames
+// after they were recorded, and go to the Profiler frame that recorded them on
+// its GPU track. The GPU clock is not calibrated against the CPU's: each frame's
+// scopes are placed at that frame's CPU start, keeping their relative offsets.
+// Without timestamp support on the graphics queue every call is a no-op.
+class GpuTimer {
+public:
+    static constexpr uint32_t MAX_SCOPES    = 16;
+    static constexpr uint32_t INVALID_SCOPE = 0xFFFFFFFFu;
+
+    explicit GpuTimer(const VulkanContext& ctx);
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    bool isSupported() const { return pool_ != VK_NULL_HANDLE; }
+
+    // After `frame`'s fence wait, first thing in its primary command buffer (outside
+    // a render pass): report what the frame measured last time round, then reset
+    // its queries. `profilerFrame` is the Profiler frame now being recorded.
+    void beginFrame(VkCommandBuffer cmd, uint32_t frame, uint64_t profilerFrame);
+
+    // Render thread, before recording: claim a scope for this frame. Returns
+    // INVALID_SCOPE when all are taken or timestamps are unsupported.
+    uint32_t scope(const char* name);
+
+    // Any command buffer of the frame, from any recording thread. Both stamps of a
+    // claimed scope must be recorded, begin executing before end.
+    void begin(VkCommandBuffer cmd, uint32_t scope) const;
+    void end(VkCommandBuffer cmd, uint32_t scope) const;
+
+    // GPU milliseconds from the first scope's start to the last one's end, in the
+    // frame last read back; 0 before any
+    double lastFrameMs() const { return lastFrameMs_; }
+
+    // Fragment shader invocations over the render pass, reported as the "overdraw"
+    // counter: fragments shaded per framebuffer pixel, so 1.0 means every pixel was
+    // shaded once. Needs pipelineStatisticsQuery, and inheritedQueries since the
+    // draws are in secondary buffers, which must be begun with statisticsFlags().
+    // Without them these are no-ops and statisticsFlags() is 0.
+    VkQueryPipelineStatisticFlags statisticsFlags() const {
+        return statsPool_ ? VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT : 0;
+    }
+    // Primary buffer, around the render pass contents; `pixels` is the framebuffer area
+    void beginFragmentCount(VkCommandBuffer primary) const;
+    void endFragmentCount(VkCommandBuffer primary, uint32_t pixels);
+
+    void release();
+
+private:
+    struct FrameQueries {
+        uint64_t                              profilerFrame = 0;
+        double                                cpuStart      = 0.0;
+        uint32_t                              count         = 0;
+        std::array<const char*, MAX_SCOPES>   names{};
+        uint32_t                              pixels        = 0;  // fragment count recorded
+    };
+
+    void readBack(const FrameQueries& queries, uint32_t frame);
+    void readFragmentCount(const FrameQueries& queries, uint32_t frame);
+
+    VkDevice    device_ = VK_NULL_HANDLE;
+    VkQueryPool pool_   = VK_NULL_HANDLE;
+    VkQueryPool statsPool_ = VK_NULL_HANDLE;  // one fragment count per frame in flight
+    double      nanosecondsPerTick_ = 0.0;
+    uint64_t    validMask_          = 0;
+    uint32_t    frame_              = 0;  // frame in flight being recorded
+    double      lastFrameMs_        = 0.0;
+
+    std::array<FrameQueries, MAX_FRAMES_IN_FLIGHT> frames_{};
+};
+
+} // namespace luna::core
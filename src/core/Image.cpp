@@ -1,28 +1,20 @@
 // About: Image implementation — creates Vulkan images with memory and views.
 
 #include "core/Image.h"
+#include "core/Buffer.h"
+#include "core/GpuHeap.h"
 #include "core/VulkanContext.h"
 #include "util/Log.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace luna::core {
 
-static uint32_t findMemoryType(VkPhysicalDevice physDevice, uint32_t typeFilter,
-                               VkMemoryPropertyFlags properties) {
-    VkPhysicalDeviceMemoryProperties memProps;
-    vkGetPhysicalDeviceMemoryProperties(physDevice, &memProps);
-    for (uint32_t i = 0; i < memProps.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) &&
-            (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-            return i;
-    }
-    throw std::runtime_error("Failed to find suitable memory type");
-}
-
 Image::Image(const VulkanContext& ctx, uint32_t width, uint32_t height,
-             VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect)
-    : device_(ctx.device())
+             VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect,
+             uint32_t mipLevels)
+    : device_(ctx.device()), width_(width), height_(height), mipLevels_(mipLevels)
 {
     VkImageCreateInfo imageInfo{};
     imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -30,7 +22,7 @@ Image::Image(const VulkanContext& ctx, uint32_t width, uint32_t height,
     imageInfo.extent.width  = width;
     imageInfo.extent.height = height;
     imageInfo.extent.depth  = 1;
-    imageInfo.mipLevels     = 1;
+    imageInfo.mipLevels     = mipLevels;
     imageInfo.arrayLayers   = 1;
     imageInfo.format        = format;
     imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
@@ -48,21 +40,23 @@ Image::Image(const VulkanContext& ctx, uint32_t width, uint32_t height,
     VkMemoryAllocateInfo allocInfo{};
     allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
     allocInfo.allocationSize  = memReqs.size;
-    allocInfo.memoryTypeIndex = findMemoryType(ctx.physicalDevice(), memReqs.memoryTypeBits,
-                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    // Attachments and textures are few and long-lived, so they keep dedicated memory
+    allocInfo.memoryTypeIndex = ctx.heap().findMemoryType(memReqs.memoryTypeBits,
+                                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
     if (vkAllocateMemory(device_, &allocInfo, nullptr, &memory_) != VK_SUCCESS)
         throw std::runtime_error("Failed to allocate image memory");
 
     vkBindImageMemory(device_, image_, memory_, 0);
-    view_ = createImageView(device_, image_, format, aspect);
+    view_ = createImageView(device_, image_, format, aspect, mipLevels);
 }
 
 Image::~Image() { cleanup(); }
 
 Image::Image(Image&& other) noexcept
     : device_(other.device_), image_(other.image_),
-      memory_(other.memory_), view_(other.view_)
+      memory_(other.memory_), view_(other.view_),
+      width_(other.width_), height_(other.height_), mipLevels_(other.mipLevels_)
 {
     other.device_ = VK_NULL_HANDLE;
     other.image_  = VK_NULL_HANDLE;
@@ -75,6 +69,8 @@ Image& Image::operator=(Image&& other) noexcept {
         cleanup();
         device_ = other.device_;  image_ = other.image_;
         memory_ = other.memory_;  view_  = other.view_;
+        width_  = other.width_;   height_ = other.height_;
+        mipLevels_ = other.mipLevels_;
         other.device_ = VK_NULL_HANDLE;
         other.image_  = VK_NULL_HANDLE;
         other.memory_ = VK_NULL_HANDLE;
@@ -93,8 +89,46 @@ void Image::cleanup() {
     memory_ = VK_NULL_HANDLE;
 }
 
+void Image::recordTransition(VkCommandBuffer cmd,
+                             VkImageLayout oldLayout, VkImageLayout newLayout,
+                             VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                             VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) const {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask       = srcAccess;
+    barrier.dstAccessMask       = dstAccess;
+    barrier.oldLayout           = oldLayout;
+    barrier.newLayout           = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image               = image_;
+    barrier.subresourceRange.aspectMask   = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount   = mipLevels_;
+    barrier.subresourceRange.layerCount   = 1;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void Image::recordUpload(VkCommandBuffer cmd, StagingBatch& staging, uint32_t mipLevel,
+                         const void* texels, VkDeviceSize size) const {
+    if (mipLevel >= mipLevels_)
+        throw std::runtime_error("Image upload to a mip level the image does not have");
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = staging.write(texels, size);
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel   = mipLevel;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent.width  = std::max(1u, width_ >> mipLevel);
+    region.imageExtent.height = std::max(1u, height_ >> mipLevel);
+    region.imageExtent.depth  = 1;
+    vkCmdCopyBufferToImage(cmd, staging.handle, image_,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
+
 VkImageView Image::createImageView(VkDevice device, VkImage image,
-                                   VkFormat format, VkImageAspectFlags aspect) {
+                                   VkFormat format, VkImageAspectFlags aspect,
+                                   uint32_t mipLevels) {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image    = image;
@@ -102,7 +136,7 @@ VkImageView Image::createImageView(VkDevice device, VkImage image,
     viewInfo.format   = format;
     viewInfo.subresourceRange.aspectMask     = aspect;
     viewInfo.subresourceRange.baseMipLevel   = 0;
-    viewInfo.subresourceRange.levelCount     = 1;
+    viewInfo.subresourceRange.levelCount     = mipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount     = 1;
 
@@ -3,16 +3,20 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <cstdint>
 
 namespace luna::core {
 
 class VulkanContext;
+struct StagingBatch;
 
 class Image {
 public:
     Image() = default;
+    // The view covers all mipLevels; level k is max(1, width >> k) by max(1, height >> k)
     Image(const VulkanContext& ctx, uint32_t width, uint32_t height,
-          VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect);
+          VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect,
+          uint32_t mipLevels = 1);
     ~Image();
 
     Image(Image&& other) noexcept;
@@ -22,9 +26,22 @@ public:
 
     VkImageView view() const { return view_; }
     VkImage     image() const { return image_; }
+    uint32_t    mipLevels() const { return mipLevels_; }
+
+    // Record a barrier moving every mip level of a color image between layouts
+    void recordTransition(VkCommandBuffer cmd,
+                          VkImageLayout oldLayout, VkImageLayout newLayout,
+                          VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                          VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) const;
+
+    // Record a staging copy of one tightly packed mip level. The level must be in
+    // TRANSFER_DST_OPTIMAL, and staging must stay alive until the copy has executed.
+    void recordUpload(VkCommandBuffer cmd, StagingBatch& staging, uint32_t mipLevel,
+                      const void* texels, VkDeviceSize size) const;
 
     static VkImageView createImageView(VkDevice device, VkImage image,
-                                       VkFormat format, VkImageAspectFlags aspect);
+                                       VkFormat format, VkImageAspectFlags aspect,
+                                       uint32_t mipLevels = 1);
 
 private:
     void cleanup();
@@ -33,6 +50,9 @@ private:
     VkImage        image_  = VK_NULL_HANDLE;
     VkDeviceMemory memory_ = VK_NULL_HANDLE;
     VkImageView    view_   = VK_NULL_HANDLE;
+    uint32_t       width_     = 0;
+    uint32_t       height_    = 0;
+    uint32_t       mipLevels_ = 1;
 };
 
 } // namespace luna::core
@@ -0,0 +1,70 @@
+// About: ParallelRecorder implementation — per-slice pools, secondary begin and execution.
+
+#include "core/ParallelRecorder.h"
+#include "core/VulkanContext.h"
+
+#include <algorithm>
+
+namespace luna::core {
+
+ParallelRecorder::ParallelRecorder(const VulkanContext& ctx, uint32_t sliceCount)
+    : sliceCount_(sliceCount)
+{
+    for (auto& frame : frames_) {
+        frame.pools.reserve(sliceCount);
+        for (uint32_t i = 0; i < sliceCount; i++)
+            frame.pools.push_back(std::make_unique<CommandPool>(ctx, 1, UINT32_MAX,
+                                                                VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+        frame.begun.assign(sliceCount, 0);
+    }
+    executeList_.reserve(sliceCount);
+}
+
+void ParallelRecorder::begin(uint32_t frame) {
+    FrameSlices& fs = frames_[frame];
+    for (const auto& pool : fs.pools)
+        pool->reset();
+    std::fill(fs.begun.begin(), fs.begun.end(), 0);
+}
+
+VkCommandBuffer ParallelRecorder::beginSlice(uint32_t frame, uint32_t slice,
+                                             const RenderPassInheritance& pass) {
+    FrameSlices& fs = frames_[frame];
+    VkCommandBuffer cmd = fs.pools[slice]->buffer(0);
+
+    VkCommandBufferInheritanceInfo inheritance{};
+    inheritance.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.renderPass  = pass.renderPass;
+    inheritance.subpass     = 0;
+    inheritance.framebuffer = pass.framebuffer;
+    inheritance.pipelineStatistics = pass.pipelineStatistics;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+                                 VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &inheritance;
+    vkBeginCommandBuffer(cmd, &beginInfo);
+
+    vkCmdSetViewport(cmd, 0, 1, &pass.viewport);
+    vkCmdSetScissor(cmd, 0, 1, &pass.scissor);
+    fs.begun[slice] = 1;
+    return cmd;
+}
+
+void ParallelRecorder::execute(VkCommandBuffer primary, uint32_t frame) {
+    execute(primary, frame, 0, sliceCount_);
+}
+
+void ParallelRecorder::execute(VkCommandBuffer primary, uint32_t frame,
+                               uint32_t firstSlice, uint32_t count) {
+    const FrameSlices& fs = frames_[frame];
+    executeList_.clear();
+    uint32_t end = std::min(firstSlice + count, sliceCount_);
+    for (uint32_t i = firstSlice; i < end; i++)
+        if (fs.begun[i]) executeList_.push_back(fs.pools[i]->buffer(0));
+    if (!executeList_.empty())
+        vkCmdExecuteCommands(primary, static_cast<uint32_t>(executeList_.size()), executeList_.data());
+}
+
+} // namespace luna::core
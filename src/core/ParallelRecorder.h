@@ -0,0 +1,66 @@
+// About: Secondary command buffers recorded on worker threads and executed from one primary buffer.
+
+#pragma once
+
+#include "core/CommandPool.h"
+#include "core/Sync.h"
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace luna::core {
+
+class VulkanContext;
+
+// Render pass state a secondary buffer continues. Viewport and scissor are
+// dynamic state, which secondary buffers do not inherit, so each slice sets them.
+struct RenderPassInheritance {
+    VkRenderPass  renderPass  = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    VkViewport    viewport{};
+    VkRect2D      scissor{};
+    // Statistics of a query the primary buffer has active around the slices
+    VkQueryPipelineStatisticFlags pipelineStatistics = 0;
+};
+
+// A frame's draws are split into a fixed number of slices, each recorded into its
+// own secondary command buffer. Every slice has its own command pool per frame in
+// flight, so slices can be recorded on different threads without locking and a
+// frame's pools are reset wholesale once its fence has signalled. The primary
+// buffer then executes the recorded slices in slice order.
+class ParallelRecorder {
+public:
+    ParallelRecorder(const VulkanContext& ctx, uint32_t sliceCount);
+
+    uint32_t sliceCount() const { return sliceCount_; }
+
+    // Reset `frame`'s pools. Call on the render thread after its fence has signalled.
+    void begin(uint32_t frame);
+
+    // Begin a slice's secondary buffer inside the render pass, with viewport and
+    // scissor set; the caller binds its pipeline, records and ends the buffer.
+    // Different slices may be begun and recorded concurrently.
+    VkCommandBuffer beginSlice(uint32_t frame, uint32_t slice, const RenderPassInheritance& pass);
+
+    // Execute the slices begun since begin(frame). The render pass must have been
+    // begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+    void execute(VkCommandBuffer primary, uint32_t frame);
+
+    // Only slices [firstSlice, firstSlice + count), for frames whose slices
+    // continue different render passes; each range inside its own
+    void execute(VkCommandBuffer primary, uint32_t frame, uint32_t firstSlice, uint32_t count);
+
+private:
+    struct FrameSlices {
+        std::vector<std::unique_ptr<CommandPool>> pools;  // one buffer each
+        std::vector<uint8_t>                      begun;  // written by each slice's own thread
+    };
+
+    uint32_t                                      sliceCount_;
+    std::array<FrameSlices, MAX_FRAMES_IN_FLIGHT> frames_;
+    std::vector<VkCommandBuffer>                  executeList_;
+};
+
+} // namespace luna::core
@@ -1,4 +1,4 @@
-// About: Pipeline implementation — builder pattern assembles graphics pipeline state.
+// About: Pipeline implementation — builders assemble graphics and compute pipeline state.
 
 #include "core/Pipeline.h"
 #include "core/VulkanContext.h"
@@ -34,6 +34,29 @@ Pipeline& Pipeline::operator=(Pipeline&& other) noexcept {
     return *this;
 }
 
+VkPipelineLayout Pipeline::createLayout(VkDevice device, VkShaderStageFlags pushStages,
+                                        uint32_t pushConstantSize,
+                                        const std::vector<VkDescriptorSetLayout>& setLayouts) {
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = pushStages;
+    pushRange.offset     = 0;
+    pushRange.size       = pushConstantSize;
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    layoutInfo.pSetLayouts    = setLayouts.data();
+    if (pushConstantSize > 0) {
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges    = &pushRange;
+    }
+
+    VkPipelineLayout layout;
+    if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create pipeline layout");
+    return layout;
+}
+
 // --- Builder ---
 
 Pipeline::Builder::Builder(const VulkanContext& ctx, VkRenderPass renderPass)
@@ -75,7 +98,11 @@ Pipeline::Builder& Pipeline::Builder::setDepthWrite(bool enabled) {
 }
 
 Pipeline::Builder& Pipeline::Builder::enableAlphaBlending() {
-    alphaBlend_ = true;
+    return setBlendMode(BlendMode::Alpha);
+}
+
+Pipeline::Builder& Pipeline::Builder::setBlendMode(BlendMode mode) {
+    blendMode_ = mode;
     return *this;
 }
 
@@ -84,18 +111,23 @@ Pipeline::Builder& Pipeline::Builder::setPushConstantSize(uint32_t size) {
     return *this;
 }
 
+Pipeline::Builder& Pipeline::Builder::addDescriptorSetLayout(VkDescriptorSetLayout layout) {
+    setLayouts_.push_back(layout);
+    return *this;
+}
+
 Pipeline Pipeline::Builder::build() {
-    ShaderModule vertShader(ctx_.device(), vertPath_);
-    ShaderModule fragShader(ctx_.device(), fragPath_);
+    VkShaderModule vertShader = ctx_.shaderCache().get(vertPath_);
+    VkShaderModule fragShader = ctx_.shaderCache().get(fragPath_);
 
     std::array<VkPipelineShaderStageCreateInfo, 2> stages{};
     stages[0].sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     stages[0].stage  = VK_SHADER_STAGE_VERTEX_BIT;
-    stages[0].module = vertShader.handle();
+    stages[0].module = vertShader;
     stages[0].pName  = "main";
     stages[1].sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     stages[1].stage  = VK_SHADER_STAGE_FRAGMENT_BIT;
-    stages[1].module = fragShader.handle();
+    stages[1].module = fragShader;
     stages[1].pName  = "main";
 
     // Vertex input
@@ -151,13 +183,19 @@ Pipeline Pipeline::Builder::build() {
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
     colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT
                                         | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    if (alphaBlend_) {
+    if (blendMode_ != BlendMode::Opaque) {
+        // Alpha keeps the source alpha; the layer modes accumulate coverage so that
+        // a premultiplied composite of the layer equals drawing its contents directly
+        bool layer = blendMode_ != BlendMode::Alpha;
         colorBlendAttachment.blendEnable         = VK_TRUE;
-        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        colorBlendAttachment.srcColorBlendFactor = blendMode_ == BlendMode::Premultiplied
+                                                 ? VK_BLEND_FACTOR_ONE
+                                                 : VK_BLEND_FACTOR_SRC_ALPHA;
         colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
         colorBlendAttachment.colorBlendOp        = VK_BLEND_OP_ADD;
         colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        colorBlendAttachment.dstAlphaBlendFactor = layer ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA
+                                                         : VK_BLEND_FACTOR_ZERO;
         colorBlendAttachment.alphaBlendOp        = VK_BLEND_OP_ADD;
     }
 
@@ -166,24 +204,12 @@ Pipeline Pipeline::Builder::build() {
     colorBlend.attachmentCount = 1;
     colorBlend.pAttachments    = &colorBlendAttachment;
 
-    // Pipeline layout with push constants
-    VkPushConstantRange pushRange{};
-    pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-    pushRange.offset     = 0;
-    pushRange.size       = pushConstantSize_;
-
-    VkPipelineLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    if (pushConstantSize_ > 0) {
-        layoutInfo.pushConstantRangeCount = 1;
-        layoutInfo.pPushConstantRanges    = &pushRange;
-    }
-
+    // Pipeline layout with push constants and any descriptor set layouts
     Pipeline pipeline;
     pipeline.device_ = ctx_.device();
-
-    if (vkCreatePipelineLayout(ctx_.device(), &layoutInfo, nullptr, &pipeline.layout_) != VK_SUCCESS)
-        throw std::runtime_error("Failed to create pipeline layout");
+    pipeline.layout_ = createLayout(ctx_.device(),
+                                    VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                    pushConstantSize_, setLayouts_);
 
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -201,11 +227,54 @@ Pipeline Pipeline::Builder::build() {
     pipelineInfo.renderPass          = renderPass_;
     pipelineInfo.subpass             = 0;
 
-    if (vkCreateGraphicsPipelines(ctx_.device(), VK_NULL_HANDLE, 1, &pipelineInfo,
+    if (vkCreateGraphicsPipelines(ctx_.device(), ctx_.pipelineCache(), 1, &pipelineInfo,
                                    nullptr, &pipeline.pipeline_) != VK_SUCCESS)
         throw std::runtime_error("Failed to create graphics pipeline");
 
     return pipeline;
 }
 
+// --- ComputeBuilder ---
+
+Pipeline::ComputeBuilder::ComputeBuilder(const VulkanContext& ctx)
+    : ctx_(ctx) {}
+
+Pipeline::ComputeBuilder& Pipeline::ComputeBuilder::setShader(const std::string& compPath) {
+    compPath_ = compPath;
+    return *this;
+}
+
+Pipeline::ComputeBuilder& Pipeline::ComputeBuilder::setPushConstantSize(uint32_t size) {
+    pushConstantSize_ = size;
+    return *this;
+}
+
+Pipeline::ComputeBuilder& Pipeline::ComputeBuilder::addDescriptorSetLayout(VkDescriptorSetLayout layout) {
+    setLayouts_.push_back(layout);
+    return *this;
+}
+
+Pipeline Pipeline::ComputeBuilder::build() {
+    VkShaderModule compShader = ctx_.shaderCache().get(compPath_);
+
+    Pipeline pipeline;
+    pipeline.device_ = ctx_.device();
+    pipeline.layout_ = createLayout(ctx_.device(), VK_SHADER_STAGE_COMPUTE_BIT,
+                                    pushConstantSize_, setLayouts_);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType        = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = compShader;
+    pipelineInfo.stage.pName  = "main";
+    pipelineInfo.layout       = pipeline.layout_;
+
+    if (vkCreateComputePipelines(ctx_.device(), ctx_.pipelineCache(), 1, &pipelineInfo,
+                                 nullptr, &pipeline.pipeline_) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create compute pipeline");
+
+    return pipeline;
+}
+
 } // namespace luna::core
@@ -1,4 +1,4 @@
-// About: Vulkan graphics pipeline with builder pattern for configurable setup.
+// About: Vulkan graphics and compute pipelines with builder pattern for configurable setup.
 
 #pragma once
 
@@ -10,6 +10,14 @@ namespace luna::core {
 
 class VulkanContext;
 
+// How a pipeline's color output combines with the attachment
+enum class BlendMode {
+    Opaque,
+    Alpha,          // straight alpha over the attachment
+    Accumulate,     // straight alpha in, premultiplied out: builds a layer composited later
+    Premultiplied,  // premultiplied color over the attachment, e.g. such a layer
+};
+
 class Pipeline {
 public:
     ~Pipeline();
@@ -33,8 +41,10 @@ public:
         Builder& setCullMode(VkCullModeFlags mode);
         Builder& enableDepthTest(VkCompareOp compareOp = VK_COMPARE_OP_GREATER_OR_EQUAL);
         Builder& setDepthWrite(bool enabled);
-        Builder& enableAlphaBlending();
+        Builder& enableAlphaBlending();  // BlendMode::Alpha
+        Builder& setBlendMode(BlendMode mode);
         Builder& setPushConstantSize(uint32_t size);
+        Builder& addDescriptorSetLayout(VkDescriptorSetLayout layout);
 
         Pipeline build();
 
@@ -47,16 +57,38 @@ public:
         VkCullModeFlags      cullMode_ = VK_CULL_MODE_BACK_BIT;
         bool                 depthTest_ = false;
         bool                 depthWrite_ = true;
-        bool                 alphaBlend_ = false;
+        BlendMode            blendMode_ = BlendMode::Opaque;
         VkCompareOp          depthCompareOp_ = VK_COMPARE_OP_GREATER_OR_EQUAL;
         uint32_t             pushConstantSize_ = 0;
         uint32_t             vertexStride_ = 0;
         std::vector<VkVertexInputAttributeDescription> attributes_;
+        std::vector<VkDescriptorSetLayout>             setLayouts_;
+    };
+
+    class ComputeBuilder {
+    public:
+        explicit ComputeBuilder(const VulkanContext& ctx);
+
+        ComputeBuilder& setShader(const std::string& compPath);
+        ComputeBuilder& setPushConstantSize(uint32_t size);
+        ComputeBuilder& addDescriptorSetLayout(VkDescriptorSetLayout layout);
+
+        Pipeline build();
+
+    private:
+        const VulkanContext&               ctx_;
+        std::string                        compPath_;
+        uint32_t                           pushConstantSize_ = 0;
+        std::vector<VkDescriptorSetLayout> setLayouts_;
     };
 
 private:
     Pipeline() = default;
 
+    static VkPipelineLayout createLayout(VkDevice device, VkShaderStageFlags pushStages,
+                                         uint32_t pushConstantSize,
+                                         const std::vector<VkDescriptorSetLayout>& setLayouts);
+
     VkDevice         device_   = VK_NULL_HANDLE;
     VkPipeline       pipeline_ = VK_NULL_HANDLE;
     VkPipelineLayout layout_   = VK_NULL_HANDLE;
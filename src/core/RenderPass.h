@@ -1,4 +1,4 @@
-// About: Vulkan render pass with color and reversed-Z depth attachments.
+// About: Vulkan render pass onto the swapchain images: the upscaled scene, then the HUD.
 
 #pragma once
 
@@ -10,6 +10,8 @@ namespace luna::core {
 class VulkanContext;
 class Swapchain;
 
+// Color only: the scene and its depth live in a SceneTarget, and the upscale
+// pass covers every pixel before the HUD is drawn, so nothing is loaded
 class RenderPass {
 public:
     RenderPass(const VulkanContext& ctx, const Swapchain& swapchain);
@@ -0,0 +1,45 @@
+// About: ResolutionController implementation — smoothed GPU time to a quantised render scale.
+
+#include "core/ResolutionController.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace luna::core {
+
+ResolutionController::ResolutionController(const Settings& settings)
+    : targetMs_(settings.targetGpuMs),
+      minScale_(std::clamp(settings.minScale, SCALE_STEP, 1.0)),
+      maxScale_(std::clamp(settings.maxScale, minScale_, 1.0)),
+      scale_(std::clamp(settings.scale, SCALE_STEP, 1.0)) {
+    if (enabled()) scale_ = std::clamp(scale_, minScale_, maxScale_);
+}
+
+bool ResolutionController::update(double gpuMs) {
+    if (!enabled() || gpuMs <= 0.0) return false;
+    averageMs_ = averageMs_ == 0.0 ? gpuMs : averageMs_ + (gpuMs - averageMs_) * SMOOTHING;
+    if (++frames_ < ADJUST_INTERVAL) return false;
+    frames_ = 0;
+
+    if (averageMs_ <= targetMs_ * OVER_BUDGET && averageMs_ >= targetMs_ * UNDER_BUDGET)
+        return false;
+    double next = scale_ * std::sqrt(targetMs_ / averageMs_);
+    next = std::clamp(next, scale_ * MAX_SHRINK, scale_ * MAX_GROW);
+    next = std::clamp(std::round(next / SCALE_STEP) * SCALE_STEP, minScale_, maxScale_);
+    if (next == scale_) return false;
+
+    // Frames still in flight were drawn at the old scale; start the average over
+    scale_     = next;
+    averageMs_ = 0.0;
+    return true;
+}
+
+VkExtent2D ResolutionController::renderExtent(VkExtent2D native) const {
+    auto side = [this](uint32_t n) {
+        auto scaled = static_cast<uint32_t>(std::lround(n * scale_));
+        return std::clamp<uint32_t>(scaled, 1, n);
+    };
+    return {side(native.width), side(native.height)};
+}
+
+} // namespace luna::core
@@ -0,0 +1,58 @@
+// About: Dynamic resolution — moves the scene's render scale to hold a GPU frame time.
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+namespace luna::core {
+
+// Holds the GPU frame time near Settings::targetGpuMs by scaling the scene's
+// resolution (SceneTarget), the HUD staying native. Fragment work follows the
+// pixel count, the square of the scale, so each adjustment aims straight at
+// the target with sqrt(target / average) and is then limited: quick to shrink,
+// slow to grow back, so it settles rather than oscillates. GPU times arrive
+// frames in flight late, hence the interval between adjustments and a fresh
+// average after each one. Vertex-bound frames (low-altitude terrain) gain less
+// and settle at minScale; the terrain's QualityController takes over from there.
+class ResolutionController {
+public:
+    static constexpr uint32_t ADJUST_INTERVAL = 8;
+    static constexpr double   SMOOTHING       = 0.2;   // weight of a new frame in the average
+    static constexpr double   OVER_BUDGET     = 1.0;   // shrink above this fraction of the target
+    static constexpr double   UNDER_BUDGET    = 0.85;  // grow below it
+    static constexpr double   MAX_SHRINK      = 0.85;  // per adjustment, of the scale
+    static constexpr double   MAX_GROW        = 1.05;
+    static constexpr double   SCALE_STEP      = 1.0 / 64.0;
+
+    struct Settings {
+        double targetGpuMs = 15.0;  // 60 Hz with some headroom; 0 keeps `scale` fixed
+        double minScale    = 0.5;
+        double maxScale    = 1.0;
+        double scale       = 1.0;   // starting scale, or the fixed one
+    };
+
+    explicit ResolutionController(const Settings& settings);
+
+    bool enabled() const { return targetMs_ > 0.0; }
+
+    // Account for one frame's GPU milliseconds (GpuTimer::lastFrameMs). Returns
+    // true when scale() changed.
+    bool update(double gpuMs);
+
+    double scale() const { return scale_; }
+    double averageMs() const { return averageMs_; }
+
+    // `native` at the current scale, each side between 1 and native
+    VkExtent2D renderExtent(VkExtent2D native) const;
+
+private:
+    double   targetMs_;
+    double   minScale_;
+    double   maxScale_;
+    double   scale_;
+    double   averageMs_ = 0.0;
+    uint32_t frames_    = 0;
+};
+
+} // namespace luna::core
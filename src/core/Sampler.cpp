@@ -0,0 +1,50 @@
+// About: Sampler implementation — creation and RAII ownership of a VkSampler.
+
+#include "core/Sampler.h"
+#include "core/VulkanContext.h"
+
+#include <stdexcept>
+
+namespace luna::core {
+
+Sampler::Sampler(const VulkanContext& ctx, VkFilter filter)
+    : device_(ctx.device())
+{
+    VkSamplerCreateInfo info{};
+    info.sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    info.magFilter    = filter;
+    info.minFilter    = filter;
+    info.mipmapMode   = filter == VK_FILTER_LINEAR ? VK_SAMPLER_MIPMAP_MODE_LINEAR
+                                                   : VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    info.minLod       = 0.0f;
+    info.maxLod       = VK_LOD_CLAMP_NONE;
+    info.borderColor  = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+
+    if (vkCreateSampler(device_, &info, nullptr, &sampler_) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create sampler");
+}
+
+Sampler::~Sampler() {
+    if (sampler_) vkDestroySampler(device_, sampler_, nullptr);
+}
+
+Sampler::Sampler(Sampler&& other) noexcept
+    : device_(other.device_), sampler_(other.sampler_)
+{
+    other.sampler_ = VK_NULL_HANDLE;
+}
+
+Sampler& Sampler::operator=(Sampler&& other) noexcept {
+    if (this != &other) {
+        if (sampler_) vkDestroySampler(device_, sampler_, nullptr);
+        device_  = other.device_;
+        sampler_ = other.sampler_;
+        other.sampler_ = VK_NULL_HANDLE;
+    }
+    return *this;
+}
+
+} // namespace luna::core
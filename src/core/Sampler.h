@@ -0,0 +1,30 @@
+// About: Vulkan sampler RAII wrapper.
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace luna::core {
+
+class VulkanContext;
+
+class Sampler {
+public:
+    Sampler() = default;
+    // Clamp-to-edge addressing on every axis; mipmapMode follows `filter`
+    Sampler(const VulkanContext& ctx, VkFilter filter);
+    ~Sampler();
+
+    Sampler(Sampler&& other) noexcept;
+    Sampler& operator=(Sampler&& other) noexcept;
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    VkSampler handle() const { return sampler_; }
+
+private:
+    VkDevice  device_  = VK_NULL_HANDLE;
+    VkSampler sampler_ = VK_NULL_HANDLE;
+};
+
+} // namespace luna::core
@@ -0,0 +1,171 @@
+// About: SceneTarget implementation — scene render pass, attachments, and the upscale draw.
+
+#include "core/SceneTarget.h"
+#include "core/VulkanContext.h"
+
+#include <array>
+#include <stdexcept>
+
+namespace luna::core {
+
+SceneTarget::SceneTarget(const VulkanContext& ctx, VkFormat colorFormat, VkExtent2D extent)
+    : ctx_(ctx), colorFormat_(colorFormat), extent_(extent)
+{
+    createRenderPass(colorFormat);
+
+    // Bilinear, clamped: upscale.frag keeps its taps inside the drawn extent
+    sampler_   = Sampler(ctx, VK_FILTER_LINEAR);
+    setLayout_ = DescriptorSetLayout(ctx, {
+        DescriptorSetLayout::combinedImageSampler(0, VK_SHADER_STAGE_FRAGMENT_BIT),
+    });
+    pool_ = DescriptorPool(ctx, 1, {
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
+    });
+    set_ = pool_.allocate(setLayout_.handle());
+
+    createTargets();
+}
+
+SceneTarget::~SceneTarget() {
+    destroyTargets();
+    if (renderPass_)
+        vkDestroyRenderPass(ctx_.device(), renderPass_, nullptr);
+}
+
+void SceneTarget::resize(VkExtent2D extent) {
+    destroyTargets();
+    extent_ = extent;
+    createTargets();
+}
+
+void SceneTarget::createRenderPass(VkFormat colorFormat) {
+    VkAttachmentDescription colorAttachment{};
+    colorAttachment.format         = colorFormat;
+    colorAttachment.samples        = VK_SAMPLE_COUNT_1_BIT;
+    colorAttachment.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout    = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkAttachmentDescription depthAttachment{};
+    depthAttachment.format         = DEPTH_FORMAT;
+    depthAttachment.samples        = VK_SAMPLE_COUNT_1_BIT;
+    depthAttachment.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp        = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference colorRef{};
+    colorRef.attachment = 0;
+    colorRef.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference depthRef{};
+    depthRef.attachment = 1;
+    depthRef.layout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount    = 1;
+    subpass.pColorAttachments       = &colorRef;
+    subpass.pDepthStencilAttachment = &depthRef;
+
+    // In: the previous frame's upscale has read the color and its depth tests are
+    // done. Out: the upscale reads what was drawn.
+    std::array<VkSubpassDependency, 2> dependencies{};
+    dependencies[0].srcSubpass    = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass    = 0;
+    dependencies[0].srcStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+                                  | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[0].dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                                  | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                  | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[1].srcSubpass    = 0;
+    dependencies[1].dstSubpass    = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
+
+    VkRenderPassCreateInfo rpInfo{};
+    rpInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    rpInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+    rpInfo.pAttachments    = attachments.data();
+    rpInfo.subpassCount    = 1;
+    rpInfo.pSubpasses      = &subpass;
+    rpInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    rpInfo.pDependencies   = dependencies.data();
+
+    if (vkCreateRenderPass(ctx_.device(), &rpInfo, nullptr, &renderPass_) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create scene render pass");
+}
+
+void SceneTarget::createTargets() {
+    color_ = Image(ctx_, extent_.width, extent_.height, colorFormat_,
+                   VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                   VK_IMAGE_ASPECT_COLOR_BIT);
+    depth_ = Image(ctx_, extent_.width, extent_.height, DEPTH_FORMAT,
+                   VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+    std::array<VkImageView, 2> attachments = { color_.view(), depth_.view() };
+    VkFramebufferCreateInfo fbInfo{};
+    fbInfo.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    fbInfo.renderPass      = renderPass_;
+    fbInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+    fbInfo.pAttachments    = attachments.data();
+    fbInfo.width           = extent_.width;
+    fbInfo.height          = extent_.height;
+    fbInfo.layers          = 1;
+    if (vkCreateFramebuffer(ctx_.device(), &fbInfo, nullptr, &framebuffer_) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create scene framebuffer");
+
+    writeCombinedImageSampler(ctx_.device(), set_, 0, color_.view(), sampler_.handle());
+}
+
+void SceneTarget::destroyTargets() {
+    if (framebuffer_)
+        vkDestroyFramebuffer(ctx_.device(), framebuffer_, nullptr);
+    framebuffer_ = VK_NULL_HANDLE;
+    color_ = Image();
+    depth_ = Image();
+}
+
+void SceneTarget::beginPass(VkCommandBuffer cmd, VkExtent2D renderExtent) const {
+    std::array<VkClearValue, 2> clearValues{};
+    clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+    clearValues[1].depthStencil = {0.0f, 0};  // reversed Z: far plane at 0
+
+    VkRenderPassBeginInfo begin{};
+    begin.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    begin.renderPass        = renderPass_;
+    begin.framebuffer       = framebuffer_;
+    begin.renderArea.extent = renderExtent;
+    begin.clearValueCount   = static_cast<uint32_t>(clearValues.size());
+    begin.pClearValues      = clearValues.data();
+    vkCmdBeginRenderPass(cmd, &begin, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+}
+
+void SceneTarget::drawUpscale(VkCommandBuffer cmd, VkPipelineLayout layout,
+                              VkExtent2D renderExtent, float sharpness) const {
+    UpscalePushConstants pc{};
+    pc.uvScaleX   = static_cast<float>(renderExtent.width) / static_cast<float>(extent_.width);
+    pc.uvScaleY   = static_cast<float>(renderExtent.height) / static_cast<float>(extent_.height);
+    pc.texelSizeX = 1.0f / static_cast<float>(extent_.width);
+    pc.texelSizeY = 1.0f / static_cast<float>(extent_.height);
+    // Nothing to restore at native resolution, and sharpening would only add ringing
+    pc.sharpness  = (renderExtent.width < extent_.width) ? sharpness : 0.0f;
+
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &set_, 0, nullptr);
+    vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, sizeof(pc), &pc);
+    vkCmdDraw(cmd, 3, 1, 0, 0);
+}
+
+} // namespace luna::core
@@ -0,0 +1,81 @@
+// About: Offscreen scene color and reversed-Z depth, drawn at a scaled extent and upscaled to the swapchain.
+
+#pragma once
+
+#include "core/Descriptors.h"
+#include "core/Image.h"
+#include "core/Sampler.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+namespace luna::core {
+
+class VulkanContext;
+
+// upscale.frag push constants
+struct UpscalePushConstants {
+    float uvScaleX;    // drawn extent / allocated extent
+    float uvScaleY;
+    float texelSizeX;  // 1 / allocated extent
+    float texelSizeY;
+    float sharpness;   // 0 = plain bilinear
+};
+
+// The world is drawn here rather than into the swapchain image, so its
+// resolution can follow the GPU budget (ResolutionController) while the HUD
+// stays native. The images are allocated at the swapchain's size and a frame
+// renders into the top-left renderExtent of them: the render area, viewport and
+// scissor shrink, nothing is reallocated when the scale moves. The color image
+// is in the swapchain's format, so blending and the upscale's filtering happen
+// in the same encoding as before.
+//
+// The render pass clears both attachments and leaves color
+// SHADER_READ_ONLY_OPTIMAL for the upscale in the swapchain pass. Its external
+// dependencies order a frame's scene after the previous frame's upscale and
+// depth tests, and the upscale after the scene.
+class SceneTarget {
+public:
+    static constexpr VkFormat DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+
+    SceneTarget(const VulkanContext& ctx, VkFormat colorFormat, VkExtent2D extent);
+    ~SceneTarget();
+
+    SceneTarget(const SceneTarget&) = delete;
+    SceneTarget& operator=(const SceneTarget&) = delete;
+
+    VkRenderPass          renderPass() const { return renderPass_; }
+    VkFramebuffer         framebuffer() const { return framebuffer_; }
+    VkExtent2D            extent() const { return extent_; }
+    VkDescriptorSetLayout setLayout() const { return setLayout_.handle(); }
+
+    // After the swapchain was recreated, with the device idle
+    void resize(VkExtent2D extent);
+
+    // Begin the scene pass over the top-left `renderExtent`, for secondary buffers
+    void beginPass(VkCommandBuffer cmd, VkExtent2D renderExtent) const;
+
+    // Inside the swapchain pass with the upscale pipeline bound: one triangle over
+    // the whole framebuffer, filtering the `renderExtent` the scene was drawn at
+    void drawUpscale(VkCommandBuffer cmd, VkPipelineLayout layout, VkExtent2D renderExtent,
+                     float sharpness) const;
+
+private:
+    void createRenderPass(VkFormat colorFormat);
+    void createTargets();
+    void destroyTargets();
+
+    const VulkanContext& ctx_;
+    VkFormat      colorFormat_;
+    VkExtent2D    extent_;
+    VkRenderPass  renderPass_  = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer_ = VK_NULL_HANDLE;
+
+    Image               color_;
+    Image               depth_;
+    Sampler             sampler_;
+    DescriptorSetLayout setLayout_;
+    DescriptorPool      pool_;
+    VkDescriptorSet     set_ = VK_NULL_HANDLE;
+};
+
+} // namespace luna::core
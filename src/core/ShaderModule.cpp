@@ -1,4 +1,4 @@
-// About: ShaderModule implementation — loads SPIR-V binary and creates VkShaderModule.
+// About: ShaderModule implementation — loads SPIR-V binary and creates VkShaderModule; ShaderCache lookup.
 
 #include "core/ShaderModule.h"
 #include "util/FileIO.h"
@@ -44,4 +44,12 @@ ShaderModule& ShaderModule::operator=(ShaderModule&& other) noexcept {
     return *this;
 }
 
+VkShaderModule ShaderCache::get(const std::string& spirvPath) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = modules_.find(spirvPath);
+    if (it == modules_.end())
+        it = modules_.emplace(spirvPath, ShaderModule(device_, spirvPath)).first;
+    return it->second.handle();
+}
+
 } // namespace luna::core
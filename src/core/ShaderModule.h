@@ -1,9 +1,11 @@
-// About: SPIR-V shader module loading and RAII lifetime management.
+// About: SPIR-V shader module loading, RAII lifetime management and a per-path module cache.
 
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace luna::core {
 
@@ -24,4 +26,24 @@ private:
     VkShaderModule module_ = VK_NULL_HANDLE;
 };
 
+// Each SPIR-V file read and turned into a module once, then shared by every
+// pipeline built from it (terrain.frag alone backs three). Modules live until the
+// cache is destroyed, which VulkanContext does just before the device; they are a
+// few kilobytes each. Internally synchronized.
+class ShaderCache {
+public:
+    explicit ShaderCache(VkDevice device) : device_(device) {}
+
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    // Loads on first use; throws like ShaderModule if the file is missing or invalid
+    VkShaderModule get(const std::string& spirvPath);
+
+private:
+    VkDevice                                      device_;
+    std::mutex                                    mutex_;
+    std::unordered_map<std::string, ShaderModule> modules_;
+};
+
 } // namespace luna::core
@@ -0,0 +1,38 @@
+// About: StagingSlots implementation — one mapped transfer-source buffer and a locked free list.
+
+#include "core/StagingSlots.h"
+
+namespace luna::core {
+
+StagingSlots::StagingSlots(const VulkanContext& ctx, uint32_t slotCount, VkDeviceSize slotSize)
+    : slotSize_(slotSize)
+{
+    buffer_ = Buffer::createDynamic(ctx, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, slotSize * slotCount);
+    mapped_ = static_cast<uint8_t*>(buffer_.map());
+
+    // Hand out low slots first
+    free_.reserve(slotCount);
+    for (uint32_t i = slotCount; i-- > 0;)
+        free_.push_back(i);
+}
+
+uint32_t StagingSlots::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) return INVALID_SLOT;
+    uint32_t slot = free_.back();
+    free_.pop_back();
+    return slot;
+}
+
+void StagingSlots::release(uint32_t slot) {
+    if (slot == INVALID_SLOT) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(slot);
+}
+
+uint32_t StagingSlots::freeCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<uint32_t>(free_.size());
+}
+
+} // namespace luna::core
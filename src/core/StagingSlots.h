@@ -0,0 +1,50 @@
+// About: Fixed-size regions of one persistently mapped staging buffer, filled by workers and copied in place.
+
+#pragma once
+
+#include "core/Buffer.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace luna::core {
+
+class VulkanContext;
+
+// For data built off the render thread that should go to the GPU without a copy
+// on the CPU: a worker writes straight into data(slot), then the render thread
+// records a transfer from (buffer(), offset(slot)). Unlike a batch's ring region a
+// slot is held for as long as the work takes, in any order, so slots come from a
+// free list rather than a ring. The holder releases the slot once nothing reads
+// it: after the copy's transfer batch has retired, or when the work is dropped.
+// acquire() and release() may be called from any thread.
+class StagingSlots {
+public:
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+    StagingSlots(const VulkanContext& ctx, uint32_t slotCount, VkDeviceSize slotSize);
+
+    StagingSlots(const StagingSlots&) = delete;
+    StagingSlots& operator=(const StagingSlots&) = delete;
+
+    // INVALID_SLOT when all are held; callers fall back to memory of their own
+    uint32_t acquire();
+    void     release(uint32_t slot);
+
+    VkBuffer     buffer()              const { return buffer_.handle(); }
+    VkDeviceSize offset(uint32_t slot) const { return static_cast<VkDeviceSize>(slot) * slotSize_; }
+    void*        data(uint32_t slot)   const { return mapped_ + offset(slot); }
+    VkDeviceSize slotSize()            const { return slotSize_; }
+    uint32_t     freeCount()           const;
+
+private:
+    Buffer       buffer_;
+    uint8_t*     mapped_   = nullptr;
+    VkDeviceSize slotSize_ = 0;
+
+    mutable std::mutex    mutex_;
+    std::vector<uint32_t> free_;
+};
+
+} // namespace luna::core
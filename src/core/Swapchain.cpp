@@ -8,13 +8,45 @@
 #include <GLFW/glfw3.h>
 
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 namespace luna::core {
 
-static constexpr VkFormat DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+namespace {
 
-Swapchain::Swapchain(const VulkanContext& ctx) : ctx_(ctx) {
+struct PresentModeName {
+    VkPresentModeKHR mode;
+    const char*      name;
+};
+
+constexpr PresentModeName PRESENT_MODES[] = {
+    {VK_PRESENT_MODE_IMMEDIATE_KHR,    "immediate"},
+    {VK_PRESENT_MODE_MAILBOX_KHR,      "mailbox"},
+    {VK_PRESENT_MODE_FIFO_KHR,         "fifo"},
+    {VK_PRESENT_MODE_FIFO_RELAXED_KHR, "fifo_relaxed"},
+};
+
+} // anonymous namespace
+
+bool parsePresentMode(const char* name, VkPresentModeKHR& mode) {
+    for (const auto& m : PRESENT_MODES) {
+        if (std::strcmp(m.name, name) == 0) {
+            mode = m.mode;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* presentModeName(VkPresentModeKHR mode) {
+    for (const auto& m : PRESENT_MODES)
+        if (m.mode == mode) return m.name;
+    return "unknown";
+}
+
+Swapchain::Swapchain(const VulkanContext& ctx, VkPresentModeKHR preferred)
+    : ctx_(ctx), preferredMode_(preferred) {
     create();
 }
 
@@ -44,7 +76,7 @@ void Swapchain::create() {
     vkGetPhysicalDeviceSurfaceCapabilitiesKHR(ctx_.physicalDevice(), ctx_.surface(), &caps);
 
     auto surfaceFormat = chooseFormat();
-    auto presentMode   = chooseMode();
+    presentMode_       = chooseMode();
     extent_            = chooseExtent(caps);
     format_            = surfaceFormat.format;
 
@@ -74,7 +106,7 @@ void Swapchain::create() {
 
     createInfo.preTransform   = caps.currentTransform;
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    createInfo.presentMode    = presentMode;
+    createInfo.presentMode    = presentMode_;
     createInfo.clipped        = VK_TRUE;
 
     if (vkCreateSwapchainKHR(ctx_.device(), &createInfo, nullptr, &swapchain_) != VK_SUCCESS)
@@ -92,16 +124,11 @@ void Swapchain::create() {
         imageViews_[i] = Image::createImageView(ctx_.device(), images_[i], format_,
                                                  VK_IMAGE_ASPECT_COLOR_BIT);
 
-    // Create depth image
-    depthImage_ = Image(ctx_, extent_.width, extent_.height, DEPTH_FORMAT,
-                        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                        VK_IMAGE_ASPECT_DEPTH_BIT);
-
-    LOG_INFO("Swapchain created: %ux%u, %u images", extent_.width, extent_.height, count);
+    LOG_INFO("Swapchain created: %ux%u, %u images, %s", extent_.width, extent_.height, count,
+             presentModeName(presentMode_));
 }
 
 void Swapchain::cleanup() {
-    depthImage_ = Image(); // destroy depth image
     for (auto view : imageViews_)
         vkDestroyImageView(ctx_.device(), view, nullptr);
     imageViews_.clear();
@@ -132,9 +159,13 @@ VkPresentModeKHR Swapchain::chooseMode() const {
     std::vector<VkPresentModeKHR> modes(count);
     vkGetPhysicalDeviceSurfacePresentModesKHR(ctx_.physicalDevice(), ctx_.surface(), &count, modes.data());
 
-    for (auto mode : modes) {
-        if (mode == VK_PRESENT_MODE_MAILBOX_KHR) return mode;
-    }
+    auto supported = [&](VkPresentModeKHR mode) {
+        return std::find(modes.begin(), modes.end(), mode) != modes.end();
+    };
+    if (supported(preferredMode_)) return preferredMode_;
+    // Unthrottled is better served by mailbox than by a vsync'd queue
+    if (preferredMode_ == VK_PRESENT_MODE_IMMEDIATE_KHR && supported(VK_PRESENT_MODE_MAILBOX_KHR))
+        return VK_PRESENT_MODE_MAILBOX_KHR;
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -10,9 +10,15 @@ namespace luna::core {
 
 class VulkanContext;
 
+// "immediate", "mailbox", "fifo" or "fifo_relaxed"; false for anything else
+bool parsePresentMode(const char* name, VkPresentModeKHR& mode);
+const char* presentModeName(VkPresentModeKHR mode);
+
 class Swapchain {
 public:
-    Swapchain(const VulkanContext& ctx);
+    // Uses `preferred` where the surface supports it. Otherwise IMMEDIATE falls back
+    // to MAILBOX, and anything falls back to FIFO, which is always available.
+    Swapchain(const VulkanContext& ctx, VkPresentModeKHR preferred = VK_PRESENT_MODE_MAILBOX_KHR);
     ~Swapchain();
 
     Swapchain(const Swapchain&) = delete;
@@ -26,8 +32,7 @@ public:
     VkExtent2D     extent()     const { return extent_; }
     uint32_t       imageCount() const { return static_cast<uint32_t>(imageViews_.size()); }
     VkImageView    imageView(uint32_t i) const { return imageViews_[i]; }
-
-    VkImageView depthView() const { return depthImage_.view(); }
+    VkPresentModeKHR presentMode() const { return presentMode_; }
 
 private:
     void create();
@@ -38,12 +43,13 @@ private:
     VkExtent2D         chooseExtent(const VkSurfaceCapabilitiesKHR& caps) const;
 
     const VulkanContext& ctx_;
+    VkPresentModeKHR     preferredMode_;
+    VkPresentModeKHR     presentMode_ = VK_PRESENT_MODE_FIFO_KHR;
     VkSwapchainKHR       swapchain_ = VK_NULL_HANDLE;
     VkFormat             format_    = VK_FORMAT_UNDEFINED;
     VkExtent2D           extent_    = {0, 0};
     std::vector<VkImage>     images_;
     std::vector<VkImageView> imageViews_;
-    Image                    depthImage_;
 };
 
 } // namespace luna::core
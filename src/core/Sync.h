@@ -9,7 +9,9 @@ namespace luna::core {
 
 class VulkanContext;
 
-static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+// Per-frame resources are sized for this many frames; FramePacer::framesInFlight()
+// is how many the main loop actually cycles through
+static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
 
 class Sync {
 public:
@@ -0,0 +1,154 @@
+// About: UploadManager implementation — staging ring regions, fence pool, in-order retirement.
+
+#include "core/UploadManager.h"
+#include "core/VulkanContext.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace luna::core {
+
+namespace {
+
+// Region starts stay aligned for buffer-to-image copies of any texel size
+constexpr VkDeviceSize RING_ALIGNMENT = 256;
+
+VkDeviceSize alignRing(VkDeviceSize offset) {
+    return (offset + RING_ALIGNMENT - 1) & ~(RING_ALIGNMENT - 1);
+}
+
+} // anonymous namespace
+
+UploadManager::UploadManager(const VulkanContext& ctx, VkDeviceSize ringCapacity)
+    : ctx_(ctx),
+      pool_(ctx, 0, ctx.queueFamilies().transfer),
+      queue_(ctx.transferQueue())
+{
+    ring_ = Buffer::createDynamic(ctx, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, ringCapacity);
+    ringMapped_ = ring_.map();
+}
+
+UploadManager::~UploadManager() {
+    if (isOpen()) submit();
+    waitIdle();
+    for (VkFence fence : freeFences_)
+        vkDestroyFence(ctx_.device(), fence, nullptr);
+}
+
+VkCommandBuffer UploadManager::begin(VkDeviceSize stagingCapacity) {
+    if (!isOpen()) {
+        if (stagingCapacity <= ring_.size())
+            staging_.beginRegion(ring_.handle(), ringMapped_, claimRing(stagingCapacity),
+                                 stagingCapacity);
+        else
+            staging_.begin(ctx_, stagingCapacity);
+        cmd_ = pool_.beginOneShot();
+    }
+    return cmd_;
+}
+
+VkDeviceSize UploadManager::claimRing(VkDeviceSize size) {
+    for (;;) {
+        // The busy span runs from the oldest ring batch in flight to the head
+        const InFlight* oldest = nullptr;
+        for (const InFlight& f : inFlight_)
+            if (f.ringEnd != f.ringStart) { oldest = &f; break; }
+        if (!oldest) {
+            ringHead_ = 0;
+            return 0;
+        }
+
+        VkDeviceSize tail = oldest->ringStart;
+        if (ringHead_ > tail) {
+            // Free: [head, end) and, after wrapping, [0, tail)
+            if (ringHead_ + size <= ring_.size()) return ringHead_;
+            if (size <= tail) return 0;
+        } else if (ringHead_ < tail && ringHead_ + size <= tail) {
+            return ringHead_;
+        }
+
+        // Full: wait for the oldest batch, then look again
+        ringStalls_++;
+        while (!inFlight_.empty()) {
+            bool ring = inFlight_.front().ringEnd != inFlight_.front().ringStart;
+            VkFence fence = inFlight_.front().fence;
+            vkWaitForFences(ctx_.device(), 1, &fence, VK_TRUE, UINT64_MAX);
+            retireFront();
+            if (ring) break;
+        }
+    }
+}
+
+VkFence UploadManager::acquireFence() {
+    if (!freeFences_.empty()) {
+        VkFence fence = freeFences_.back();
+        freeFences_.pop_back();
+        vkResetFences(ctx_.device(), 1, &fence);
+        return fence;
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    if (vkCreateFence(ctx_.device(), &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create upload fence");
+    return fence;
+}
+
+uint64_t UploadManager::submit() {
+    if (!isOpen()) return completedTicket_;
+
+    staging_.end();
+    vkEndCommandBuffer(cmd_);
+
+    VkFence fence = acquireFence();
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers    = &cmd_;
+
+    if (vkQueueSubmit(queue_, 1, &submitInfo, fence) != VK_SUCCESS)
+        throw std::runtime_error("Failed to submit upload batch");
+
+    uint64_t ticket = nextTicket_++;
+    bytesSubmitted_ += staging_.offset;
+    VkDeviceSize ringStart = staging_.base;
+    VkDeviceSize ringEnd   = ringStart;
+    if (!staging_.buffer.handle()) {
+        // The region shrinks to what was used; the next batch starts after it
+        ringEnd   = std::min(std::max(alignRing(ringStart + staging_.offset), ringStart + RING_ALIGNMENT),
+                             ring_.size());
+        ringHead_ = ringEnd;
+    }
+    inFlight_.push_back({ticket, fence, cmd_, std::move(staging_), ringStart, ringEnd});
+    staging_ = StagingBatch{};
+    cmd_ = VK_NULL_HANDLE;
+    return ticket;
+}
+
+void UploadManager::retireFront() {
+    InFlight& done = inFlight_.front();
+    vkFreeCommandBuffers(ctx_.device(), pool_.pool(), 1, &done.cmd);
+    freeFences_.push_back(done.fence);
+    completedTicket_ = done.ticket;
+    inFlight_.pop_front();  // frees its ring region, or releases its own staging buffer
+}
+
+void UploadManager::poll() {
+    // Retire strictly in submission order so completedTicket_ is a watermark
+    while (!inFlight_.empty() &&
+           vkGetFenceStatus(ctx_.device(), inFlight_.front().fence) == VK_SUCCESS) {
+        retireFront();
+    }
+}
+
+void UploadManager::waitIdle() {
+    while (!inFlight_.empty()) {
+        VkFence fence = inFlight_.front().fence;
+        vkWaitForFences(ctx_.device(), 1, &fence, VK_TRUE, UINT64_MAX);
+        retireFront();
+    }
+}
+
+} // namespace luna::core
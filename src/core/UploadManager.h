@@ -0,0 +1,98 @@
+// About: Non-blocking transfer-queue uploads — batches staged in one mapped ring, tracked by pooled fences.
+
+#pragma once
+
+#include "core/Buffer.h"
+#include "core/CommandPool.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace luna::core {
+
+class VulkanContext;
+
+// Each submitted batch gets a monotonically increasing ticket. Resources that
+// depend on a batch compare their ticket against completedTicket() instead of
+// waiting on the GPU, so the frame loop never blocks on a copy.
+//
+// Staging memory is one host-visible ring, created and mapped once. A batch takes
+// the next free region from the head; on submit the head moves to the end of what
+// it actually used. A region comes free when its batch's fence has retired, so the
+// fences of the batches in flight are what marks the ring's busy span. Only when
+// the ring is full does begin() wait, on the oldest batch. A batch larger than the
+// whole ring gets a staging buffer of its own.
+class UploadManager {
+public:
+    static constexpr VkDeviceSize DEFAULT_RING_CAPACITY = 16ull << 20;
+
+    explicit UploadManager(const VulkanContext& ctx,
+                           VkDeviceSize ringCapacity = DEFAULT_RING_CAPACITY);
+    ~UploadManager();
+
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+
+    // Open a batch with the given staging capacity if none is open. Returns its command buffer.
+    VkCommandBuffer begin(VkDeviceSize stagingCapacity);
+
+    bool            isOpen()         const { return cmd_ != VK_NULL_HANDLE; }
+    VkCommandBuffer commandBuffer()  const { return cmd_; }
+    StagingBatch&   staging()              { return staging_; }
+
+    // Ticket the open batch will carry once submitted
+    uint64_t pendingTicket() const { return nextTicket_; }
+
+    // Submit the open batch on the transfer queue without waiting. Returns its ticket.
+    uint64_t submit();
+
+    // Retire batches whose fences have signalled. Non-blocking; call once per frame.
+    void poll();
+
+    // Staging bytes of every batch submitted so far
+    uint64_t bytesSubmitted() const { return bytesSubmitted_; }
+    // Times begin() found the ring full and waited for a batch to retire
+    uint64_t ringStalls()     const { return ringStalls_; }
+
+    bool     isComplete(uint64_t ticket) const { return ticket <= completedTicket_; }
+    uint64_t completedTicket()           const { return completedTicket_; }
+
+    // Block until every submitted batch has retired (startup and shutdown only)
+    void waitIdle();
+
+private:
+    struct InFlight {
+        uint64_t        ticket;
+        VkFence         fence;
+        VkCommandBuffer cmd;
+        StagingBatch    staging;  // source memory must outlive the copy
+        VkDeviceSize    ringStart;
+        VkDeviceSize    ringEnd;  // equal to ringStart when the batch had its own buffer
+    };
+
+    VkFence      acquireFence();
+    void         retireFront();
+    // Start of a free ring region of `size` bytes, waiting for batches if needed
+    VkDeviceSize claimRing(VkDeviceSize size);
+
+    const VulkanContext& ctx_;
+    CommandPool          pool_;
+    VkQueue              queue_ = VK_NULL_HANDLE;
+
+    VkCommandBuffer cmd_ = VK_NULL_HANDLE;
+    StagingBatch    staging_;
+
+    Buffer       ring_;
+    void*        ringMapped_ = nullptr;
+    VkDeviceSize ringHead_   = 0;  // where the next batch's region starts, at the earliest
+
+    std::deque<InFlight> inFlight_;
+    std::vector<VkFence> freeFences_;
+    uint64_t             nextTicket_      = 1;
+    uint64_t             completedTicket_ = 0;
+    uint64_t             bytesSubmitted_  = 0;
+    uint64_t             ringStalls_      = 0;
+};
+
+} // namespace luna::core
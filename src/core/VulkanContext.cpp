@@ -1,12 +1,17 @@
 // About: VulkanContext implementation — creates window, Vulkan instance, surface, and device.
 
 #include "core/VulkanContext.h"
+#include "core/GpuHeap.h"
+#include "core/ShaderModule.h"
+#include "util/FileIO.h"
 #include "util/Log.h"
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <set>
 #include <stdexcept>
 #include <vector>
@@ -23,6 +28,40 @@ static const std::vector<const char*> VALIDATION_LAYERS = {
     "VK_LAYER_KHRONOS_validation"
 };
 
+static const char* PIPELINE_CACHE_PATH = "cache/pipelines.bin";
+
+// Precedes the driver's blob in PIPELINE_CACHE_PATH. Drivers check the blob's own
+// header, but some have crashed on data from another driver build, so a file that
+// does not match this device exactly is never handed to them.
+struct PipelineCacheFileHeader {
+    uint32_t magic;          // PIPELINE_CACHE_MAGIC
+    uint32_t version;        // PIPELINE_CACHE_VERSION
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+    uint32_t reserved;       // zero; keeps dataSize aligned without padding
+    uint64_t dataSize;       // bytes of driver data after the header
+};
+
+static constexpr uint32_t PIPELINE_CACHE_MAGIC   = 0x4850504C;  // "LPPH"
+static constexpr uint32_t PIPELINE_CACHE_VERSION = 1;
+static_assert(sizeof(PipelineCacheFileHeader) == 48, "header must have no padding");
+
+static PipelineCacheFileHeader pipelineCacheHeader(VkPhysicalDevice device) {
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(device, &props);
+
+    PipelineCacheFileHeader header{};
+    header.magic         = PIPELINE_CACHE_MAGIC;
+    header.version       = PIPELINE_CACHE_VERSION;
+    header.vendorID      = props.vendorID;
+    header.deviceID      = props.deviceID;
+    header.driverVersion = props.driverVersion;
+    std::memcpy(header.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE);
+    return header;
+}
+
 static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
     VkDebugUtilsMessageSeverityFlagBitsEXT severity,
     VkDebugUtilsMessageTypeFlagsEXT /*type*/,
@@ -48,11 +87,20 @@ VulkanContext::VulkanContext(int width, int height, const char* title) {
     createSurface();
     pickPhysicalDevice();
     createLogicalDevice();
+    heap_ = std::make_unique<GpuHeap>(device_, physicalDevice_);
+    createPipelineCache();
+    shaderCache_ = std::make_unique<ShaderCache>(device_);
 
     LOG_INFO("VulkanContext initialized");
 }
 
 VulkanContext::~VulkanContext() {
+    shaderCache_.reset();
+    if (pipelineCache_) {
+        savePipelineCache();
+        vkDestroyPipelineCache(device_, pipelineCache_, nullptr);
+    }
+    heap_.reset();  // frees every heap block; all Buffers must already be gone
     if (device_)         vkDestroyDevice(device_, nullptr);
     if (debugMessenger_) {
         auto func = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
@@ -81,6 +129,19 @@ void VulkanContext::createInstance() {
     if (ENABLE_VALIDATION)
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
+    // Extended feature queries, for optional device features such as present wait
+    uint32_t availableCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, nullptr);
+    std::vector<VkExtensionProperties> available(availableCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &availableCount, available.data());
+    for (auto& ext : available) {
+        if (std::strcmp(ext.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0) {
+            hasProperties2_ = true;
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+            break;
+        }
+    }
+
     VkInstanceCreateInfo createInfo{};
     createInfo.sType                   = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo        = &appInfo;
@@ -156,7 +217,8 @@ void VulkanContext::pickPhysicalDevice() {
 }
 
 void VulkanContext::createLogicalDevice() {
-    std::set<uint32_t> uniqueFamilies = { queueFamilies_.graphics, queueFamilies_.present };
+    std::set<uint32_t> uniqueFamilies = { queueFamilies_.graphics, queueFamilies_.present,
+                                          queueFamilies_.transfer };
     float queuePriority = 1.0f;
 
     std::vector<VkDeviceQueueCreateInfo> queueInfos;
@@ -169,12 +231,61 @@ void VulkanContext::createLogicalDevice() {
         queueInfos.push_back(queueInfo);
     }
 
+    // GPU-driven terrain needs multi-draw indirect with a per-draw firstInstance;
+    // enable both when present and let callers check enabledFeatures()
+    VkPhysicalDeviceFeatures supported;
+    vkGetPhysicalDeviceFeatures(physicalDevice_, &supported);
     VkPhysicalDeviceFeatures features{};
+    features.multiDrawIndirect         = supported.multiDrawIndirect;
+    features.drawIndirectFirstInstance = supported.drawIndirectFirstInstance;
+    // Fragment counts for the overdraw readout, queried around secondary buffers
+    features.pipelineStatisticsQuery   = supported.pipelineStatisticsQuery;
+    features.inheritedQueries          = supported.inheritedQueries;
 
-    const std::vector<const char*> deviceExtensions = {
+    std::vector<const char*> deviceExtensions = {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
 
+    uint32_t extCount;
+    vkEnumerateDeviceExtensionProperties(physicalDevice_, nullptr, &extCount, nullptr);
+    std::vector<VkExtensionProperties> available(extCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice_, nullptr, &extCount, available.data());
+
+    bool hasDrawIndirectCount = false;
+    bool hasPresentId = false, hasPresentWait = false;
+    for (auto& ext : available) {
+        if (std::strcmp(ext.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0) {
+            hasDrawIndirectCount = true;
+            deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        }
+        hasPresentId   |= std::strcmp(ext.extensionName, VK_KHR_PRESENT_ID_EXTENSION_NAME) == 0;
+        hasPresentWait |= std::strcmp(ext.extensionName, VK_KHR_PRESENT_WAIT_EXTENSION_NAME) == 0;
+    }
+
+    // Frame pacing waits on presents by ID (see FramePacer). The extensions alone
+    // are not enough: the features must be queried and enabled too.
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    presentIdFeatures.pNext = &presentWaitFeatures;
+    bool enablePresentWait = false;
+    auto getFeatures2 = hasProperties2_
+        ? reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+              vkGetInstanceProcAddr(instance_, "vkGetPhysicalDeviceFeatures2KHR"))
+        : nullptr;
+    if (hasPresentId && hasPresentWait && getFeatures2) {
+        VkPhysicalDeviceFeatures2KHR features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+        features2.pNext = &presentIdFeatures;
+        getFeatures2(physicalDevice_, &features2);
+        enablePresentWait = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+    }
+    if (enablePresentWait) {
+        deviceExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+        deviceExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    }
+
     VkDeviceCreateInfo createInfo{};
     createInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     createInfo.queueCreateInfoCount    = static_cast<uint32_t>(queueInfos.size());
@@ -182,12 +293,96 @@ void VulkanContext::createLogicalDevice() {
     createInfo.pEnabledFeatures        = &features;
     createInfo.enabledExtensionCount   = static_cast<uint32_t>(deviceExtensions.size());
     createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    if (enablePresentWait) createInfo.pNext = &presentIdFeatures;
 
     if (vkCreateDevice(physicalDevice_, &createInfo, nullptr, &device_) != VK_SUCCESS)
         throw std::runtime_error("Failed to create logical device");
 
+    enabledFeatures_ = features;
+    if (hasDrawIndirectCount) {
+        drawIndexedIndirectCount_ = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+            vkGetDeviceProcAddr(device_, "vkCmdDrawIndexedIndirectCountKHR"));
+    }
+    if (enablePresentWait) {
+        waitForPresent_ = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+            vkGetDeviceProcAddr(device_, "vkWaitForPresentKHR"));
+    }
+
     vkGetDeviceQueue(device_, queueFamilies_.graphics, 0, &graphicsQueue_);
     vkGetDeviceQueue(device_, queueFamilies_.present,  0, &presentQueue_);
+    vkGetDeviceQueue(device_, queueFamilies_.transfer, 0, &transferQueue_);
+
+    if (queueFamilies_.hasDedicatedTransfer())
+        LOG_INFO("Using dedicated transfer queue family %u", queueFamilies_.transfer);
+}
+
+void VulkanContext::createPipelineCache() {
+    // Seed with the previous run's data if it came from this exact device and driver
+    std::vector<char> data;
+    if (std::filesystem::exists(PIPELINE_CACHE_PATH)) {
+        std::vector<char> file = luna::util::readBinaryFile(PIPELINE_CACHE_PATH);
+        PipelineCacheFileHeader expected = pipelineCacheHeader(physicalDevice_);
+        PipelineCacheFileHeader stored{};
+        bool match = false;
+        if (file.size() > sizeof(stored)) {
+            std::memcpy(&stored, file.data(), sizeof(stored));
+            expected.dataSize = file.size() - sizeof(stored);
+            match = std::memcmp(&stored, &expected, sizeof(stored)) == 0;
+        }
+        if (match)
+            data.assign(file.begin() + sizeof(stored), file.end());
+        else
+            LOG_INFO("Pipeline cache %s is stale or from another GPU or driver, starting empty", PIPELINE_CACHE_PATH);
+    }
+
+    VkPipelineCacheCreateInfo info{};
+    info.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.initialDataSize = data.size();
+    info.pInitialData    = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(device_, &info, nullptr, &pipelineCache_) != VK_SUCCESS) {
+        // The driver rejected the data after all; an empty cache still helps within the run
+        info.initialDataSize = 0;
+        info.pInitialData    = nullptr;
+        if (vkCreatePipelineCache(device_, &info, nullptr, &pipelineCache_) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create pipeline cache");
+        LOG_WARN("Pipeline cache %s rejected by the driver, starting empty", PIPELINE_CACHE_PATH);
+    } else if (!data.empty()) {
+        LOG_INFO("Pipeline cache loaded: %zu bytes", data.size());
+    }
+}
+
+void VulkanContext::savePipelineCache() const {
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device_, pipelineCache_, &size, nullptr) != VK_SUCCESS || size == 0)
+        return;
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(device_, pipelineCache_, &size, data.data()) != VK_SUCCESS)
+        return;
+
+    PipelineCacheFileHeader header = pipelineCacheHeader(physicalDevice_);
+    header.dataSize = size;
+
+    // Through a temporary and a rename, so a crash mid-write leaves the old file
+    std::error_code ec;
+    std::filesystem::path target(PIPELINE_CACHE_PATH);
+    if (target.has_parent_path())
+        std::filesystem::create_directories(target.parent_path(), ec);
+    std::string temp = std::string(PIPELINE_CACHE_PATH) + ".tmp";
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(data.data(), static_cast<std::streamsize>(size));
+    out.close();
+    if (!out) {
+        LOG_WARN("Cannot write pipeline cache %s", temp.c_str());
+        std::filesystem::remove(temp, ec);
+        return;
+    }
+    std::filesystem::rename(temp, target, ec);
+    if (ec)
+        LOG_WARN("Cannot replace pipeline cache %s: %s", PIPELINE_CACHE_PATH, ec.message().c_str());
+    else
+        LOG_INFO("Pipeline cache saved: %zu bytes", size);
 }
 
 QueueFamilyIndices VulkanContext::findQueueFamilies(VkPhysicalDevice device) const {
@@ -208,6 +403,20 @@ QueueFamilyIndices VulkanContext::findQueueFamilies(VkPhysicalDevice device) con
 
         if (indices.isComplete()) break;
     }
+
+    // Transfer-only family (DMA engine) lets uploads run beside rendering.
+    // Graphics families always support transfer, so fall back to that.
+    for (uint32_t i = 0; i < count; i++) {
+        VkQueueFlags flags = families[i].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) &&
+            !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+            indices.transfer = i;
+            break;
+        }
+    }
+    if (indices.transfer == UINT32_MAX)
+        indices.transfer = indices.graphics;
+
     return indices;
 }
 
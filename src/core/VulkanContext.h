@@ -3,15 +3,21 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <memory>
 
 struct GLFWwindow;
 
 namespace luna::core {
 
+class GpuHeap;
+class ShaderCache;
+
 struct QueueFamilyIndices {
     uint32_t graphics = UINT32_MAX;
     uint32_t present  = UINT32_MAX;
+    uint32_t transfer = UINT32_MAX;  // dedicated DMA family if the GPU has one, else graphics
     bool isComplete() const { return graphics != UINT32_MAX && present != UINT32_MAX; }
+    bool hasDedicatedTransfer() const { return transfer != graphics; }
 };
 
 class VulkanContext {
@@ -29,14 +35,38 @@ public:
     VkSurfaceKHR     surface()        const { return surface_; }
     VkQueue          graphicsQueue()  const { return graphicsQueue_; }
     VkQueue          presentQueue()   const { return presentQueue_; }
+    VkQueue          transferQueue()  const { return transferQueue_; }
     QueueFamilyIndices queueFamilies() const { return queueFamilies_; }
 
+    // Shared buffer memory sub-allocator; internally synchronized
+    GpuHeap&         heap()           const { return *heap_; }
+
+    // Passed to every pipeline creation. Loaded from PIPELINE_CACHE_PATH at
+    // startup when the file was written by this GPU and driver, saved back on
+    // destruction, so later runs skip most of the driver's shader compilation.
+    VkPipelineCache  pipelineCache()  const { return pipelineCache_; }
+
+    // SPIR-V modules by path, each loaded once; internally synchronized
+    ShaderCache&     shaderCache()    const { return *shaderCache_; }
+
+    // Optional features enabled at device creation when the GPU supports them
+    const VkPhysicalDeviceFeatures& enabledFeatures() const { return enabledFeatures_; }
+
+    // VK_KHR_draw_indirect_count entry point, or nullptr when the extension is absent
+    PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount() const { return drawIndexedIndirectCount_; }
+
+    // VK_KHR_present_wait entry point, or nullptr when it or VK_KHR_present_id is
+    // absent. When set, both are enabled and presents may carry a VkPresentIdKHR.
+    PFN_vkWaitForPresentKHR waitForPresent() const { return waitForPresent_; }
+
 private:
     void createInstance();
     void setupDebugMessenger();
     void createSurface();
     void pickPhysicalDevice();
     void createLogicalDevice();
+    void createPipelineCache();
+    void savePipelineCache() const;
 
     QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device) const;
     bool isDeviceSuitable(VkPhysicalDevice device) const;
@@ -49,7 +79,15 @@ private:
     VkDevice                 device_         = VK_NULL_HANDLE;
     VkQueue                  graphicsQueue_  = VK_NULL_HANDLE;
     VkQueue                  presentQueue_   = VK_NULL_HANDLE;
+    VkQueue                  transferQueue_  = VK_NULL_HANDLE;
     QueueFamilyIndices       queueFamilies_;
+    VkPhysicalDeviceFeatures enabledFeatures_{};
+    PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount_ = nullptr;
+    PFN_vkWaitForPresentKHR  waitForPresent_ = nullptr;
+    bool                     hasProperties2_ = false;  // VK_KHR_get_physical_device_properties2
+    VkPipelineCache          pipelineCache_  = VK_NULL_HANDLE;
+    std::unique_ptr<GpuHeap> heap_;
+    std::unique_ptr<ShaderCache> shaderCache_;
 };
 
 } // namespace luna::core
@@ -1,8 +1,12 @@
-// About: Builds static HUD mesh and draws with per-frame telemetry push constants.
+// About: Builds the HUD tile mesh, redraws changed tiles into the layer cache and draws with telemetry push constants.
 
 #include "hud/Hud.h"
+#include "hud/HudLayerCache.h"
+#include "core/Pipeline.h"
 #include "sim/SimState.h"
+#include "sim/TrajectoryPredictor.h"
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -10,72 +14,190 @@ namespace luna::hud {
 
 namespace {
 
-void addQuad(std::vector<HudVertex>& verts, std::vector<uint32_t>& indices,
-             float x, float y, float w, float h, float instrumentId) {
-    uint32_t base = static_cast<uint32_t>(verts.size());
-    verts.push_back({{x,     y},     {0.0f, 0.0f}, instrumentId});
-    verts.push_back({{x + w, y},     {1.0f, 0.0f}, instrumentId});
-    verts.push_back({{x + w, y + h}, {1.0f, 1.0f}, instrumentId});
-    verts.push_back({{x,     y + h}, {0.0f, 1.0f}, instrumentId});
-    indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+// Instrument IDs the HUD tiles carry (hud.frag)
+constexpr float COCKPIT_FRAME = 10.0f;
+constexpr float CROSSHAIR     = 13.0f;
+constexpr float PROGRADE      = 14.0f;
+constexpr float WARNINGS      = 15.0f;
+constexpr float PROFILER      = 12.0f;
+
+constexpr uint32_t VERTICES_PER_TILE = 6;
+
+struct Rect {
+    glm::vec2 min;
+    glm::vec2 max;
+};
+
+bool overlaps(const Rect& a, const Rect& b) {
+    return a.min.x < b.max.x && b.min.x < a.max.x && a.min.y < b.max.y && b.min.y < a.max.y;
+}
+
+bool overlaps(const VkRect2D& a, const VkRect2D& b) {
+    return a.offset.x < b.offset.x + static_cast<int32_t>(b.extent.width)
+        && b.offset.x < a.offset.x + static_cast<int32_t>(a.extent.width)
+        && a.offset.y < b.offset.y + static_cast<int32_t>(b.extent.height)
+        && b.offset.y < a.offset.y + static_cast<int32_t>(a.extent.height);
+}
+
+void addQuad(std::vector<HudVertex>& verts, float x, float y, float w, float h,
+             float instrumentId) {
+    HudVertex v0{{x,     y},     {0.0f, 0.0f}, instrumentId};
+    HudVertex v1{{x + w, y},     {1.0f, 0.0f}, instrumentId};
+    HudVertex v2{{x + w, y + h}, {1.0f, 1.0f}, instrumentId};
+    HudVertex v3{{x,     y + h}, {0.0f, 1.0f}, instrumentId};
+    verts.insert(verts.end(), {v0, v1, v2, v0, v2, v3});
+}
+
+// Cached tiles as few non-overlapping rectangles, so the composite reads each
+// texel once: overlapping tiles are replaced by their bounding box until none
+// overlap. Texels between tiles are transparent and composite to nothing.
+std::vector<Rect> mergeOverlapping(std::vector<Rect> rects) {
+    for (bool merged = true; merged;) {
+        merged = false;
+        for (size_t i = 0; i < rects.size() && !merged; ++i) {
+            for (size_t j = i + 1; j < rects.size(); ++j) {
+                if (!overlaps(rects[i], rects[j])) continue;
+                rects[i].min = glm::min(rects[i].min, rects[j].min);
+                rects[i].max = glm::max(rects[i].max, rects[j].max);
+                rects.erase(rects.begin() + static_cast<std::ptrdiff_t>(j));
+                merged = true;
+                break;
+            }
+        }
+    }
+    return rects;
 }
 
 } // anonymous namespace
 
+void Hud::addTile(std::vector<HudVertex>& vertices, float x, float y, float w, float h,
+                  float instrumentId, bool cached) {
+    tiles_.push_back({{x, y}, {x + w, y + h}, instrumentId,
+                      static_cast<uint32_t>(vertices.size()), cached});
+    addQuad(vertices, x, y, w, h, instrumentId);
+}
+
 Hud::Hud(const luna::core::VulkanContext& ctx,
          const luna::core::CommandPool& cmdPool) {
     std::vector<HudVertex> vertices;
-    std::vector<uint32_t> indices;
 
     // === Bottom instruments ===
     // Panel dimensions chosen so text rendering has reasonable pixel aspect.
     // On 16:9: pixelAspect = (W * 1.78) / H — should be 2-4 for readable text.
 
     // Altitude — bottom-left, 7 digits + label
-    addQuad(vertices, indices, 0.02f, 0.06f, 0.22f, 0.08f, 0.0f);
+    addTile(vertices, 0.02f, 0.06f, 0.22f, 0.08f, 0.0f, true);
 
     // Vertical speed — below altitude, sign + 5 digits + label
-    addQuad(vertices, indices, 0.02f, 0.00f, 0.18f, 0.06f, 1.0f);
+    addTile(vertices, 0.02f, 0.00f, 0.18f, 0.06f, 1.0f, true);
 
     // Surface speed — bottom-right, 5 digits + label
-    addQuad(vertices, indices, 0.80f, 0.00f, 0.18f, 0.06f, 2.0f);
+    addTile(vertices, 0.80f, 0.00f, 0.18f, 0.06f, 2.0f, true);
 
     // Throttle bar — bottom-center-left, vertical + label
-    addQuad(vertices, indices, 0.44f, 0.00f, 0.04f, 0.15f, 3.0f);
+    addTile(vertices, 0.44f, 0.00f, 0.04f, 0.15f, 3.0f, true);
 
     // Fuel bar — bottom-center-right, vertical + label
-    addQuad(vertices, indices, 0.52f, 0.00f, 0.04f, 0.15f, 4.0f);
+    addTile(vertices, 0.52f, 0.00f, 0.04f, 0.15f, 4.0f, true);
 
     // === Phase 2 instruments ===
 
-    // Full-screen overlay (cockpit frame, crosshair, prograde, warnings)
-    addQuad(vertices, indices, 0.0f, 0.0f, 1.0f, 1.0f, 10.0f);
+    // Overlay: a tile per cockpit frame corner bracket, then the crosshair and
+    // prograde marker, placed by hud.vert around their centres in aspect-corrected
+    // units, and the warning row. The markers move or flash, so are never cached.
+    addTile(vertices, 0.0f, 0.9f, 0.1f, 0.1f, COCKPIT_FRAME, true);
+    addTile(vertices, 0.9f, 0.9f, 0.1f, 0.1f, COCKPIT_FRAME, true);
+    addTile(vertices, 0.0f, 0.0f, 0.1f, 0.1f, COCKPIT_FRAME, true);
+    addTile(vertices, 0.9f, 0.0f, 0.1f, 0.1f, COCKPIT_FRAME, true);
+    addTile(vertices, -0.02f, -0.02f, 0.04f, 0.04f, CROSSHAIR, false);
+    addTile(vertices, -0.025f, -0.025f, 0.05f, 0.05f, PROGRADE, false);
+    addTile(vertices, 0.35f, 0.175f, 0.30f, 0.045f, WARNINGS, false);
 
     // Attitude indicator — left side (W:H ≈ 9:16 in UV → ~1:1 in pixels on 16:9)
-    addQuad(vertices, indices, 0.02f, 0.24f, 0.12f, 0.20f, 5.0f);
+    addTile(vertices, 0.02f, 0.24f, 0.12f, 0.20f, 5.0f, true);
 
     // Heading compass — top-center horizontal strip
-    addQuad(vertices, indices, 0.20f, 0.94f, 0.60f, 0.04f, 6.0f);
+    addTile(vertices, 0.20f, 0.94f, 0.60f, 0.04f, 6.0f, true);
 
     // Flight phase — top-left
-    addQuad(vertices, indices, 0.02f, 0.90f, 0.14f, 0.08f, 7.0f);
+    addTile(vertices, 0.02f, 0.90f, 0.14f, 0.08f, 7.0f, true);
 
     // Mission elapsed time — top-right
-    addQuad(vertices, indices, 0.82f, 0.90f, 0.16f, 0.08f, 8.0f);
+    addTile(vertices, 0.82f, 0.90f, 0.16f, 0.08f, 8.0f, true);
 
     // Time to surface — below altitude stack (gap above ALT)
-    addQuad(vertices, indices, 0.02f, 0.15f, 0.14f, 0.07f, 9.0f);
+    addTile(vertices, 0.02f, 0.15f, 0.14f, 0.07f, 9.0f, true);
+
+    // Time warp achieved — below mission time
+    addTile(vertices, 0.82f, 0.82f, 0.16f, 0.07f, 11.0f, true);
+
+    // Profiler panel — right side, hidden unless toggled on
+    addTile(vertices, 0.84f, 0.40f, 0.14f, 0.25f, PROFILER, true);
+
+    std::vector<Rect> cachedRects;
+    for (const Tile& tile : tiles_)
+        if (tile.cached) cachedRects.push_back({tile.min, tile.max});
+    compositeFirst_ = static_cast<uint32_t>(vertices.size());
+    for (const Rect& rect : mergeOverlapping(cachedRects)) {
+        glm::vec2 size = rect.max - rect.min;
+        addQuad(vertices, rect.min.x, rect.min.y, size.x, size.y, -1.0f);
+    }
+    compositeCount_ = static_cast<uint32_t>(vertices.size()) - compositeFirst_;
+    drawnKeys_.resize(tiles_.size());
 
     mesh_ = luna::scene::Mesh(ctx, cmdPool,
                                vertices.data(),
                                static_cast<uint32_t>(vertices.size() * sizeof(HudVertex)),
-                               indices.data(),
-                               static_cast<uint32_t>(indices.size()));
+                               static_cast<uint32_t>(vertices.size()));
+
+    for (uint32_t f = 0; f < luna::core::MAX_FRAMES_IN_FLIGHT; ++f) {
+        trajectoryBuffers_[f] = luna::core::Buffer::createDynamic(
+            ctx, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, MAX_TRAJECTORY_POINTS * sizeof(TrajectoryVertex));
+        trajectoryMapped_[f] = static_cast<TrajectoryVertex*>(trajectoryBuffers_[f].map());
+    }
+}
+
+void Hud::releaseGPU() {
+    mesh_.release();
+    for (auto& buffer : trajectoryBuffers_) buffer.release();
 }
 
-void Hud::draw(VkCommandBuffer cmd, VkPipelineLayout layout,
-               const luna::sim::SimState& simState, float aspectRatio,
-               const glm::mat4& viewProj) const {
+void Hud::updateTrajectory(uint32_t frame, const luna::sim::Trajectory& trajectory,
+                           const glm::dvec3& cameraPos) {
+    static_assert(MAX_TRAJECTORY_POINTS == luna::sim::TrajectoryPredictor::MAX_POINTS);
+
+    uint32_t count = static_cast<uint32_t>(
+        std::min<size_t>(trajectory.points.size(), MAX_TRAJECTORY_POINTS));
+    TrajectoryVertex* out = trajectoryMapped_[frame];
+    for (uint32_t i = 0; i < count; ++i) {
+        // Subtract in double before narrowing, as for the terrain patches
+        out[i].position = glm::vec3(trajectory.points[i] - cameraPos);
+        out[i].progress = count > 1 ? static_cast<float>(i) / static_cast<float>(count - 1) : 0.0f;
+    }
+    trajectoryCounts_[frame] = count;
+    trajectoryImpact_[frame] = trajectory.impact;
+}
+
+void Hud::drawTrajectory(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t frame,
+                         const glm::mat4& viewProj) const {
+    if (trajectoryCounts_[frame] < 2) return;
+
+    // Cyan while the path stays aloft, amber when it ends on the surface
+    TrajectoryPushConstants pc{};
+    pc.viewProj = viewProj;
+    pc.color    = trajectoryImpact_[frame] ? glm::vec4(1.0f, 0.6f, 0.2f, 0.9f)
+                                           : glm::vec4(0.3f, 0.9f, 1.0f, 0.8f);
+    vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, sizeof(pc), &pc);
+
+    VkBuffer     buffer = trajectoryBuffers_[frame].handle();
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(cmd, 0, 1, &buffer, &offset);
+    vkCmdDraw(cmd, trajectoryCounts_[frame], 1, 0, 0);
+}
+
+void Hud::update(const luna::sim::SimState& simState, float aspectRatio,
+                 const glm::mat4& viewProj, double timeWarp) {
     HudPushConstants pc{};
 
     // Existing telemetry
@@ -152,6 +274,13 @@ void Hud::draw(VkCommandBuffer cmd, VkPipelineLayout layout,
     // Flight phase
     pc.flightPhase = static_cast<float>(static_cast<int>(simState.phase));
     pc.missionTime = static_cast<float>(simState.missionTime);
+    pc.timeWarp    = static_cast<float>(timeWarp);
+
+    pc.profileFrameUs   = profile_.visible ? static_cast<float>(profile_.frameMs * 1000.0) : -1.0f;
+    pc.profileGpuUs     = static_cast<float>(profile_.gpuMs * 1000.0);
+    pc.profileLodUs     = static_cast<float>(profile_.lodUpdateMs * 1000.0);
+    pc.profileSplits    = static_cast<float>(profile_.splits);
+    pc.profileUploadKiB = static_cast<float>(profile_.uploadBytes / 1024.0);
 
     // Warning flags: bit 0 = low fuel, bit 1 = high descent rate, bit 2 = tilt
     int warnings = 0;
@@ -163,10 +292,128 @@ void Hud::draw(VkCommandBuffer cmd, VkPipelineLayout layout,
         warnings |= 4;
     pc.warningFlags = static_cast<float>(warnings);
 
+    pc_ = pc;
+}
+
+Hud::TileKey Hud::tileKey(const Tile& tile) const {
+    // Mirrors what hud.frag reads: readouts show whole numbers, bars and dials
+    // are held to steps finer than a pixel at 4K
+    auto whole = [](float value, float limit) {
+        return static_cast<int64_t>(std::min(std::abs(value), limit));
+    };
+    auto steps = [](float value, float perUnit) {
+        return static_cast<int64_t>(std::lround(value * perUnit));
+    };
+
+    switch (static_cast<int>(tile.instrumentId + 0.5f)) {
+    case 0:  return {whole(pc_.altitude, 9999999.0f)};
+    case 1:  return {whole(pc_.verticalSpeed, 9999999.0f), pc_.verticalSpeed < 0.0f};
+    case 2:  return {whole(pc_.surfaceSpeed, 9999999.0f)};
+    case 3:  return {steps(pc_.throttle, 1024.0f)};
+    case 4:  return {steps(pc_.fuelFraction, 1024.0f)};
+    case 5:  return {steps(pc_.pitch, 1000.0f), steps(pc_.roll, 1000.0f)};  // milliradians
+    case 6:  return {steps(pc_.heading, 100.0f)};                             // 0.01 degree
+    case 7:  return {whole(pc_.flightPhase + 0.5f, 16.0f)};
+    case 8:  return {whole(pc_.missionTime, 1e9f)};
+    case 9:  return {pc_.timeToSurface < 0.0f ? -1 : whole(pc_.timeToSurface, 99999.0f)};
+    case 11: return {whole(pc_.timeWarp + 0.5f, 9999999.0f), pc_.timeWarp > 1.5f};
+    case 12:
+        if (pc_.profileFrameUs < 0.0f) return {-1};
+        return {whole(pc_.profileFrameUs + 0.5f, 99999.0f), whole(pc_.profileGpuUs + 0.5f, 99999.0f),
+                whole(pc_.profileLodUs + 0.5f, 99999.0f), whole(pc_.profileSplits + 0.5f, 99999.0f),
+                whole(pc_.profileUploadKiB + 0.5f, 99999.0f)};
+    default: return {};  // the cockpit frame never changes
+    }
+}
+
+VkRect2D Hud::pixelRect(glm::vec2 min, glm::vec2 max, VkExtent2D extent) const {
+    // Screen UV has its origin bottom-left, the framebuffer top-left
+    float w = static_cast<float>(extent.width);
+    float h = static_cast<float>(extent.height);
+    int32_t x0 = std::max(0, static_cast<int32_t>(std::floor(min.x * w)));
+    int32_t x1 = std::min(static_cast<int32_t>(extent.width),
+                          static_cast<int32_t>(std::ceil(max.x * w)));
+    int32_t y0 = std::max(0, static_cast<int32_t>(std::floor((1.0f - max.y) * h)));
+    int32_t y1 = std::min(static_cast<int32_t>(extent.height),
+                          static_cast<int32_t>(std::ceil((1.0f - min.y) * h)));
+    return {{x0, y0}, {static_cast<uint32_t>(std::max(x1 - x0, 1)),
+                       static_cast<uint32_t>(std::max(y1 - y0, 1))}};
+}
+
+uint32_t Hud::recordLayers(VkCommandBuffer cmd, HudLayerCache& cache,
+                           const luna::core::Pipeline& pipeline) {
+    bool redrawAll = cache.prepare(cmd);
+    VkExtent2D extent = cache.extent();
+
+    uint32_t redrawn = 0;
+    std::array<uint32_t, 32> dirty{};
+    for (uint32_t i = 0; i < tiles_.size() && redrawn < dirty.size(); ++i) {
+        if (!tiles_[i].cached) continue;
+        TileKey key = tileKey(tiles_[i]);
+        if (!redrawAll && key == drawnKeys_[i]) continue;
+        drawnKeys_[i] = key;
+        dirty[redrawn++] = i;
+    }
+    if (redrawn == 0) return 0;
+
+    cache.beginPass(cmd);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.handle());
+    vkCmdPushConstants(cmd, pipeline.layout(),
+                       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, sizeof(HudPushConstants), &pc_);
+    mesh_.bind(cmd);
+
+    if (redrawAll) {
+        VkRect2D full{{0, 0}, extent};
+        vkCmdSetScissor(cmd, 0, 1, &full);
+        for (const Tile& tile : tiles_)
+            if (tile.cached) vkCmdDraw(cmd, VERTICES_PER_TILE, 1, tile.firstVertex, 0);
+    } else {
+        // Each stale tile's pixels start over from transparent, then every cached
+        // tile reaching into them is drawn again in order, clipped to them, so
+        // overlapping neighbours (the frame corners) blend as before
+        for (uint32_t d = 0; d < redrawn; ++d) {
+            const Tile& stale = tiles_[dirty[d]];
+            VkRect2D rect = pixelRect(stale.min, stale.max, extent);
+
+            VkClearAttachment clear{};
+            clear.aspectMask      = VK_IMAGE_ASPECT_COLOR_BIT;
+            clear.colorAttachment = 0;
+            VkClearRect clearRect{rect, 0, 1};
+            vkCmdClearAttachments(cmd, 1, &clear, 1, &clearRect);
+            vkCmdSetScissor(cmd, 0, 1, &rect);
+
+            for (const Tile& tile : tiles_) {
+                if (tile.cached && overlaps(pixelRect(tile.min, tile.max, extent), rect))
+                    vkCmdDraw(cmd, VERTICES_PER_TILE, 1, tile.firstVertex, 0);
+            }
+        }
+    }
+    cache.endPass(cmd);
+    return redrawn;
+}
+
+void Hud::drawLayers(VkCommandBuffer cmd, VkPipelineLayout layout,
+                     const HudLayerCache& cache) const {
+    VkDescriptorSet set = cache.descriptorSet();
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &set, 0, nullptr);
+    mesh_.bind(cmd);
+    vkCmdDraw(cmd, compositeCount_, 1, compositeFirst_, 0);
+}
+
+void Hud::draw(VkCommandBuffer cmd, VkPipelineLayout layout, bool layersCached) const {
     vkCmdPushConstants(cmd, layout,
                        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                       0, sizeof(HudPushConstants), &pc);
-    mesh_.draw(cmd);
+                       0, sizeof(HudPushConstants), &pc_);
+    mesh_.bind(cmd);
+    for (const Tile& tile : tiles_) {
+        if (tile.cached && layersCached) continue;
+        // Tiles that would shade nothing this frame
+        if (tile.instrumentId == PROGRADE && pc_.progradeVisible < 0.5f) continue;
+        if (tile.instrumentId == WARNINGS && pc_.warningFlags < 0.5f) continue;
+        if (tile.instrumentId == PROFILER && pc_.profileFrameUs < 0.0f) continue;
+        vkCmdDraw(cmd, VERTICES_PER_TILE, 1, tile.firstVertex, 0);
+    }
 }
 
 } // namespace luna::hud
@@ -1,24 +1,33 @@
-// About: Screen-space HUD overlay with flight instruments, attitude display, and cockpit frame.
+// About: Screen-space HUD overlay with flight instruments, attitude display, and cockpit frame, drawn as tiles.
 
 #pragma once
 
+#include "core/Buffer.h"
+#include "core/Sync.h"
 #include "scene/Mesh.h"
 #include "util/Math.h"
 #include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <vector>
 
 namespace luna::core {
 class VulkanContext;
 class CommandPool;
+class Pipeline;
 }
 
 namespace luna::sim {
 struct SimState;
+struct Trajectory;
 }
 
 namespace luna::hud {
 
+class HudLayerCache;
+
 struct HudVertex {
-    glm::vec2 position;     // screen UV (0-1), origin bottom-left
+    glm::vec2 position;     // screen UV (0-1), origin bottom-left; markers: see hud.vert
     glm::vec2 uv;           // panel-local UV (0-1)
     float     instrumentId; // fragment shader rendering mode selector
 };
@@ -51,24 +60,117 @@ struct HudPushConstants {
     float progradeVisible;  // 1.0 if on screen, 0.0 if behind camera
 
     float tiltAngle;        // degrees from vertical
-    float _pad0;
+    float timeWarp;         // simulated seconds per wall second achieved
+
+    // Profiler panel; profileFrameUs < 0 hides it
+    float profileFrameUs;
+    float profileGpuUs;
+    float profileLodUs;
+    float profileSplits;
+    float profileUploadKiB;
     float _pad1;
-    float _pad2;
+};
+static_assert(sizeof(HudPushConstants) <= 128, "HUD push constants exceed the guaranteed minimum");
+
+// Last frame's numbers for the profiler panel
+struct HudProfile {
+    bool   visible     = false;
+    double frameMs     = 0.0;
+    double gpuMs       = 0.0;
+    double lodUpdateMs = 0.0;
+    double splits      = 0.0;
+    double uploadBytes = 0.0;
+};
+
+// Predicted flight path line strip (trajectory.vert)
+struct TrajectoryVertex {
+    glm::vec3 position;  // camera-relative
+    float     progress;  // 0 at the vehicle, 1 at the end of the prediction
 };
 
+struct TrajectoryPushConstants {
+    glm::mat4 viewProj;  // rotation-only
+    glm::vec4 color;     // rgb, alpha at the vehicle end
+};
+
+// The HUD is a set of tiles, each a quad around one instrument: panels, the
+// four corners of the cockpit frame, and the centred markers (crosshair,
+// prograde, warnings). Nothing is shaded outside them.
+//
+// With a HudLayerCache the panels and frame are drawn into the cache only when
+// what they display changes, quantised to what the screen can show, and each
+// frame composites the cache and draws the markers on top. Without one every
+// tile is shaded every frame.
 class Hud {
 public:
+    static constexpr uint32_t MAX_TRAJECTORY_POINTS = 512;  // TrajectoryPredictor::MAX_POINTS
+
     Hud(const luna::core::VulkanContext& ctx,
         const luna::core::CommandPool& cmdPool);
 
-    void draw(VkCommandBuffer cmd, VkPipelineLayout layout,
-              const luna::sim::SimState& simState, float aspectRatio,
-              const glm::mat4& viewProj) const;
+    // Once per frame, before the draws: this frame's telemetry and attitude.
+    // `timeWarp` is the rate the simulation actually kept (PhysicsThread::achievedWarp).
+    void update(const luna::sim::SimState& simState, float aspectRatio,
+                const glm::mat4& viewProj, double timeWarp = 1.0);
+
+    // Outside a render pass: redraw the cached tiles whose values changed since
+    // they were last drawn into `cache`, with `pipeline` made for its render
+    // pass. Returns the number of tiles redrawn.
+    uint32_t recordLayers(VkCommandBuffer cmd, HudLayerCache& cache,
+                          const luna::core::Pipeline& pipeline);
+
+    // Composite `cache` over the frame. The layer composite pipeline must be bound.
+    void drawLayers(VkCommandBuffer cmd, VkPipelineLayout layout,
+                    const HudLayerCache& cache) const;
+
+    // Draw the tiles shaded every frame: the markers after drawLayers(), or every
+    // tile when `layersCached` is false. The HUD pipeline must be bound.
+    void draw(VkCommandBuffer cmd, VkPipelineLayout layout, bool layersCached) const;
+
+    // Write `frame`'s trajectory strip: the predicted points relative to the camera
+    void updateTrajectory(uint32_t frame, const luna::sim::Trajectory& trajectory,
+                          const glm::dvec3& cameraPos);
+
+    // Numbers for the profiler panel drawn by the next update() calls
+    void setProfile(const HudProfile& profile) { profile_ = profile; }
+
+    // Draw the strip written for `frame`. The trajectory pipeline must be bound.
+    void drawTrajectory(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t frame,
+                        const glm::mat4& viewProj) const;
 
-    void releaseGPU() { mesh_.release(); }
+    void releaseGPU();
 
 private:
-    luna::scene::Mesh mesh_;
+    // What a cached tile shows, quantised; the tile is redrawn when it changes
+    using TileKey = std::array<int64_t, 5>;
+
+    struct Tile {
+        glm::vec2 min;       // screen UV, origin bottom-left
+        glm::vec2 max;
+        float     instrumentId;
+        uint32_t  firstVertex;
+        bool      cached;    // in the layer cache rather than drawn every frame
+    };
+
+    void    addTile(std::vector<HudVertex>& vertices, float x, float y, float w, float h,
+                    float instrumentId, bool cached);
+    TileKey tileKey(const Tile& tile) const;
+    VkRect2D pixelRect(glm::vec2 min, glm::vec2 max, VkExtent2D extent) const;
+
+    luna::scene::Mesh mesh_;  // non-indexed, six vertices per tile
+    HudProfile        profile_;
+    HudPushConstants  pc_{};
+
+    std::vector<Tile>    tiles_;          // in draw order
+    std::vector<TileKey> drawnKeys_;      // by tile; what the cache holds
+    uint32_t             compositeFirst_ = 0;  // merged cached tile rectangles
+    uint32_t             compositeCount_ = 0;
+
+    // Host-visible, one per frame in flight: rewritten every frame as the camera moves
+    std::array<luna::core::Buffer, luna::core::MAX_FRAMES_IN_FLIGHT> trajectoryBuffers_;
+    std::array<TrajectoryVertex*, luna::core::MAX_FRAMES_IN_FLIGHT>  trajectoryMapped_{};
+    std::array<uint32_t, luna::core::MAX_FRAMES_IN_FLIGHT>           trajectoryCounts_{};
+    std::array<bool, luna::core::MAX_FRAMES_IN_FLIGHT>               trajectoryImpact_{};
 };
 
 } // namespace luna::hud
@@ -0,0 +1,161 @@
+// About: HudLayerCache implementation — load/store render pass, cleared target image and its sampler set.
+
+#include "hud/HudLayerCache.h"
+#include "core/VulkanContext.h"
+
+#include <stdexcept>
+
+namespace luna::hud {
+
+HudLayerCache::HudLayerCache(const luna::core::VulkanContext& ctx, VkFormat format,
+                             VkExtent2D extent)
+    : ctx_(ctx), format_(format), extent_(extent)
+{
+    createRenderPass();
+
+    // Texels are fetched at the fragment's own pixel, so no filtering is involved
+    sampler_   = luna::core::Sampler(ctx, VK_FILTER_NEAREST);
+    setLayout_ = luna::core::DescriptorSetLayout(ctx, {
+        luna::core::DescriptorSetLayout::combinedImageSampler(0, VK_SHADER_STAGE_FRAGMENT_BIT),
+    });
+    pool_ = luna::core::DescriptorPool(ctx, 1, {
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
+    });
+    set_ = pool_.allocate(setLayout_.handle());
+
+    createTarget();
+}
+
+HudLayerCache::~HudLayerCache() {
+    destroyTarget();
+    if (renderPass_)
+        vkDestroyRenderPass(ctx_.device(), renderPass_, nullptr);
+}
+
+void HudLayerCache::resize(VkExtent2D extent) {
+    destroyTarget();
+    extent_ = extent;
+    createTarget();
+}
+
+void HudLayerCache::createRenderPass() {
+    VkAttachmentDescription color{};
+    color.format         = format_;
+    color.samples        = VK_SAMPLE_COUNT_1_BIT;
+    color.loadOp         = VK_ATTACHMENT_LOAD_OP_LOAD;
+    color.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+    color.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    color.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    color.initialLayout  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    color.finalLayout    = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkAttachmentReference colorRef{};
+    colorRef.attachment = 0;
+    colorRef.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments    = &colorRef;
+
+    // In: earlier frames' composites have finished sampling. Out: this frame's
+    // composite sees the redrawn tiles.
+    VkSubpassDependency dependencies[2]{};
+    dependencies[0].srcSubpass    = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass    = 0;
+    dependencies[0].srcStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+                                  | VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    dependencies[0].dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT
+                                  | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[1].srcSubpass    = 0;
+    dependencies[1].dstSubpass    = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    VkRenderPassCreateInfo rpInfo{};
+    rpInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    rpInfo.attachmentCount = 1;
+    rpInfo.pAttachments    = &color;
+    rpInfo.subpassCount    = 1;
+    rpInfo.pSubpasses      = &subpass;
+    rpInfo.dependencyCount = 2;
+    rpInfo.pDependencies   = dependencies;
+
+    if (vkCreateRenderPass(ctx_.device(), &rpInfo, nullptr, &renderPass_) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create HUD layer render pass");
+}
+
+void HudLayerCache::createTarget() {
+    image_ = luna::core::Image(ctx_, extent_.width, extent_.height, format_,
+                               VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+                                   | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                               VK_IMAGE_ASPECT_COLOR_BIT);
+
+    VkImageView view = image_.view();
+    VkFramebufferCreateInfo fbInfo{};
+    fbInfo.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    fbInfo.renderPass      = renderPass_;
+    fbInfo.attachmentCount = 1;
+    fbInfo.pAttachments    = &view;
+    fbInfo.width           = extent_.width;
+    fbInfo.height          = extent_.height;
+    fbInfo.layers          = 1;
+    if (vkCreateFramebuffer(ctx_.device(), &fbInfo, nullptr, &framebuffer_) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create HUD layer framebuffer");
+
+    luna::core::writeCombinedImageSampler(ctx_.device(), set_, 0, view, sampler_.handle());
+    cleared_ = false;
+}
+
+void HudLayerCache::destroyTarget() {
+    if (framebuffer_)
+        vkDestroyFramebuffer(ctx_.device(), framebuffer_, nullptr);
+    framebuffer_ = VK_NULL_HANDLE;
+    image_ = luna::core::Image();
+}
+
+bool HudLayerCache::prepare(VkCommandBuffer cmd) {
+    if (cleared_) return false;
+
+    // Transparent everywhere, so the composite adds nothing outside the tiles
+    image_.recordTransition(cmd, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    VkClearColorValue clear{};
+    VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdClearColorImage(cmd, image_.image(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         &clear, 1, &range);
+    image_.recordTransition(cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                                | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                            VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+    cleared_ = true;
+    return true;
+}
+
+void HudLayerCache::beginPass(VkCommandBuffer cmd) const {
+    VkRenderPassBeginInfo begin{};
+    begin.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    begin.renderPass        = renderPass_;
+    begin.framebuffer       = framebuffer_;
+    begin.renderArea.extent = extent_;
+    vkCmdBeginRenderPass(cmd, &begin, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport{};
+    viewport.width    = static_cast<float>(extent_.width);
+    viewport.height   = static_cast<float>(extent_.height);
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+}
+
+void HudLayerCache::endPass(VkCommandBuffer cmd) const {
+    vkCmdEndRenderPass(cmd);
+}
+
+} // namespace luna::hud
@@ -0,0 +1,67 @@
+// About: Offscreen image holding the HUD's slowly changing instrument layers, composited each frame.
+
+#pragma once
+
+#include "core/Descriptors.h"
+#include "core/Image.h"
+#include "core/Sampler.h"
+#include <vulkan/vulkan.h>
+
+namespace luna::core {
+class VulkanContext;
+}
+
+namespace luna::hud {
+
+// A swapchain-sized color image in the swapchain's format. Hud::recordLayers()
+// redraws the instrument tiles whose values changed into it, outside the main
+// render pass, and Hud::drawLayers() composites it with one texel fetch per
+// covered pixel. Texels hold premultiplied color (BlendMode::Accumulate) so the
+// composite (BlendMode::Premultiplied) matches drawing the tiles directly.
+//
+// Between frames the image is SHADER_READ_ONLY_OPTIMAL. The render pass loads
+// it, and its dependencies order the redraw after earlier frames' composites
+// and before this frame's.
+class HudLayerCache {
+public:
+    HudLayerCache(const luna::core::VulkanContext& ctx, VkFormat format, VkExtent2D extent);
+    ~HudLayerCache();
+
+    HudLayerCache(const HudLayerCache&) = delete;
+    HudLayerCache& operator=(const HudLayerCache&) = delete;
+
+    VkRenderPass          renderPass() const { return renderPass_; }
+    VkDescriptorSetLayout setLayout() const { return setLayout_.handle(); }
+    VkDescriptorSet       descriptorSet() const { return set_; }
+    VkExtent2D            extent() const { return extent_; }
+
+    // After the swapchain was recreated, with the device idle: a new, empty image
+    void resize(VkExtent2D extent);
+
+    // Outside a render pass, before anything is drawn into the image. A new image
+    // is cleared here; returns true when that happened and every tile is stale.
+    bool prepare(VkCommandBuffer cmd);
+
+    void beginPass(VkCommandBuffer cmd) const;
+    void endPass(VkCommandBuffer cmd) const;
+
+private:
+    void createRenderPass();
+    void createTarget();
+    void destroyTarget();
+
+    const luna::core::VulkanContext& ctx_;
+    VkFormat      format_;
+    VkExtent2D    extent_;
+    VkRenderPass  renderPass_  = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer_ = VK_NULL_HANDLE;
+    bool          cleared_     = false;
+
+    luna::core::Image               image_;
+    luna::core::Sampler             sampler_;
+    luna::core::DescriptorSetLayout setLayout_;
+    luna::core::DescriptorPool      pool_;
+    VkDescriptorSet                 set_ = VK_NULL_HANDLE;
+};
+
+} // namespace luna::hud
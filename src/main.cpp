@@ -4,28 +4,47 @@
 #include "camera/CameraController.h"
 #include "core/Buffer.h"
 #include "core/CommandPool.h"
+#include "core/FramePacer.h"
+#include "core/GpuTimer.h"
+#include "core/ParallelRecorder.h"
 #include "core/Pipeline.h"
 #include "core/RenderPass.h"
+#include "core/ResolutionController.h"
+#include "core/SceneTarget.h"
 #include "core/Swapchain.h"
 #include "core/Sync.h"
+#include "core/UploadManager.h"
 #include "core/VulkanContext.h"
 #include "hud/Hud.h"
+#include "hud/HudLayerCache.h"
 #include "input/InputManager.h"
 #include "scene/ChunkGenerator.h"
 #include "scene/CubesphereBody.h"
 #include "scene/Starfield.h"
+#include "scene/TerrainQuality.h"
+#include "sim/FlightRecording.h"
 #include "sim/Physics.h"
+#include "sim/PhysicsThread.h"
 #include "sim/SimState.h"
 #include "sim/TerrainQuery.h"
+#include "sim/TrajectoryPredictor.h"
 #include "util/Log.h"
 #include "util/Math.h"
+#include "util/Profiler.h"
+#include "util/JobSystem.h"
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <vector>
 
 using namespace luna::core;
 
@@ -36,34 +55,197 @@ static void framebufferResizeCallback(GLFWwindow * /*window*/, int /*w*/,
   framebufferResized = true;
 }
 
-struct TerrainPushConstants {
-  glm::mat4 viewProj; // rotation + projection, no translation
-  glm::vec3
-      cameraOffset; // (chunkCenter - cameraPos), computed in doubles on CPU
-  float _pad0;
-  glm::vec4 sunDirection;
-  glm::vec3 cameraWorldPos; // camera position relative to Moon center (for
-                            // sphere dir)
-  float _pad1;
-};
-
 struct StarfieldPushConstants {
   glm::mat4 viewProj;
 };
 
-int main() {
+// Secondary command buffer slices, executed in this order: the scene pass at
+// the render scale, then the swapchain pass at native resolution
+constexpr uint32_t TERRAIN_SLICE = 0; // one per cube face, nearest face first
+constexpr uint32_t STARFIELD_SLICE = // stars, then the predicted trajectory
+    TERRAIN_SLICE + luna::scene::CubesphereBody::FACE_COUNT;
+constexpr uint32_t SCENE_SLICES = STARFIELD_SLICE + 1;
+constexpr uint32_t HUD_SLICE = SCENE_SLICES; // upscale, then the HUD
+constexpr uint32_t SLICE_COUNT = HUD_SLICE + 1;
+
+// LOD work summed over a replay
+struct ReplayTotals {
+  uint64_t splits = 0;
+  uint64_t merges = 0;
+  uint64_t bytesStaged = 0;
+  uint32_t maxLeaves = 0;
+  uint32_t maxDepth = 0;
+
+  void add(const luna::scene::LodStats &stats) {
+    splits += stats.splits;
+    merges += stats.merges;
+    bytesStaged += stats.bytesStaged;
+    maxLeaves = std::max(maxLeaves, stats.leaves);
+    maxDepth = std::max(maxDepth, stats.maxDepth);
+  }
+};
+
+// Nearest-rank percentile; `values` is reordered
+static double percentile(std::vector<double> &values, double p) {
+  size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+  size_t index = std::min(values.size() - 1, rank > 0 ? rank - 1 : 0);
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+static void reportReplay(std::vector<double> frameMs, const ReplayTotals &totals,
+                         const luna::scene::LodStats &last) {
+  double total = 0.0;
+  for (double ms : frameMs)
+    total += ms;
+  LOG_INFO("Replay: %zu frames in %.2f s, mean %.2f ms", frameMs.size(),
+           total / 1000.0, total / frameMs.size());
+  LOG_INFO("Replay frame time: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms",
+           percentile(frameMs, 0.50), percentile(frameMs, 0.95),
+           percentile(frameMs, 0.99));
+  LOG_INFO("Replay LOD: %llu splits, %llu merges, %.1f MB staged, peak %u "
+           "leaves, depth %u, %llu patches generated",
+           static_cast<unsigned long long>(totals.splits),
+           static_cast<unsigned long long>(totals.merges),
+           totals.bytesStaged / (1024.0 * 1024.0), totals.maxLeaves,
+           totals.maxDepth,
+           static_cast<unsigned long long>(last.patchesGenerated));
+}
+
+int main(int argc, char **argv) {
   luna::util::Log::init();
   LOG_INFO("Luna starting");
 
-  luna::sim::initTerrain("assets/terrain/ldem_16.tif");
+  // --gpu-terrain: displace a shared grid from a heightmap image in the vertex
+  // shader instead of generating patch meshes on the CPU.
+  // --gpu-patches: generate patch meshes with a compute shader instead.
+  // --trace <path>: write the last few seconds of frame profiles on exit.
+  // --lod-stats <path>: write terrain LOD counters every frame (.csv or JSON Lines).
+  // --record <path>: log state, camera and controls every frame.
+  // --replay <path>: fly a recording instead of taking input, with vsync off,
+  // and report frame times and LOD work at the end. --replay-step <seconds>
+  // samples it at a fixed step instead of frame by frame.
+  // --quality <preset|path>: terrain LOD settings, a preset name (low, medium,
+  // high, ultra) or a config file; assets/quality.txt when present otherwise.
+  // --present <immediate|mailbox|fifo|fifo_relaxed>: swapchain present mode.
+  // --frames-in-flight <1..3>, --fps-limit <hz>, --low-latency (sample input
+  // only once the previous frame is done, or on screen with present wait) and
+  // --no-present-wait: frame pacing, see FramePacer.
+  // --no-depth-sort: draw terrain in tree order instead of front to back, to
+  // compare the "overdraw" counter.
+  // --no-hud-cache: shade every HUD tile every frame instead of keeping the
+  // instrument panels in an offscreen layer redrawn when their values change.
+  // --target-gpu-ms <ms>: GPU frame time the scene's render scale is moved to
+  // hold (default 15, 0 = fixed); --render-scale <0.25..1>: the starting or
+  // fixed scale; --sharpen <0..1>: strength of the upscale's sharpening.
+  auto terrainSource = luna::scene::TerrainSource::CpuMeshes;
+  const char *qualityArg = nullptr;
+  VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+  bool presentModeSet = false;
+  FramePacer::Settings pacing;
+  const char *tracePath = nullptr;
+  const char *lodStatsPath = nullptr;
+  const char *recordPath = nullptr;
+  const char *replayPath = nullptr;
+  double replayStep = 0.0;
+  bool depthSort = true;
+  bool hudCache = true;
+  luna::core::ResolutionController::Settings resolutionSettings;
+  float sharpness = 0.3f;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--gpu-terrain") == 0)
+      terrainSource = luna::scene::TerrainSource::GpuDisplacement;
+    else if (std::strcmp(argv[i], "--gpu-patches") == 0)
+      terrainSource = luna::scene::TerrainSource::GpuCompute;
+    else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+      tracePath = argv[++i];
+    else if (std::strcmp(argv[i], "--lod-stats") == 0 && i + 1 < argc)
+      lodStatsPath = argv[++i];
+    else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+      recordPath = argv[++i];
+    else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+      replayPath = argv[++i];
+    else if (std::strcmp(argv[i], "--replay-step") == 0 && i + 1 < argc)
+      replayStep = std::max(0.0, std::atof(argv[++i]));
+    else if (std::strcmp(argv[i], "--quality") == 0 && i + 1 < argc)
+      qualityArg = argv[++i];
+    else if (std::strcmp(argv[i], "--present") == 0 && i + 1 < argc) {
+      presentModeSet = parsePresentMode(argv[++i], presentMode);
+      if (!presentModeSet)
+        LOG_WARN("Unknown present mode %s", argv[i]);
+    } else if (std::strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+      pacing.framesInFlight = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+    else if (std::strcmp(argv[i], "--fps-limit") == 0 && i + 1 < argc)
+      pacing.fpsLimit = std::max(0.0, std::atof(argv[++i]));
+    else if (std::strcmp(argv[i], "--low-latency") == 0)
+      pacing.lowLatency = true;
+    else if (std::strcmp(argv[i], "--no-present-wait") == 0)
+      pacing.presentWait = false;
+    else if (std::strcmp(argv[i], "--no-depth-sort") == 0)
+      depthSort = false;
+    else if (std::strcmp(argv[i], "--no-hud-cache") == 0)
+      hudCache = false;
+    else if (std::strcmp(argv[i], "--target-gpu-ms") == 0 && i + 1 < argc)
+      resolutionSettings.targetGpuMs = std::max(0.0, std::atof(argv[++i]));
+    else if (std::strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc)
+      resolutionSettings.scale = std::clamp(std::atof(argv[++i]), 0.25, 1.0);
+    else if (std::strcmp(argv[i], "--sharpen") == 0 && i + 1 < argc)
+      sharpness = std::clamp(static_cast<float>(std::atof(argv[++i])), 0.0f, 1.0f);
+  }
+
+  luna::scene::TerrainQuality quality;
+  const char *qualityPath = qualityArg ? qualityArg : "assets/quality.txt";
+  if (qualityArg && luna::scene::qualityPreset(qualityArg, quality))
+    LOG_INFO("Terrain quality preset %s", qualityArg);
+  else if (luna::scene::loadQualityConfig(qualityPath, quality))
+    LOG_INFO("Terrain quality from %s", qualityPath);
+  else if (qualityArg)
+    LOG_WARN("Unknown terrain quality preset or file %s — using medium", qualityArg);
+
+  luna::sim::FlightRecording recording;
+  bool replaying = false;
+  if (replayPath) {
+    replaying = recording.load(replayPath);
+    if (replaying)
+      LOG_INFO("Replaying %s: %zu frames, %.1f s", replayPath,
+               recording.size(), recording.duration());
+    else
+      LOG_WARN("Could not load flight recording %s", replayPath);
+  }
+  size_t replayFrames =
+      replayStep > 0.0 ? static_cast<size_t>(recording.duration() / replayStep) + 1
+                       : recording.size();
+
+  auto &profiler = luna::util::Profiler::instance();
+  profiler.nameThread("render");
+
+  // Prefer a converted high-resolution tiled map (tools/TileHeightmap.cpp)
+  const char *tiledTerrain = "assets/terrain/sldem2015_512.lht";
+  luna::sim::initTerrain(std::filesystem::exists(tiledTerrain)
+                             ? tiledTerrain
+                             : "assets/terrain/ldem_16.tif");
+  // Optional regional high-resolution overlays, streamed in near the lander
+  luna::sim::loadTerrainRegions("assets/terrain/regions.txt");
 
   VulkanContext ctx;
   glfwSetFramebufferSizeCallback(ctx.window(), framebufferResizeCallback);
 
-  Swapchain swapchain(ctx);
+  // A replay measures the frame, not the display's refresh
+  if (replaying && !presentModeSet)
+    presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+  Swapchain swapchain(ctx, presentMode);
   RenderPass renderPass(ctx, swapchain);
+  // World geometry is drawn offscreen at the render scale and upscaled into the
+  // swapchain pass, where the HUD is drawn at native resolution
+  SceneTarget sceneTarget(ctx, swapchain.imageFormat(), swapchain.extent());
+  luna::core::ResolutionController resolution(resolutionSettings);
   CommandPool commandPool(ctx, MAX_FRAMES_IN_FLIGHT);
+  // Render pass contents are recorded as secondary buffers, as Frame jobs
+  ParallelRecorder recorder(ctx, SLICE_COUNT);
+  luna::util::JobSystem& jobs = luna::util::JobSystem::instance();
   Sync sync(ctx, swapchain.imageCount());
+  GpuTimer gpuTimer(ctx);
+  FramePacer pacer(ctx, sync, pacing);
 
   luna::input::InputManager input(ctx.window());
   luna::camera::Camera camera;
@@ -76,31 +258,11 @@ int main() {
   // Face orbital velocity direction (+X) with slight pitch toward the Moon
   camera.setRotation(glm::radians(10.0), glm::radians(-90.0));
 
-  // Terrain pipeline
-  auto terrainPipeline =
-      Pipeline::Builder(ctx, renderPass.handle())
-          .setShaders("shaders/terrain.vert.spv", "shaders/terrain.frag.spv")
-          .setVertexBinding(sizeof(luna::scene::ChunkVertex),
-                            {
-                                {0, 0, VK_FORMAT_R32G32B32_SFLOAT,
-                                 static_cast<uint32_t>(offsetof(
-                                     luna::scene::ChunkVertex, position))},
-                                {1, 0, VK_FORMAT_R32G32B32_SFLOAT,
-                                 static_cast<uint32_t>(offsetof(
-                                     luna::scene::ChunkVertex, normal))},
-                                {2, 0, VK_FORMAT_R32_SFLOAT,
-                                 static_cast<uint32_t>(offsetof(
-                                     luna::scene::ChunkVertex, height))},
-                            })
-          .setCullMode(VK_CULL_MODE_NONE)
-          .enableDepthTest()
-          .setPushConstantSize(sizeof(TerrainPushConstants))
-          .build();
-
-  // Starfield pipeline (points, depth test on but no depth write, alpha
-  // blending)
+  // Starfield pipeline (points at the far plane, drawn after the terrain and
+  // only where the depth buffer still holds the clear value, no depth write,
+  // alpha blending)
   auto starfieldPipeline =
-      Pipeline::Builder(ctx, renderPass.handle())
+      Pipeline::Builder(ctx, sceneTarget.renderPass())
           .setShaders("shaders/starfield.vert.spv",
                       "shaders/starfield.frag.spv")
           .setVertexBinding(sizeof(luna::scene::StarVertex),
@@ -113,36 +275,194 @@ int main() {
                                      luna::scene::StarVertex, brightness))},
                             })
           .setTopology(VK_PRIMITIVE_TOPOLOGY_POINT_LIST)
-          .enableDepthTest()
+          .enableDepthTest(VK_COMPARE_OP_EQUAL)
           .setDepthWrite(false)
           .enableAlphaBlending()
           .setPushConstantSize(sizeof(StarfieldPushConstants))
           .build();
 
-  // HUD pipeline (screen-space overlay, no depth test, alpha blending)
+  // HUD pipeline (screen-space tiles, no depth test, alpha blending)
+  const std::vector<VkVertexInputAttributeDescription> hudAttributes = {
+      {0, 0, VK_FORMAT_R32G32_SFLOAT,
+       static_cast<uint32_t>(offsetof(luna::hud::HudVertex, position))},
+      {1, 0, VK_FORMAT_R32G32_SFLOAT,
+       static_cast<uint32_t>(offsetof(luna::hud::HudVertex, uv))},
+      {2, 0, VK_FORMAT_R32_SFLOAT,
+       static_cast<uint32_t>(offsetof(luna::hud::HudVertex, instrumentId))},
+  };
   auto hudPipeline =
       Pipeline::Builder(ctx, renderPass.handle())
           .setShaders("shaders/hud.vert.spv", "shaders/hud.frag.spv")
+          .setVertexBinding(sizeof(luna::hud::HudVertex), hudAttributes)
+          .setCullMode(VK_CULL_MODE_NONE)
+          .enableAlphaBlending()
+          .setPushConstantSize(sizeof(luna::hud::HudPushConstants))
+          .build();
+
+  // HUD layer cache: the same tiles accumulated into an offscreen image, and
+  // the premultiplied composite of that image over the frame
+  std::optional<luna::hud::HudLayerCache> hudLayers;
+  std::optional<Pipeline> hudLayerPipeline;
+  std::optional<Pipeline> hudCompositePipeline;
+  if (hudCache) {
+    hudLayers.emplace(ctx, swapchain.imageFormat(), swapchain.extent());
+    hudLayerPipeline.emplace(
+        Pipeline::Builder(ctx, hudLayers->renderPass())
+            .setShaders("shaders/hud.vert.spv", "shaders/hud.frag.spv")
+            .setVertexBinding(sizeof(luna::hud::HudVertex), hudAttributes)
+            .setCullMode(VK_CULL_MODE_NONE)
+            .setBlendMode(luna::core::BlendMode::Accumulate)
+            .setPushConstantSize(sizeof(luna::hud::HudPushConstants))
+            .build());
+    hudCompositePipeline.emplace(
+        Pipeline::Builder(ctx, renderPass.handle())
+            .setShaders("shaders/hud_layers.vert.spv",
+                        "shaders/hud_layers.frag.spv")
+            .setVertexBinding(sizeof(luna::hud::HudVertex), {hudAttributes[0]})
+            .setCullMode(VK_CULL_MODE_NONE)
+            .setBlendMode(luna::core::BlendMode::Premultiplied)
+            .addDescriptorSetLayout(hudLayers->setLayout())
+            .build());
+  }
+
+  // Upscale of the scene into the swapchain image (one triangle from the
+  // vertex index, bilinear filter with an optional sharpen, opaque)
+  auto upscalePipeline =
+      Pipeline::Builder(ctx, renderPass.handle())
+          .setShaders("shaders/upscale.vert.spv", "shaders/upscale.frag.spv")
+          .setCullMode(VK_CULL_MODE_NONE)
+          .setPushConstantSize(sizeof(luna::core::UpscalePushConstants))
+          .addDescriptorSetLayout(sceneTarget.setLayout())
+          .build();
+
+  // Predicted trajectory (camera-relative line strip; depth tested so the Moon
+  // hides the far side, no depth write, alpha blending)
+  auto trajectoryPipeline =
+      Pipeline::Builder(ctx, sceneTarget.renderPass())
+          .setShaders("shaders/trajectory.vert.spv",
+                      "shaders/trajectory.frag.spv")
           .setVertexBinding(
-              sizeof(luna::hud::HudVertex),
+              sizeof(luna::hud::TrajectoryVertex),
               {
-                  {0, 0, VK_FORMAT_R32G32_SFLOAT,
+                  {0, 0, VK_FORMAT_R32G32B32_SFLOAT,
                    static_cast<uint32_t>(
-                       offsetof(luna::hud::HudVertex, position))},
-                  {1, 0, VK_FORMAT_R32G32_SFLOAT,
-                   static_cast<uint32_t>(offsetof(luna::hud::HudVertex, uv))},
-                  {2, 0, VK_FORMAT_R32_SFLOAT,
+                       offsetof(luna::hud::TrajectoryVertex, position))},
+                  {1, 0, VK_FORMAT_R32_SFLOAT,
                    static_cast<uint32_t>(
-                       offsetof(luna::hud::HudVertex, instrumentId))},
+                       offsetof(luna::hud::TrajectoryVertex, progress))},
               })
+          .setTopology(VK_PRIMITIVE_TOPOLOGY_LINE_STRIP)
           .setCullMode(VK_CULL_MODE_NONE)
+          .enableDepthTest()
+          .setDepthWrite(false)
           .enableAlphaBlending()
-          .setPushConstantSize(sizeof(luna::hud::HudPushConstants))
+          .setPushConstantSize(sizeof(luna::hud::TrajectoryPushConstants))
           .build();
 
   luna::hud::Hud hud(ctx, commandPool);
   luna::scene::Starfield starfield(ctx, commandPool);
-  luna::scene::CubesphereBody moon(ctx, commandPool, luna::util::LUNAR_RADIUS);
+  UploadManager uploader(ctx);
+  // Shallow patches come from a precomputed file, rebuilt when the terrain changes
+  luna::scene::CubesphereBody moon(
+      ctx, uploader, luna::util::LUNAR_RADIUS, "cache/terrain_patches.lpc",
+      luna::scene::CubesphereBody::DISK_CACHE_DEPTH, terrainSource, quality);
+  // Coarsens or refines the terrain to hold target_frame_ms, if the settings set one
+  luna::scene::QualityController qualityController(moon.quality());
+  moon.setDepthSort(depthSort);
+
+  // Terrain pipeline: frame constants and per-patch records come from the
+  // body's frame set, so there are no push constants
+  auto terrainPipeline =
+      Pipeline::Builder(ctx, sceneTarget.renderPass())
+          .setShaders("shaders/terrain.vert.spv", "shaders/terrain.frag.spv")
+          .setVertexBinding(sizeof(luna::scene::ChunkVertex),
+                            {
+                                {0, 0, VK_FORMAT_R16G16B16A16_UNORM,
+                                 static_cast<uint32_t>(offsetof(
+                                     luna::scene::ChunkVertex, position))},
+                                {1, 0, VK_FORMAT_R16G16_SNORM,
+                                 static_cast<uint32_t>(offsetof(
+                                     luna::scene::ChunkVertex, normal))},
+                                {2, 0, VK_FORMAT_R16G16B16A16_UNORM,
+                                 static_cast<uint32_t>(offsetof(
+                                     luna::scene::ChunkVertex, morph))},
+                            })
+          .setCullMode(VK_CULL_MODE_NONE)
+          .enableDepthTest()
+          .addDescriptorSetLayout(moon.frameSetLayout())
+          .build();
+
+  // GPU-displaced terrain pipeline: the vertex shader reads the heightmap image
+  // at set 1; same fragment shader as the mesh path
+  std::optional<Pipeline> terrainDisplacedPipeline;
+  if (moon.usesGpuDisplacement()) {
+    terrainDisplacedPipeline.emplace(
+        Pipeline::Builder(ctx, sceneTarget.renderPass())
+            .setShaders("shaders/terrain_displaced.vert.spv",
+                        "shaders/terrain.frag.spv")
+            .setVertexBinding(sizeof(luna::scene::DisplacedGridVertex),
+                              {
+                                  {0, 0, VK_FORMAT_R32G32_SFLOAT,
+                                   static_cast<uint32_t>(offsetof(
+                                       luna::scene::DisplacedGridVertex, grid))},
+                              })
+            .setCullMode(VK_CULL_MODE_NONE)
+            .enableDepthTest()
+            .setPushConstantSize(
+                luna::scene::CubesphereBody::displacementPushConstantSize())
+            .addDescriptorSetLayout(moon.frameSetLayout())
+            .addDescriptorSetLayout(moon.displacementSetLayout())
+            .build());
+  }
+
+  // GPU-driven terrain pipeline: same vertex layout and fragment shader, but the
+  // patch records are the culler's SSBO bound at set 1
+  std::optional<Pipeline> terrainIndirectPipeline;
+  if (moon.supportsGpuDriven()) {
+    terrainIndirectPipeline.emplace(
+        Pipeline::Builder(ctx, sceneTarget.renderPass())
+            .setShaders("shaders/terrain_indirect.vert.spv",
+                        "shaders/terrain.frag.spv")
+            .setVertexBinding(sizeof(luna::scene::ChunkVertex),
+                              {
+                                  {0, 0, VK_FORMAT_R16G16B16A16_UNORM,
+                                   static_cast<uint32_t>(offsetof(
+                                       luna::scene::ChunkVertex, position))},
+                                  {1, 0, VK_FORMAT_R16G16_SNORM,
+                                   static_cast<uint32_t>(offsetof(
+                                       luna::scene::ChunkVertex, normal))},
+                                  {2, 0, VK_FORMAT_R16G16B16A16_UNORM,
+                                   static_cast<uint32_t>(offsetof(
+                                       luna::scene::ChunkVertex, morph))},
+                              })
+            .setCullMode(VK_CULL_MODE_NONE)
+            .enableDepthTest()
+            .addDescriptorSetLayout(moon.frameSetLayout())
+            .addDescriptorSetLayout(moon.gpuDrawSetLayout())
+            .build());
+  }
+  bool gpuDrivenTerrain = false;
+  bool showProfile = false;
+
+  luna::sim::FlightRecorder flightRecorder;
+  if (recordPath && !replaying) {
+    if (flightRecorder.open(recordPath))
+      LOG_INFO("Recording flight to %s", recordPath);
+    else
+      LOG_WARN("Could not create flight recording %s", recordPath);
+  }
+  double recordDt = 0.0;
+
+  // Replay progress and what it measured
+  size_t replayIndex = 0;
+  double replayTime = 0.0;
+  double replayFrameStart = -1.0;
+  std::vector<double> replayFrameMs;
+  ReplayTotals replayTotals;
+
+  luna::scene::LodStatsWriter lodStatsLog;
+  if (lodStatsPath && !lodStatsLog.open(lodStatsPath))
+    LOG_WARN("Could not open LOD statistics file %s", lodStatsPath);
 
   // Starship HLS starts in 100km circular orbit (post-transfer from NRHO)
   luna::sim::SimState simState;
@@ -151,11 +471,27 @@ int main() {
   simState.position = glm::dvec3(0.0, -orbitR, 0.0);
   simState.velocity = glm::dvec3(orbitV, 0.0, 0.0);
 
+  // Physics steps at a fixed rate on its own thread; the render loop sends the
+  // pilot's controls and draws an interpolated state
   luna::sim::Physics physics;
-  physics.setTerrainQuery(luna::sim::sampleTerrainHeight);
+  physics.setTerrainQuery(luna::sim::sampleTerrainHeight, luna::sim::terrainGeneration);
+  luna::sim::PhysicsThread physicsThread(std::move(physics), simState);
+  luna::sim::SimControls controls;
+
+  // Forward prediction of the lander's path, drawn under the HUD
+  luna::sim::TrajectoryPredictor predictor(luna::sim::sampleTerrainHeight);
 
   bool attachedToLander = true;
 
+  // Camera motion per wall second, for LOD prefetch along the ground track
+  glm::dvec3 lastCameraPos = camera.position();
+  glm::dvec3 cameraVelocity(0.0);
+
+  // Where the camera will be over the terrain prefetch horizon, nearest first:
+  // on the predicted trajectory when attached, straight ahead otherwise
+  constexpr int PREFETCH_POINTS = 10;
+  std::vector<glm::dvec3> prefetchPath;
+
   // Sun direction (hardcoded: from upper-right in world space)
   glm::vec3 sunDir3 = glm::normalize(glm::vec3(0.5f, 0.8f, 0.3f));
   glm::vec4 sunDir(sunDir3, 0.0f);
@@ -163,8 +499,52 @@ int main() {
   uint32_t currentFrame = 0;
   uint32_t currentSemaphore = 0;
   double lastTime = glfwGetTime();
+  uint64_t lastUploadBytes = 0;
+
+  // Wait for a frame's GPU work in steps so we stay responsive: between steps
+  // window events are handled, and a close request abandons the wait (false)
+  constexpr uint64_t FENCE_TIMEOUT =
+      100'000'000; // 100ms — keeps loop responsive to close events
+  auto waitForFrame = [&](uint32_t frame) {
+    VkFence fence = sync.inFlight(frame);
+    PROFILE_SCOPE("wait fence");
+    while (vkWaitForFences(ctx.device(), 1, &fence, VK_TRUE, FENCE_TIMEOUT) ==
+           VK_TIMEOUT) {
+      glfwPollEvents();
+      if (glfwWindowShouldClose(ctx.window()))
+        return false;
+    }
+    pacer.frameRetired(frame);
+    return true;
+  };
 
   while (!glfwWindowShouldClose(ctx.window())) {
+    uint64_t profilerFrame = profiler.beginFrame();
+    // The frame that ran the last LOD update has just closed
+    if (lodStatsLog.isOpen() || qualityController.enabled()) {
+      luna::util::FrameProfile last = profiler.lastFrame();
+      double frameMs = last.duration * 1000.0;
+      if (lodStatsLog.isOpen())
+        lodStatsLog.write(moon.stats(), frameMs);
+      // Its cost is whichever of the CPU and GPU was busier; time blocked on the
+      // fence, the swapchain or the pacer is the other one, vsync or the limiter
+      double cpuMs = frameMs - last.eventMs("wait fence") - last.eventMs("acquire") -
+                     last.eventMs("frame limiter") - last.eventMs("present wait");
+      if (qualityController.update(std::max(cpuMs, gpuTimer.lastFrameMs())))
+        moon.setSplitThreshold(qualityController.splitThreshold());
+    }
+    // The render scale answers to GPU time alone: a CPU-bound frame gains
+    // nothing from fewer pixels
+    if (resolution.enabled())
+      resolution.update(gpuTimer.lastFrameMs());
+    const VkExtent2D renderExtent = resolution.renderExtent(swapchain.extent());
+
+    // Pacing happens before input is sampled, so what the frame shows is as
+    // fresh as the wait allows. Low latency also waits out this slot's last
+    // frame here rather than after the simulation step.
+    pacer.beginFrame(swapchain.handle());
+    if (pacer.lowLatency() && !waitForFrame(currentFrame))
+      break;
     glfwPollEvents();
 
     // Exit immediately after processing close event — before any blocking
@@ -177,71 +557,133 @@ int main() {
     double now = glfwGetTime();
     double dt = now - lastTime;
     lastTime = now;
+    recordDt += dt;
 
-    // Cursor capture: right-click to capture, ESC to release
-    if (input.isKeyPressed(GLFW_KEY_ESCAPE))
-      input.setCursorCaptured(false);
-    if (glfwGetMouseButton(ctx.window(), GLFW_MOUSE_BUTTON_RIGHT) ==
-            GLFW_PRESS &&
-        !input.isCursorCaptured())
-      input.setCursorCaptured(true);
-
-    // Toggle camera mode: P key
-    if (input.isKeyPressed(GLFW_KEY_P))
-      attachedToLander = !attachedToLander;
-
-    // Lander throttle: Z to increase, X to decrease
-    if (input.isKeyDown(GLFW_KEY_Z))
-      simState.throttle = glm::min(simState.throttle + 0.5 * dt, 1.0);
-    if (input.isKeyDown(GLFW_KEY_X))
-      simState.throttle = glm::max(simState.throttle - 0.5 * dt, 0.0);
-
-    // Lander rotation torque (body frame): IJKL for pitch/yaw, UO for roll
-    simState.torqueInput = glm::dvec3(0.0);
-    double torqueRate = 0.5;
-    if (input.isKeyDown(GLFW_KEY_I))
-      simState.torqueInput.x += torqueRate;
-    if (input.isKeyDown(GLFW_KEY_K))
-      simState.torqueInput.x -= torqueRate;
-    if (input.isKeyDown(GLFW_KEY_J))
-      simState.torqueInput.y += torqueRate;
-    if (input.isKeyDown(GLFW_KEY_L))
-      simState.torqueInput.y -= torqueRate;
-    if (input.isKeyDown(GLFW_KEY_U))
-      simState.torqueInput.z += torqueRate;
-    if (input.isKeyDown(GLFW_KEY_O))
-      simState.torqueInput.z -= torqueRate;
-
-    // Step physics
-    physics.step(simState, dt);
-
-    // Camera follows lander when attached
-    if (attachedToLander) {
-      camera.setPosition(simState.position);
+    if (replaying) {
+      // Replay: the recording drives state, camera and mode; the clock is the
+      // recording's, not the wall's
+      if (replayIndex >= replayFrames)
+        break;
+      if (replayFrameStart < 0.0)
+        replayFrameStart = now;
+      replayTime = replayStep > 0.0 ? replayIndex * replayStep
+                                    : recording.timeAt(replayIndex);
+      luna::sim::FlightFrame frame = replayStep > 0.0
+                                         ? recording.sample(replayTime)
+                                         : recording[replayIndex];
+      dt = replayStep > 0.0 ? replayStep : replayIndex > 0 ? frame.wallDt : 0.0;
+      glm::dvec3 replayCameraPos;
+      glm::dquat replayCameraOrientation;
+      luna::sim::applyFrame(frame, simState, controls, replayCameraPos,
+                            replayCameraOrientation);
+      camera.setPosition(replayCameraPos);
+      camera.setOrientation(replayCameraOrientation);
+      attachedToLander = frame.flags & luna::sim::FlightFrame::FLAG_ATTACHED;
+      gpuDrivenTerrain =
+          (frame.flags & luna::sim::FlightFrame::FLAG_GPU_DRIVEN) &&
+          moon.supportsGpuDriven();
+      predictor.update(simState);
+      luna::sim::setTerrainFocus(simState.position);
+    } else {
+      // Cursor capture: right-click to capture, ESC to release
+      if (input.isKeyPressed(GLFW_KEY_ESCAPE))
+        input.setCursorCaptured(false);
+      if (glfwGetMouseButton(ctx.window(), GLFW_MOUSE_BUTTON_RIGHT) ==
+              GLFW_PRESS &&
+          !input.isCursorCaptured())
+        input.setCursorCaptured(true);
+
+      // Toggle camera mode: P key
+      if (input.isKeyPressed(GLFW_KEY_P))
+        attachedToLander = !attachedToLander;
+
+      // Toggle GPU-driven terrain culling: G key
+      if (input.isKeyPressed(GLFW_KEY_G) && moon.supportsGpuDriven()) {
+        gpuDrivenTerrain = !gpuDrivenTerrain;
+        LOG_INFO("Terrain drawing: %s", gpuDrivenTerrain ? "GPU-driven" : "CPU");
+      }
+
+      // Toggle the profiler panel: F3 key
+      if (input.isKeyPressed(GLFW_KEY_F3))
+        showProfile = !showProfile;
+
+      // Time warp: period to speed up tenfold, comma to slow down
+      if (input.isKeyPressed(GLFW_KEY_PERIOD) &&
+          controls.timeWarp < luna::sim::PhysicsThread::MAX_WARP) {
+        controls.timeWarp *= 10.0;
+        LOG_INFO("Time warp: %.0fx", controls.timeWarp);
+      }
+      if (input.isKeyPressed(GLFW_KEY_COMMA) && controls.timeWarp > 1.0) {
+        controls.timeWarp /= 10.0;
+        LOG_INFO("Time warp: %.0fx", controls.timeWarp);
+      }
+
+      // Lander throttle: Z to increase, X to decrease
+      if (input.isKeyDown(GLFW_KEY_Z))
+        controls.throttle = glm::min(controls.throttle + 0.5 * dt, 1.0);
+      if (input.isKeyDown(GLFW_KEY_X))
+        controls.throttle = glm::max(controls.throttle - 0.5 * dt, 0.0);
+
+      // Lander rotation torque (body frame): IJKL for pitch/yaw, UO for roll
+      controls.torqueInput = glm::dvec3(0.0);
+      double torqueRate = 0.5;
+      if (input.isKeyDown(GLFW_KEY_I))
+        controls.torqueInput.x += torqueRate;
+      if (input.isKeyDown(GLFW_KEY_K))
+        controls.torqueInput.x -= torqueRate;
+      if (input.isKeyDown(GLFW_KEY_J))
+        controls.torqueInput.y += torqueRate;
+      if (input.isKeyDown(GLFW_KEY_L))
+        controls.torqueInput.y -= torqueRate;
+      if (input.isKeyDown(GLFW_KEY_U))
+        controls.torqueInput.z += torqueRate;
+      if (input.isKeyDown(GLFW_KEY_O))
+        controls.torqueInput.z -= torqueRate;
+
+      // Hand the controls to the physics thread and take the state to display
+      physicsThread.setControls(controls);
+      simState = physicsThread.sample();
+      predictor.update(simState);
+      luna::sim::setTerrainFocus(simState.position);
+
+      // Camera follows lander when attached
+      if (attachedToLander) {
+        camera.setPosition(simState.position);
+      }
     }
 
     camera.setAspect(static_cast<double>(swapchain.extent().width) /
                      static_cast<double>(swapchain.extent().height));
-    cameraController.update(camera, input, dt);
-
-    // Wait for previous frame's GPU work with timeout so we stay responsive
+    if (!replaying)
+      cameraController.update(camera, input, dt);
+    if (dt > 0.0)
+      cameraVelocity = (camera.position() - lastCameraPos) / dt;
+    lastCameraPos = camera.position();
+
+    // This slot's previous frame must be done before its buffers are reused.
+    // Waiting here, not retrying the whole frame, keeps a slow GPU from
+    // spinning the loop through input and simulation.
     VkFence fence = sync.inFlight(currentFrame);
-    constexpr uint64_t FENCE_TIMEOUT =
-        100'000'000; // 100ms — keeps loop responsive to close events
-    VkResult fenceResult =
-        vkWaitForFences(ctx.device(), 1, &fence, VK_TRUE, FENCE_TIMEOUT);
-    if (fenceResult == VK_TIMEOUT)
-      continue; // retry next iteration
+    if (!pacer.lowLatency() && !waitForFrame(currentFrame))
+      break;
 
     uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(
-        ctx.device(), swapchain.handle(), FENCE_TIMEOUT,
-        sync.imageAvailable(currentSemaphore), VK_NULL_HANDLE, &imageIndex);
+    VkResult result;
+    {
+      PROFILE_SCOPE("acquire");
+      result = vkAcquireNextImageKHR(
+          ctx.device(), swapchain.handle(), FENCE_TIMEOUT,
+          sync.imageAvailable(currentSemaphore), VK_NULL_HANDLE, &imageIndex);
+    }
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
       if (!swapchain.recreate())
         break;
       renderPass.recreateFramebuffers(swapchain);
+      sceneTarget.resize(swapchain.extent());
+      if (hudLayers)
+        hudLayers->resize(swapchain.extent());
       sync.recreateSemaphores(swapchain.imageCount());
+      pacer.resetSwapchain();
       currentSemaphore = 0;
       continue;
     }
@@ -250,71 +692,206 @@ int main() {
 
     vkResetFences(ctx.device(), 1, &fence);
 
+    // This frame will be drawn: log it with the wall time since the last one
+    if (flightRecorder.isOpen()) {
+      uint8_t flags = 0;
+      if (attachedToLander)
+        flags |= luna::sim::FlightFrame::FLAG_ATTACHED;
+      if (gpuDrivenTerrain)
+        flags |= luna::sim::FlightFrame::FLAG_GPU_DRIVEN;
+      flightRecorder.append(luna::sim::captureFrame(recordDt, simState, controls,
+                                                    camera.position(),
+                                                    camera.orientation(), flags));
+      recordDt = 0.0;
+    }
+
     VkCommandBuffer cmd = commandPool.buffer(currentFrame);
     vkResetCommandBuffer(cmd, 0);
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     vkBeginCommandBuffer(cmd, &beginInfo);
-
-    std::array<VkClearValue, 2> clearValues{};
-    clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
-    clearValues[1].depthStencil = {0.0f, 0};
-
-    VkRenderPassBeginInfo rpBegin{};
-    rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    rpBegin.renderPass = renderPass.handle();
-    rpBegin.framebuffer = renderPass.framebuffer(imageIndex);
-    rpBegin.renderArea.offset = {0, 0};
-    rpBegin.renderArea.extent = swapchain.extent();
-    rpBegin.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    rpBegin.pClearValues = clearValues.data();
-
-    vkCmdBeginRenderPass(cmd, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
-
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(swapchain.extent().width);
-    viewport.height = static_cast<float>(swapchain.extent().height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(cmd, 0, 1, &viewport);
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = swapchain.extent();
-    vkCmdSetScissor(cmd, 0, 1, &scissor);
+    // This frame's fence has signalled, so its timestamps from last time are in
+    gpuTimer.beginFrame(cmd, currentFrame, profilerFrame);
 
     // Camera-relative rendering: rotation-only VP + per-chunk offset
     glm::dmat4 viewRot = camera.getRotationOnlyViewMatrix();
     glm::dmat4 proj = camera.getProjectionMatrix();
     glm::mat4 vp = glm::mat4(proj * viewRot);
 
-    // Draw starfield first (behind everything, no depth write)
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      starfieldPipeline.handle());
-    starfield.draw(cmd, starfieldPipeline.layout(), vp);
+    // Terrain prefetch path over the next few wall seconds, at the achieved
+    // warp. A replay knows where the camera goes, and reading it from the
+    // recording keeps the prefetch independent of the predictor thread.
+    prefetchPath.clear();
+    const luna::sim::Trajectory &trajectory = predictor.latest();
+    for (int i = 1; i <= PREFETCH_POINTS; i++) {
+      double ahead =
+          luna::scene::CubesphereBody::PREFETCH_HORIZON * i / PREFETCH_POINTS;
+      glm::dvec3 point = camera.position() + cameraVelocity * ahead;
+      if (replaying) {
+        const luna::sim::FlightFrame future = recording.sample(replayTime + ahead);
+        point = glm::dvec3(future.cameraPosition[0], future.cameraPosition[1],
+                           future.cameraPosition[2]);
+      } else if (attachedToLander) {
+        trajectory.positionAt(simState.missionTime +
+                                  ahead * physicsThread.achievedWarp(),
+                              point);
+      }
+      prefetchPath.push_back(point);
+    }
 
     // Update LOD before drawing — frustum-aware so budget goes to visible
     // patches
     moon.update(camera.position(), camera.fovY(),
-                static_cast<double>(swapchain.extent().height), vp);
-
-    // Draw Moon (cubesphere handles per-chunk push constants internally)
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      terrainPipeline.handle());
-    moon.draw(cmd, terrainPipeline.layout(), vp, camera.position(), sunDir);
-
-    // Draw HUD overlay (screen-space, after all world geometry)
+                static_cast<double>(renderExtent.height), vp,
+                cameraVelocity, prefetchPath);
+    if (replaying)
+      replayTotals.add(moon.stats());
+
+    // Compute passes must be recorded before the render pass begins: patch
+    // generation first, so the cull and the draws see this frame's patches
+    uint32_t computeScope = gpuTimer.scope("terrain compute");
+    gpuTimer.begin(cmd, computeScope);
+    moon.recordPatchGeneration(cmd, currentFrame);
+    if (gpuDrivenTerrain)
+      moon.recordGpuCull(cmd, currentFrame, vp, camera.position());
+    gpuTimer.end(cmd, computeScope);
+
+    // Each slice is recorded into its own secondary buffer. The scene pass at
+    // the render scale: the Moon first, one cube face per slice with patches
+    // front to back, then the starfield (far plane only, so sky hidden by
+    // terrain is never shaded) and the trajectory. The swapchain pass at native
+    // resolution: the upscaled scene, then the HUD overlay.
+    RenderPassInheritance scenePass{};
+    scenePass.renderPass = sceneTarget.renderPass();
+    scenePass.framebuffer = sceneTarget.framebuffer();
+    scenePass.viewport.width = static_cast<float>(renderExtent.width);
+    scenePass.viewport.height = static_cast<float>(renderExtent.height);
+    scenePass.viewport.maxDepth = 1.0f;
+    scenePass.scissor.extent = renderExtent;
+    scenePass.pipelineStatistics = gpuTimer.statisticsFlags();
+
+    RenderPassInheritance hudPass{};
+    hudPass.renderPass = renderPass.handle();
+    hudPass.framebuffer = renderPass.framebuffer(imageIndex);
+    hudPass.viewport.width = static_cast<float>(swapchain.extent().width);
+    hudPass.viewport.height = static_cast<float>(swapchain.extent().height);
+    hudPass.viewport.maxDepth = 1.0f;
+    hudPass.scissor.extent = swapchain.extent();
+
+    const Pipeline &moonPipeline =
+        gpuDrivenTerrain           ? *terrainIndirectPipeline
+        : terrainDisplacedPipeline ? *terrainDisplacedPipeline
+                                   : terrainPipeline;
     float aspect = static_cast<float>(swapchain.extent().width) /
                    static_cast<float>(swapchain.extent().height);
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      hudPipeline.handle());
-    hud.draw(cmd, hudPipeline.layout(), simState, aspect, vp);
 
+    hud.updateTrajectory(currentFrame, trajectory, camera.position());
+
+    // Profiler panel shows the last complete frame; GPU time trails by the
+    // frames in flight
+    luna::hud::HudProfile hudProfile;
+    if (showProfile) {
+      luna::util::FrameProfile last = profiler.lastFrame();
+      hudProfile.visible = true;
+      hudProfile.frameMs = last.duration * 1000.0;
+      hudProfile.gpuMs = gpuTimer.lastFrameMs();
+      hudProfile.lodUpdateMs = last.eventMs("lod update");
+      hudProfile.splits = last.counter("splits");
+      hudProfile.uploadBytes = last.counter("upload bytes");
+    }
+    hud.setProfile(hudProfile);
+    hud.update(simState, aspect, vp,
+               replaying ? controls.timeWarp : physicsThread.achievedWarp());
+
+    // Instrument panels whose readings changed are redrawn into the HUD layer
+    // cache before the render pass that composites it
+    if (hudLayers) {
+      uint32_t hudLayerScope = gpuTimer.scope("hud layers");
+      gpuTimer.begin(cmd, hudLayerScope);
+      uint32_t redrawn = hud.recordLayers(cmd, *hudLayers, *hudLayerPipeline);
+      gpuTimer.end(cmd, hudLayerScope);
+      profiler.counter("hud tiles redrawn", redrawn);
+    }
+
+    // Pass timestamps are written inside the slices: the primary buffer only
+    // executes them within the render passes. Terrain ends where the starfield
+    // begins.
+    uint32_t terrainScope = gpuTimer.scope("terrain");
+    uint32_t starfieldScope = gpuTimer.scope("starfield");
+    uint32_t upscaleScope = gpuTimer.scope("upscale");
+    uint32_t hudScope = gpuTimer.scope("hud");
+
+    double recordStart = profiler.now();
+    recorder.begin(currentFrame);
+    moon.prepareDraw(currentFrame, vp, camera.position(), sunDir);
+    jobs.parallelFor(SLICE_COUNT, [&](uint32_t slice) {
+      // GPU-driven terrain is a single indirect draw: one slice is enough
+      if (gpuDrivenTerrain && slice > TERRAIN_SLICE && slice < STARFIELD_SLICE)
+        return;
+      VkCommandBuffer sc = recorder.beginSlice(
+          currentFrame, slice, slice == HUD_SLICE ? hudPass : scenePass);
+      if (slice == STARFIELD_SLICE) {
+        gpuTimer.end(sc, terrainScope);
+        gpuTimer.begin(sc, starfieldScope);
+        vkCmdBindPipeline(sc, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          starfieldPipeline.handle());
+        starfield.draw(sc, starfieldPipeline.layout(), vp);
+        gpuTimer.end(sc, starfieldScope);
+        vkCmdBindPipeline(sc, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          trajectoryPipeline.handle());
+        hud.drawTrajectory(sc, trajectoryPipeline.layout(), currentFrame, vp);
+      } else if (slice == HUD_SLICE) {
+        gpuTimer.begin(sc, upscaleScope);
+        vkCmdBindPipeline(sc, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          upscalePipeline.handle());
+        sceneTarget.drawUpscale(sc, upscalePipeline.layout(), renderExtent,
+                                sharpness);
+        gpuTimer.end(sc, upscaleScope);
+        gpuTimer.begin(sc, hudScope);
+        if (hudLayers) {
+          vkCmdBindPipeline(sc, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            hudCompositePipeline->handle());
+          hud.drawLayers(sc, hudCompositePipeline->layout(), *hudLayers);
+        }
+        vkCmdBindPipeline(sc, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          hudPipeline.handle());
+        hud.draw(sc, hudPipeline.layout(), hudLayers.has_value());
+        gpuTimer.end(sc, hudScope);
+      } else {
+        if (slice == TERRAIN_SLICE)
+          gpuTimer.begin(sc, terrainScope);
+        vkCmdBindPipeline(sc, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          moonPipeline.handle());
+        if (gpuDrivenTerrain)
+          moon.drawGpuDriven(sc, moonPipeline.layout(), currentFrame);
+        else
+          moon.drawFace(sc, moonPipeline.layout(),
+                        moon.faceInDrawOrder(slice - TERRAIN_SLICE));
+      }
+      vkEndCommandBuffer(sc);
+    });
+
+    // Fragment statistics cover the scene pass, per rendered pixel
+    gpuTimer.beginFragmentCount(cmd);
+    sceneTarget.beginPass(cmd, renderExtent);
+    recorder.execute(cmd, currentFrame, TERRAIN_SLICE, SCENE_SLICES);
+    vkCmdEndRenderPass(cmd);
+    gpuTimer.endFragmentCount(cmd, renderExtent.width * renderExtent.height);
+
+    // The upscale writes every pixel, so the swapchain image is not cleared
+    VkRenderPassBeginInfo rpBegin{};
+    rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rpBegin.renderPass = renderPass.handle();
+    rpBegin.framebuffer = renderPass.framebuffer(imageIndex);
+    rpBegin.renderArea.offset = {0, 0};
+    rpBegin.renderArea.extent = swapchain.extent();
+    vkCmdBeginRenderPass(cmd, &rpBegin,
+                         VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    recorder.execute(cmd, currentFrame, HUD_SLICE, 1);
     vkCmdEndRenderPass(cmd);
     vkEndCommandBuffer(cmd);
+    profiler.record("record", recordStart, profiler.now() - recordStart);
 
     // Submit
     VkSemaphore waitSems[] = {sync.imageAvailable(currentSemaphore)};
@@ -332,6 +909,7 @@ int main() {
     submitInfo.signalSemaphoreCount = 1;
     submitInfo.pSignalSemaphores = signalSems;
 
+    PROFILE_SCOPE("submit and present");
     vkQueueSubmit(ctx.graphicsQueue(), 1, &submitInfo,
                   sync.inFlight(currentFrame));
 
@@ -343,6 +921,8 @@ int main() {
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = swapchains;
     presentInfo.pImageIndices = &imageIndex;
+    VkPresentIdKHR presentId;
+    pacer.preparePresent(presentInfo, presentId, currentFrame);
 
     result = vkQueuePresentKHR(ctx.presentQueue(), &presentInfo);
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR ||
@@ -351,11 +931,28 @@ int main() {
       if (!swapchain.recreate())
         break;
       renderPass.recreateFramebuffers(swapchain);
+      sceneTarget.resize(swapchain.extent());
+      if (hudLayers)
+        hudLayers->resize(swapchain.extent());
       sync.recreateSemaphores(swapchain.imageCount());
+      pacer.resetSwapchain();
       currentSemaphore = 0;
     }
 
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    profiler.counter("splits", moon.stats().splits);
+    profiler.counter("split threshold", moon.quality().splitThreshold);
+    profiler.counter("render scale", resolution.scale());
+    profiler.counter("upload bytes", static_cast<double>(
+                                         uploader.bytesSubmitted() - lastUploadBytes));
+    lastUploadBytes = uploader.bytesSubmitted();
+
+    if (replaying) {
+      replayFrameMs.push_back((glfwGetTime() - replayFrameStart) * 1000.0);
+      replayFrameStart = -1.0;
+      replayIndex++;
+    }
+
+    currentFrame = (currentFrame + 1) % pacer.framesInFlight();
     currentSemaphore = (currentSemaphore + 1) % sync.semaphoreCount();
   }
 
@@ -369,11 +966,26 @@ int main() {
   }
 
   vkDeviceWaitIdle(ctx.device());
+  gpuTimer.release();
+
+  flightRecorder.close();
+  if (replaying && !replayFrameMs.empty())
+    reportReplay(replayFrameMs, replayTotals, moon.stats());
+
+  if (tracePath) {
+    if (profiler.writeChromeTrace(tracePath))
+      LOG_INFO("Wrote frame trace to %s", tracePath);
+    else
+      LOG_WARN("Could not write frame trace to %s", tracePath);
+  }
 
   // Free cubesphere GPU resources in a flat traversal before the destructor
   // chain tears down the quadtree — avoids deep recursive Vulkan calls.
   moon.releaseGPU();
 
+  // The physics and prediction threads sample the terrain
+  physicsThread.stop();
+  predictor.stop();
   luna::sim::shutdownTerrain();
   LOG_INFO("Luna shutting down");
   return 0;
@@ -2,8 +2,11 @@
 
 #include "scene/ChunkGenerator.h"
 #include "sim/TerrainQuery.h"
+#include "util/LinearArena.h"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace luna::scene {
 
@@ -21,8 +24,128 @@ glm::dvec3 ChunkGenerator::facePointToSphere(int face, double u, double v) {
     return glm::normalize(p);
 }
 
+void ChunkGenerator::sphereToFacePoint(const glm::dvec3& dir, int& face, double& u, double& v) {
+    glm::dvec3 a = glm::abs(dir);
+    if (a.x >= a.y && a.x >= a.z) {
+        face = dir.x > 0.0 ? 0 : 1;
+        u = (face == 0 ? dir.y : -dir.y) / a.x;
+        v = dir.z / a.x;
+    } else if (a.y >= a.z) {
+        face = dir.y > 0.0 ? 2 : 3;
+        u = dir.x / a.y;
+        v = (face == 2 ? -dir.z : dir.z) / a.y;
+    } else {
+        face = dir.z > 0.0 ? 4 : 5;
+        u = (face == 4 ? dir.x : -dir.x) / a.z;
+        v = dir.y / a.z;
+    }
+}
+
+ChunkVertex packVertex(const glm::vec3& position, const glm::vec3& normal, float height,
+                       const glm::vec3& morphPosition, float morphHeight, float positionScale) {
+    auto unorm = [](float x) {  // [-1, 1] → [0, 65535]
+        return static_cast<uint16_t>(std::lround((std::clamp(x, -1.0f, 1.0f) * 0.5f + 0.5f) * 65535.0f));
+    };
+    auto snorm = [](float x) {
+        return static_cast<int16_t>(std::lround(std::clamp(x, -1.0f, 1.0f) * 32767.0f));
+    };
+
+    ChunkVertex v;
+    v.position[0] = unorm(position.x / positionScale);
+    v.position[1] = unorm(position.y / positionScale);
+    v.position[2] = unorm(position.z / positionScale);
+    v.position[3] = unorm(height / HEIGHT_RANGE);
+    v.morph[0] = unorm(morphPosition.x / positionScale);
+    v.morph[1] = unorm(morphPosition.y / positionScale);
+    v.morph[2] = unorm(morphPosition.z / positionScale);
+    v.morph[3] = unorm(morphHeight / HEIGHT_RANGE);
+
+    // Octahedral: project onto |x|+|y|+|z| = 1, fold the lower hemisphere over the diagonals
+    float l1 = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    float ox = normal.x / l1;
+    float oy = normal.y / l1;
+    if (normal.z < 0.0f) {
+        float fx = (1.0f - std::fabs(oy)) * (ox >= 0.0f ? 1.0f : -1.0f);
+        float fy = (1.0f - std::fabs(ox)) * (oy >= 0.0f ? 1.0f : -1.0f);
+        ox = fx;
+        oy = fy;
+    }
+    v.normal[0] = snorm(ox);
+    v.normal[1] = snorm(oy);
+    return v;
+}
+
+glm::vec3 unpackPosition(const ChunkVertex& v, float positionScale) {
+    return glm::vec3(v.position[0] / 65535.0f * 2.0f - 1.0f,
+                     v.position[1] / 65535.0f * 2.0f - 1.0f,
+                     v.position[2] / 65535.0f * 2.0f - 1.0f) * positionScale;
+}
+
+glm::vec3 unpackNormal(const ChunkVertex& v) {
+    // Same steps as octDecode in terrain.vert
+    float x = std::max(v.normal[0] / 32767.0f, -1.0f);
+    float y = std::max(v.normal[1] / 32767.0f, -1.0f);
+    float z = 1.0f - std::fabs(x) - std::fabs(y);
+    float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+    return glm::normalize(glm::vec3(x, y, z));
+}
+
+float unpackHeight(const ChunkVertex& v) {
+    return (v.position[3] / 65535.0f * 2.0f - 1.0f) * HEIGHT_RANGE;
+}
+
+glm::vec3 unpackMorphPosition(const ChunkVertex& v, float positionScale) {
+    return glm::vec3(v.morph[0] / 65535.0f * 2.0f - 1.0f,
+                     v.morph[1] / 65535.0f * 2.0f - 1.0f,
+                     v.morph[2] / 65535.0f * 2.0f - 1.0f) * positionScale;
+}
+
+float unpackMorphHeight(const ChunkVertex& v) {
+    return (v.morph[3] / 65535.0f * 2.0f - 1.0f) * HEIGHT_RANGE;
+}
+
 namespace {
 
+// Per-worker scratch for everything a patch needs while it is built: reset at the
+// start of each patch, so after the first few patches a worker allocates nothing
+thread_local luna::util::LinearArena scratch(256 * 1024);
+
+// Full-precision vertex, packed into a ChunkVertex once the patch is complete
+struct GridVertex {
+    glm::vec3 position;   // relative to chunk center
+    glm::vec3 normal;
+    float     height;     // elevation above LUNAR_RADIUS in meters
+    glm::vec3 morphPosition;  // where the parent patch puts this vertex
+    float     morphHeight;
+};
+
+// Parent-level shape of the grid. Even-even vertices are the parent's own; the rest
+// lie on a parent edge (or quad diagonal, tr→bl as buildIndices splits quads) and
+// take the midpoint of the two even vertices it joins. On the patch boundary that is
+// also the shape a one-level-coarser neighbour has there.
+void fillMorphTargets(GridVertex* verts, uint32_t gridSize) {
+    for (uint32_t j = 0; j < gridSize; j++) {
+        for (uint32_t i = 0; i < gridSize; i++) {
+            uint32_t idx = j * gridSize + i;
+            uint32_t a = idx, b = idx;
+            if ((i & 1) && (j & 1)) {
+                a = idx - gridSize + 1;   // (i+1, j-1)
+                b = idx + gridSize - 1;   // (i-1, j+1)
+            } else if (i & 1) {
+                a = idx - 1;
+                b = idx + 1;
+            } else if (j & 1) {
+                a = idx - gridSize;
+                b = idx + gridSize;
+            }
+            verts[idx].morphPosition = (verts[a].position + verts[b].position) * 0.5f;
+            verts[idx].morphHeight   = (verts[a].height + verts[b].height) * 0.5f;
+        }
+    }
+}
+
 // Sphere direction to lat/lon (Y-up: Y is polar axis)
 inline void dirToLatLon(const glm::dvec3& dir, double& lat, double& lon) {
     lat = std::asin(glm::clamp(dir.y, -1.0, 1.0));
@@ -30,34 +153,27 @@ inline void dirToLatLon(const glm::dvec3& dir, double& lat, double& lon) {
 }
 
 // Sample displaced world position from face UV coordinates
-inline glm::dvec3 sampleWorldPos(int face, double u, double v, double radius) {
+inline glm::dvec3 sampleWorldPos(int face, double u, double v, double radius, uint32_t level) {
     glm::dvec3 dir = ChunkGenerator::facePointToSphere(face, u, v);
     double lat, lon;
     dirToLatLon(dir, lat, lon);
-    double h = luna::sim::sampleTerrainHeight(lat, lon);
+    double h = luna::sim::sampleTerrainHeightAtLevel(lat, lon, level);
     return dir * (radius + h);
 }
 
-} // anonymous namespace
-
-ChunkMeshData ChunkGenerator::generate(int faceIndex,
-                                        double u0, double u1,
-                                        double v0, double v1,
-                                        double radius,
-                                        uint32_t gridSize) {
-    ChunkMeshData data;
-
-    double uStep = (u1 - u0) / static_cast<double>(gridSize - 1);
-    double vStep = (v1 - v0) / static_cast<double>(gridSize - 1);
-
-    // Compute world center with terrain displacement
-    double uMid = (u0 + u1) * 0.5;
-    double vMid = (v0 + v1) * 0.5;
-    data.worldCenter = sampleWorldPos(faceIndex, uMid, vMid, radius);
-
-    uint32_t vertCount = gridSize * gridSize;
-    data.vertices.resize(vertCount);
+// Heightmap mip for a patch whose half-step samples are halfStepUV apart in face UV.
+// Uses the smallest arc per unit UV on a face (√2/3, at the corners) so the choice
+// depends on depth alone: same-depth neighbours agree and their shared edges match.
+inline uint32_t levelForSpacing(double halfStepUV) {
+    const double MIN_ARC_PER_UV = std::sqrt(2.0) / 3.0;
+    return luna::sim::terrainLevelForFootprint(halfStepUV * MIN_ARC_PER_UV);
+}
 
+// Reference path: each vertex samples its own centre and four half-step neighbours,
+// then looks its height up again
+void fillGridPerVertex(GridVertex* verts, const glm::dvec3& worldCenter,
+                       int face, double u0, double v0, double uStep, double vStep,
+                       double radius, uint32_t gridSize, uint32_t level) {
     // Half-step offsets for central differencing normals
     double halfU = uStep * 0.5;
     double halfV = vStep * 0.5;
@@ -67,13 +183,13 @@ ChunkMeshData ChunkGenerator::generate(int faceIndex,
             double u = u0 + i * uStep;
             double v = v0 + j * vStep;
 
-            glm::dvec3 worldPos = sampleWorldPos(faceIndex, u, v, radius);
+            glm::dvec3 worldPos = sampleWorldPos(face, u, v, radius, level);
 
             // Central differencing: sample 4 neighbors, compute tangent cross product
-            glm::dvec3 pU0 = sampleWorldPos(faceIndex, u - halfU, v, radius);
-            glm::dvec3 pU1 = sampleWorldPos(faceIndex, u + halfU, v, radius);
-            glm::dvec3 pV0 = sampleWorldPos(faceIndex, u, v - halfV, radius);
-            glm::dvec3 pV1 = sampleWorldPos(faceIndex, u, v + halfV, radius);
+            glm::dvec3 pU0 = sampleWorldPos(face, u - halfU, v, radius, level);
+            glm::dvec3 pU1 = sampleWorldPos(face, u + halfU, v, radius, level);
+            glm::dvec3 pV0 = sampleWorldPos(face, u, v - halfV, radius, level);
+            glm::dvec3 pV1 = sampleWorldPos(face, u, v + halfV, radius, level);
 
             glm::dvec3 tangentU = pU1 - pU0;
             glm::dvec3 tangentV = pV1 - pV0;
@@ -81,101 +197,255 @@ ChunkMeshData ChunkGenerator::generate(int faceIndex,
 
             double lat, lon;
             dirToLatLon(glm::normalize(worldPos), lat, lon);
-            double h = luna::sim::sampleTerrainHeight(lat, lon);
+            double h = luna::sim::sampleTerrainHeightAtLevel(lat, lon, level);
 
             uint32_t idx = j * gridSize + i;
-            data.vertices[idx].position = glm::vec3(worldPos - data.worldCenter);
-            data.vertices[idx].normal   = glm::vec3(normal);
-            data.vertices[idx].height   = static_cast<float>(h);
+            verts[idx].position = glm::vec3(worldPos - worldCenter);
+            verts[idx].normal   = glm::vec3(normal);
+            verts[idx].height   = static_cast<float>(h);
         }
     }
+}
 
-    // Generate triangle-list indices from grid
-    uint32_t quads = gridSize - 1;
-    data.indices.reserve(quads * quads * 6 + 4 * quads * 6);
-
-    for (uint32_t j = 0; j < quads; j++) {
-        for (uint32_t i = 0; i < quads; i++) {
-            uint32_t tl = j * gridSize + i;
-            uint32_t tr = tl + 1;
-            uint32_t bl = (j + 1) * gridSize + i;
-            uint32_t br = bl + 1;
-
-            data.indices.push_back(tl);
-            data.indices.push_back(bl);
-            data.indices.push_back(tr);
-
-            data.indices.push_back(tr);
-            data.indices.push_back(bl);
-            data.indices.push_back(br);
+// Shared path: sample a (2N+1)² half-step lattice once, a row per batch call. Lattice index k sits at
+// u0 + (k - 1)·halfU, so vertex i is k = 2i + 1 and its differencing neighbours are
+// k = 2i and 2i + 2 — shared with the adjacent vertices. Lattice points with both
+// indices even are never referenced and are skipped.
+void fillGridShared(GridVertex* verts, const glm::dvec3& worldCenter,
+                    int face, double u0, double v0, double uStep, double vStep,
+                    double radius, uint32_t gridSize, uint32_t level) {
+    struct Sample {
+        glm::dvec3 pos;
+        double     height;
+    };
+    const uint32_t n = 2 * gridSize + 1;
+    Sample*     lattice   = scratch.allocateArray<Sample>(static_cast<size_t>(n) * n);
+    glm::dvec3* rowDirs   = scratch.allocateArray<glm::dvec3>(n);
+    double*     rowLat    = scratch.allocateArray<double>(n);
+    double*     rowLon    = scratch.allocateArray<double>(n);
+    float*      rowHeight = scratch.allocateArray<float>(n);
+
+    double halfU = uStep * 0.5;
+    double halfV = vStep * 0.5;
+    for (uint32_t b = 0; b < n; b++) {
+        // Odd rows need every column, even rows only the odd ones
+        uint32_t first = (b & 1) ? 0 : 1;
+        uint32_t step  = (b & 1) ? 1 : 2;
+        double v = v0 + (static_cast<double>(b) - 1.0) * halfV;
+
+        // Gather the row's directions, then convert and sample them as one batch
+        uint32_t count = 0;
+        for (uint32_t a = first; a < n; a += step) {
+            double u = u0 + (static_cast<double>(a) - 1.0) * halfU;
+            rowDirs[count++] = ChunkGenerator::facePointToSphere(face, u, v);
         }
-    }
+        luna::sim::directionsToLatLon(rowDirs, rowLat, rowLon, count);
+        luna::sim::sampleTerrainHeights(rowLat, rowLon, rowHeight, count, level);
 
-    // Skirt geometry — fills T-junction gaps between patches at different LOD levels.
-    // Each edge gets a strip hanging inward AND laterally outward from the patch
-    // boundary so adjacent patches overlap even at grazing viewing angles.
-    double skirtDepth = 3.0 * (u1 - u0) * radius / static_cast<double>(gridSize - 1);
-
-    // interiorOffset: signed step from an edge vertex to the adjacent interior vertex,
-    // used to compute the outward lateral direction for skirt extension.
-    auto addSkirt = [&](uint32_t startIdx, uint32_t stride, uint32_t count,
-                        bool flip, int interiorOffset) {
-        uint32_t skirtBase = static_cast<uint32_t>(data.vertices.size());
-        for (uint32_t k = 0; k < count; k++) {
-            uint32_t edgeIdx = startIdx + k * stride;
-            ChunkVertex sv = data.vertices[edgeIdx];
-            glm::dvec3 worldPos = glm::dvec3(sv.position) + data.worldCenter;
-            glm::dvec3 dir = glm::normalize(worldPos);
-
-            // Radial inward displacement
-            worldPos -= dir * skirtDepth;
-
-            // Lateral outward displacement — push skirt beyond patch boundary
-            uint32_t interiorIdx = static_cast<uint32_t>(
-                static_cast<int>(edgeIdx) + interiorOffset);
-            glm::dvec3 interiorPos = glm::dvec3(data.vertices[interiorIdx].position)
-                                   + data.worldCenter;
-            glm::dvec3 outward = worldPos - interiorPos;
-            double outLen = glm::length(outward);
-            if (outLen > 0.0)
-                worldPos += (outward / outLen) * skirtDepth * 0.5;
-
-            sv.position = glm::vec3(worldPos - data.worldCenter);
-            data.vertices.push_back(sv);
+        for (uint32_t k = 0, a = first; k < count; k++, a += step) {
+            Sample& s = lattice[b * n + a];
+            s.height = rowHeight[k];
+            s.pos    = rowDirs[k] * (radius + s.height);
         }
-        for (uint32_t k = 0; k < count - 1; k++) {
-            uint32_t e0 = startIdx + k * stride;
-            uint32_t e1 = startIdx + (k + 1) * stride;
-            uint32_t s0 = skirtBase + k;
-            uint32_t s1 = skirtBase + k + 1;
-            if (flip) {
-                data.indices.push_back(e0);
-                data.indices.push_back(e1);
-                data.indices.push_back(s0);
-                data.indices.push_back(s0);
-                data.indices.push_back(e1);
-                data.indices.push_back(s1);
-            } else {
-                data.indices.push_back(e0);
-                data.indices.push_back(s0);
-                data.indices.push_back(e1);
-                data.indices.push_back(e1);
-                data.indices.push_back(s0);
-                data.indices.push_back(s1);
-            }
+    }
+
+    for (uint32_t j = 0; j < gridSize; j++) {
+        uint32_t b = 2 * j + 1;
+        for (uint32_t i = 0; i < gridSize; i++) {
+            uint32_t a = 2 * i + 1;
+            const Sample& c = lattice[b * n + a];
+
+            glm::dvec3 tangentU = lattice[b * n + a + 1].pos - lattice[b * n + a - 1].pos;
+            glm::dvec3 tangentV = lattice[(b + 1) * n + a].pos - lattice[(b - 1) * n + a].pos;
+            glm::dvec3 normal = glm::normalize(glm::cross(tangentU, tangentV));
+
+            uint32_t idx = j * gridSize + i;
+            verts[idx].position = glm::vec3(c.pos - worldCenter);
+            verts[idx].normal   = glm::vec3(normal);
+            verts[idx].height   = static_cast<float>(c.height);
         }
+    }
+}
+
+// Re-sample the boundary vertices at EDGE_LEVEL, keeping their normals. Edge UVs are
+// taken from the patch bounds exactly, so both patches along an edge agree bit for bit.
+void pinBoundary(GridVertex* verts, const glm::dvec3& worldCenter,
+                 int face, double u0, double u1, double v0, double v1,
+                 double radius, uint32_t gridSize) {
+    uint32_t last = gridSize - 1;
+    size_t  capacity = 4 * static_cast<size_t>(last);
+    uint32_t*   indices = scratch.allocateArray<uint32_t>(capacity);
+    glm::dvec3* dirs    = scratch.allocateArray<glm::dvec3>(capacity);
+    double*     lat     = scratch.allocateArray<double>(capacity);
+    double*     lon     = scratch.allocateArray<double>(capacity);
+    float*      heights = scratch.allocateArray<float>(capacity);
+
+    auto coord = [last](double lo, double hi, uint32_t k) {
+        if (k == last) return hi;
+        return lo + (hi - lo) * static_cast<double>(k) / static_cast<double>(last);
     };
 
-    // Bottom edge (j=0): interior is one row up (+gridSize)
-    addSkirt(0, 1, gridSize, false, static_cast<int>(gridSize));
-    // Top edge (j=gridSize-1): interior is one row down (-gridSize)
-    addSkirt((gridSize - 1) * gridSize, 1, gridSize, true, -static_cast<int>(gridSize));
-    // Left edge (i=0): interior is one column right (+1)
-    addSkirt(0, gridSize, gridSize, true, 1);
-    // Right edge (i=gridSize-1): interior is one column left (-1)
-    addSkirt(gridSize - 1, gridSize, gridSize, false, -1);
+    size_t n = 0;
+    for (uint32_t j = 0; j < gridSize; j++) {
+        for (uint32_t i = 0; i < gridSize; i++) {
+            if (i != 0 && i != last && j != 0 && j != last) continue;
+            indices[n] = j * gridSize + i;
+            dirs[n++]  = ChunkGenerator::facePointToSphere(face, coord(u0, u1, i),
+                                                           coord(v0, v1, j));
+        }
+    }
+    luna::sim::directionsToLatLon(dirs, lat, lon, n);
+    luna::sim::sampleTerrainHeights(lat, lon, heights, n, ChunkGenerator::EDGE_LEVEL);
+
+    for (size_t k = 0; k < n; k++) {
+        GridVertex& gv = verts[indices[k]];
+        gv.position = glm::vec3(dirs[k] * (radius + heights[k]) - worldCenter);
+        gv.height   = heights[k];
+    }
+}
+
+} // anonymous namespace
 
+ChunkMeshData ChunkGenerator::generate(int faceIndex,
+                                        double u0, double u1,
+                                        double v0, double v1,
+                                        double radius,
+                                        uint32_t gridSize,
+                                        SampleMode mode) {
+    ChunkMeshData data;
+    data.vertices.resize(static_cast<size_t>(gridSize) * gridSize);
+    ChunkPlacement placement = generate(faceIndex, u0, u1, v0, v1, radius, gridSize,
+                                        data.vertices.data(), mode);
+    data.worldCenter   = placement.worldCenter;
+    data.positionScale = placement.positionScale;
     return data;
 }
 
+ChunkPlacement ChunkGenerator::generate(int faceIndex,
+                                        double u0, double u1,
+                                        double v0, double v1,
+                                        double radius,
+                                        uint32_t gridSize,
+                                        ChunkVertex* out,
+                                        SampleMode mode) {
+    ChunkPlacement placement;
+
+    double uStep = (u1 - u0) / static_cast<double>(gridSize - 1);
+    double vStep = (v1 - v0) / static_cast<double>(gridSize - 1);
+
+    // Coarse patches sample a coarser mip instead of aliasing the full-resolution map
+    uint32_t level = levelForPatch(u0, u1, v0, v1, gridSize);
+
+    // Compute world center with terrain displacement
+    double uMid = (u0 + u1) * 0.5;
+    double vMid = (v0 + v1) * 0.5;
+    placement.worldCenter = sampleWorldPos(faceIndex, uMid, vMid, radius, level);
+
+    // Built at full precision in scratch, packed into `out` at the end
+    scratch.reset();
+    size_t vertexCount = static_cast<size_t>(gridSize) * gridSize;
+    GridVertex* verts = scratch.allocateArray<GridVertex>(vertexCount);
+
+    if (mode == SampleMode::PerVertex)
+        fillGridPerVertex(verts, placement.worldCenter, faceIndex, u0, v0, uStep, vStep,
+                          radius, gridSize, level);
+    else
+        fillGridShared(verts, placement.worldCenter, faceIndex, u0, v0, uStep, vStep,
+                       radius, gridSize, level);
+
+    // No skirts: neighbours meet exactly, through shared edge samples and stitching
+    pinBoundary(verts, placement.worldCenter, faceIndex, u0, u1, v0, v1, radius, gridSize);
+    fillMorphTargets(verts, gridSize);
+
+    // Quantisation box: the largest coordinate, nudged outward so rounding never clamps
+    float extent = 0.0f;
+    for (size_t i = 0; i < vertexCount; i++) {
+        const GridVertex& gv = verts[i];
+        extent = std::max({extent, std::fabs(gv.position.x), std::fabs(gv.position.y),
+                           std::fabs(gv.position.z), std::fabs(gv.morphPosition.x),
+                           std::fabs(gv.morphPosition.y), std::fabs(gv.morphPosition.z)});
+    }
+    placement.positionScale = std::max(extent * 1.0001f, 1.0f);
+
+    for (size_t i = 0; i < vertexCount; i++)
+        out[i] = packVertex(verts[i].position, verts[i].normal, verts[i].height,
+                            verts[i].morphPosition, verts[i].morphHeight,
+                            placement.positionScale);
+    return placement;
+}
+
+uint32_t ChunkGenerator::levelForPatch(double u0, double u1, double v0, double v1,
+                                       uint32_t gridSize) {
+    double uStep = (u1 - u0) / static_cast<double>(gridSize - 1);
+    double vStep = (v1 - v0) / static_cast<double>(gridSize - 1);
+    return levelForSpacing(0.5 * std::min(uStep, vStep));
+}
+
+std::vector<uint16_t> ChunkGenerator::buildIndices(uint32_t gridSize) {
+    uint32_t quads = gridSize - 1;
+    std::vector<uint16_t> indices;
+    indices.reserve(totalIndexCount(gridSize));
+
+    // Every triangle is wound like the grid's (tl, bl, tr): negative area in (i, j)
+    auto tri = [&](glm::ivec2 a, glm::ivec2 b, glm::ivec2 c) {
+        glm::ivec2 ab = b - a, ac = c - a;
+        if (ab.x * ac.y - ab.y * ac.x > 0) std::swap(b, c);
+        for (const glm::ivec2& p : {a, b, c})
+            indices.push_back(static_cast<uint16_t>(p.y * gridSize + p.x));
+    };
+
+    // Outer vertex k and the vertex one step inward along each edge, in mask bit order
+    auto outer = [&](uint32_t edge, int k) {
+        int q = static_cast<int>(quads);
+        switch (edge) {
+            case 0:  return glm::ivec2(k, 0);
+            case 1:  return glm::ivec2(k, q);
+            case 2:  return glm::ivec2(0, k);
+            default: return glm::ivec2(q, k);
+        }
+    };
+    auto inner = [&](uint32_t edge, int k) {
+        glm::ivec2 p = outer(edge, k);
+        int q = static_cast<int>(quads);
+        switch (edge) {
+            case 0:  p.y = 1; break;
+            case 1:  p.y = q - 1; break;
+            case 2:  p.x = 1; break;
+            default: p.x = q - 1; break;
+        }
+        return p;
+    };
+
+    for (uint32_t mask = 0; mask < STITCH_VARIANTS; mask++) {
+        // Interior quads, one ring in from the boundary
+        for (uint32_t j = 1; j + 1 < quads; j++) {
+            for (uint32_t i = 1; i + 1 < quads; i++) {
+                glm::ivec2 tl(i, j), tr(i + 1, j), bl(i, j + 1), br(i + 1, j + 1);
+                tri(tl, bl, tr);
+                tri(tr, bl, br);
+            }
+        }
+
+        // Boundary ring: per edge, the strip between outer vertices 0..quads and inner
+        // vertices 1..quads-1. Adjacent strips share the diagonal to the corner.
+        int q = static_cast<int>(quads);
+        for (uint32_t edge = 0; edge < 4; edge++) {
+            if (mask & (1u << edge)) {
+                // Only even outer vertices: one wide triangle per coarse segment,
+                // and each inner segment closes on the nearer even outer vertex
+                for (int k = 0; k < q; k += 2)
+                    tri(outer(edge, k), outer(edge, k + 2), inner(edge, k + 1));
+                for (int m = 1; m + 1 < q; m++)
+                    tri(inner(edge, m), inner(edge, m + 1), outer(edge, (m & 1) ? m + 1 : m));
+            } else {
+                for (int k = 0; k < q; k++)
+                    tri(outer(edge, k), outer(edge, k + 1), inner(edge, std::clamp(k + 1, 1, q - 1)));
+                for (int m = 1; m + 1 < q; m++)
+                    tri(inner(edge, m), inner(edge, m + 1), outer(edge, m));
+            }
+        }
+    }
+    return indices;
+}
+
 } // namespace luna::scene
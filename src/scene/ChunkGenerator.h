@@ -1,4 +1,4 @@
-// About: Generates vertex/index mesh data for a single cubesphere patch.
+// About: Generates vertex mesh data for a single cubesphere patch, plus the shared patch topology.
 
 #pragma once
 
@@ -8,16 +8,65 @@
 
 namespace luna::scene {
 
+// Packed patch vertex, 20 bytes. position xyz is UNORM16 over
+// [-positionScale, +positionScale] around the patch centre (the scale is per patch);
+// position w is the height, UNORM16 over [-HEIGHT_RANGE, +HEIGHT_RANGE] meters.
+// normal is a unit vector in SNORM16 octahedral encoding. morph is the position and
+// height the parent patch has at this vertex, packed like position; terrain.vert
+// blends toward it by the patch's morph factor. Read as R16G16B16A16_UNORM +
+// R16G16_SNORM + R16G16B16A16_UNORM, and decoded in terrain.vert.
 struct ChunkVertex {
-    glm::vec3 position;   // relative to chunk center
-    glm::vec3 normal;
-    float     height;     // elevation above LUNAR_RADIUS in meters
+    uint16_t position[4];
+    int16_t  normal[2];
+    uint16_t morph[4];
 };
+static_assert(sizeof(ChunkVertex) == 20);
 
+// Elevation range a packed height covers (LOLA spans about -9.1 km to +10.8 km)
+inline constexpr float HEIGHT_RANGE = 16384.0f;
+
+ChunkVertex packVertex(const glm::vec3& position, const glm::vec3& normal, float height,
+                       const glm::vec3& morphPosition, float morphHeight, float positionScale);
+glm::vec3   unpackPosition(const ChunkVertex& v, float positionScale);
+glm::vec3   unpackNormal(const ChunkVertex& v);
+float       unpackHeight(const ChunkVertex& v);
+glm::vec3   unpackMorphPosition(const ChunkVertex& v, float positionScale);
+float       unpackMorphHeight(const ChunkVertex& v);
+
+// Bits of a stitch mask, one per patch edge: set when the neighbour across that edge
+// is one level coarser. bottom is v = v0 (grid row 0), left is u = u0 (column 0).
+enum PatchEdge : uint32_t {
+    EDGE_BOTTOM = 1u << 0,
+    EDGE_TOP    = 1u << 1,
+    EDGE_LEFT   = 1u << 2,
+    EDGE_RIGHT  = 1u << 3,
+};
+inline constexpr uint32_t STITCH_VARIANTS = 16;
+
+// Where one stitch variant sits in ChunkGenerator::buildIndices' output
+struct IndexRange {
+    uint32_t first;
+    uint32_t count;
+};
+
+// Where a generated patch sits: the datum its vertices are relative to, and the
+// half-extent of their quantisation box
+struct ChunkPlacement {
+    glm::dvec3 worldCenter;
+    float      positionScale = 1.0f;
+};
+
+// Vertices only — every patch of a given gridSize shares the same indices (see buildIndices)
 struct ChunkMeshData {
     std::vector<ChunkVertex> vertices;
-    std::vector<uint32_t>    indices;
     glm::dvec3               worldCenter;
+    float                    positionScale = 1.0f;  // half-extent of the quantisation box
+};
+
+// How generate() samples the terrain for vertex positions, heights and normals
+enum class SampleMode {
+    PerVertex,   // centre + 4 half-step neighbours + a height lookup per vertex (reference)
+    SharedGrid,  // one pass over a half-step lattice; neighbouring vertices share samples
 };
 
 class ChunkGenerator {
@@ -28,10 +77,65 @@ public:
                                   double u0, double u1,
                                   double v0, double v1,
                                   double radius,
-                                  uint32_t gridSize = 33);
+                                  uint32_t gridSize = 33,
+                                  SampleMode mode = SampleMode::SharedGrid);
+
+    // The same mesh written to `out`, gridSize² vertices of caller memory — staging
+    // memory itself, or a reused buffer — so nothing is allocated or copied per patch.
+    // Scratch comes from a per-thread arena.
+    static ChunkPlacement generate(int faceIndex,
+                                   double u0, double u1,
+                                   double v0, double v1,
+                                   double radius,
+                                   uint32_t gridSize,
+                                   ChunkVertex* out,
+                                   SampleMode mode = SampleMode::SharedGrid);
+
+    // Triangle-list indices for every stitch variant of a gridSize patch, concatenated
+    // in mask order. A stitched edge skips its odd vertices, so it meets the coarser
+    // neighbour's edge without T-junctions. Depends only on gridSize, which must be
+    // odd; 16-bit is enough while gridSize² < 65536.
+    static std::vector<uint16_t> buildIndices(uint32_t gridSize);
+
+    // Index range of variant `stitchMask` within buildIndices(gridSize)
+    static constexpr IndexRange stitchRange(uint32_t gridSize, uint32_t stitchMask) {
+        IndexRange range{0, stitchedIndexCount(gridSize, stitchMask)};
+        for (uint32_t m = 0; m < stitchMask; m++)
+            range.first += stitchedIndexCount(gridSize, m);
+        return range;
+    }
+
+    // Size of buildIndices(gridSize)
+    static constexpr uint32_t totalIndexCount(uint32_t gridSize) {
+        return stitchRange(gridSize, STITCH_VARIANTS - 1).first +
+               stitchedIndexCount(gridSize, STITCH_VARIANTS - 1);
+    }
 
     // Map (face, u, v) to a unit sphere direction vector
     static glm::dvec3 facePointToSphere(int face, double u, double v);
+
+    // Inverse of facePointToSphere: the face a direction falls on and its UV there
+    static void sphereToFacePoint(const glm::dvec3& dir, int& face, double& u, double& v);
+
+    // Heightmap mip level a patch with these bounds samples. Depends on the UV extent
+    // only, so every patch of a depth agrees and shared edges match.
+    static uint32_t levelForPatch(double u0, double u1, double v0, double v1, uint32_t gridSize);
+
+    // Heightmap level every patch samples its boundary vertices at, whatever its depth,
+    // so neighbours at different depths place shared edge points identically. Regions
+    // apply at every level (TerrainLayers::sample), so inside one the boundary and
+    // the interior both carry the overlay.
+    static constexpr uint32_t EDGE_LEVEL = 0;
+
+private:
+    // Interior quads, plus per edge a ring strip that fans to every other vertex when stitched
+    static constexpr uint32_t stitchedIndexCount(uint32_t gridSize, uint32_t stitchMask) {
+        uint32_t quads = gridSize - 1;
+        uint32_t triangles = 2 * (quads - 2) * (quads - 2);
+        for (uint32_t edge = 0; edge < 4; edge++)
+            triangles += (stitchMask & (1u << edge)) ? quads / 2 + quads - 2 : 2 * quads - 2;
+        return 3 * triangles;
+    }
 };
 
 } // namespace luna::scene
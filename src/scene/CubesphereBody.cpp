@@ -3,268 +3,1594 @@
 #include "scene/CubesphereBody.h"
 #include "scene/ChunkGenerator.h"
 #include "core/Buffer.h"
-#include "core/CommandPool.h"
+#include "core/Sync.h"
+#include "core/UploadManager.h"
 #include "core/VulkanContext.h"
+#include "sim/TerrainQuery.h"
 #include "util/Log.h"
+#include "util/Profiler.h"
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <numeric>
 
 namespace luna::scene {
 
-// Push constant layout must match shaders/terrain.vert
-struct TerrainPC {
+// Uniform block layout (std140) must match FrameConstants in shaders/terrain.vert,
+// terrain_indirect.vert, terrain_displaced.vert and terrain.frag; the latter two
+// leave out patchGrid and the split camera, which only arena patches need
+struct TerrainFrame {
     glm::mat4 viewProj;
-    glm::vec3 cameraOffset;
-    float     _pad0;
     glm::vec4 sunDirection;
     glm::vec3 cameraWorldPos;
-    float     _pad1;
+    uint32_t  patchGrid;
+    glm::vec4 cameraHigh;   // cameraWorldPos split by luna::util::splitDouble (xyz)
+    glm::vec4 cameraLow;
 };
 
+// Push constant layout must match shaders/terrain_displaced.vert. Frame constants
+// come from the frame set, so only the patch's placement is pushed per draw.
+struct DisplacedPC {
+    glm::vec3 originOffset;   // datum point at the patch's centre UV, camera-relative
+    float     radius;
+    glm::vec2 uvCenter;
+    float     uvHalfSize;
+    float     gridSteps;
+    uint32_t  faceAndLevel;   // face | image mip << 8 | boundary image mip << 16
+};
+static_assert(sizeof(DisplacedPC) <= 128, "Displaced terrain push constants exceed the guaranteed minimum");
+
+namespace {
+
+TerrainQuality sanitized(TerrainQuality quality) {
+    quality.sanitize();
+    return quality;
+}
+
+// Whether the spherical cap around direction `center`, `reach` radians wide, can
+// overlap a lat/lon box. The cap's own lat/lon bounds are exact, so this is
+// conservative only at the box's corners.
+bool capTouchesBox(const glm::dvec3& center, double reach, const luna::sim::TerrainBox& box) {
+    double lat = std::asin(glm::clamp(center.y, -1.0, 1.0));
+    double lon = std::atan2(center.z, center.x);
+    if (lat - reach > box.latMax || lat + reach < box.latMin) return false;
+    if (std::fabs(lat) + reach >= 0.5 * M_PI) return true;  // holds a pole: every longitude
+    double halfLon = std::asin(std::min(1.0, std::sin(reach) / std::cos(lat)));
+    for (double shift : {-2.0 * M_PI, 0.0, 2.0 * M_PI})
+        if (lon + shift - halfLon <= box.lonMax && lon + shift + halfLon >= box.lonMin)
+            return true;
+    return false;
+}
+
+} // anonymous namespace
+
 CubesphereBody::CubesphereBody(const luna::core::VulkanContext& ctx,
-                               const luna::core::CommandPool& cmdPool,
-                               double radius)
-    : radius_(radius), ctx_(&ctx), cmdPool_(&cmdPool) {
+                               luna::core::UploadManager& uploader,
+                               double radius,
+                               const std::string& diskCachePath,
+                               uint32_t diskCacheDepth,
+                               TerrainSource source,
+                               const TerrainQuality& quality)
+    : radius_(radius),
+      quality_(sanitized(quality)),
+      verticesPerPatch_(quality_.patchGrid * quality_.patchGrid),
+      topologyIndices_(ChunkGenerator::totalIndexCount(quality_.patchGrid)),
+      bytesPerMesh_(verticesPerPatch_ * sizeof(ChunkVertex)),
+      mergeRatio_(quality_.mergeThreshold / quality_.splitThreshold),
+      ctx_(&ctx), uploader_(&uploader),
+      arena_(ctx, ARENA_SLOTS, verticesPerPatch_, topologyIndices_,
+             source == TerrainSource::GpuCompute ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : 0),
+      frameRing_(ctx,
+                 luna::core::FrameRing::regionBytes(ctx, {sizeof(TerrainFrame),
+                                                          ARENA_SLOTS * sizeof(PatchRecord)}),
+                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT),
+      cache_(PATCH_CACHE_BYTES, bytesPerMesh_),
+      retainedBudget_(static_cast<size_t>(quality_.retainedMeshMB) << 20) {
+
+    const uint32_t grid = quality_.patchGrid;
+    for (uint32_t mask = 0; mask < STITCH_VARIANTS; mask++)
+        stitchRanges_[mask] = ChunkGenerator::stitchRange(grid, mask);
+
+    // The ring bindings cover one frame's share; vkCmdBindDescriptorSets picks the
+    // frame. The arena's patch centres are the same buffer every frame.
+    frameSetLayout_ = luna::core::DescriptorSetLayout(ctx, {
+        luna::core::DescriptorSetLayout::uniformBufferDynamic(
+            0, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT),
+        luna::core::DescriptorSetLayout::storageBufferDynamic(1, VK_SHADER_STAGE_VERTEX_BIT),
+        luna::core::DescriptorSetLayout::storageBuffer(2, VK_SHADER_STAGE_VERTEX_BIT),
+    });
+    framePool_ = luna::core::DescriptorPool(ctx, 1, {
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1},
+    });
+    frameSet_ = framePool_.allocate(frameSetLayout_.handle());
+    luna::core::writeDynamicBuffer(ctx.device(), frameSet_, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+                                   frameRing_.buffer(), sizeof(TerrainFrame));
+    luna::core::writeDynamicBuffer(ctx.device(), frameSet_, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+                                   frameRing_.buffer(), ARENA_SLOTS * sizeof(PatchRecord));
+    luna::core::writeStorageBuffer(ctx.device(), frameSet_, 2, arena_.centerBuffer());
+
+    // The GPU sources only have the base layer: drawing it over a region would put
+    // the visible ground somewhere other than where the lander touches down
+    if (source != TerrainSource::CpuMeshes && luna::sim::terrainRegionCount() > 0) {
+        LOG_WARN("GPU terrain generation ignores terrain regions — using CPU meshes");
+        source = TerrainSource::CpuMeshes;
+    }
+
+    if (source == TerrainSource::GpuDisplacement) {
+        const auto& heightmap = luna::sim::terrainBaseLayer();
+        if (DisplacedTerrain::isSupported(ctx, heightmap))
+            displaced_ = std::make_unique<DisplacedTerrain>(ctx, heightmap, grid);
+        else
+            LOG_WARN("GPU terrain displacement needs an in-memory heightmap — using CPU meshes");
+    }
+
+    // Roots need no mesh when displaced, so the tree starts with six bare nodes
+    if (displaced_) {
+        NodeId rootBlock[2] = {nodes_.allocateSiblings(), nodes_.allocateSiblings()};
+        for (int face = 0; face < 6; face++) {
+            roots_[face] = rootBlock[face / 4] + face % 4;
+            initNode(roots_[face], face, -1.0, 1.0, -1.0, 1.0, 0);
+        }
+        LOG_INFO("Cubesphere initialized with 6 root nodes, GPU displacement");
+        return;
+    }
+
+    if (source == TerrainSource::GpuCompute) {
+        const auto& heightmap = luna::sim::terrainBaseLayer();
+        if (grid != GpuPatchGenerator::GRID_SIZE)
+            LOG_WARN("terrain_patch.comp generates %ux%u patches, not %ux%u — using CPU meshes",
+                     GpuPatchGenerator::GRID_SIZE, GpuPatchGenerator::GRID_SIZE, grid, grid);
+        else if (GpuPatchGenerator::isSupported(ctx, heightmap))
+            patchGenerator_ = std::make_unique<GpuPatchGenerator>(ctx, heightmap, arena_.vertexBuffer(),
+                                                                  ARENA_SLOTS, radius_);
+        else
+            LOG_WARN("GPU patch generation needs an in-memory heightmap — using CPU meshes");
+    }
+
+    if (TerrainCuller::isSupported(ctx))
+        culler_ = std::make_unique<TerrainCuller>(ctx, ARENA_SLOTS, arena_.centerBuffer());
+
+    // CPU meshes from split jobs are generated into persistent staging and copied
+    // from there, so the vertices are never memcpy'd on the way to the arena. A
+    // direct arena needs no staging: uploadJob() writes the job's vertices in place.
+    if (!displaced_ && !patchGenerator_ && !arena_.isDirect())
+        stagingSlots_ = std::make_unique<luna::core::StagingSlots>(ctx, STAGING_SLOTS, bytesPerMesh_);
+
+    // Topology is identical for every patch — upload it once with the roots
+    arena_.uploadIndices(uploader.begin(quality_.meshesPerBatch * (bytesPerMesh_ + sizeof(PatchCenter))),
+                         uploader.staging(), ChunkGenerator::buildIndices(grid));
 
-    // 6 root meshes fit comfortably in one batch (12 device-local BOs + 1 staging = 13)
-    luna::core::StagingBatch staging;
-    staging.begin(ctx, 6 * BYTES_PER_MESH);
-    VkCommandBuffer cmd = cmdPool.beginOneShot();
+    // Meshes from here on are built at this generation; regions listed now never
+    // change boxes
+    terrainGeneration_ = luna::sim::terrainGeneration();
+    luna::sim::terrainRegionBoxes(regionBoxes_);
 
+    // Without a valid file this run generates as usual, and rebuilds the file for
+    // the next start once the LOD has converged (see update()). Compute generation
+    // is cheap enough not to need it.
+    if (!diskCachePath.empty() && !patchGenerator_ &&
+        !diskCache_.open(diskCachePath, luna::sim::terrainContentHash(), radius_, grid)) {
+        diskCacheBuildPath_  = diskCachePath;
+        diskCacheBuildDepth_ = diskCacheDepth;
+    }
+
+    // Roots are loaded synchronously — nothing can be drawn until they exist
+    // The six roots take the first two sibling blocks; the last two nodes stay unused
+    NodeId rootBlock[2] = {nodes_.allocateSiblings(), nodes_.allocateSiblings()};
     for (int face = 0; face < 6; face++) {
-        roots_[face] = std::make_unique<QuadtreeNode>();
-        initNode(*roots_[face], face, -1.0, 1.0, -1.0, 1.0, 0);
-        generateMeshBatched(*roots_[face], cmd, staging);
+        roots_[face] = rootBlock[face / 4] + face % 4;
+        initNode(roots_[face], face, -1.0, 1.0, -1.0, 1.0, 0);
+        uint64_t ticket;
+        if (patchGenerator_) {
+            nodes_.slot(roots_[face]) = arena_.allocate();
+            patchGenerator_->queue(nodes_.slot(roots_[face]), face, -1.0, 1.0, -1.0, 1.0);
+            uploadCenter(nodes_.slot(roots_[face]), nodes_.worldCenter(roots_[face]), ticket);
+            continue;
+        }
+        glm::dvec3 center;
+        float scale;
+        const ChunkVertex* mapped =
+            diskCached(face, 0, -1.0, 1.0, -1.0, 1.0)
+                ? diskCache_.find(PatchCache::makeKey(face, 0, -1.0, -1.0), center, scale)
+                : nullptr;
+        if (mapped) {
+            nodes_.worldCenter(roots_[face]) = center;
+            nodes_.positionScale(roots_[face]) = scale;
+            nodes_.slot(roots_[face]) = uploadMesh(mapped, verticesPerPatch_, center, ticket);
+            continue;
+        }
+        nodes_.slot(roots_[face]) = generateMesh(roots_[face], ticket);
     }
 
-    // Flush remaining
-    if (batchCount_ > 0) {
-        staging.end();
-        cmdPool.endOneShot(cmd, ctx.graphicsQueue());
-    } else {
-        vkEndCommandBuffer(cmd);
-        vkFreeCommandBuffers(ctx.device(), cmdPool.pool(), 1, &cmd);
+    uploader.submit();
+    uploader.waitIdle();
+    batchCount_ = 0;
+
+    if (patchGenerator_) {
+        patchGenerator_->generateNow();
+        for (NodeId root : roots_)
+            nodes_.positionScale(root) = patchGenerator_->positionScale(nodes_.slot(root));
     }
 
-    LOG_INFO("Cubesphere initialized with 6 root nodes");
+    LOG_INFO("Cubesphere initialized with 6 root nodes, %u generation workers, %ux%u patches, "
+             "split at %.1f px", jobs_->workerCount(), grid, grid, quality_.splitThreshold);
+}
+
+void CubesphereBody::setSplitThreshold(double pixels) {
+    if (!(pixels > 0.0)) return;
+    quality_.splitThreshold = pixels;
+    quality_.mergeThreshold = pixels * mergeRatio_;
 }
 
-void CubesphereBody::initNode(QuadtreeNode& node, int face,
+void CubesphereBody::initNode(NodeId node, int face,
                                double u0, double u1, double v0, double v1,
                                uint32_t depth) {
-    node.faceIndex = face;
-    node.u0 = u0;
-    node.u1 = u1;
-    node.v0 = v0;
-    node.v1 = v1;
-    node.depth = depth;
+    NodeInfo& info = nodes_.info(node);
+    info.faceIndex = face;
+    info.u0 = u0;
+    info.u1 = u1;
+    info.v0 = v0;
+    info.v1 = v1;
+    nodes_.depth(node) = static_cast<uint8_t>(depth);
+    patchBounds(face, u0, u1, v0, v1, radius_, nodes_.worldCenter(node), nodes_.boundingRadius(node));
+}
 
+void CubesphereBody::patchBounds(int face, double u0, double u1, double v0, double v1,
+                                 double radius, glm::dvec3& center, double& boundingRadius) {
     double uMid = (u0 + u1) * 0.5;
     double vMid = (v0 + v1) * 0.5;
-    node.worldCenter = ChunkGenerator::facePointToSphere(face, uMid, vMid) * radius_;
+    center = ChunkGenerator::facePointToSphere(face, uMid, vMid) * radius;
 
     // Conservative bounding radius: max distance from center to any corner/edge midpoint
     glm::dvec3 testPoints[] = {
-        ChunkGenerator::facePointToSphere(face, u0, v0) * radius_,
-        ChunkGenerator::facePointToSphere(face, u1, v0) * radius_,
-        ChunkGenerator::facePointToSphere(face, u0, v1) * radius_,
-        ChunkGenerator::facePointToSphere(face, u1, v1) * radius_,
-        ChunkGenerator::facePointToSphere(face, uMid, v0) * radius_,
-        ChunkGenerator::facePointToSphere(face, uMid, v1) * radius_,
-        ChunkGenerator::facePointToSphere(face, u0, vMid) * radius_,
-        ChunkGenerator::facePointToSphere(face, u1, vMid) * radius_,
+        ChunkGenerator::facePointToSphere(face, u0, v0) * radius,
+        ChunkGenerator::facePointToSphere(face, u1, v0) * radius,
+        ChunkGenerator::facePointToSphere(face, u0, v1) * radius,
+        ChunkGenerator::facePointToSphere(face, u1, v1) * radius,
+        ChunkGenerator::facePointToSphere(face, uMid, v0) * radius,
+        ChunkGenerator::facePointToSphere(face, uMid, v1) * radius,
+        ChunkGenerator::facePointToSphere(face, u0, vMid) * radius,
+        ChunkGenerator::facePointToSphere(face, u1, vMid) * radius,
     };
-    node.boundingRadius = 0.0;
+    boundingRadius = 0.0;
     for (const auto& p : testPoints) {
-        node.boundingRadius = glm::max(node.boundingRadius, glm::length(p - node.worldCenter));
+        boundingRadius = glm::max(boundingRadius, glm::length(p - center));
     }
     // Additive margin for terrain displacement (LOLA range ~-9km to +11km)
     constexpr double MAX_TERRAIN_DISPLACEMENT = 12000.0;
-    node.boundingRadius += MAX_TERRAIN_DISPLACEMENT;
-}
-
-void CubesphereBody::generateMesh(QuadtreeNode& node) {
-    auto meshData = ChunkGenerator::generate(
-        node.faceIndex, node.u0, node.u1, node.v0, node.v1, radius_, PATCH_GRID);
-    node.worldCenter = meshData.worldCenter;
-    node.mesh = std::make_unique<Mesh>(
-        *ctx_, *cmdPool_,
-        meshData.vertices.data(),
-        static_cast<uint32_t>(meshData.vertices.size() * sizeof(ChunkVertex)),
-        meshData.indices.data(),
-        static_cast<uint32_t>(meshData.indices.size()));
-}
-
-void CubesphereBody::ensureBatchStarted(VkCommandBuffer& cmd,
-                                         luna::core::StagingBatch& staging) {
-    if (!batchStarted_) {
-        staging.begin(*ctx_, MESHES_PER_BATCH * BYTES_PER_MESH);
-        cmd = cmdPool_->beginOneShot();
-        batchStarted_ = true;
-    }
-}
-
-void CubesphereBody::generateMeshBatched(QuadtreeNode& node, VkCommandBuffer& cmd,
-                                          luna::core::StagingBatch& staging) {
-    ensureBatchStarted(cmd, staging);
-    auto meshData = ChunkGenerator::generate(
-        node.faceIndex, node.u0, node.u1, node.v0, node.v1, radius_, PATCH_GRID);
-    node.worldCenter = meshData.worldCenter;
-    node.mesh = std::make_unique<Mesh>(
-        *ctx_, cmd,
-        meshData.vertices.data(),
-        static_cast<uint32_t>(meshData.vertices.size() * sizeof(ChunkVertex)),
-        meshData.indices.data(),
-        static_cast<uint32_t>(meshData.indices.size()),
-        staging);
-    batchCount_++;
-
-    // Flush when sub-batch is full to keep BO count per submission low
-    if (batchCount_ >= MESHES_PER_BATCH) {
-        staging.end();
-        cmdPool_->endOneShot(cmd, ctx_->graphicsQueue());
-
-        // Start fresh sub-batch
-        staging.begin(*ctx_, MESHES_PER_BATCH * BYTES_PER_MESH);
-        cmd = cmdPool_->beginOneShot();
+    boundingRadius += MAX_TERRAIN_DISPLACEMENT;
+}
+
+VkCommandBuffer CubesphereBody::beginUpload(uint64_t& ticket) {
+    VkCommandBuffer cmd = uploader_->begin(quality_.meshesPerBatch * (bytesPerMesh_ + sizeof(PatchCenter)));
+    ticket = uploader_->pendingTicket();
+    return cmd;
+}
+
+void CubesphereBody::endUpload() {
+    // Submit when sub-batch is full to keep BO count per submission low.
+    // The next upload opens a fresh batch; nothing here waits on the GPU.
+    if (++batchCount_ >= quality_.meshesPerBatch) {
+        uploader_->submit();
         batchCount_ = 0;
     }
 }
 
+uint32_t CubesphereBody::uploadMesh(const ChunkVertex* vertices, uint32_t vertexCount,
+                                    const glm::dvec3& center, uint64_t& ticket) {
+    uint32_t slot = arena_.allocate();
+    if (slot == TerrainArena::INVALID_SLOT) return slot;
+
+    if (arena_.isDirect()) {
+        arena_.write(slot, vertices, vertexCount, center);
+        ticket = 0;  // nothing in flight to wait for
+        stats_.meshesWritten++;
+        stats_.bytesWritten += vertexCount * sizeof(ChunkVertex);
+        return slot;
+    }
+
+    VkCommandBuffer cmd = beginUpload(ticket);
+    arena_.upload(slot, cmd, uploader_->staging(), vertices, vertexCount, center);
+    stats_.meshesStaged++;
+    stats_.bytesStaged += vertexCount * sizeof(ChunkVertex);
+    endUpload();
+    return slot;
+}
+
+uint32_t CubesphereBody::generateMesh(NodeId node, uint64_t& ticket) {
+    uint32_t slot = arena_.allocate();
+    if (slot == TerrainArena::INVALID_SLOT) return slot;
+
+    const NodeInfo& info = nodes_.info(node);
+    if (arena_.isDirect()) {
+        ChunkPlacement placement = ChunkGenerator::generate(info.faceIndex, info.u0, info.u1,
+                                                            info.v0, info.v1, radius_,
+                                                            quality_.patchGrid, arena_.slotVertices(slot));
+        arena_.writeCenter(slot, placement.worldCenter);
+        nodes_.worldCenter(node)   = placement.worldCenter;
+        nodes_.positionScale(node) = placement.positionScale;
+        ticket = 0;
+        stats_.meshesWritten++;
+        stats_.bytesWritten += bytesPerMesh_;
+        return slot;
+    }
+
+    // The centre is only known once generated, so it is staged after the vertices
+    VkCommandBuffer cmd = beginUpload(ticket);
+    ChunkVertex* staged = arena_.stageVertices(slot, cmd, uploader_->staging());
+    ChunkPlacement placement = ChunkGenerator::generate(info.faceIndex, info.u0, info.u1,
+                                                        info.v0, info.v1, radius_,
+                                                        quality_.patchGrid, staged);
+    arena_.uploadCenter(slot, cmd, uploader_->staging(), placement.worldCenter);
+    nodes_.worldCenter(node)   = placement.worldCenter;
+    nodes_.positionScale(node) = placement.positionScale;
+    stats_.meshesStaged++;
+    stats_.bytesStaged += verticesPerPatch_ * sizeof(ChunkVertex);
+    endUpload();
+    return slot;
+}
+
+void CubesphereBody::uploadCenter(uint32_t slot, const glm::dvec3& center, uint64_t& ticket) {
+    if (arena_.isDirect()) {
+        arena_.writeCenter(slot, center);
+        ticket = 0;
+        return;
+    }
+    VkCommandBuffer cmd = beginUpload(ticket);
+    arena_.uploadCenter(slot, cmd, uploader_->staging(), center);
+    endUpload();
+}
+
+void CubesphereBody::uploadJob(ChunkJob& job) {
+    // Compute generation writes the slot in place; the dispatch is recorded this frame
+    if (patchGenerator_) {
+        uint32_t slot = arena_.allocate();
+        if (slot == TerrainArena::INVALID_SLOT) return;  // arena full — retried next frame
+        if (!patchGenerator_->queue(slot, job.faceIndex, job.u0, job.u1, job.v0, job.v1)) {
+            arena_.free(slot);  // batch full — retried next frame
+            return;
+        }
+        // The vertices are datum-relative to job.data.worldCenter; the slot's centre
+        // goes through the transfer queue, which jobResident() also waits on, unless
+        // the arena is written in place
+        uploadCenter(slot, job.data.worldCenter, job.uploadTicket);
+        job.slot = slot;
+        job.computeFrame = frameCounter_;
+        patchesGenerated_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Generated into a staging slot: the copy reads the slot, which is released
+    // once the batch carrying it has retired
+    if (job.isStaged()) {
+        job.slot = arena_.allocate();
+        if (!job.isUploaded()) return;  // arena full — retried next frame
+        VkCommandBuffer cmd = beginUpload(job.uploadTicket);
+        arena_.copyVertices(job.slot, cmd, stagingSlots_->buffer(),
+                            stagingSlots_->offset(job.stagingSlot));
+        arena_.uploadCenter(job.slot, cmd, uploader_->staging(), job.data.worldCenter);
+        stats_.meshesStaged++;
+        stats_.bytesStaged += bytesPerMesh_;
+        endUpload();
+        stagedCopies_.push_back({job.stagingSlot, job.uploadTicket});
+        job.staging     = nullptr;
+        job.stagingSlot = luna::core::StagingSlots::INVALID_SLOT;
+        return;
+    }
+
+    // Disk cache hits copy from the mapped file straight into staging, or into a direct arena
+    if (job.mappedVertices)
+        job.slot = uploadMesh(job.mappedVertices, verticesPerPatch_, job.data.worldCenter,
+                              job.uploadTicket);
+    else
+        job.slot = uploadMesh(job.data.vertices.data(), static_cast<uint32_t>(job.data.vertices.size()),
+                              job.data.worldCenter, job.uploadTicket);
+    if (!job.isUploaded()) return;  // arena full — retried next frame
+    // Only worldCenter and positionScale are needed once the vertices are in staging or the arena
+    job.data.vertices = {};
+    job.mappedVertices = nullptr;
+}
+
+bool CubesphereBody::jobResident(ChunkJob& job) {
+    if (!job.isUploaded() || !uploader_->isComplete(job.uploadTicket)) return false;
+    if (job.computeFrame == 0) return true;
+    // The frame fence for computeFrame has been waited on once the frame index wraps
+    if (frameCounter_ < job.computeFrame + luna::core::MAX_FRAMES_IN_FLIGHT) return false;
+    job.data.positionScale = patchGenerator_->positionScale(job.slot);
+    job.computeFrame = 0;
+    return true;
+}
+
+std::shared_ptr<ChunkJob> CubesphereBody::acquireJob(int face, uint32_t depth,
+                                                     double u0, double u1,
+                                                     double v0, double v1) {
+    uint64_t key = PatchCache::makeKey(face, depth, u0, v0);
+
+    // A finished prefetch is as good as a cache hit. One still waiting at background
+    // priority is dropped, and the patch is generated at full priority instead.
+    auto prefetched = prefetchJobs_.find(key);
+    if (prefetched != prefetchJobs_.end()) {
+        std::shared_ptr<ChunkJob> ready = std::move(prefetched->second);
+        prefetchJobs_.erase(prefetched);
+        if (ready->ready.load(std::memory_order_acquire)) return ready;
+    }
+
+    auto job = std::make_shared<ChunkJob>();
+    job->faceIndex = face;
+    job->u0 = u0;
+    job->u1 = u1;
+    job->v0 = v0;
+    job->v1 = v1;
+    job->cacheKey = key;
+
+    // A recently dropped copy skips generation, and upload too if it kept its slot
+    CachedPatch cached;
+    if (cache_.take(job->cacheKey, cached)) {
+        job->data         = std::move(cached.mesh);
+        job->slot         = cached.slot;
+        job->uploadTicket = cached.uploadTicket;
+        job->ready.store(true, std::memory_order_relaxed);
+        return job;
+    }
+
+    // Nothing to build on the CPU: the job is ready for uploadJob() to queue its
+    // dispatch, and its vertices will sit around the datum point initNode() uses
+    if (patchGenerator_) {
+        job->data.worldCenter = ChunkGenerator::facePointToSphere(face, (u0 + u1) * 0.5,
+                                                                  (v0 + v1) * 0.5) * radius_;
+        job->ready.store(true, std::memory_order_relaxed);
+        return job;
+    }
+
+    // Shallow patches precomputed on disk need no worker at all
+    if (diskCached(face, depth, u0, u1, v0, v1)) {
+        job->mappedVertices = diskCache_.find(job->cacheKey, job->data.worldCenter,
+                                              job->data.positionScale);
+        if (job->mappedVertices) {
+            job->ready.store(true, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    // Generated in place into a staging slot when one is free
+    if (stagingSlots_) {
+        job->stagingSlot = stagingSlots_->acquire();
+        if (job->isStaged()) job->staging = stagingSlots_.get();
+    }
+
+    // The worker only holds a weak reference: if the requesting node is merged
+    // or cancels before the job starts, the generation is skipped entirely.
+    std::weak_ptr<ChunkJob> weak = job;
+    double radius = radius_;
+    uint32_t grid = quality_.patchGrid;
+    inFlightJobs_.fetch_add(1, std::memory_order_relaxed);
+    jobs_->submit([this, weak, radius, grid] {
+        auto j = weak.lock();
+        if (j && !stopping_.load(std::memory_order_relaxed)) {
+            PROFILE_SCOPE("generate patch");
+            if (j->isStaged()) {
+                ChunkPlacement placement = ChunkGenerator::generate(
+                    j->faceIndex, j->u0, j->u1, j->v0, j->v1, radius, grid, j->stagedVertices());
+                j->data.worldCenter   = placement.worldCenter;
+                j->data.positionScale = placement.positionScale;
+            } else {
+                j->data = ChunkGenerator::generate(j->faceIndex, j->u0, j->u1, j->v0, j->v1,
+                                                   radius, grid);
+            }
+            j->ready.store(true, std::memory_order_release);
+            patchesGenerated_.fetch_add(1, std::memory_order_relaxed);
+        }
+        inFlightJobs_.fetch_sub(1, std::memory_order_relaxed);
+    }, luna::util::JobPriority::Normal, &jobsPending_);
+    return job;
+}
+
+void CubesphereBody::queuePrefetch(int face, uint32_t depth,
+                                   double u0, double u1, double v0, double v1) {
+    uint64_t key = PatchCache::makeKey(face, depth, u0, v0);
+    if (diskCached(face, depth, u0, u1, v0, v1) || cache_.contains(key) || prefetchJobs_.count(key))
+        return;
+
+    auto job = std::make_shared<ChunkJob>();
+    job->faceIndex = face;
+    job->u0 = u0;
+    job->u1 = u1;
+    job->v0 = v0;
+    job->v1 = v1;
+    job->cacheKey = key;
+
+    // Runs only when no split is waiting for a worker; skipped if acquireJob()
+    // dropped it in the meantime
+    std::weak_ptr<ChunkJob> weak = job;
+    double radius = radius_;
+    uint32_t grid = quality_.patchGrid;
+    jobs_->submit([this, weak, radius, grid] {
+        auto j = weak.lock();
+        if (j && !stopping_.load(std::memory_order_relaxed)) {
+            PROFILE_SCOPE("prefetch patch");
+            j->data = ChunkGenerator::generate(j->faceIndex, j->u0, j->u1, j->v0, j->v1,
+                                               radius, grid);
+            j->ready.store(true, std::memory_order_release);
+            patchesGenerated_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }, luna::util::JobPriority::Background, &jobsPending_);
+    prefetchJobs_.emplace(key, std::move(job));
+}
+
+void CubesphereBody::cancelJob(std::shared_ptr<ChunkJob>& job) {
+    // A compute job still in flight has no scale yet, so its slot is not worth caching
+    if (job && job->computeFrame != 0 && !jobResident(*job)) {
+        retireSlot(job->slot);
+        job.reset();
+        return;
+    }
+
+    // Finished work is cached: an uploaded slot (its copy may still be in flight,
+    // hence the ticket) or generated vertices. The worker is done with a ready job.
+    // A disk cache hit that was never uploaded holds neither and is just dropped.
+    // Staged vertices are copied out, since the cache may keep them for minutes and
+    // the slot goes back to the pool with the job.
+    bool ready = job && job->ready.load(std::memory_order_acquire);
+    if (ready && job->isStaged() && !job->isUploaded())
+        job->data.vertices.assign(job->stagedVertices(), job->stagedVertices() + verticesPerPatch_);
+    if (ready && (job->isUploaded() || !job->data.vertices.empty())) {
+        CachedPatch patch;
+        patch.mesh         = std::move(job->data);
+        patch.slot         = job->slot;
+        patch.uploadTicket = job->uploadTicket;
+        job->slot = TerrainArena::INVALID_SLOT;
+        cachePatch(job->cacheKey, std::move(patch));
+    }
+    job.reset();
+}
+
+void CubesphereBody::discardJob(std::shared_ptr<ChunkJob>& job) {
+    // A worker still generating it holds its own reference and drops the result
+    if (job) retireSlot(job->slot, job->uploadTicket);
+    job.reset();
+}
+
+void CubesphereBody::retireSlot(uint32_t& slot, uint64_t ticket) {
+    if (slot == TerrainArena::INVALID_SLOT) return;
+    // Frames already recorded may still draw it; wait out every frame in flight
+    deferredDestroy_.push_back({slot, ticket, frameCounter_ + luna::core::MAX_FRAMES_IN_FLIGHT});
+    slot = TerrainArena::INVALID_SLOT;
+}
+
+void CubesphereBody::retireNode(NodeId node) {
+    uint32_t& slot = nodes_.slot(node);
+    if (slot == TerrainArena::INVALID_SLOT) return;
+
+    const NodeInfo& info = nodes_.info(node);
+    CachedPatch patch;
+    patch.mesh.worldCenter = nodes_.worldCenter(node);
+    patch.mesh.positionScale = nodes_.positionScale(node);
+    patch.slot = slot;
+    slot = TerrainArena::INVALID_SLOT;
+    cachePatch(PatchCache::makeKey(info.faceIndex, nodes_.depth(node), info.u0, info.v0),
+               std::move(patch));
+}
+
+void CubesphereBody::cachePatch(uint64_t key, CachedPatch&& patch) {
+    // Evicted slots may have been drawn by frames in flight; retire them normally
+    std::vector<CachedPatch> evicted;
+    cache_.insert(key, std::move(patch), evicted);
+    for (auto& e : evicted)
+        retireSlot(e.slot, e.uploadTicket);
+}
+
+void CubesphereBody::setPatchCacheBudget(size_t bytes) {
+    std::vector<CachedPatch> evicted;
+    cache_.setBudget(bytes, evicted);
+    for (auto& e : evicted)
+        retireSlot(e.slot, e.uploadTicket);
+}
+
+void CubesphereBody::setRetainedMeshBudget(size_t bytes) {
+    retainedBudget_ = bytes;
+    evictRetained(retainedBudget_ / bytesPerMesh_);
+}
+
+void CubesphereBody::evictRetained(size_t keep) {
+    if (retained_.size() <= keep) return;
+    // The deepest are most of the count and each covers the least ground, so
+    // keeping the shallow levels covers a long climb with few slots
+    auto first = retained_.begin() + static_cast<std::ptrdiff_t>(keep);
+    std::nth_element(retained_.begin(), first, retained_.end(),
+                     [this](const RetainedMesh& a, const RetainedMesh& b) {
+                         uint8_t da = nodes_.depth(a.node), db = nodes_.depth(b.node);
+                         if (da != db) return da < db;
+                         return a.drawnFrame > b.drawnFrame;
+                     });
+    for (auto it = first; it != retained_.end(); ++it)
+        retireNode(it->node);
+    retained_.erase(first, retained_.end());
+}
+
+bool CubesphereBody::tileTouches(int face, double u0, double u1, double v0, double v1,
+                                 const std::vector<luna::sim::TerrainBox>& boxes) const {
+    if (boxes.empty()) return false;
+    // Normals difference samples half a grid step outside the patch. Grown by that,
+    // the patch is still bounded by great circles, so a cap around its centre
+    // through its farthest corner holds every sample.
+    double padU = (u1 - u0) / (2.0 * (quality_.patchGrid - 1));
+    double padV = (v1 - v0) / (2.0 * (quality_.patchGrid - 1));
+    glm::dvec3 center = ChunkGenerator::facePointToSphere(face, (u0 + u1) * 0.5, (v0 + v1) * 0.5);
+    double cosReach = 1.0;
+    for (double u : {u0 - padU, u1 + padU})
+        for (double v : {v0 - padV, v1 + padV})
+            cosReach = std::min(cosReach,
+                                glm::dot(center, ChunkGenerator::facePointToSphere(face, u, v)));
+    double reach = std::acos(glm::clamp(cosReach, -1.0, 1.0));
+    return std::any_of(boxes.begin(), boxes.end(), [&](const luna::sim::TerrainBox& box) {
+        return capTouchesBox(center, reach, box);
+    });
+}
+
+bool CubesphereBody::diskCached(int face, uint32_t depth,
+                                double u0, double u1, double v0, double v1) const {
+    return depth <= diskCache_.maxDepth() && !tileTouches(face, u0, u1, v0, v1, regionBoxes_);
+}
+
+void CubesphereBody::invalidateTerrain(const std::vector<luna::sim::TerrainBox>& boxes) {
+    auto stale = [&](const NodeInfo& info) {
+        return tileTouches(info.faceIndex, info.u0, info.u1, info.v0, info.v1, boxes);
+    };
+
+    // Cached patches, prefetches and retained parents would come back as they were
+    std::vector<CachedPatch> removed;
+    cache_.removeIf([&](uint64_t key) {
+        int face;
+        uint32_t depth;
+        double u0, u1, v0, v1;
+        PatchCache::keyTile(key, face, depth, u0, u1, v0, v1);
+        return tileTouches(face, u0, u1, v0, v1, boxes);
+    }, removed);
+    for (auto& patch : removed)
+        retireSlot(patch.slot, patch.uploadTicket);
+    for (auto it = prefetchJobs_.begin(); it != prefetchJobs_.end();) {
+        const ChunkJob& job = *it->second;
+        if (tileTouches(job.faceIndex, job.u0, job.u1, job.v0, job.v1, boxes))
+            it = prefetchJobs_.erase(it);
+        else
+            ++it;
+    }
+    auto retainedStale = [&](const RetainedMesh& r) {
+        if (!stale(nodes_.info(r.node))) return false;
+        retireSlot(nodes_.slot(r.node));
+        return true;
+    };
+    retained_.erase(std::remove_if(retained_.begin(), retained_.end(), retainedStale),
+                    retained_.end());
+
+    // The tree: tiles nest, so only subtrees that touch a box are walked. Pending
+    // jobs there are dropped and asked for again by the walk; leaves keep drawing
+    // their stale mesh until a regenerated one replaces it.
+    beginTraversal();
+    while (!stack_.empty()) {
+        NodeId node = stack_.back();
+        stack_.pop_back();
+        NodeInfo& info = nodes_.info(node);
+        if (!stale(info)) continue;
+
+        uint8_t& flags = nodes_.flags(node);
+        if (!nodes_.isLeaf(node)) {
+            if (flags & QuadtreePool::MERGE_PENDING) {
+                discardJob(info.pendingMesh);
+                flags &= ~QuadtreePool::MERGE_PENDING;
+            }
+            NodeId first = nodes_.firstChild(node);
+            for (NodeId child = first + 4; child-- > first;)
+                stack_.push_back(child);
+            continue;
+        }
+
+        if (flags & QuadtreePool::SPLIT_PENDING) {
+            for (auto& job : info.pendingChildren)
+                discardJob(job);
+            flags &= ~(QuadtreePool::SPLIT_PENDING | QuadtreePool::SPLIT_FORCED);
+        }
+        discardJob(info.pendingMesh);
+        if (nodes_.slot(node) != TerrainArena::INVALID_SLOT)
+            flags |= QuadtreePool::REFRESH_PENDING;
+        unsettle(node);
+    }
+}
+
+namespace {
+
+// UV bounds of child i (0..3), i.e. node firstChild + i
+void childBounds(const NodeInfo& node, int i,
+                 double& u0, double& u1, double& v0, double& v1) {
+    double uMid = (node.u0 + node.u1) * 0.5;
+    double vMid = (node.v0 + node.v1) * 0.5;
+    u0 = (i & 1) ? uMid : node.u0;
+    u1 = (i & 1) ? node.u1 : uMid;
+    v0 = (i & 2) ? vMid : node.v0;
+    v1 = (i & 2) ? node.v1 : vMid;
+}
+
+bool jobsGenerated(const std::array<std::shared_ptr<ChunkJob>, 4>& jobs) {
+    for (const auto& job : jobs) {
+        if (!job || !job->ready.load(std::memory_order_acquire)) return false;
+    }
+    return true;
+}
+
+bool jobsUploaded(const std::array<std::shared_ptr<ChunkJob>, 4>& jobs) {
+    for (const auto& job : jobs) {
+        if (!job || !job->isUploaded()) return false;
+    }
+    return true;
+}
+
+// How far the camera can move before a patch with `error` at `distance` can reach
+// `threshold`. The error goes with 1 / distance, and the distance changes by at
+// most as much as the camera moves.
+double thresholdMargin(double distance, double error, double threshold) {
+    return std::fabs(distance - distance * error / threshold);
+}
+
+// How far the camera can move before a leaf's geomorph factor changes by `slack`
+// of the error range it morphs over: moving x closer grows the error by
+// error * x / (distance - x). Clamped at either end, it holds until the threshold.
+double morphMargin(double distance, double error, double split, double merge, double slack) {
+    if (error <= merge) return thresholdMargin(distance, error, merge);
+    if (error >= split) return thresholdMargin(distance, error, split);
+    slack *= split - merge;
+    return distance * slack / (error + slack);
+}
+
+} // anonymous namespace
+
 void CubesphereBody::update(const glm::dvec3& cameraPos,
                              double fovY, double screenHeight,
-                             const glm::mat4& viewProj) {
+                             const glm::mat4& viewProj,
+                             const glm::dvec3& cameraVelocity,
+                             std::span<const glm::dvec3> predictedPath) {
+    PROFILE_SCOPE("lod update");
+    frameArena_.reset();
+    uint32_t lastLeaves = activeNodes_;
     activeNodes_ = 0;
-    batchCount_ = 0;
-    batchStarted_ = false;
+    pendingSplits_ = 0;
+    frameCounter_++;
+    stats_ = {};
+    stats_.frame = frameCounter_;
+    updatePrefetch(cameraPos, cameraVelocity);
+    uint32_t splitBudget = static_cast<uint32_t>(quality_.maxSplitsPerFrame * budgetScale_);
+
+    // Frame-invariant screen factor, shared by every error this frame
+    double pixelsPerRadian = screenHeight / (2.0 * std::tan(fovY * 0.5));
+
+    // Settled margins hold for this projection and threshold, judged from the
+    // camera alone; anything else re-judges every node
+    lodTravel_ += glm::length(cameraPos - lodCameraPos_);
+    lodCameraPos_ = cameraPos;
+    bool fullWalk = prefetching_ || pixelsPerRadian != walkPixelsPerRadian_ ||
+                    quality_.splitThreshold != walkSplitThreshold_;
+    walkPixelsPerRadian_ = pixelsPerRadian;
+    walkSplitThreshold_  = quality_.splitThreshold;
+
+    // Retire finished transfer batches so their meshes can be published below
+    uploader_->poll();
+
+    // A region arrived or left since last frame. The GPU sources never draw
+    // regions, and are not used while any is listed.
+    if (!displaced_ && !patchGenerator_ && luna::sim::terrainGeneration() != terrainGeneration_) {
+        changedBoxes_.clear();
+        terrainGeneration_ = luna::sim::terrainChangesSince(terrainGeneration_, changedBoxes_);
+        invalidateTerrain(changedBoxes_);
+    }
 
     glm::vec4 frustumPlanes[6];
     extractFrustumPlanes(viewProj, frustumPlanes);
 
-    luna::core::StagingBatch staging;
-    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    // Phase 1: walk entire tree collecting the splits and merges to work on. The
+    // list lives in the frame arena; most entries are split candidates, which are
+    // leaves, so last frame's leaf count is a good first size.
+    auto work = luna::util::makeArenaVector<LodWork>(frameArena_);
+    work.reserve(lastLeaves);
+    collectCandidates(cameraPos, pixelsPerRadian, frustumPlanes, fullWalk, work);
+
+    // Phase 2: install, upload and request, most urgent first, within the budget
+    runWork(work, cameraPos, pixelsPerRadian, quality_.lodBudgetMs * budgetScale_, splitBudget);
 
-    // Phase 1: walk entire tree collecting leaves that want to split.
-    // Merges happen immediately during traversal since they don't compete for budget.
-    std::vector<SplitCandidate> candidates;
-    for (auto& root : roots_) {
-        collectCandidates(*root, cameraPos, fovY, screenHeight, cmd, staging, frustumPlanes, candidates);
+    if (uploader_->isOpen()) {
+        uploader_->submit();
+        batchCount_ = 0;
     }
 
-    // Phase 2: sort candidates by screen error (highest first) so the most
-    // visually important splits happen regardless of which face they're on.
-    // This eliminates depth-first budget starvation that caused the seam.
-    std::sort(candidates.begin(), candidates.end(), [](const SplitCandidate& a, const SplitCandidate& b) {
-        return a.screenError > b.screenError;
-    });
+    if (!converged_ && stats_.candidates == 0 && pendingSplits_ == 0) {
+        converged_ = true;
+        auto elapsed = std::chrono::steady_clock::now() - startTime_;
+        LOG_INFO("Terrain LOD converged: %u leaves after %llu frames, %.0f ms",
+                 activeNodes_, static_cast<unsigned long long>(frameCounter_),
+                 std::chrono::duration<double, std::milli>(elapsed).count());
 
-    uint32_t splitBudget = MAX_SPLITS_PER_FRAME;
-    for (size_t i = 0; i < candidates.size(); i++) {
-        if (splitBudget < 4) {
-            // Remaining candidates stay as leaf nodes
-            activeNodes_ += static_cast<uint32_t>(candidates.size() - i);
-            break;
+        // Startup generation is done; the disk cache build no longer competes with it,
+        // and it yields the queue to splits and prefetch
+        if (!diskCacheBuildPath_.empty()) {
+            jobs_->submit([this, path = std::move(diskCacheBuildPath_),
+                           depth = diskCacheBuildDepth_, grid = quality_.patchGrid,
+                           hash = luna::sim::terrainContentHash()] {
+                PatchDiskCache::build(path, hash, radius_, grid, depth, stopping_);
+            }, luna::util::JobPriority::Background, &jobsPending_);
+            diskCacheBuildPath_.clear();
         }
-        splitNode(*candidates[i].node, cmd, staging);
-        activeNodes_ += 4;
-        splitBudget -= 4;
     }
 
-    if (batchStarted_) {
-        staging.end();
-        cmdPool_->endOneShot(cmd, ctx_->graphicsQueue());
+    updateStitching(fullWalk);
+
+    // Free slots once both their transfer copy and every frame that could
+    // have drawn them have retired
+    auto retired = [this](const DeferredSlot& d) {
+        if (!uploader_->isComplete(d.ticket) || frameCounter_ < d.retireFrame) return false;
+        arena_.free(d.slot);
+        return true;
+    };
+    deferredDestroy_.erase(std::remove_if(deferredDestroy_.begin(), deferredDestroy_.end(), retired),
+                           deferredDestroy_.end());
+    auto copied = [this](const StagedCopy& c) {
+        if (!uploader_->isComplete(c.ticket)) return false;
+        stagingSlots_->release(c.slot);
+        return true;
+    };
+    stagedCopies_.erase(std::remove_if(stagedCopies_.begin(), stagedCopies_.end(), copied),
+                        stagedCopies_.end());
+
+    // Cached and retained slots yield to live geometry: keep enough of the arena
+    // free or on its way back that two frames' worth of uploads never stall on
+    // them. Retained meshes pass through the cache on their way out.
+    size_t reserve = static_cast<size_t>(2 * quality_.maxSplitsPerFrame * budgetScale_);
+    size_t keep = retainedBudget_ / bytesPerMesh_;
+    size_t reclaimable = arena_.freeCount() + deferredDestroy_.size() + cache_.slotCount();
+    if (reclaimable < reserve)
+        keep = std::min(keep, retained_.size() - std::min(retained_.size(), reserve - reclaimable));
+    evictRetained(keep);
+    CachedPatch evicted;
+    while (arena_.freeCount() + deferredDestroy_.size() < reserve && cache_.evictSlot(evicted))
+        retireSlot(evicted.slot, evicted.uploadTicket);
+
+    // Finished prefetches wait in the patch cache like recently merged patches
+    for (auto it = prefetchJobs_.begin(); it != prefetchJobs_.end();) {
+        if (it->second->ready.load(std::memory_order_acquire)) {
+            cancelJob(it->second);
+            it = prefetchJobs_.erase(it);
+        } else {
+            ++it;
+        }
     }
 
-    // Amortize GPU resource destruction across frames to avoid hitches
-    uint32_t destroyCount = glm::min(static_cast<uint32_t>(deferredDestroy_.size()),
-                                      MAX_DESTROYS_PER_FRAME);
-    deferredDestroy_.erase(deferredDestroy_.begin(),
-                           deferredDestroy_.begin() + destroyCount);
+    // One point of the predicted path per frame, in turn, so the scan and the
+    // generation it queues are spread evenly over the horizon
+    if (!predictedPath.empty() && !displaced_ && !patchGenerator_ && cache_.budget() > 0) {
+        prefetchCursor_ = (prefetchCursor_ + 1) % predictedPath.size();
+        prefetchAround(predictedPath[prefetchCursor_], pixelsPerRadian);
+    }
+
+    stats_.leaves        = activeNodes_;
+    stats_.pendingSplits = pendingSplits_;
+    stats_.jobsInFlight  = inFlightJobs_.load(std::memory_order_relaxed);
+    stats_.prefetchJobs  = static_cast<uint32_t>(prefetchJobs_.size());
+    stats_.deferredSlots = static_cast<uint32_t>(deferredDestroy_.size());
+    stats_.liveMeshes    = arena_.slotCount() - arena_.freeCount() - stats_.deferredSlots;
+    stats_.liveMeshBytes = stats_.liveMeshes * bytesPerMesh_;
+    stats_.arenaBytes    = arena_.slotCount() * (bytesPerMesh_ + sizeof(PatchCenter))
+                         + topologyIndices_ * sizeof(uint16_t);
+    stats_.cachedPatches = cache_.entryCount();
+    stats_.cacheBytes    = cache_.bytesUsed();
+    stats_.retainedMeshes = static_cast<uint32_t>(retained_.size());
+    stats_.retainedBytes  = retainedMeshBytes();
+    stats_.patchesGenerated = patchesGenerated_.load(std::memory_order_relaxed);
 }
 
-void CubesphereBody::collectCandidates(QuadtreeNode& node, const glm::dvec3& cameraPos,
-                                        double fovY, double screenHeight,
-                                        VkCommandBuffer& cmd,
-                                        luna::core::StagingBatch& staging,
-                                        const glm::vec4 frustumPlanes[6],
-                                        std::vector<SplitCandidate>& candidates) {
-    double distance = glm::length(node.worldCenter - cameraPos);
-    distance = glm::max(distance, node.boundingRadius * 0.1);
+void CubesphereBody::beginTraversal() const {
+    // Reversed so face 0 is visited first
+    stack_.assign(roots_.rbegin(), roots_.rend());
+}
 
-    double patchArc = node.boundingRadius * 2.0;
-    double geometricError = patchArc / static_cast<double>(PATCH_GRID - 1);
-    double screenError = (geometricError / distance) *
-                         (screenHeight / (2.0 * std::tan(fovY * 0.5)));
+double CubesphereBody::screenError(NodeId n, const glm::dvec3& cameraPos,
+                                   double pixelsPerRadian) const {
+    return projectedError(nodes_.worldCenter(n), nodes_.boundingRadius(n), cameraPos, pixelsPerRadian,
+                          quality_.patchGrid);
+}
+
+double CubesphereBody::projectedError(const glm::dvec3& center, double boundingRadius,
+                                      const glm::dvec3& cameraPos, double pixelsPerRadian,
+                                      uint32_t patchGrid) {
+    double distance = glm::length(center - cameraPos);
+    distance = glm::max(distance, boundingRadius * 0.1);
+
+    double patchArc = boundingRadius * 2.0;
+    double geometricError = patchArc / static_cast<double>(patchGrid - 1);
+    return (geometricError / distance) * pixelsPerRadian;
+}
 
-    glm::vec3 offset = glm::vec3(node.worldCenter - cameraPos);
-    bool visible = sphereInFrustum(frustumPlanes, offset, static_cast<float>(node.boundingRadius));
+void CubesphereBody::prefetchAround(const glm::dvec3& point, double pixelsPerRadian) {
+    auto& stack = prefetchStack_;
+    stack.clear();
+    for (int face = 0; face < 6; face++) {
+        const NodeInfo& info = nodes_.info(roots_[face]);
+        stack.push_back({roots_[face], face, 0, info.u0, info.u1, info.v0, info.v1});
+    }
 
-    if (node.isLeaf()) {
-        if (visible && screenError > SPLIT_THRESHOLD && node.depth < MAX_DEPTH) {
-            candidates.push_back({&node, screenError});
+    uint32_t queued = 0;
+    while (!stack.empty() && queued < PREFETCH_JOBS_PER_FRAME &&
+           prefetchJobs_.size() < MAX_PREFETCH_JOBS) {
+        PrefetchRegion r = stack.back();
+        stack.pop_back();
+        if (r.depth >= MAX_DEPTH) continue;
+
+        bool       live = r.node != INVALID_NODE;
+        glm::dvec3 center;
+        double     boundingRadius;
+        if (live) {
+            center         = nodes_.worldCenter(r.node);
+            boundingRadius = nodes_.boundingRadius(r.node);
         } else {
-            activeNodes_++;
+            patchBounds(r.face, r.u0, r.u1, r.v0, r.v1, radius_, center, boundingRadius);
+        }
+        if (sphereBehindHorizon(center - point, boundingRadius, -point, radius_ - OCCLUDER_DEPTH) ||
+            projectedError(center, boundingRadius, point, pixelsPerRadian, quality_.patchGrid) <=
+                quality_.splitThreshold)
+            continue;
+
+        // The patch splits at `point`: its children are needed. Live ones exist, and
+        // a pending split is already generating them at full priority.
+        bool split   = live && !nodes_.isLeaf(r.node);
+        bool pending = live && (nodes_.flags(r.node) & QuadtreePool::SPLIT_PENDING);
+        double uMid = (r.u0 + r.u1) * 0.5;
+        double vMid = (r.v0 + r.v1) * 0.5;
+        for (int i = 4; i-- > 0;) {
+            PrefetchRegion child{INVALID_NODE, r.face, r.depth + 1,
+                                 (i & 1) ? uMid : r.u0, (i & 1) ? r.u1 : uMid,
+                                 (i & 2) ? vMid : r.v0, (i & 2) ? r.v1 : vMid};
+            if (split) {
+                child.node = nodes_.firstChild(r.node) + i;
+            } else if (!pending && queued < PREFETCH_JOBS_PER_FRAME) {
+                size_t before = prefetchJobs_.size();
+                queuePrefetch(child.face, child.depth, child.u0, child.u1, child.v0, child.v1);
+                queued += static_cast<uint32_t>(prefetchJobs_.size() - before);
+            }
+            stack.push_back(child);
+        }
+    }
+}
+
+double CubesphereBody::lodError(NodeId n, const glm::dvec3& cameraPos,
+                                double pixelsPerRadian) const {
+    double error = screenError(n, cameraPos, pixelsPerRadian);
+    if (prefetching_) error = glm::max(error, screenError(n, prefetchPos_, pixelsPerRadian));
+    return error;
+}
+
+void CubesphereBody::updatePrefetch(const glm::dvec3& cameraPos, const glm::dvec3& cameraVelocity) {
+    prefetching_ = false;
+    budgetScale_ = 1.0;
+
+    double r = glm::length(cameraPos);
+    if (r <= 0.0) return;
+    glm::dvec3 up = cameraPos / r;
+    double     altitude = glm::max(r - radius_, 1.0);
+    double     travel   = glm::length(cameraVelocity) * PREFETCH_SECONDS;
+    if (travel < altitude * PREFETCH_MIN_TRAVEL) return;
+
+    // Carry the camera along its great circle and climb or descend at its vertical
+    // rate — a straight line would leave the surface within one pass of an orbit
+    double     vertical   = glm::dot(cameraVelocity, up);
+    glm::dvec3 horizontal = cameraVelocity - vertical * up;
+    glm::dvec3 axis       = glm::cross(up, horizontal);
+    double     axisLength = glm::length(axis);
+    glm::dvec3 aheadDir   = up;
+    if (axisLength > 0.0) {
+        double arc = glm::min(glm::length(horizontal) * PREFETCH_SECONDS / r, MAX_PREFETCH_ARC);
+        aheadDir = glm::angleAxis(arc, axis / axisLength) * up;
+    }
+    double aheadRadius = glm::max(r + vertical * PREFETCH_SECONDS, radius_);
+
+    prefetchPos_ = aheadDir * aheadRadius;
+    prefetching_ = true;
+    budgetScale_ = glm::clamp(travel / altitude, 1.0, MAX_BUDGET_SCALE);
+}
+
+float CubesphereBody::morphFactor(NodeId n, double screenError) const {
+    if (nodes_.depth(n) == 0) return 0.0f;  // roots have no parent shape
+    // A split turns a leaf at the split threshold into children at about half its
+    // error (the merge threshold): they start at 1, and reach 0 where they would
+    // split in turn
+    double split = quality_.splitThreshold;
+    double t = (split - screenError) / (split - quality_.mergeThreshold);
+    return static_cast<float>(glm::clamp(t, 0.0, 1.0));
+}
+
+NodeId CubesphereBody::nodeAt(int face, double u, double v, uint32_t maxDepth) const {
+    NodeId n = roots_[face];
+    while (!nodes_.isLeaf(n) && nodes_.depth(n) < maxDepth) {
+        const NodeInfo& info = nodes_.info(n);
+        int i = (u >= (info.u0 + info.u1) * 0.5 ? 1 : 0) | (v >= (info.v0 + info.v1) * 0.5 ? 2 : 0);
+        n = nodes_.firstChild(n) + i;
+    }
+    return n;
+}
+
+NodeId CubesphereBody::neighbourAt(NodeId node, uint32_t edge, double t, uint32_t maxDepth) const {
+    const NodeInfo& info = nodes_.info(node);
+    // A short step past the edge: inside any neighbour at most one level finer, and
+    // small enough that crossing onto another face barely shifts it along the edge
+    double stepU = (info.u1 - info.u0) / 64.0;
+    double stepV = (info.v1 - info.v0) / 64.0;
+    double u = info.u0 + (info.u1 - info.u0) * t;
+    double v = info.v0 + (info.v1 - info.v0) * t;
+    switch (edge) {
+        case 0:  v = info.v0 - stepV; break;
+        case 1:  v = info.v1 + stepV; break;
+        case 2:  u = info.u0 - stepU; break;
+        default: u = info.u1 + stepU; break;
+    }
+
+    int face = info.faceIndex;
+    if (std::fabs(u) > 1.0 || std::fabs(v) > 1.0)
+        ChunkGenerator::sphereToFacePoint(ChunkGenerator::facePointToSphere(face, u, v), face, u, v);
+    return nodeAt(face, u, v, maxDepth);
+}
+
+NodeId CubesphereBody::coarserNeighbour(NodeId leaf) const {
+    uint32_t depth = nodes_.depth(leaf);
+    for (uint32_t edge = 0; edge < 4; edge++) {
+        NodeId n = neighbourAt(leaf, edge, 0.5, depth);
+        if (nodes_.depth(n) < depth) return n;
+    }
+    return INVALID_NODE;
+}
+
+bool CubesphereBody::canMerge(NodeId node, const glm::dvec3& cameraPos,
+                              double pixelsPerRadian) const {
+    // Two of the children's neighbours lie along each edge
+    uint32_t childDepth = nodes_.depth(node) + 1u;
+    for (uint32_t edge = 0; edge < 4; edge++) {
+        for (double t : {0.25, 0.75}) {
+            NodeId n = neighbourAt(node, edge, t, childDepth);
+            if (nodes_.depth(n) != childDepth) continue;
+            if (!nodes_.isLeaf(n) || (nodes_.flags(n) & QuadtreePool::SPLIT_PENDING)) return false;
+            if (childDepth < MAX_DEPTH && lodError(n, cameraPos, pixelsPerRadian) > quality_.splitThreshold)
+                return false;
+        }
+    }
+    return true;
+}
+
+void CubesphereBody::updateStitching(bool fullWalk) {
+    // A changed leaf takes eight neighbour lookups to expand and four per leaf
+    // restitched, so past a quarter of the leaves the whole tree is cheaper
+    if (fullWalk || restitch_.size() * 4 > activeNodes_) {
+        restitch_.clear();
+        beginTraversal();
+        while (!stack_.empty()) {
+            NodeId node = stack_.back();
+            stack_.pop_back();
+            if (nodes_.isLeaf(node)) {
+                stitchLeaf(node);
+                continue;
+            }
+            NodeId first = nodes_.firstChild(node);
+            for (NodeId child = first + 4; child-- > first;)
+                stack_.push_back(child);
         }
         return;
     }
 
-    // Interior node — check if we should merge children back
-    bool allChildrenLeaves = true;
-    double maxChildError = 0.0;
-    for (auto& child : node.children) {
-        if (!child || !child->isLeaf()) {
-            allChildrenLeaves = false;
+    // A changed leaf's edges are shared with the leaves across them, coarser, as
+    // deep, or one level finer (two per edge). Queued nodes split since are
+    // interior now; their children were queued in their place.
+    size_t changed = restitch_.size();
+    for (size_t i = 0; i < changed; i++) {
+        NodeId node = restitch_[i];
+        if (!nodes_.isLeaf(node)) continue;
+        uint32_t finer = nodes_.depth(node) + 1u;
+        for (uint32_t edge = 0; edge < 4; edge++)
+            for (double t : {0.25, 0.75})
+                restitch_.push_back(neighbourAt(node, edge, t, finer));
+    }
+    std::sort(restitch_.begin(), restitch_.end());
+    restitch_.erase(std::unique(restitch_.begin(), restitch_.end()), restitch_.end());
+    for (NodeId node : restitch_)
+        if (nodes_.isLeaf(node)) stitchLeaf(node);
+    restitch_.clear();
+}
+
+void CubesphereBody::stitchLeaf(NodeId node) {
+    // Coarser: stitch, so the odd edge vertices go unused. Finer: their even
+    // vertices are ours where we stay unmorphed. Same depth: both sides blend
+    // the shared edge by the larger of the two factors.
+    uint32_t depth = nodes_.depth(node);
+    uint8_t stitch = 0;
+    glm::vec4 edgeMorph(0.0f);
+    for (uint32_t edge = 0; edge < 4; edge++) {
+        NodeId n = neighbourAt(node, edge, 0.5, depth);
+        if (nodes_.depth(n) < depth)
+            stitch |= static_cast<uint8_t>(1u << edge);
+        else if (nodes_.isLeaf(n))
+            edgeMorph[edge] = glm::max(nodes_.morph(node), nodes_.morph(n));
+    }
+    nodes_.stitch(node) = stitch;
+    nodes_.edgeMorph(node) = edgeMorph;
+}
+
+void CubesphereBody::unsettle(NodeId node) {
+    const NodeInfo& info = nodes_.info(node);
+    double u = (info.u0 + info.u1) * 0.5;
+    double v = (info.v0 + info.v1) * 0.5;
+    NodeId n = roots_[info.faceIndex];
+    for (;;) {
+        nodes_.stableTravel(n) = 0.0;
+        if (n == node || nodes_.isLeaf(n)) break;
+        const NodeInfo& ni = nodes_.info(n);
+        int i = (u >= (ni.u0 + ni.u1) * 0.5 ? 1 : 0) | (v >= (ni.v0 + ni.v1) * 0.5 ? 2 : 0);
+        n = nodes_.firstChild(n) + i;
+    }
+}
+
+void CubesphereBody::collectCandidates(const glm::dvec3& cameraPos, double pixelsPerRadian,
+                                        const glm::vec4 frustumPlanes[6], bool fullWalk,
+                                        luna::util::ArenaVector<LodWork>& work) {
+    // projectedError() with its per-frame factors taken out of the loop
+    const double errorScale = 2.0 * pixelsPerRadian / static_cast<double>(quality_.patchGrid - 1);
+    auto distanceOf = [&](NodeId n, const glm::dvec3& from) {
+        return glm::max(glm::length(nodes_.worldCenter(n) - from), nodes_.boundingRadius(n) * 0.1);
+    };
+    auto errorAt = [&](NodeId n, double distance) {
+        return nodes_.boundingRadius(n) * errorScale / distance;
+    };
+    auto lodErrorOf = [&](NodeId n) {
+        double error = errorAt(n, distanceOf(n, cameraPos));
+        if (prefetching_) error = glm::max(error, errorAt(n, distanceOf(n, prefetchPos_)));
+        return error;
+    };
+    const Horizon horizon = horizonFrom(-cameraPos, radius_ - OCCLUDER_DEPTH);
+    const Horizon aheadHorizon = horizonFrom(-prefetchPos_, radius_ - OCCLUDER_DEPTH);
+
+    const double split = quality_.splitThreshold;
+    const double merge = quality_.mergeThreshold;
+    const double travel = lodTravel_;
+    const uint32_t frame = static_cast<uint32_t>(frameCounter_);
+    constexpr double UNBOUNDED = std::numeric_limits<double>::infinity();
+    // Stack entry for a node whose children have been walked: fold their margins in
+    constexpr NodeId SUBTREE_DONE = 1u << 31;
+    // Stack entry for a child whose parent's merge is queued for install: the merge
+    // would free it, so it gets no work of its own this frame
+    constexpr NodeId PARENT_MERGING = 1u << 30;
+
+    auto settled = [&](NodeId n) {
+        return !fullWalk && travel < nodes_.stableTravel(n) &&
+               static_cast<int32_t>(nodes_.stableFrame(n) - frame) > 0;
+    };
+    auto settle = [&](NodeId n, double margin) {
+        nodes_.stableTravel(n) = travel + margin;
+        nodes_.stableFrame(n)  = frame + REVISIT_FRAMES + n % REVISIT_FRAMES;
+    };
+    auto settleLeaf = [&](NodeId n, double margin) {
+        settle(n, margin);
+        nodes_.subtreeLeaves(n) = 1;
+        nodes_.subtreeDepth(n)  = nodes_.depth(n);
+    };
+
+    beginTraversal();
+    while (!stack_.empty()) {
+        NodeId entry = stack_.back();
+        stack_.pop_back();
+
+        if (entry & SUBTREE_DONE) {
+            NodeId node = entry & ~SUBTREE_DONE;
+            NodeId first = nodes_.firstChild(node);
+            double   until   = nodes_.stableTravel(node);
+            uint32_t revisit = nodes_.stableFrame(node);
+            uint32_t leaves  = 0;
+            uint8_t  deepest = 0;
+            for (NodeId child = first; child < first + 4; child++) {
+                until = glm::min(until, nodes_.stableTravel(child));
+                if (static_cast<int32_t>(nodes_.stableFrame(child) - revisit) < 0)
+                    revisit = nodes_.stableFrame(child);
+                leaves += nodes_.subtreeLeaves(child);
+                deepest = std::max(deepest, nodes_.subtreeDepth(child));
+            }
+            nodes_.stableTravel(node)  = until;
+            nodes_.stableFrame(node)   = revisit;
+            nodes_.subtreeLeaves(node) = leaves;
+            nodes_.subtreeDepth(node)  = deepest;
+            continue;
+        }
+
+        bool parentMerging = entry & PARENT_MERGING;
+        NodeId node = entry & ~PARENT_MERGING;
+        if (settled(node)) {
+            activeNodes_ += nodes_.subtreeLeaves(node);
+            stats_.maxDepth = std::max<uint32_t>(stats_.maxDepth, nodes_.subtreeDepth(node));
+            stats_.subtreesSkipped++;
+            continue;
+        }
+        stats_.nodesVisited++;
+
+        double distance = distanceOf(node, cameraPos);
+        double screenError = errorAt(node, distance);
+        glm::dvec3 offset = nodes_.worldCenter(node) - cameraPos;
+        double boundingRadius = nodes_.boundingRadius(node);
+        bool hidden  = sphereBehindHorizon(offset, boundingRadius, horizon);
+        bool visible = !hidden &&
+                       sphereInFrustum(frustumPlanes, glm::vec3(offset),
+                                       static_cast<float>(boundingRadius));
+        // Over the horizon from the prefetch point: the camera is about to see it
+        bool ahead   = prefetching_ &&
+                       !sphereBehindHorizon(nodes_.worldCenter(node) - prefetchPos_, boundingRadius,
+                                            aheadHorizon);
+        uint8_t& flags = nodes_.flags(node);
+
+        if (nodes_.isLeaf(node)) {
+            activeNodes_++;
+            stats_.maxDepth = std::max<uint32_t>(stats_.maxDepth, nodes_.depth(node));
+            float morph = morphFactor(node, screenError);
+            if (morph != nodes_.morph(node)) restitch_.push_back(node);
+            nodes_.morph(node) = morph;
+            // Drawn from heights that have since changed; the merge frees it if one
+            // is queued, and a split replaces it along with its mesh
+            if ((flags & QuadtreePool::REFRESH_PENDING) && !parentMerging) {
+                ChunkJob* job = nodes_.info(node).pendingMesh.get();
+                double priority = screenError / split;
+                if (!job)
+                    work.push_back({node, LodWorkKind::RequestRefresh, priority});
+                else if (job->isUploaded() && jobResident(*job))
+                    work.push_back({node, LodWorkKind::InstallRefresh, priority});
+                else if (!job->isUploaded() && job->ready.load(std::memory_order_acquire))
+                    work.push_back({node, LodWorkKind::UploadRefresh, priority});
+            }
+            if (flags & QuadtreePool::SPLIT_PENDING) {
+                pendingSplits_++;
+                auto& jobs = nodes_.info(node).pendingChildren;
+                double lodError = lodErrorOf(node);
+                // Camera backed off before the children arrived — drop the request
+                if (lodError < split && !(flags & QuadtreePool::SPLIT_FORCED)) {
+                    for (auto& job : jobs)
+                        cancelJob(job);
+                    flags &= ~QuadtreePool::SPLIT_PENDING;
+                } else if (parentMerging) {
+                    // the merge cancels it
+                } else if (std::all_of(jobs.begin(), jobs.end(), [this](const auto& job) {
+                               return job && jobResident(*job);
+                           })) {
+                    work.push_back({node, LodWorkKind::InstallSplit, lodError / split});
+                } else if (!jobsUploaded(jobs) && jobsGenerated(jobs)) {
+                    work.push_back({node, LodWorkKind::UploadSplit, lodError / split});
+                }
+            } else if (nodes_.depth(node) < MAX_DEPTH && !parentMerging) {
+                if (visible && screenError > split) {
+                    work.push_back({node, LodWorkKind::RequestSplit, screenError / split});
+                    stats_.candidates++;
+                } else if (ahead) {
+                    double aheadError = errorAt(node, distanceOf(node, prefetchPos_));
+                    if (aheadError > split) {
+                        work.push_back({node, LodWorkKind::RequestSplit,
+                                        aheadError / split * PREFETCH_PRIORITY});
+                        stats_.candidates++;
+                    }
+                }
+            }
+
+            // Settled: nothing in flight, and under the split threshold. One over
+            // it but out of view becomes a candidate as soon as the camera turns.
+            double margin = 0.0;
+            bool deepest = nodes_.depth(node) >= MAX_DEPTH;
+            constexpr uint8_t IN_FLIGHT = QuadtreePool::SPLIT_PENDING | QuadtreePool::REFRESH_PENDING;
+            if (!(flags & IN_FLIGHT) && (deepest || screenError <= split)) {
+                margin = morphMargin(distance, screenError, split, merge, MORPH_TOLERANCE);
+                if (!deepest) margin = glm::min(margin, thresholdMargin(distance, screenError, split));
+            }
+            settleLeaf(node, margin);
+            continue;
+        }
+
+        // Interior node — check if we should merge children back. The merge needs
+        // every child under the threshold, so it is as far off as the child that
+        // is furthest from it.
+        NodeId first = nodes_.firstChild(node);
+        bool allChildrenLeaves = true;
+        double maxChildError = 0.0;
+        double mergeMargin = 0.0;
+        for (NodeId child = first; child < first + 4; child++) {
+            if (!nodes_.isLeaf(child)) {
+                allChildrenLeaves = false;
+                break;
+            }
+            double childDistance = distanceOf(child, cameraPos);
+            double childError = errorAt(child, childDistance);
+            maxChildError = glm::max(maxChildError, prefetching_ ? lodErrorOf(child) : childError);
+            if (childError >= merge)
+                mergeMargin = glm::max(mergeMargin, thresholdMargin(childDistance, childError, merge));
+        }
+
+        // A subtree entirely behind the limb cannot be seen from here or from ahead,
+        // so collapse it regardless of distance; it splits again if it comes back
+        // over the horizon
+        bool mergeWanted = allChildrenLeaves &&
+                           ((hidden && !ahead) || maxChildError < merge);
+        bool merging = false;
+        if (mergeWanted && canMerge(node, cameraPos, pixelsPerRadian)) {
+            double priority = maxChildError > 0.0 ? merge / maxChildError : UNBOUNDED;
+            if (hidden && !ahead) priority = glm::max(priority, 1.0);
+            ChunkJob* job = nodes_.info(node).pendingMesh.get();
+            // Displaced patches need no parent mesh
+            if (displaced_ || nodes_.slot(node) != TerrainArena::INVALID_SLOT ||
+                (job && job->isUploaded() && jobResident(*job))) {
+                work.push_back({node, LodWorkKind::InstallMerge, priority});
+                merging = true;
+            } else if (!job) {
+                work.push_back({node, LodWorkKind::RequestMerge, priority});
+            } else if (!job->isUploaded() && job->ready.load(std::memory_order_acquire)) {
+                work.push_back({node, LodWorkKind::UploadMerge, priority});
+            }
+            // Otherwise the parent mesh is still generating or uploading — the
+            // children keep drawing in the meantime
+        } else if (flags & QuadtreePool::MERGE_PENDING) {
+            cancelJob(nodes_.info(node).pendingMesh);
+            flags &= ~QuadtreePool::MERGE_PENDING;
+        }
+
+        // A wanted merge is in progress or waits on the neighbours: revisit next
+        // frame. Otherwise the children's own margins decide.
+        double margin = UNBOUNDED;
+        if (mergeWanted)
+            margin = 0.0;
+        else if (allChildrenLeaves)
+            margin = prefetching_ ? 0.0 : mergeMargin;
+        settle(node, margin);
+
+        stack_.push_back(node | SUBTREE_DONE);
+        for (NodeId child = first + 4; child-- > first;)
+            stack_.push_back(merging ? child | PARENT_MERGING : child);
+    }
+}
+
+void CubesphereBody::runWork(luna::util::ArenaVector<LodWork>& work, const glm::dvec3& cameraPos,
+                             double pixelsPerRadian, double budgetMs, uint32_t splitBudget) {
+    // Stage first: finishing what is resident frees slots and jobs for the rest.
+    // Within a stage, merges and splits go by how far past their threshold they are,
+    // so the most visible error is fixed first whichever face it is on.
+    std::sort(work.begin(), work.end(), [](const LodWork& a, const LodWork& b) {
+        if (a.stage() != b.stage()) return a.stage() < b.stage();
+        return a.priority > b.priority;
+    });
+
+    // A candidate next to a coarser leaf splits that leaf first (2:1 restriction)
+    // and follows once it has. Earlier splits this frame may have taken a candidate.
+    auto splitTarget = [this](NodeId node, bool& forced) {
+        NodeId target = node;
+        for (NodeId coarser; (coarser = coarserNeighbour(target)) != INVALID_NODE;)
+            target = coarser;
+        forced = target != node;
+        if (!nodes_.isLeaf(target) || (nodes_.flags(target) & QuadtreePool::SPLIT_PENDING))
+            return INVALID_NODE;
+        return target;
+    };
+
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                             std::chrono::duration<double, std::milli>(budgetMs));
+    uint32_t meshBudget = splitBudget;
+    size_t done = 0;
+    for (; done < work.size(); done++) {
+        if (done > 0 && Clock::now() >= deadline) break;
+        const LodWork& item = work[done];
+        NodeId node = item.node;
+
+        switch (item.kind) {
+        case LodWorkKind::InstallSplit: {
+            // Children start from the morph their error calls for — near 1, the
+            // parent's shape — so the split itself does not pop
+            installChildren(node);
+            NodeId first = nodes_.firstChild(node);
+            for (NodeId child = first; child < first + 4; child++)
+                nodes_.morph(child) = morphFactor(child, screenError(child, cameraPos, pixelsPerRadian));
+            activeNodes_ += 3;  // one leaf replaced by four
+            stats_.splits++;
             break;
         }
-        double childDist = glm::length(child->worldCenter - cameraPos);
-        childDist = glm::max(childDist, child->boundingRadius * 0.1);
-        double childArc = child->boundingRadius * 2.0;
-        double childGeoError = childArc / static_cast<double>(PATCH_GRID - 1);
-        double childScreenError = (childGeoError / childDist) *
-                                  (screenHeight / (2.0 * std::tan(fovY * 0.5)));
-        maxChildError = glm::max(maxChildError, childScreenError);
-    }
-
-    if (allChildrenLeaves && maxChildError < MERGE_THRESHOLD) {
-        if (!node.hasMesh()) {
-            generateMeshBatched(node, cmd, staging);
+        case LodWorkKind::InstallMerge:
+            if (installMerge(node, cameraPos, pixelsPerRadian)) stats_.merges++;
+            break;
+        case LodWorkKind::InstallRefresh:
+            // A split installed earlier this frame may have taken the leaf
+            if (!nodes_.isLeaf(node) || !(nodes_.flags(node) & QuadtreePool::REFRESH_PENDING)) break;
+            installRefresh(node);
+            stats_.refreshes++;
+            break;
+        case LodWorkKind::UploadSplit:
+            // Generated on a worker; this only records copies into the transfer batch
+            if (meshBudget < 4 || arena_.freeCount() < 4) break;  // uploaded next frame
+            for (auto& job : nodes_.info(node).pendingChildren)
+                if (!job->isUploaded()) uploadJob(*job);  // cache hits may already hold a slot
+            meshBudget -= 4;
+            break;
+        case LodWorkKind::UploadMerge:
+        case LodWorkKind::UploadRefresh:
+            if (meshBudget < 1 || arena_.freeCount() < 1) break;
+            uploadJob(*nodes_.info(node).pendingMesh);
+            meshBudget -= 1;
+            break;
+        case LodWorkKind::RequestSplit: {
+            if (meshBudget < 4 && !displaced_) break;
+            bool forced;
+            NodeId target = splitTarget(node, forced);
+            if (target == INVALID_NODE) break;
+            // Displaced patches are complete as soon as they exist: no meshes to count
+            if (displaced_) {
+                splitInPlace(target);
+                activeNodes_ += 3;
+                stats_.splits++;
+                break;
+            }
+            if (inFlightJobs_.load(std::memory_order_relaxed) + 4 > MAX_PENDING_JOBS) break;
+            requestSplit(target, forced);
+            stats_.splitsRequested++;
+            meshBudget -= 4;
+            break;
+        }
+        case LodWorkKind::RequestMerge: {
+            if (inFlightJobs_.load(std::memory_order_relaxed) + 1 > MAX_PENDING_JOBS) break;
+            NodeInfo& info = nodes_.info(node);
+            info.pendingMesh = acquireJob(info.faceIndex, nodes_.depth(node),
+                                          info.u0, info.u1, info.v0, info.v1);
+            nodes_.flags(node) |= QuadtreePool::MERGE_PENDING;
+            break;
         }
-        for (auto& child : node.children) {
-            if (child && child->mesh)
-                deferredDestroy_.push_back(std::move(child->mesh));
-            child.reset();
+        case LodWorkKind::RequestRefresh: {
+            // A region can touch hundreds of leaves at once: refreshes share the
+            // split budget rather than flooding the workers
+            if (meshBudget < 1) break;
+            if (inFlightJobs_.load(std::memory_order_relaxed) + 1 > MAX_PENDING_JOBS) break;
+            NodeInfo& info = nodes_.info(node);
+            info.pendingMesh = acquireJob(info.faceIndex, nodes_.depth(node),
+                                          info.u0, info.u1, info.v0, info.v1);
+            meshBudget -= 1;
+            break;
         }
-        activeNodes_++;
-    } else {
-        for (auto& child : node.children) {
-            if (child)
-                collectCandidates(*child, cameraPos, fovY, screenHeight, cmd, staging, frustumPlanes, candidates);
         }
     }
+    stats_.workQueued   = static_cast<uint32_t>(work.size());
+    stats_.workDeferred = static_cast<uint32_t>(work.size() - done);
 }
 
-void CubesphereBody::splitNode(QuadtreeNode& node, VkCommandBuffer& cmd,
-                                luna::core::StagingBatch& staging) {
-    double uMid = (node.u0 + node.u1) * 0.5;
-    double vMid = (node.v0 + node.v1) * 0.5;
+bool CubesphereBody::installMerge(NodeId node, const glm::dvec3& cameraPos, double pixelsPerRadian) {
+    // Splits installed earlier this frame may have changed the children or the
+    // neighbours the walk checked
+    NodeId first = nodes_.firstChild(node);
+    for (NodeId child = first; child < first + 4; child++)
+        if (!nodes_.isLeaf(child)) return false;
+    if (!canMerge(node, cameraPos, pixelsPerRadian)) return false;
 
-    node.children[0] = std::make_unique<QuadtreeNode>();
-    node.children[1] = std::make_unique<QuadtreeNode>();
-    node.children[2] = std::make_unique<QuadtreeNode>();
-    node.children[3] = std::make_unique<QuadtreeNode>();
+    if (nodes_.slot(node) != TerrainArena::INVALID_SLOT) {
+        // Retained since its split: nothing to generate or upload
+        auto it = std::find_if(retained_.begin(), retained_.end(),
+                               [node](const RetainedMesh& r) { return r.node == node; });
+        if (it != retained_.end()) {
+            *it = retained_.back();
+            retained_.pop_back();
+        }
+    } else if (!displaced_) {
+        NodeInfo& info = nodes_.info(node);
+        ChunkJob& job = *info.pendingMesh;
+        nodes_.worldCenter(node)   = job.data.worldCenter;
+        nodes_.positionScale(node) = job.data.positionScale;
+        nodes_.slot(node) = job.slot;
+        job.slot = TerrainArena::INVALID_SLOT;
+        info.pendingMesh.reset();
+        nodes_.flags(node) &= ~QuadtreePool::MERGE_PENDING;
+    }
 
-    initNode(*node.children[0], node.faceIndex, node.u0, uMid, node.v0, vMid, node.depth + 1);
-    initNode(*node.children[1], node.faceIndex, uMid, node.u1, node.v0, vMid, node.depth + 1);
-    initNode(*node.children[2], node.faceIndex, node.u0, uMid, vMid, node.v1, node.depth + 1);
-    initNode(*node.children[3], node.faceIndex, uMid, node.u1, vMid, node.v1, node.depth + 1);
+    releaseChildren(node);
+    nodes_.morph(node) = morphFactor(node, screenError(node, cameraPos, pixelsPerRadian));
+    activeNodes_ -= 3;  // four leaves replaced by one
+    restitch_.push_back(node);
+    // A leaf now: its ancestors' leaf counts are stale until the walk recounts them
+    nodes_.subtreeLeaves(node) = 1;
+    nodes_.subtreeDepth(node)  = nodes_.depth(node);
+    unsettle(node);
+    return true;
+}
 
-    for (auto& child : node.children) {
-        generateMeshBatched(*child, cmd, staging);
+void CubesphereBody::installRefresh(NodeId node) {
+    // Frames in flight may still draw the stale mesh; it is not worth caching
+    retireSlot(nodes_.slot(node));
+    NodeInfo& info = nodes_.info(node);
+    ChunkJob& job = *info.pendingMesh;
+    nodes_.worldCenter(node)   = job.data.worldCenter;
+    nodes_.positionScale(node) = job.data.positionScale;
+    nodes_.slot(node) = job.slot;
+    job.slot = TerrainArena::INVALID_SLOT;
+    info.pendingMesh.reset();
+    nodes_.flags(node) &= ~QuadtreePool::REFRESH_PENDING;
+    restitch_.push_back(node);
+    unsettle(node);
+}
+
+void CubesphereBody::requestSplit(NodeId node, bool forced) {
+    NodeInfo& info = nodes_.info(node);
+    uint32_t depth = nodes_.depth(node) + 1u;
+    for (int i = 0; i < 4; i++) {
+        double u0, u1, v0, v1;
+        childBounds(info, i, u0, u1, v0, v1);
+        info.pendingChildren[i] = acquireJob(info.faceIndex, depth, u0, u1, v0, v1);
+    }
+    nodes_.flags(node) |= QuadtreePool::SPLIT_PENDING;
+    if (forced) nodes_.flags(node) |= QuadtreePool::SPLIT_FORCED;
+    unsettle(node);  // a forced split may sit in a skipped subtree
+}
+
+void CubesphereBody::installChildren(NodeId node) {
+    // Allocate first: growing the pool invalidates references into it
+    NodeId first = nodes_.allocateSiblings();
+    nodes_.firstChild(node) = first;
+
+    auto jobs = std::move(nodes_.info(node).pendingChildren);
+    bool stale = nodes_.flags(node) & QuadtreePool::REFRESH_PENDING;
+    nodes_.flags(node) &= ~(QuadtreePool::SPLIT_PENDING | QuadtreePool::SPLIT_FORCED |
+                            QuadtreePool::REFRESH_PENDING);
+    // The children replace the stale mesh; a regenerated one is still worth caching
+    cancelJob(nodes_.info(node).pendingMesh);
+
+    uint32_t depth = nodes_.depth(node) + 1u;
+    int face = nodes_.info(node).faceIndex;
+    for (int i = 0; i < 4; i++) {
+        ChunkJob& job = *jobs[i];
+        NodeId child = first + i;
+        initNode(child, face, job.u0, job.u1, job.v0, job.v1, depth);
+        nodes_.worldCenter(child) = job.data.worldCenter;
+        nodes_.positionScale(child) = job.data.positionScale;
+        nodes_.slot(child) = job.slot;
+        job.slot = TerrainArena::INVALID_SLOT;
+        restitch_.push_back(child);
     }
 
-    if (node.mesh)
-        deferredDestroy_.push_back(std::move(node.mesh));
+    // Kept for an instant merge while the budget allows; update() trims the excess
+    if (stale)
+        retireSlot(nodes_.slot(node));
+    else if (retainedBudget_ > 0)
+        retained_.push_back({node, frameCounter_});
+    else
+        retireNode(node);
+    unsettle(node);
+}
+
+void CubesphereBody::splitInPlace(NodeId node) {
+    // Allocate first: growing the pool invalidates references into it
+    NodeId first = nodes_.allocateSiblings();
+    nodes_.firstChild(node) = first;
+
+    const NodeInfo& info = nodes_.info(node);
+    uint32_t depth = nodes_.depth(node) + 1u;
+    for (int i = 0; i < 4; i++) {
+        double u0, u1, v0, v1;
+        childBounds(info, i, u0, u1, v0, v1);
+        initNode(first + i, info.faceIndex, u0, u1, v0, v1, depth);
+        restitch_.push_back(first + i);
+    }
+    unsettle(node);
+}
+
+void CubesphereBody::releaseChildren(NodeId node) {
+    NodeId first = nodes_.firstChild(node);
+    for (NodeId child = first; child < first + 4; child++) {
+        // A stale mesh is not worth caching; its regenerated replacement is
+        if (nodes_.flags(child) & QuadtreePool::REFRESH_PENDING)
+            retireSlot(nodes_.slot(child));
+        else
+            retireNode(child);
+        cancelJob(nodes_.info(child).pendingMesh);
+        for (auto& job : nodes_.info(child).pendingChildren)
+            cancelJob(job);
+    }
+    nodes_.freeSiblings(first);
+    nodes_.firstChild(node) = INVALID_NODE;
 }
 
 void CubesphereBody::extractFrustumPlanes(const glm::mat4& vp, glm::vec4 planes[6]) {
@@ -293,66 +1619,267 @@ bool CubesphereBody::sphereInFrustum(const glm::vec4 planes[6],
     return true;
 }
 
-void CubesphereBody::draw(VkCommandBuffer cmd, VkPipelineLayout layout,
-                           const glm::mat4& viewProj,
-                           const glm::dvec3& cameraPos,
-                           const glm::vec4& sunDirection) const {
-    glm::vec4 frustumPlanes[6];
-    extractFrustumPlanes(viewProj, frustumPlanes);
+bool CubesphereBody::sphereBehindHorizon(const glm::dvec3& center, double radius,
+                                         const glm::dvec3& moonCenter, double occluderRadius) {
+    return sphereBehindHorizon(center, radius, horizonFrom(moonCenter, occluderRadius));
+}
+
+CubesphereBody::Horizon CubesphereBody::horizonFrom(const glm::dvec3& moonCenter,
+                                                    double occluderRadius) {
+    Horizon h{};
+    double d = glm::length(moonCenter);
+    double R = occluderRadius;
+    h.outside = d > R;
+    if (!h.outside) return h;
+
+    // The horizon circle lies in the plane R²/d from the moon center toward the camera
+    h.moonCenter    = moonCenter;
+    h.toCamera      = -moonCenter / d;
+    h.planeDistance = R * R / d;
+    h.coneHalfAngle = std::asin(R / d);
+    return h;
+}
+
+bool CubesphereBody::sphereBehindHorizon(const glm::dvec3& center, double radius,
+                                         const Horizon& horizon) {
+    // Same test as terrain_cull.comp, in double precision
+    if (!horizon.outside) return false;
+    double planeDist = glm::dot(center - horizon.moonCenter, horizon.toCamera);
+    if (planeDist + radius > horizon.planeDistance) return false;
+
+    // Fully beyond the horizon plane: hidden only if also inside the occluder's cone
+    double dist = glm::length(center);
+    if (dist <= radius) return false;
+    double cosAngle = glm::clamp(glm::dot(center / dist, -horizon.toCamera), -1.0, 1.0);
+    return std::acos(cosAngle) + std::asin(radius / dist) < horizon.coneHalfAngle;
+}
+
+void CubesphereBody::prepareDraw(uint32_t frame, const glm::mat4& viewProj,
+                                 const glm::dvec3& cameraPos, const glm::vec4& sunDirection) {
+    // The frame fence has retired this region's previous contents. The layout is the
+    // same every frame, so the allocations cannot fail.
+    frameRing_.begin(frame);
+    TerrainFrame* constants = frameRing_.allocate<TerrainFrame>(1, frameOffsets_[0]);
+    frameRecords_           = frameRing_.allocate<PatchRecord>(ARENA_SLOTS, frameOffsets_[1]);
+    constants->viewProj       = viewProj;
+    constants->sunDirection   = sunDirection;
+    constants->cameraWorldPos = glm::vec3(cameraPos);
+    constants->patchGrid      = quality_.patchGrid;
+    glm::vec3 cameraHigh, cameraLow;
+    luna::util::splitDouble(cameraPos, cameraHigh, cameraLow);
+    constants->cameraHigh     = glm::vec4(cameraHigh, 0.0f);
+    constants->cameraLow      = glm::vec4(cameraLow, 0.0f);
+
+    extractFrustumPlanes(viewProj, drawFrustum_);
+    drawCameraPos_ = cameraPos;
+    nextRecord_.store(0, std::memory_order_relaxed);
 
-    for (const auto& root : roots_) {
-        drawNode(*root, cmd, layout, viewProj, cameraPos, sunDirection, frustumPlanes);
+    // Faces facing the camera most directly hold the nearest terrain
+    std::iota(faceOrder_.begin(), faceOrder_.end(), 0u);
+    if (depthSort_) {
+        glm::dvec3 up = glm::normalize(cameraPos);
+        std::array<double, FACE_COUNT> facing;
+        for (uint32_t face = 0; face < FACE_COUNT; face++)
+            facing[face] = glm::dot(up, glm::normalize(nodes_.worldCenter(roots_[face])));
+        std::sort(faceOrder_.begin(), faceOrder_.end(),
+                  [&facing](uint32_t a, uint32_t b) { return facing[a] > facing[b]; });
     }
 }
 
-void CubesphereBody::drawNode(const QuadtreeNode& node, VkCommandBuffer cmd,
-                               VkPipelineLayout layout,
-                               const glm::mat4& viewProj,
-                               const glm::dvec3& cameraPos,
-                               const glm::vec4& sunDirection,
-                               const glm::vec4 frustumPlanes[6]) const {
-    // Frustum cull: test bounding sphere in camera-relative space
-    glm::vec3 offset = glm::vec3(node.worldCenter - cameraPos);
-    if (!sphereInFrustum(frustumPlanes, offset, static_cast<float>(node.boundingRadius))) {
+void CubesphereBody::draw(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t frame,
+                           const glm::mat4& viewProj,
+                           const glm::dvec3& cameraPos,
+                           const glm::vec4& sunDirection) {
+    prepareDraw(frame, viewProj, cameraPos, sunDirection);
+    for (uint32_t i = 0; i < FACE_COUNT; i++)
+        drawFace(cmd, layout, faceInDrawOrder(i));
+}
+
+void CubesphereBody::drawFace(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t face) {
+    FaceScratch& scratch = faceScratch_[face];
+    collectVisibleLeaves(roots_[face], scratch);
+    if (scratch.leaves.empty()) return;
+
+    bindFrameSet(cmd, layout);
+    if (displaced_) {
+        drawDisplacedLeaves(cmd, layout, scratch.leaves);
         return;
     }
 
-    if (node.isLeaf()) {
-        if (node.hasMesh()) {
-            TerrainPC pc{};
-            pc.viewProj = viewProj;
-            pc.cameraOffset = offset;
-            pc.sunDirection = sunDirection;
-            pc.cameraWorldPos = glm::vec3(cameraPos);
+    // Every patch lives in the arena, so geometry is bound once per command buffer.
+    // Faces claim their record ranges in whatever order they finish culling; each draw
+    // finds its record through firstInstance.
+    arena_.bind(cmd);
+    uint32_t count = static_cast<uint32_t>(scratch.leaves.size());
+    uint32_t first = nextRecord_.fetch_add(count, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < count; i++) {
+        NodeId leaf = scratch.leaves[i];
+        fillPatchRecord(leaf, frameRecords_[first + i]);
+        arena_.drawSlot(cmd, nodes_.slot(leaf), stitchRanges_[nodes_.stitch(leaf)], first + i);
+    }
+}
+
+void CubesphereBody::bindFrameSet(VkCommandBuffer cmd, VkPipelineLayout layout) const {
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &frameSet_,
+                            2, frameOffsets_.data());
+}
+
+void CubesphereBody::collectVisibleLeaves(NodeId root, FaceScratch& scratch) const {
+    scratch.leaves.clear();
+    scratch.byDistance.clear();
+    scratch.stack.assign(1, root);
+    while (!scratch.stack.empty()) {
+        NodeId node = scratch.stack.back();
+        scratch.stack.pop_back();
+
+        // Frustum and horizon cull: test bounding sphere in camera-relative space
+        glm::dvec3 relative = nodes_.worldCenter(node) - drawCameraPos_;
+        double boundingRadius = nodes_.boundingRadius(node);
+        if (!sphereInFrustum(drawFrustum_, glm::vec3(relative), static_cast<float>(boundingRadius)))
+            continue;
+        if (sphereBehindHorizon(relative, boundingRadius, -drawCameraPos_, radius_ - OCCLUDER_DEPTH))
+            continue;
 
-            vkCmdPushConstants(cmd, layout,
-                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                               0, sizeof(TerrainPC), &pc);
-            node.mesh->draw(cmd);
+        if (nodes_.isLeaf(node)) {
+            // Displaced patches need no slot. The cull's camera-relative centre gives
+            // the sort key: distance to the nearest point of the bounding sphere.
+            if (displaced_ || nodes_.slot(node) != TerrainArena::INVALID_SLOT)
+                scratch.byDistance.emplace_back(
+                    static_cast<float>(glm::length(relative) - boundingRadius), node);
+            continue;
         }
-        return;
+
+        // Interior node: visit children
+        NodeId first = nodes_.firstChild(node);
+        for (NodeId child = first + 4; child-- > first;)
+            scratch.stack.push_back(child);
     }
 
-    // Interior node: recurse into children
-    for (const auto& child : node.children) {
-        if (child) drawNode(*child, cmd, layout, viewProj, cameraPos, sunDirection, frustumPlanes);
+    if (depthSort_)
+        std::sort(scratch.byDistance.begin(), scratch.byDistance.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+    scratch.leaves.reserve(scratch.byDistance.size());
+    for (const auto& entry : scratch.byDistance)
+        scratch.leaves.push_back(entry.second);
+}
+
+uint32_t CubesphereBody::displacementPushConstantSize() {
+    return sizeof(DisplacedPC);
+}
+
+void CubesphereBody::drawDisplacedLeaves(VkCommandBuffer cmd, VkPipelineLayout layout,
+                                         const std::vector<NodeId>& leaves) const {
+    // Every patch draws the same grid; only the push constants change
+    displaced_->bind(cmd, layout);
+
+    DisplacedPC pc{};
+    pc.radius = static_cast<float>(radius_);
+    pc.gridSteps = static_cast<float>(quality_.patchGrid - 1);
+    uint32_t edgeLevel = displaced_->imageLevel(ChunkGenerator::EDGE_LEVEL);
+
+    for (NodeId node : leaves) {
+        // initNode puts worldCenter on the datum at the centre UV: the shader's origin
+        const NodeInfo& info = nodes_.info(node);
+        uint32_t level = displaced_->imageLevel(
+            ChunkGenerator::levelForPatch(info.u0, info.u1, info.v0, info.v1, quality_.patchGrid));
+        pc.originOffset = glm::vec3(nodes_.worldCenter(node) - drawCameraPos_);
+        pc.faceAndLevel = static_cast<uint32_t>(info.faceIndex) | (level << 8) | (edgeLevel << 16);
+        pc.uvCenter   = glm::vec2(static_cast<float>((info.u0 + info.u1) * 0.5),
+                                  static_cast<float>((info.v0 + info.v1) * 0.5));
+        pc.uvHalfSize = static_cast<float>((info.u1 - info.u0) * 0.5);
+        vkCmdPushConstants(cmd, layout,
+                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                           0, sizeof(DisplacedPC), &pc);
+        displaced_->drawPatch(cmd, nodes_.stitch(node));
     }
 }
 
-namespace {
-void releaseNodeGPU(QuadtreeNode* node) {
-    if (!node) return;
-    if (node->mesh) node->mesh->release();
-    for (auto& child : node->children)
-        releaseNodeGPU(child.get());
+void CubesphereBody::collectPatchRecords(PatchRecord* records, uint32_t& count) const {
+    beginTraversal();
+    while (!stack_.empty()) {
+        NodeId node = stack_.back();
+        stack_.pop_back();
+
+        if (!nodes_.isLeaf(node)) {
+            NodeId first = nodes_.firstChild(node);
+            for (NodeId child = first + 4; child-- > first;)
+                stack_.push_back(child);
+            continue;
+        }
+        uint32_t slot = nodes_.slot(node);
+        if (slot == TerrainArena::INVALID_SLOT) continue;
+        if (count >= culler_->maxPatches()) return;
+
+        fillPatchRecord(node, records[count++]);
+    }
+}
+
+void CubesphereBody::fillPatchRecord(NodeId leaf, PatchRecord& r) const {
+    r.slot           = nodes_.slot(leaf);
+    r.boundingRadius = static_cast<float>(nodes_.boundingRadius(leaf));
+    r.vertexOffset   = static_cast<int32_t>(nodes_.slot(leaf) * verticesPerPatch_);
+    r.positionScale  = nodes_.positionScale(leaf);
+    r.morph          = nodes_.morph(leaf);
+    const IndexRange& indices = stitchRanges_[nodes_.stitch(leaf)];
+    r.indexRange     = indices.first | (indices.count << 16);
+    r.edgeMorph      = nodes_.edgeMorph(leaf);
+}
+
+void CubesphereBody::recordPatchGeneration(VkCommandBuffer cmd, uint32_t frame) {
+    if (patchGenerator_) patchGenerator_->record(cmd, frame);
+}
+
+void CubesphereBody::recordGpuCull(VkCommandBuffer cmd, uint32_t frame,
+                                   const glm::mat4& viewProj, const glm::dvec3& cameraPos) {
+    // Records are written straight into this frame's mapped SSBO; the frame fence
+    // guarantees the GPU is done with the previous contents.
+    uint32_t count = 0;
+    PatchRecord* records = culler_->records(frame);
+    collectPatchRecords(records, count);
+    gpuPatchCount_[frame] = count;
+
+    glm::vec4 frustumPlanes[6];
+    extractFrustumPlanes(viewProj, frustumPlanes);
+    culler_->recordCull(cmd, frame, count, frustumPlanes, cameraPos,
+                        static_cast<float>(radius_ - OCCLUDER_DEPTH));
+}
+
+void CubesphereBody::drawGpuDriven(VkCommandBuffer cmd, VkPipelineLayout layout,
+                                   uint32_t frame) const {
+    // Patch records come from the culler's SSBO; only the frame constants are used
+    bindFrameSet(cmd, layout);
+    arena_.bind(cmd);
+    culler_->draw(cmd, layout, frame, gpuPatchCount_[frame]);
+}
+
+CubesphereBody::~CubesphereBody() {
+    stopWorkers();
+}
+
+void CubesphereBody::stopWorkers() {
+    stopping_.store(true, std::memory_order_relaxed);
+    jobs_->wait(jobsPending_);
 }
-} // anonymous namespace
 
 void CubesphereBody::releaseGPU() {
-    for (auto& root : roots_)
-        releaseNodeGPU(root.get());
-    for (auto& m : deferredDestroy_)
-        if (m) m->release();
+    // Jobs read the heightmap; let them drain before terrain data is freed. Queued
+    // ones see stopping_ and return at once, and a disk cache build in progress
+    // abandons its temporary file.
+    stopWorkers();
+
+    // Nodes only hold slot indices, so the arena is the only per-patch GPU state.
+    // The pool is flat, so dropping every node and its jobs is a plain clear.
+    nodes_.clear();
+    roots_.fill(INVALID_NODE);
+    prefetchJobs_.clear();
+    retained_.clear();
+    stagedCopies_.clear();
+    stagingSlots_.reset();
+    arena_.release();
+    if (culler_) culler_->release();
+    if (displaced_) displaced_->release();
+    if (patchGenerator_) patchGenerator_->release();
+    frameRing_.release();
 }
 
 } // namespace luna::scene
@@ -1,126 +1,624 @@
-// About: Spherical Moon as a cubesphere with dynamic quadtree LOD and frustum culling.
+// About: Spherical Moon as a cubesphere with dynamic quadtree LOD, frustum and horizon culling.
 
 #pragma once
 
-#include "scene/Mesh.h"
+#include "core/Descriptors.h"
+#include "core/FrameRing.h"
+#include "core/StagingSlots.h"
+#include "scene/ChunkGenerator.h"
+#include "scene/DisplacedTerrain.h"
+#include "scene/GpuPatchGenerator.h"
+#include "scene/LodStats.h"
+#include "scene/PatchCache.h"
+#include "scene/PatchDiskCache.h"
+#include "scene/QuadtreePool.h"
+#include "scene/TerrainArena.h"
+#include "scene/TerrainCuller.h"
+#include "scene/TerrainQuality.h"
+#include "sim/TerrainQuery.h"
 #include "util/Math.h"
+#include "util/JobSystem.h"
+#include "util/LinearArena.h"
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <vulkan/vulkan.h>
 
 namespace luna::core {
 class VulkanContext;
-class CommandPool;
-struct StagingBatch;
+class UploadManager;
 }
 
 namespace luna::scene {
 
-struct QuadtreeNode {
+// CPU mesh generation handed to a worker thread. The worker fills `data` and then
+// sets `ready`; the render thread only touches `data` after observing `ready`.
+// Dropping the last shared_ptr cancels the job if it has not started yet.
+// Once generated, the render thread uploads it into an arena `slot` on the transfer
+// queue; the slot is only published to the tree after `uploadTicket` has retired.
+// Jobs served from the PatchCache start out ready, and possibly already uploaded.
+// Jobs served from the PatchDiskCache start out ready with `mappedVertices` set
+// instead of `data.vertices`. Split jobs that got a `stagingSlot` are generated
+// straight into it and leave `data.vertices` empty; the slot goes back to its pool
+// when the job is destroyed, on whichever thread drops it last.
+struct ChunkJob {
     int      faceIndex;
     double   u0, u1, v0, v1;
-    uint32_t depth;
+    uint64_t cacheKey = 0;
 
-    glm::dvec3 worldCenter;
-    double     boundingRadius;  // conservative radius around worldCenter
+    ChunkMeshData      data;
+    const ChunkVertex* mappedVertices = nullptr;
+    std::atomic<bool>  ready{false};
 
-    std::unique_ptr<Mesh> mesh;
-    std::array<std::unique_ptr<QuadtreeNode>, 4> children;
+    luna::core::StagingSlots* staging     = nullptr;
+    uint32_t                  stagingSlot = luna::core::StagingSlots::INVALID_SLOT;
 
-    bool isLeaf() const { return !children[0]; }
-    bool hasMesh() const { return mesh != nullptr; }
+    ChunkJob() = default;
+    ~ChunkJob() { if (staging) staging->release(stagingSlot); }
+    ChunkJob(const ChunkJob&) = delete;
+    ChunkJob& operator=(const ChunkJob&) = delete;
+
+    bool isStaged() const { return stagingSlot != luna::core::StagingSlots::INVALID_SLOT; }
+    ChunkVertex* stagedVertices() const {
+        return static_cast<ChunkVertex*>(staging->data(stagingSlot));
+    }
+
+    uint32_t slot         = TerrainArena::INVALID_SLOT;
+    uint64_t uploadTicket = 0;
+
+    // GpuCompute: frame whose command buffer generates the slot (0 once resident, or
+    // for CPU jobs). data.positionScale is read back after that frame retires.
+    uint64_t computeFrame = 0;
+
+    bool isUploaded() const { return slot != TerrainArena::INVALID_SLOT; }
+};
+
+// Where patch geometry comes from
+enum class TerrainSource {
+    CpuMeshes,        // ChunkGenerator meshes on worker threads, uploaded into the arena
+    GpuDisplacement,  // one shared grid displaced in terrain_displaced.vert (base layer only)
+    GpuCompute,       // terrain_patch.comp writes each patch into its arena slot (base layer only)
+    // Both GPU sources fall back to CpuMeshes while any terrain region is listed, so
+    // the drawn surface is the one physics samples
 };
 
 class CubesphereBody {
 public:
+    // Default depth the on-disk patch cache covers (~2,000 patches, 15 MB)
+    static constexpr uint32_t DISK_CACHE_DEPTH = 4;
+
+    // How far ahead, in wall seconds, update()'s predicted path should reach
+    static constexpr double   PREFETCH_HORIZON = 10.0;
+
+    // With a diskCachePath, patches down to diskCacheDepth come from that file
+    // instead of being generated. A missing or stale file (other terrain, radius or
+    // format) is rebuilt on a worker after the LOD first converges, for the next start.
+    // GpuDisplacement and GpuCompute fall back to CpuMeshes when the heightmap cannot
+    // be uploaded (see HeightmapTexture::isSupported); neither uses the disk cache.
+    // GpuCompute also falls back when `quality` asks for a patch grid other than the
+    // one terrain_patch.comp is built for. Out-of-range settings are sanitized.
     CubesphereBody(const luna::core::VulkanContext& ctx,
-                   const luna::core::CommandPool& cmdPool,
-                   double radius);
+                   luna::core::UploadManager& uploader,
+                   double radius,
+                   const std::string& diskCachePath = {},
+                   uint32_t diskCacheDepth = DISK_CACHE_DEPTH,
+                   TerrainSource source = TerrainSource::CpuMeshes,
+                   const TerrainQuality& quality = {});
+    ~CubesphereBody();
 
     // Update LOD based on camera position and view frustum. Call once per frame before draw().
+    // Installing, uploading and requesting splits and merges shares one budget of
+    // TerrainQuality::lodBudgetMs per frame.
+    // `cameraVelocity` is in meters per wall second, so it includes any time warp: a
+    // camera crossing the ground quickly also splits along its track ahead and gets
+    // larger time and split budgets (see PREFETCH_SECONDS).
+    // `predictedPath` is where the camera is expected to be over the next
+    // PREFETCH_HORIZON, nearest first. Each frame one of its points, in turn, is
+    // scanned for patches that would split there, and their meshes are generated at
+    // background priority into the patch cache, so the split later finds them ready.
     void update(const glm::dvec3& cameraPos, double fovY, double screenHeight,
-                const glm::mat4& viewProj);
+                const glm::mat4& viewProj,
+                const glm::dvec3& cameraVelocity = glm::dvec3(0.0),
+                std::span<const glm::dvec3> predictedPath = {});
+
+    // Set 0 of every terrain pipeline: this frame's constants (viewProj, sun, camera)
+    // and the per-patch records of the CPU-culled draws, both in a per-frame ring
+    VkDescriptorSetLayout frameSetLayout() const { return frameSetLayout_.handle(); }
+
+    // Write `frame`'s constants into the ring and fix the view that drawFace() culls
+    // against. Call once per frame on the render thread, after update().
+    void prepareDraw(uint32_t frame, const glm::mat4& viewProj,
+                     const glm::dvec3& cameraPos, const glm::vec4& sunDirection);
+
+    // Cull and record one cube face's visible leaves, nearest first so early depth
+    // rejects what closer patches hide. Faces may be recorded concurrently, each
+    // into its own command buffer with the pipeline bound; with GPU displacement the
+    // pipeline must be the one built from displacementSetLayout().
+    static constexpr uint32_t FACE_COUNT = 6;
+    void drawFace(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t face);
+
+    // The face to draw `i`th for front-to-back order across faces: the one under
+    // the camera first. Fixed by prepareDraw().
+    uint32_t faceInDrawOrder(uint32_t i) const { return faceOrder_[i]; }
+
+    // Front-to-back sorting of CPU-culled draws (on by default); off draws leaves
+    // in tree order, for comparing overdraw
+    void setDepthSort(bool enabled) { depthSort_ = enabled; }
 
-    // Record draw commands for visible leaf nodes.
-    void draw(VkCommandBuffer cmd, VkPipelineLayout layout,
+    // prepareDraw() and every face into one command buffer
+    void draw(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t frame,
               const glm::mat4& viewProj,
               const glm::dvec3& cameraPos,
-              const glm::vec4& sunDirection) const;
+              const glm::vec4& sunDirection);
+
+    // GPU-driven mode: the leaf list is uploaded as patch records and a compute pass
+    // does frustum + horizon culling and writes the indirect draws. Only available
+    // when the device supports multi-draw indirect with firstInstance.
+    bool                  supportsGpuDriven() const { return culler_ != nullptr; }
+    VkDescriptorSetLayout gpuDrawSetLayout() const { return culler_->drawSetLayout(); }
+
+    // True when patches are displaced on the GPU rather than meshed on the CPU.
+    // GPU-driven culling is not available in this mode.
+    bool                  usesGpuDisplacement() const { return displaced_ != nullptr; }
+    VkDescriptorSetLayout displacementSetLayout() const { return displaced_->setLayout(); }
+    static uint32_t       displacementPushConstantSize();
+
+    // GpuCompute: record the dispatch generating the patches update() requested.
+    // Call every frame after update() and outside the render pass; no-op otherwise.
+    void recordPatchGeneration(VkCommandBuffer cmd, uint32_t frame);
+
+    // Write this frame's patch records and record the cull dispatch. Call after
+    // update() and outside the render pass.
+    void recordGpuCull(VkCommandBuffer cmd, uint32_t frame,
+                       const glm::mat4& viewProj, const glm::dvec3& cameraPos);
+
+    // Record the indirect terrain draws for `frame` (pipeline from frameSetLayout()
+    // and gpuDrawSetLayout()). prepareDraw() must have run for the frame.
+    void drawGpuDriven(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t frame) const;
 
     uint32_t activeNodeCount() const { return activeNodes_; }
 
-    // Destroy all GPU buffers/memory in a flat traversal — avoids the deep
-    // recursive destructor chain that freezes on shutdown. Call after vkDeviceWaitIdle.
+    // What the last update() did and what the terrain holds after it
+    const LodStats& stats() const { return stats_; }
+
+    // Multiple of TerrainQuality::maxSplitsPerFrame the last update() could split and upload
+    double   splitBudgetScale() const { return budgetScale_; }
+
+    // Settings in use. Only the split threshold can change after construction:
+    // setSplitThreshold() keeps the merge threshold at the same fraction of it, and
+    // the tree follows over the next frames, within the usual split budget.
+    const TerrainQuality& quality() const { return quality_; }
+    void                  setSplitThreshold(double pixels);
+
+    // Memory the patch cache may hold: vertex bytes of cached meshes plus one
+    // mesh's worth for each cached arena slot. Zero disables caching.
+    void              setPatchCacheBudget(size_t bytes);
+    const PatchCache& patchCache() const { return cache_; }
+
+    // Vertex memory for split nodes' own meshes, kept in their arena slots while
+    // their children draw so that merging back costs nothing. Past the budget the
+    // deepest go first, the longest undrawn among equals, into the patch cache.
+    // Zero, the default unless TerrainQuality::retainedMeshMB says otherwise,
+    // retains none.
+    void   setRetainedMeshBudget(size_t bytes);
+    size_t retainedMeshBytes() const { return retained_.size() * bytesPerMesh_; }
+
+    // Destroy the terrain arena buffers. Call after vkDeviceWaitIdle.
+    // Also waits for the terrain's jobs, so call before shutdownTerrain().
     void releaseGPU();
 
-private:
+    // LOD parameters and the math update() applies per node, public for tools and
+    // benchmarks that exercise it without a device; the tunable ones are in
+    // TerrainQuality
     static constexpr uint32_t MAX_DEPTH            = 15;
-    static constexpr uint32_t PATCH_GRID           = 17;
-    static constexpr double   SPLIT_THRESHOLD      = 4.0;
-    static constexpr double   MERGE_THRESHOLD      = 2.0;
-    static constexpr uint32_t MAX_SPLITS_PER_FRAME   = 64;
-    static constexpr uint32_t MAX_DESTROYS_PER_FRAME = 8;
-
-    // Max meshes per batch before flushing the command buffer
-    static constexpr uint32_t MESHES_PER_BATCH     = 512;
-
-    // Approximate bytes per mesh for staging capacity estimation
-    static constexpr VkDeviceSize BYTES_PER_MESH =
-        PATCH_GRID * PATCH_GRID * sizeof(float) * 7  // vertices (position + normal + height)
-        + (PATCH_GRID - 1) * (PATCH_GRID - 1) * 6 * sizeof(uint32_t)  // indices
-        + PATCH_GRID * 4 * (sizeof(float) * 7 + 6 * sizeof(uint32_t)); // skirt (conservative)
-
-    void initNode(QuadtreeNode& node, int face,
+
+    // Horizon occluder sits this far below the datum — below the lowest LOLA point (~-9.1 km)
+    static constexpr double   OCCLUDER_DEPTH       = 10000.0;
+
+    // Datum-sphere centre of a patch and a bounding radius that covers its terrain
+    static void patchBounds(int face, double u0, double u1, double v0, double v1,
+                            double radius, glm::dvec3& center, double& boundingRadius);
+
+    // Projected geometric error in pixels of a patch with these bounds, meshed
+    // with patchGrid vertices per edge
+    static double projectedError(const glm::dvec3& center, double boundingRadius,
+                                 const glm::dvec3& cameraPos, double pixelsPerRadian,
+                                 uint32_t patchGrid);
+
+    static void extractFrustumPlanes(const glm::mat4& vp, glm::vec4 planes[6]);
+    static bool sphereInFrustum(const glm::vec4 planes[6],
+                                const glm::vec3& center, float radius);
+
+    // True when a camera-relative sphere is completely hidden behind the occluder
+    // sphere of `occluderRadius` centred at `moonCenter` (also camera-relative)
+    static bool sphereBehindHorizon(const glm::dvec3& center, double radius,
+                                    const glm::dvec3& moonCenter, double occluderRadius);
+
+    // The part of that test that depends only on the camera, for walks that test
+    // many spheres from one position
+    struct Horizon {
+        glm::dvec3 moonCenter;     // camera-relative
+        glm::dvec3 toCamera;       // unit, from the moon centre
+        double     planeDistance;  // of the horizon plane from the moon centre, R² / d
+        double     coneHalfAngle;  // of the occluder seen from the camera
+        bool       outside;        // camera outside the occluder, else nothing is hidden
+    };
+    static Horizon horizonFrom(const glm::dvec3& moonCenter, double occluderRadius);
+    static bool    sphereBehindHorizon(const glm::dvec3& center, double radius,
+                                       const Horizon& horizon);
+
+private:
+    // Ground-track prefetch. Splits and merges are also judged from where the camera
+    // will be this many wall seconds ahead, about how long a split takes to become
+    // resident, so a fast pass has the terrain it is about to cross ready instead of
+    // splitting it on arrival and merging it behind. The budgets scale with how many
+    // altitudes the camera covers in that time, up to MAX_BUDGET_SCALE.
+    static constexpr double   PREFETCH_SECONDS     = 1.0;
+    static constexpr double   PREFETCH_MIN_TRAVEL  = 0.25;  // altitudes per PREFETCH_SECONDS
+    static constexpr double   MAX_PREFETCH_ARC     = 0.25;  // radians of ground track
+    static constexpr double   MAX_BUDGET_SCALE     = 4.0;
+    // Prefetched candidates rank below visible ones of the same error
+    static constexpr double   PREFETCH_PRIORITY    = 0.5;
+
+    // Incremental LOD walk. A visited node is settled for as far as the camera can
+    // travel before any of its decisions could change, and its subtree is skipped
+    // until then. Geomorph factors of skipped leaves lag by at most MORPH_TOLERANCE
+    // of the morph range. Every node is still revisited within REVISIT_FRAMES,
+    // staggered by id, which bounds the lag of what the margins leave out: subtrees
+    // passing behind the horizon and collapsing there.
+    static constexpr double   MORPH_TOLERANCE      = 1.0 / 64.0;
+    static constexpr uint32_t REVISIT_FRAMES       = 32;
+
+    // Background generation along the predicted path: jobs queued per frame, and
+    // finished or queued at once. Kept small so the cache holds what is due soon.
+    static constexpr uint32_t PREFETCH_JOBS_PER_FRAME = 8;
+    static constexpr uint32_t MAX_PREFETCH_JOBS       = 128;
+
+    // Cap on generation jobs queued or running; new split requests wait beyond this
+    static constexpr uint32_t MAX_PENDING_JOBS     = 256;
+    // Persistent staging a split job generates into, ~5.5 MB at the default grid.
+    // Jobs beyond it, prefetches and cache hits stage from their own vectors.
+    static constexpr uint32_t STAGING_SLOTS        = MAX_PENDING_JOBS;
+
+    // Arena capacity: live leaves plus meshes awaiting upload or retirement
+    static constexpr uint32_t ARENA_SLOTS          = 4096;
+    static_assert(ChunkGenerator::totalIndexCount(TerrainQuality::MAX_PATCH_GRID) <= 0xFFFF,
+                  "PatchRecord::indexRange packs index offsets in 16 bits");
+
+    // Default patch cache budget; the cache must leave twice the unscaled split
+    // budget of free slots (see update())
+    static constexpr size_t   PATCH_CACHE_BYTES    = 32ull * 1024 * 1024;
+
+    void initNode(NodeId node, int face,
                   double u0, double u1, double v0, double v1, uint32_t depth);
 
-    // Blocking single-mesh upload (used for merges outside a batch)
-    void generateMesh(QuadtreeNode& node);
+    // Record an upload of patch vertices and their world-space centre into a free
+    // arena slot in the open transfer batch; submits the batch every meshesPerBatch
+    // meshes. `ticket` receives the batch ticket. A direct arena is written at once
+    // and the ticket is 0, which is always complete. Returns INVALID_SLOT if the arena is full.
+    uint32_t uploadMesh(const ChunkVertex* vertices, uint32_t vertexCount,
+                        const glm::dvec3& center, uint64_t& ticket);
+    // Same, generating the patch on this thread straight into staging or the slot.
+    // Fills in the node's centre and position scale.
+    uint32_t generateMesh(NodeId node, uint64_t& ticket);
+    // The centre alone, for a slot that compute generation fills
+    void     uploadCenter(uint32_t slot, const glm::dvec3& center, uint64_t& ticket);
+    void     uploadJob(ChunkJob& job);
+    // Make queued jobs return at once and wait for every job to finish
+    void     stopWorkers();
+    // Opens the transfer batch if needed; endUpload() submits it once it is full
+    VkCommandBuffer beginUpload(uint64_t& ticket);
+    void            endUpload();
+
+    // True once a job's slot holds its finished patch: the transfer copy has retired,
+    // or for GpuCompute the generating frame has, in which case its scale is read back
+    bool     jobResident(ChunkJob& job);
+
+    // Mesh job for a patch: served from the patch cache or the disk cache on a hit,
+    // otherwise queued for CPU generation on the worker pool
+    std::shared_ptr<ChunkJob> acquireJob(int face, uint32_t depth,
+                                         double u0, double u1, double v0, double v1);
+
+    // Drop a job; whatever it finished (vertices or an uploaded slot) goes to the cache
+    void cancelJob(std::shared_ptr<ChunkJob>& job);
+    // Drop a job built from heights that have since changed, caching nothing
+    void discardJob(std::shared_ptr<ChunkJob>& job);
+
+    // Whether a patch's samples can fall inside any of `boxes`
+    bool tileTouches(int face, double u0, double u1, double v0, double v1,
+                     const std::vector<luna::sim::TerrainBox>& boxes) const;
+    // Whether the disk cache may serve a patch: shallow enough, and outside every
+    // region, whose heights depend on what was resident when the file was built
+    bool diskCached(int face, uint32_t depth, double u0, double u1, double v0, double v1) const;
+
+    // The terrain changed inside `boxes` (a region arrived or left): drop cached,
+    // retained and prefetched patches and pending jobs there, and mark the leaves
+    // drawn there for regeneration
+    void invalidateTerrain(const std::vector<luna::sim::TerrainBox>& boxes);
+
+    // Hand a slot that recent frames may have drawn to the deferred-free list;
+    // `ticket` is a transfer copy that must also retire first
+    void retireSlot(uint32_t& slot, uint64_t ticket = 0);
+
+    // Move a node's slot into the patch cache as the node leaves the tree
+    void retireNode(NodeId node);
+    void cachePatch(uint64_t key, CachedPatch&& patch);
+
+    // Deepest node, no deeper than maxDepth, whose patch contains the point
+    NodeId nodeAt(int face, double u, double v, uint32_t maxDepth) const;
 
-    // Batched mesh upload; auto-flushes every MESHES_PER_BATCH meshes
-    void generateMeshBatched(QuadtreeNode& node, VkCommandBuffer& cmd,
-                             luna::core::StagingBatch& staging);
+    // Node no deeper than maxDepth just across `edge` (PatchEdge bit index) of a
+    // node, at fraction t along that edge; follows the edge onto the next cube face
+    NodeId neighbourAt(NodeId node, uint32_t edge, double t, uint32_t maxDepth) const;
 
-    struct SplitCandidate {
-        QuadtreeNode* node;
-        double screenError;
+    // 2:1 restriction. A leaf may split only when no edge neighbour is coarser, and
+    // returns the first one that is; a node's children may merge only when no node
+    // along its edges at their depth is split, about to split, or wants to.
+    NodeId coarserNeighbour(NodeId leaf) const;
+    bool   canMerge(NodeId node, const glm::dvec3& cameraPos, double pixelsPerRadian) const;
+
+    // Set leaves' stitch masks and edge morph factors from their neighbours, once
+    // the tree is final for the frame: the leaves in restitch_ and the leaves
+    // across their edges, or every leaf after a full walk or when that is cheaper
+    void updateStitching(bool fullWalk);
+    void stitchLeaf(NodeId leaf);
+
+    // Clear the settled state from the root down to a node changed outside the walk,
+    // so the next walk reaches it
+    void unsettle(NodeId node);
+
+    // Projected geometric error of a node's patch in pixels
+    double screenError(NodeId n, const glm::dvec3& cameraPos, double pixelsPerRadian) const;
+
+    // Error that splits and merges go by: the larger of screenError() from the
+    // camera and, while prefetching, from the point ahead on its ground track
+    double lodError(NodeId n, const glm::dvec3& cameraPos, double pixelsPerRadian) const;
+
+    // Set this frame's prefetch point and budget scale from the camera's motion
+    void updatePrefetch(const glm::dvec3& cameraPos, const glm::dvec3& cameraVelocity);
+
+    // Walk the patches that would split with the camera at `point`, live or not
+    // yet, and queue background generation of the children not already cached
+    void prefetchAround(const glm::dvec3& point, double pixelsPerRadian);
+    void queuePrefetch(int face, uint32_t depth, double u0, double u1, double v0, double v1);
+
+    // A patch of the tree or below it, for prefetchAround()
+    struct PrefetchRegion {
+        NodeId   node;   // INVALID_NODE below the live tree
+        int      face;
+        uint32_t depth;
+        double   u0, u1, v0, v1;
     };
 
-    // Phase 1: walk tree collecting leaves that want to split; perform merges immediately
-    void collectCandidates(QuadtreeNode& node, const glm::dvec3& cameraPos,
-                           double fovY, double screenHeight,
-                           VkCommandBuffer& cmd, luna::core::StagingBatch& staging,
-                           const glm::vec4 frustumPlanes[6],
-                           std::vector<SplitCandidate>& candidates);
+    // Geomorph factor for a leaf with this screen error: 1 draws its parent's shape
+    float morphFactor(NodeId n, double screenError) const;
 
-    // Phase 2: split a single leaf into 4 children with mesh generation
-    void splitNode(QuadtreeNode& node, VkCommandBuffer& cmd,
-                   luna::core::StagingBatch& staging);
+    // One step of a split, merge or refresh, found by the walk. Kinds are in stage
+    // order, three per stage: install what is resident, upload what is generated,
+    // then request generation.
+    enum class LodWorkKind : uint8_t {
+        InstallSplit, InstallMerge, InstallRefresh,
+        UploadSplit,  UploadMerge,  UploadRefresh,
+        RequestSplit, RequestMerge, RequestRefresh,
+    };
+    struct LodWork {
+        NodeId      node;
+        LodWorkKind kind;
+        double      priority;  // how far past its threshold: error / split, or merge / error
 
-    void drawNode(const QuadtreeNode& node, VkCommandBuffer cmd, VkPipelineLayout layout,
-                  const glm::mat4& viewProj, const glm::dvec3& cameraPos,
-                  const glm::vec4& sunDirection, const glm::vec4 frustumPlanes[6]) const;
+        uint32_t stage() const { return static_cast<uint32_t>(kind) / 3; }
+    };
 
-    static void extractFrustumPlanes(const glm::mat4& vp, glm::vec4 planes[6]);
-    static bool sphereInFrustum(const glm::vec4 planes[6],
-                                const glm::vec3& center, float radius);
+    // Phase 1: walk the trees collecting the frame's LOD work: leaves that want to
+    // split, leaves whose children are generated or resident, and merges and
+    // refreshes of stale leaves at each of those steps. Nothing is changed but
+    // cancellations; runWork() does the rest.
+    // Settled subtrees are skipped unless `fullWalk`.
+    void collectCandidates(const glm::dvec3& cameraPos, double pixelsPerRadian,
+                           const glm::vec4 frustumPlanes[6], bool fullWalk,
+                           luna::util::ArenaVector<LodWork>& work);
+
+    // Phase 2: run the work by stage and then priority, merges and splits alike,
+    // until `budgetMs` has passed; what is left is found again next frame. At least
+    // one item runs, so a slow frame still makes progress. The split budget caps
+    // meshes uploaded and requested, which is load on the transfer queue and the
+    // workers rather than on this thread.
+    void runWork(luna::util::ArenaVector<LodWork>& work, const glm::dvec3& cameraPos,
+                 double pixelsPerRadian, double budgetMs, uint32_t splitBudget);
+    // Collapse a node's four leaf children into it once its mesh is resident. False
+    // if the tree changed since the walk and the merge has to wait.
+    bool installMerge(NodeId node, const glm::dvec3& cameraPos, double pixelsPerRadian);
+
+    // Swap a leaf's stale mesh for its regenerated one once that is resident
+    void installRefresh(NodeId node);
+
+    // Queue generation of a leaf's 4 children (the leaf keeps drawing). A forced
+    // split makes room for a neighbour's and is not dropped when the camera backs off.
+    void requestSplit(NodeId node, bool forced = false);
+
+    // Replace a leaf with its 4 children once their meshes are resident
+    void installChildren(NodeId node);
+
+    // GPU displacement: children need no mesh, so a split is installed at once
+    void splitInPlace(NodeId node);
+
+    // Per-face traversal state, so faces can be culled on different threads
+    struct FaceScratch {
+        std::vector<NodeId> stack;
+        std::vector<NodeId> leaves;
+        // Distance from the camera to each visible leaf's bounding sphere, for sorting
+        std::vector<std::pair<float, NodeId>> byDistance;
+    };
+
+    // Visible leaves under `root` (with a slot unless displaced), in draw order:
+    // nearest first unless depth sorting is off
+    void collectVisibleLeaves(NodeId root, FaceScratch& scratch) const;
+    void bindFrameSet(VkCommandBuffer cmd, VkPipelineLayout layout) const;
+    void drawDisplacedLeaves(VkCommandBuffer cmd, VkPipelineLayout layout,
+                             const std::vector<NodeId>& leaves) const;
+
+    // Collapse a node whose children are all leaves back into a leaf
+    void releaseChildren(NodeId node);
+
+    void collectPatchRecords(PatchRecord* records, uint32_t& count) const;
+    void fillPatchRecord(NodeId leaf, PatchRecord& record) const;
+
+    // Start an explicit-stack traversal at the six roots
+    void beginTraversal() const;
 
     double radius_;
-    std::array<std::unique_ptr<QuadtreeNode>, 6> roots_;
+
+    // Fixed at construction apart from the thresholds; the rest is derived from
+    // the patch grid. Meshes are vertices only: the indices are shared.
+    TerrainQuality quality_;
+    uint32_t       verticesPerPatch_;
+    uint32_t       topologyIndices_;  // all stitch variants, shared by all slots
+    VkDeviceSize   bytesPerMesh_;
+    double         mergeRatio_;       // mergeThreshold / splitThreshold
+
+    // Null unless patches are CPU meshes. Declared before nodes_ and the job maps:
+    // jobs give their slots back when destroyed.
+    std::unique_ptr<luna::core::StagingSlots> stagingSlots_;
+    // Slots whose copy into the arena may still be in flight, freed once `ticket` retires
+    struct StagedCopy {
+        uint32_t slot;
+        uint64_t ticket;
+    };
+    std::vector<StagedCopy> stagedCopies_;
+
+    // Every node of all six face trees; roots_ index into it
+    QuadtreePool          nodes_;
+    std::array<NodeId, 6> roots_{};
+
+    // Reused traversal stack, so walking the tree does not allocate per frame
+    mutable std::vector<NodeId> stack_;
+
+    // Incremental walk: the camera's path length, where it was last frame, and the
+    // projection and threshold the settled margins were worked out against. Any
+    // change to those, or prefetching, walks the whole tree again.
+    double     lodTravel_ = 0.0;
+    glm::dvec3 lodCameraPos_{0.0};
+    double     walkPixelsPerRadian_ = 0.0;
+    double     walkSplitThreshold_  = 0.0;
+    // Leaves whose morph or neighbourhood changed this frame, for updateStitching()
+    std::vector<NodeId> restitch_;
 
     // Stored for on-the-fly mesh creation
     const luna::core::VulkanContext* ctx_;
-    const luna::core::CommandPool*   cmdPool_;
-
-    void ensureBatchStarted(VkCommandBuffer& cmd, luna::core::StagingBatch& staging);
+    luna::core::UploadManager*       uploader_;
 
     uint32_t activeNodes_ = 0;
+    LodStats stats_;
     uint32_t batchCount_ = 0;
-    bool     batchStarted_ = false;
+    uint64_t frameCounter_ = 0;
+
+    // Ground-track prefetch for this frame (updatePrefetch)
+    glm::dvec3 prefetchPos_{0.0};
+    bool       prefetching_ = false;
+    double     budgetScale_ = 1.0;
+
+    // Background generation along the predicted path, by cache key. Finished jobs
+    // move into the patch cache; acquireJob() takes a finished one, or drops one
+    // still queued and generates the patch at full priority.
+    std::unordered_map<uint64_t, std::shared_ptr<ChunkJob>> prefetchJobs_;
+    std::vector<PrefetchRegion> prefetchStack_;
+    size_t                      prefetchCursor_ = 0;
+
+    // Terrain generation the tree has caught up with, and the boxes of every listed
+    // region (see diskCached()); changedBoxes_ is update()'s scratch
+    uint64_t                           terrainGeneration_ = 0;
+    std::vector<luna::sim::TerrainBox> regionBoxes_;
+    std::vector<luna::sim::TerrainBox> changedBoxes_;
+
+    // Time from construction to the first frame with nothing left to split, logged once
+    uint32_t pendingSplits_ = 0;
+    bool     converged_     = false;
+    std::chrono::steady_clock::time_point startTime_ = std::chrono::steady_clock::now();
+
+    // All patch geometry; replaces a vertex/index buffer pair per node
+    TerrainArena arena_;
+    std::array<IndexRange, STITCH_VARIANTS> stitchRanges_{};
+
+    // Per-frame constants and patch records. One set with dynamic offsets serves
+    // every frame's region
+    luna::core::FrameRing           frameRing_;
+    luna::core::DescriptorSetLayout frameSetLayout_;
+    luna::core::DescriptorPool      framePool_;
+    VkDescriptorSet                 frameSet_ = VK_NULL_HANDLE;
+
+    // This frame's draw state from prepareDraw(); faces claim record ranges atomically
+    std::array<uint32_t, 2>             frameOffsets_{};
+    PatchRecord*                        frameRecords_ = nullptr;
+    glm::vec4                           drawFrustum_[6]{};
+    glm::dvec3                          drawCameraPos_{0.0};
+    std::atomic<uint32_t>               nextRecord_{0};
+    std::array<FaceScratch, FACE_COUNT> faceScratch_;
+    std::array<uint32_t, FACE_COUNT>    faceOrder_{0, 1, 2, 3, 4, 5};
+    bool                                depthSort_ = true;
+
+    // Null when the device lacks the features for GPU-driven drawing
+    std::unique_ptr<TerrainCuller> culler_;
+
+    // Null unless patches are displaced on the GPU; the arena then holds no patches
+    std::unique_ptr<DisplacedTerrain> displaced_;
+
+    // Null unless patches are generated by compute into the arena
+    std::unique_ptr<GpuPatchGenerator> patchGenerator_;
+    std::array<uint32_t, luna::core::MAX_FRAMES_IN_FLIGHT> gpuPatchCount_{};
+
+    // Slots that may still be referenced by GPU work: a pending transfer copy
+    // (until `ticket` retires) or a graphics frame in flight (until `retireFrame`).
+    struct DeferredSlot {
+        uint32_t slot;
+        uint64_t ticket;
+        uint64_t retireFrame;
+    };
+    std::vector<DeferredSlot> deferredDestroy_;
+
+    // Recently dropped patches, keyed by tile
+    PatchCache cache_;
+
+    // Interior nodes that kept their mesh, with the frame they were last drawn in,
+    // as a leaf, before their split was installed. Unordered.
+    struct RetainedMesh {
+        NodeId   node;
+        uint64_t drawnFrame;
+    };
+    std::vector<RetainedMesh> retained_;
+    size_t                    retainedBudget_;
+    // Hand retained meshes over to the patch cache until at most `keep` remain
+    void evictRetained(size_t keep);
+
+    // update()'s working lists; reset at the start of every update
+    luna::util::LinearArena frameArena_;
+
+    // Precomputed shallow patches; closed when no valid file was found, in which
+    // case the build path is set until the rebuild has been queued
+    PatchDiskCache diskCache_;
+    std::string    diskCacheBuildPath_;
+    uint32_t       diskCacheBuildDepth_ = 0;
+
+    // Generation jobs queued or running on jobs_
+    std::atomic<uint32_t> inFlightJobs_{0};
+
+    // Patch meshes built by workers or compute since construction
+    std::atomic<uint64_t> patchesGenerated_{0};
+
+    // Tells a running disk cache build to give up so shutdown does not wait on it
+    std::atomic<bool> stopping_{false};
 
-    // Meshes replaced during a batch whose VRAM buffers are still referenced
-    // by the in-flight transfer command buffer. Destroyed after submit.
-    std::vector<std::unique_ptr<Mesh>> deferredDestroy_;
+    // Patch generation, prefetch and disk cache builds share the process-wide pool.
+    // Every job is counted, and stopWorkers() waits for the count before any state
+    // the jobs touch is freed.
+    luna::util::JobSystem* jobs_ = &luna::util::JobSystem::instance();
+    luna::util::JobCounter jobsPending_;
 };
 
 } // namespace luna::scene
@@ -0,0 +1,69 @@
+// About: DisplacedTerrain implementation — heightmap descriptor set, shared grid buffers, patch draws.
+
+#include "scene/DisplacedTerrain.h"
+#include "scene/ChunkGenerator.h"
+#include "core/CommandPool.h"
+#include "core/VulkanContext.h"
+#include "util/Log.h"
+
+#include <vector>
+
+namespace luna::scene {
+
+bool DisplacedTerrain::isSupported(const luna::core::VulkanContext& ctx,
+                                   const luna::sim::Heightmap& heightmap) {
+    return HeightmapTexture::isSupported(ctx, heightmap);
+}
+
+DisplacedTerrain::DisplacedTerrain(const luna::core::VulkanContext& ctx,
+                                   const luna::sim::Heightmap& heightmap, uint32_t gridSize)
+    : gridSize_(gridSize),
+      heightmap_(ctx, heightmap),
+      setLayout_(ctx, {
+          luna::core::DescriptorSetLayout::combinedImageSampler(0, VK_SHADER_STAGE_VERTEX_BIT),
+      }),
+      pool_(ctx, 1, {{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1}})
+{
+    set_ = pool_.allocate(setLayout_.handle());
+    luna::core::writeCombinedImageSampler(ctx.device(), set_, 0, heightmap_.view(),
+                                          heightmap_.sampler());
+
+    // Grid in ChunkGenerator vertex order: rows of u at increasing v
+    std::vector<DisplacedGridVertex> grid;
+    grid.reserve(gridSize * gridSize);
+    float last = static_cast<float>(gridSize - 1);
+    for (uint32_t j = 0; j < gridSize; j++)
+        for (uint32_t i = 0; i < gridSize; i++)
+            grid.push_back({glm::vec2(i / last, j / last)});
+
+    luna::core::CommandPool oneShot(ctx, 0);
+    std::vector<uint16_t> indices = ChunkGenerator::buildIndices(gridSize);
+    vertexBuffer_ = luna::core::Buffer::createStatic(ctx, oneShot, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                                     grid.data(), grid.size() * sizeof(DisplacedGridVertex));
+    indexBuffer_  = luna::core::Buffer::createStatic(ctx, oneShot, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                                                     indices.data(), indices.size() * sizeof(uint16_t));
+
+    LOG_INFO("GPU terrain displacement ready: %zu grid vertices, %zu indices in %u stitch variants",
+             grid.size(), indices.size(), STITCH_VARIANTS);
+}
+
+void DisplacedTerrain::bind(VkCommandBuffer cmd, VkPipelineLayout layout) const {
+    VkBuffer buffers[] = { vertexBuffer_.handle() };
+    VkDeviceSize offsets[] = { 0 };
+    vkCmdBindVertexBuffers(cmd, 0, 1, buffers, offsets);
+    vkCmdBindIndexBuffer(cmd, indexBuffer_.handle(), 0, VK_INDEX_TYPE_UINT16);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 1, 1, &set_, 0, nullptr);
+}
+
+void DisplacedTerrain::drawPatch(VkCommandBuffer cmd, uint32_t stitchMask) const {
+    IndexRange range = ChunkGenerator::stitchRange(gridSize_, stitchMask);
+    vkCmdDrawIndexed(cmd, range.count, 1, range.first, 0, 0);
+}
+
+void DisplacedTerrain::release() {
+    vertexBuffer_.release();
+    indexBuffer_.release();
+    heightmap_.release();
+}
+
+} // namespace luna::scene
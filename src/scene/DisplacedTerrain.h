@@ -0,0 +1,73 @@
+// About: GPU-displaced terrain — heightmap mip image plus one flat patch grid shared by every patch.
+
+#pragma once
+
+#include "core/Buffer.h"
+#include "core/Descriptors.h"
+#include "scene/HeightmapTexture.h"
+#include "util/Math.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+namespace luna::core {
+class VulkanContext;
+}
+
+namespace luna::sim {
+class Heightmap;
+}
+
+namespace luna::scene {
+
+// One vertex of the shared grid, in the same order as a ChunkGenerator patch so
+// buildIndices() topology applies. grid is the position across the patch in [0, 1]²;
+// 0 and 1 are exact, so the shader can tell boundary vertices apart.
+struct DisplacedGridVertex {
+    glm::vec2 grid;
+};
+
+// The base heightmap's mip pyramid lives in a HeightmapTexture, and
+// terrain_displaced.vert places, displaces and shades each vertex from the
+// patch's face and UV bounds in push constants. No per-patch vertex data exists,
+// so a split or merge is only a change to the quadtree. Regions are not uploaded:
+// this path draws the base layer only, and CubesphereBody uses CPU meshes instead
+// while any region is listed.
+class DisplacedTerrain {
+public:
+    // Uploads the heightmap and grid, blocking until the copies complete
+    DisplacedTerrain(const luna::core::VulkanContext& ctx, const luna::sim::Heightmap& heightmap,
+                     uint32_t gridSize);
+
+    // Same requirements as HeightmapTexture
+    static bool isSupported(const luna::core::VulkanContext& ctx,
+                            const luna::sim::Heightmap& heightmap);
+
+    // Set 1 of the displaced terrain pipeline (heightmap, vertex stage); set 0 is
+    // CubesphereBody::frameSetLayout()
+    VkDescriptorSetLayout setLayout() const { return setLayout_.handle(); }
+
+    // Image mip that stands in for a Heightmap pyramid level
+    uint32_t imageLevel(uint32_t heightmapLevel) const { return heightmap_.imageLevel(heightmapLevel); }
+
+    // Bind the grid buffers and the heightmap set. The pipeline must be bound.
+    void bind(VkCommandBuffer cmd, VkPipelineLayout layout) const;
+
+    // Draw one patch with the index variant for its coarser edges (PatchEdge bits);
+    // its push constants must already be set
+    void drawPatch(VkCommandBuffer cmd, uint32_t stitchMask) const;
+
+    void release();
+
+private:
+    uint32_t gridSize_;
+
+    HeightmapTexture                heightmap_;
+    luna::core::DescriptorSetLayout setLayout_;
+    luna::core::DescriptorPool      pool_;
+    VkDescriptorSet                 set_ = VK_NULL_HANDLE;
+
+    luna::core::Buffer vertexBuffer_;
+    luna::core::Buffer indexBuffer_;
+};
+
+} // namespace luna::scene
@@ -0,0 +1,134 @@
+// About: GpuPatchGenerator implementation — job buffers, batched patch dispatch, barriers, scale readback.
+
+#include "scene/GpuPatchGenerator.h"
+#include "scene/ChunkGenerator.h"
+#include "core/CommandPool.h"
+#include "core/VulkanContext.h"
+#include "util/Log.h"
+
+#include <cstring>
+
+namespace luna::scene {
+
+namespace {
+
+// Push constant layout must match shaders/terrain_patch.comp
+struct PatchGenPC {
+    float    radius;
+    uint32_t jobCount;
+};
+
+} // anonymous namespace
+
+bool GpuPatchGenerator::isSupported(const luna::core::VulkanContext& ctx,
+                                    const luna::sim::Heightmap& heightmap) {
+    return HeightmapTexture::isSupported(ctx, heightmap);
+}
+
+GpuPatchGenerator::GpuPatchGenerator(const luna::core::VulkanContext& ctx,
+                                     const luna::sim::Heightmap& heightmap,
+                                     VkBuffer arenaVertices, uint32_t slotCount, double radius)
+    : ctx_(ctx), radius_(radius),
+      heightmap_(ctx, heightmap),
+      setLayout_(ctx, {
+          luna::core::DescriptorSetLayout::combinedImageSampler(0, VK_SHADER_STAGE_COMPUTE_BIT),
+          luna::core::DescriptorSetLayout::storageBuffer(1, VK_SHADER_STAGE_COMPUTE_BIT),
+          luna::core::DescriptorSetLayout::storageBuffer(2, VK_SHADER_STAGE_COMPUTE_BIT),
+          luna::core::DescriptorSetLayout::storageBuffer(3, VK_SHADER_STAGE_COMPUTE_BIT),
+      }),
+      pool_(ctx, luna::core::MAX_FRAMES_IN_FLIGHT, {
+          {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, luna::core::MAX_FRAMES_IN_FLIGHT},
+          {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 * luna::core::MAX_FRAMES_IN_FLIGHT},
+      }),
+      pipeline_(luna::core::Pipeline::ComputeBuilder(ctx)
+                    .setShader("shaders/terrain_patch.comp.spv")
+                    .addDescriptorSetLayout(setLayout_.handle())
+                    .setPushConstantSize(sizeof(PatchGenPC))
+                    .build())
+{
+    scaleBuffer_ = luna::core::Buffer::createDynamic(ctx, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                     static_cast<VkDeviceSize>(slotCount) * sizeof(float));
+    scales_ = static_cast<const float*>(scaleBuffer_.map());
+
+    for (auto& frame : frames_) {
+        frame.jobs   = luna::core::Buffer::createDynamic(ctx, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                         MAX_JOBS_PER_BATCH * sizeof(GpuPatchJob));
+        frame.mapped = static_cast<GpuPatchJob*>(frame.jobs.map());
+
+        frame.set = pool_.allocate(setLayout_.handle());
+        luna::core::writeCombinedImageSampler(ctx.device(), frame.set, 0, heightmap_.view(),
+                                              heightmap_.sampler());
+        luna::core::writeStorageBuffer(ctx.device(), frame.set, 1, frame.jobs.handle());
+        luna::core::writeStorageBuffer(ctx.device(), frame.set, 2, arenaVertices);
+        luna::core::writeStorageBuffer(ctx.device(), frame.set, 3, scaleBuffer_.handle());
+    }
+    queued_.reserve(MAX_JOBS_PER_BATCH);
+
+    LOG_INFO("GPU patch generation ready: up to %u patches per dispatch", MAX_JOBS_PER_BATCH);
+}
+
+bool GpuPatchGenerator::queue(uint32_t slot, int face, double u0, double u1, double v0, double v1) {
+    if (queued_.size() >= MAX_JOBS_PER_BATCH) return false;
+
+    uint32_t level = heightmap_.imageLevel(
+        ChunkGenerator::levelForPatch(u0, u1, v0, v1, GRID_SIZE));
+
+    GpuPatchJob job{};
+    job.uvCenter     = glm::vec2(static_cast<float>((u0 + u1) * 0.5),
+                                 static_cast<float>((v0 + v1) * 0.5));
+    job.uvHalfSize   = static_cast<float>((u1 - u0) * 0.5);
+    job.faceAndLevel = static_cast<uint32_t>(face) | (level << 8);
+    job.slot         = slot;
+    job.edgeLevel    = heightmap_.imageLevel(ChunkGenerator::EDGE_LEVEL);
+    queued_.push_back(job);
+    return true;
+}
+
+void GpuPatchGenerator::record(VkCommandBuffer cmd, uint32_t frame) {
+    if (queued_.empty()) return;
+    FrameResources& fr = frames_[frame];
+
+    // The frame fence guarantees the GPU is done with this buffer's previous jobs
+    std::memcpy(fr.mapped, queued_.data(), queued_.size() * sizeof(GpuPatchJob));
+
+    PatchGenPC pc{};
+    pc.radius   = static_cast<float>(radius_);
+    pc.jobCount = static_cast<uint32_t>(queued_.size());
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_.handle());
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_.layout(),
+                            0, 1, &fr.set, 0, nullptr);
+    vkCmdPushConstants(cmd, pipeline_.layout(), VK_SHADER_STAGE_COMPUTE_BIT,
+                       0, sizeof(PatchGenPC), &pc);
+    vkCmdDispatch(cmd, pc.jobCount, 1, 1);  // one workgroup per patch
+    queued_.clear();
+
+    // Vertices feed this frame's draws; scales are read by the host after the fence
+    VkMemoryBarrier barrier{};
+    barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void GpuPatchGenerator::generateNow() {
+    if (queued_.empty()) return;
+    luna::core::CommandPool oneShot(ctx_, 0);
+    VkCommandBuffer cmd = oneShot.beginOneShot();
+    record(cmd, 0);
+    oneShot.endOneShot(cmd, ctx_.graphicsQueue());
+}
+
+void GpuPatchGenerator::release() {
+    for (auto& frame : frames_) {
+        frame.jobs.release();
+        frame.mapped = nullptr;
+    }
+    scaleBuffer_.release();
+    scales_ = nullptr;
+    heightmap_.release();
+}
+
+} // namespace luna::scene
@@ -0,0 +1,96 @@
+// About: Compute-shader patch generation — writes packed patch vertices straight into arena slots.
+
+#pragma once
+
+#include "core/Buffer.h"
+#include "core/Descriptors.h"
+#include "core/Pipeline.h"
+#include "core/Sync.h"
+#include "scene/HeightmapTexture.h"
+#include "util/Math.h"
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace luna::core {
+class VulkanContext;
+}
+
+namespace luna::sim {
+class Heightmap;
+}
+
+namespace luna::scene {
+
+// Matches PatchJob in shaders/terrain_patch.comp (std430)
+struct GpuPatchJob {
+    glm::vec2 uvCenter;
+    float     uvHalfSize;
+    uint32_t  faceAndLevel;   // face | image mip << 8
+    uint32_t  slot;           // arena slot the vertices are written to
+    uint32_t  edgeLevel;      // image mip of boundary vertices
+    uint32_t  _pad[2];
+};
+
+// Replaces ChunkGenerator::generate plus the staging copy: terrain_patch.comp runs
+// one workgroup per patch, samples the HeightmapTexture and writes ChunkVertex data
+// (grid, normals, heights and geomorph targets) into the patch's TerrainArena slot. Positions
+// are relative to the datum point at the patch's centre UV. Jobs queued during a
+// frame go out as one dispatch from record(); each patch's quantisation scale is
+// written to a host-visible buffer and can be read once that frame's fence has
+// signalled. Heights come from the base layer only.
+class GpuPatchGenerator {
+public:
+    // Baked into terrain_patch.comp, which sizes its shared memory by it
+    static constexpr uint32_t GRID_SIZE = 17;
+
+    // Patches one record() can dispatch; queue() refuses more
+    static constexpr uint32_t MAX_JOBS_PER_BATCH = 256;
+
+    GpuPatchGenerator(const luna::core::VulkanContext& ctx, const luna::sim::Heightmap& heightmap,
+                      VkBuffer arenaVertices, uint32_t slotCount, double radius);
+
+    // Same requirements as HeightmapTexture
+    static bool isSupported(const luna::core::VulkanContext& ctx,
+                            const luna::sim::Heightmap& heightmap);
+
+    // Queue generation of a patch into `slot`. Returns false when the batch is full.
+    bool queue(uint32_t slot, int face, double u0, double u1, double v0, double v1);
+
+    // Record one dispatch for every queued job and clear the queue. Must be outside
+    // a render pass; the frame's draws see the vertices.
+    void record(VkCommandBuffer cmd, uint32_t frame);
+
+    // Generate the queued jobs now on the graphics queue and wait (startup)
+    void generateNow();
+
+    // Quantisation scale of a slot's last generated patch. Valid once the frame that
+    // recorded it has retired.
+    float positionScale(uint32_t slot) const { return scales_[slot]; }
+
+    void release();
+
+private:
+    struct FrameResources {
+        luna::core::Buffer jobs;
+        GpuPatchJob*       mapped = nullptr;
+        VkDescriptorSet    set    = VK_NULL_HANDLE;
+    };
+
+    const luna::core::VulkanContext& ctx_;
+    double                           radius_;
+
+    HeightmapTexture                heightmap_;
+    luna::core::DescriptorSetLayout setLayout_;
+    luna::core::DescriptorPool      pool_;
+    luna::core::Pipeline            pipeline_;
+
+    luna::core::Buffer scaleBuffer_;
+    const float*       scales_ = nullptr;
+
+    std::vector<GpuPatchJob> queued_;
+    std::array<FrameResources, luna::core::MAX_FRAMES_IN_FLIGHT> frames_;
+};
+
+} // namespace luna::scene
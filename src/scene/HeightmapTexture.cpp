@@ -0,0 +1,101 @@
+// About: HeightmapTexture implementation — device limit check, mip chain selection, one-shot upload.
+
+#include "scene/HeightmapTexture.h"
+#include "core/Buffer.h"
+#include "core/CommandPool.h"
+#include "core/VulkanContext.h"
+#include "sim/Heightmap.h"
+#include "util/Log.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace luna::scene {
+
+namespace {
+
+uint32_t maxImageDimension(const luna::core::VulkanContext& ctx) {
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(ctx.physicalDevice(), &props);
+    return props.limits.maxImageDimension2D;
+}
+
+// Finest pyramid level the device can hold as one image, or levelCount() if none
+uint32_t firstFittingLevel(const luna::sim::Heightmap& heightmap, uint32_t maxDim) {
+    uint32_t level = 0;
+    for (; level < heightmap.levelCount(); level++) {
+        const auto& lv = heightmap.level(level);
+        if (lv.width <= maxDim && lv.height <= maxDim) break;
+    }
+    return level;
+}
+
+} // anonymous namespace
+
+bool HeightmapTexture::isSupported(const luna::core::VulkanContext& ctx,
+                                   const luna::sim::Heightmap& heightmap) {
+    if (!heightmap.isLoaded() || heightmap.isTiled()) return false;
+    return firstFittingLevel(heightmap, maxImageDimension(ctx)) < heightmap.levelCount();
+}
+
+HeightmapTexture::HeightmapTexture(const luna::core::VulkanContext& ctx,
+                                   const luna::sim::Heightmap& heightmap) {
+    if (!isSupported(ctx, heightmap))
+        throw std::runtime_error("Heightmap cannot be uploaded as a GPU image");
+
+    // Level k of the image is base >> k. The pyramid halves exactly and stops at an
+    // odd size, so its levels follow; the check keeps any that would not out
+    baseLevel_ = firstFittingLevel(heightmap, maxImageDimension(ctx));
+    const auto& base = heightmap.level(baseLevel_);
+    uint32_t mipCount = 1;
+    VkDeviceSize bytes = base.data.size() * sizeof(float);
+    while (baseLevel_ + mipCount < heightmap.levelCount()) {
+        const auto& lv = heightmap.level(baseLevel_ + mipCount);
+        if (lv.width != std::max(1u, base.width >> mipCount) ||
+            lv.height != std::max(1u, base.height >> mipCount))
+            break;
+        bytes += lv.data.size() * sizeof(float);
+        mipCount++;
+    }
+
+    image_ = luna::core::Image(ctx, base.width, base.height, VK_FORMAT_R32_SFLOAT,
+                               VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                               VK_IMAGE_ASPECT_COLOR_BIT, mipCount);
+
+    // One-time upload on the graphics queue, so no queue family ownership transfer is needed
+    luna::core::CommandPool oneShot(ctx, 0);
+    luna::core::StagingBatch staging;
+    staging.begin(ctx, bytes);
+    VkCommandBuffer cmd = oneShot.beginOneShot();
+    image_.recordTransition(cmd, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    for (uint32_t mip = 0; mip < mipCount; mip++) {
+        const auto& lv = heightmap.level(baseLevel_ + mip);
+        image_.recordUpload(cmd, staging, mip, lv.data.data(), lv.data.size() * sizeof(float));
+    }
+    image_.recordTransition(cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                            VK_ACCESS_SHADER_READ_BIT);
+    oneShot.endOneShot(cmd, ctx.graphicsQueue());
+    staging.end();
+
+    sampler_ = luna::core::Sampler(ctx, VK_FILTER_NEAREST);
+
+    LOG_INFO("Heightmap image ready: %ux%u (level %u), %u mips, %.1f MB",
+             base.width, base.height, baseLevel_, mipCount, bytes / (1024.0 * 1024.0));
+}
+
+uint32_t HeightmapTexture::imageLevel(uint32_t heightmapLevel) const {
+    if (heightmapLevel <= baseLevel_) return 0;
+    return std::min(heightmapLevel - baseLevel_, image_.mipLevels() - 1);
+}
+
+void HeightmapTexture::release() {
+    image_   = luna::core::Image{};
+    sampler_ = luna::core::Sampler{};
+}
+
+} // namespace luna::scene
@@ -0,0 +1,50 @@
+// About: Base heightmap mip pyramid as a sampled R32_SFLOAT GPU image, shared by the GPU terrain paths.
+
+#pragma once
+
+#include "core/Image.h"
+#include "core/Sampler.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+namespace luna::core {
+class VulkanContext;
+}
+
+namespace luna::sim {
+class Heightmap;
+}
+
+namespace luna::scene {
+
+// Pyramid levels become image mips for as long as they follow Vulkan's chain. Texels
+// are heights in km, as in the Heightmap. The sampler is NEAREST: shaders filter by
+// hand with texelFetch, because linear filtering of R32_SFLOAT is optional and the
+// longitude seam must wrap rather than clamp. Readable from vertex and compute shaders.
+class HeightmapTexture {
+public:
+    HeightmapTexture() = default;
+    // Uploads every usable level on the graphics queue, blocking until the copy completes
+    HeightmapTexture(const luna::core::VulkanContext& ctx, const luna::sim::Heightmap& heightmap);
+
+    // Needs the in-memory float backend with a level that fits maxImageDimension2D
+    static bool isSupported(const luna::core::VulkanContext& ctx,
+                            const luna::sim::Heightmap& heightmap);
+
+    VkImageView view() const { return image_.view(); }
+    VkSampler   sampler() const { return sampler_.handle(); }
+
+    // Image mip that stands in for a Heightmap pyramid level
+    uint32_t imageLevel(uint32_t heightmapLevel) const;
+
+    void release();
+
+private:
+    // First Heightmap level that fits the device; finer levels are read from image mip 0
+    uint32_t baseLevel_ = 0;
+
+    luna::core::Image   image_;
+    luna::core::Sampler sampler_;
+};
+
+} // namespace luna::scene
@@ -0,0 +1,92 @@
+// About: LodStatsWriter implementation — one field table shared by the CSV and JSON Lines formats.
+
+#include "scene/LodStats.h"
+
+namespace luna::scene {
+
+namespace {
+
+// Every field in output order
+template <typename F>
+void forEachField(const LodStats& s, F&& f) {
+    f("frame", s.frame);
+    f("leaves", s.leaves);
+    f("max_depth", s.maxDepth);
+    f("splits", s.splits);
+    f("merges", s.merges);
+    f("refreshes", s.refreshes);
+    f("candidates", s.candidates);
+    f("splits_requested", s.splitsRequested);
+    f("pending_splits", s.pendingSplits);
+    f("work_queued", s.workQueued);
+    f("work_deferred", s.workDeferred);
+    f("nodes_visited", s.nodesVisited);
+    f("subtrees_skipped", s.subtreesSkipped);
+    f("meshes_staged", s.meshesStaged);
+    f("bytes_staged", s.bytesStaged);
+    f("meshes_written", s.meshesWritten);
+    f("bytes_written", s.bytesWritten);
+    f("jobs_in_flight", s.jobsInFlight);
+    f("prefetch_jobs", s.prefetchJobs);
+    f("live_meshes", s.liveMeshes);
+    f("live_mesh_bytes", s.liveMeshBytes);
+    f("arena_bytes", s.arenaBytes);
+    f("deferred_slots", s.deferredSlots);
+    f("cached_patches", s.cachedPatches);
+    f("cache_bytes", s.cacheBytes);
+    f("retained_meshes", s.retainedMeshes);
+    f("retained_bytes", s.retainedBytes);
+    f("patches_generated", s.patchesGenerated);
+}
+
+} // anonymous namespace
+
+LodStatsWriter::~LodStatsWriter() {
+    close();
+}
+
+bool LodStatsWriter::open(const std::string& path) {
+    close();
+    file_ = std::fopen(path.c_str(), "w");
+    lastFrame_ = 0;
+    if (!file_) return false;
+
+    csv_ = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    if (csv_) {
+        bool first = true;
+        forEachField(LodStats{}, [&](const char* name, uint64_t) {
+            std::fprintf(file_, first ? "%s" : ",%s", name);
+            first = false;
+        });
+        std::fputs(",frame_ms\n", file_);
+    }
+    return true;
+}
+
+void LodStatsWriter::write(const LodStats& stats, double frameMs) {
+    if (!file_ || stats.frame == lastFrame_) return;
+    lastFrame_ = stats.frame;
+    bool first = true;
+    if (csv_) {
+        forEachField(stats, [&](const char*, uint64_t value) {
+            std::fprintf(file_, first ? "%llu" : ",%llu", static_cast<unsigned long long>(value));
+            first = false;
+        });
+        std::fprintf(file_, ",%.3f\n", frameMs);
+    } else {
+        std::fputc('{', file_);
+        forEachField(stats, [&](const char* name, uint64_t value) {
+            std::fprintf(file_, first ? "\"%s\":%llu" : ",\"%s\":%llu",
+                         name, static_cast<unsigned long long>(value));
+            first = false;
+        });
+        std::fprintf(file_, ",\"frame_ms\":%.3f}\n", frameMs);
+    }
+}
+
+void LodStatsWriter::close() {
+    if (file_) std::fclose(file_);
+    file_ = nullptr;
+}
+
+} // namespace luna::scene
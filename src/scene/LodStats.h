@@ -0,0 +1,84 @@
+// About: Per-frame terrain LOD and memory counters, and a CSV / JSON Lines writer for them.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace luna::scene {
+
+// Filled in by CubesphereBody::update() as it goes; reading it costs nothing.
+// Churn fields count this frame's update() only, the rest are levels after it.
+struct LodStats {
+    uint64_t frame = 0;
+
+    // Tree
+    uint32_t leaves   = 0;
+    uint32_t maxDepth = 0;  // deepest leaf
+
+    // Churn
+    uint32_t splits          = 0;  // leaves replaced by their children
+    uint32_t merges          = 0;  // interior nodes collapsed back into leaves
+    uint32_t refreshes       = 0;  // leaves given a mesh regenerated after their terrain changed
+    uint32_t candidates      = 0;  // leaves that wanted to split
+    uint32_t splitsRequested = 0;  // candidates whose children were queued this frame
+    uint32_t pendingSplits   = 0;  // leaves waiting on their children's meshes
+    uint32_t workQueued      = 0;  // split and merge steps the walk found
+    uint32_t workDeferred    = 0;  // of those, left for the next frame by the time budget
+
+    // Walk: nodes update() visited, and subtrees it skipped as settled
+    uint32_t nodesVisited    = 0;
+    uint32_t subtreesSkipped = 0;
+
+    // Transfers
+    uint32_t meshesStaged = 0;
+    uint64_t bytesStaged  = 0;  // vertex bytes copied into staging memory
+    uint32_t meshesWritten = 0;  // written straight into a direct arena instead
+    uint64_t bytesWritten  = 0;
+
+    // Jobs
+    uint32_t jobsInFlight = 0;  // generation jobs queued or running
+    uint32_t prefetchJobs = 0;  // background generation along the predicted path
+
+    // Memory. Patch meshes are arena slots, so a live mesh is a slot in use.
+    uint32_t liveMeshes    = 0;  // slots held by the tree (retained parents too), jobs and the cache
+    uint64_t liveMeshBytes = 0;  // vertex bytes of those slots
+    uint64_t arenaBytes    = 0;  // device memory of the arena, used or not
+    uint32_t deferredSlots = 0;  // freed slots waiting for GPU work to retire
+    uint32_t cachedPatches = 0;
+    uint64_t cacheBytes    = 0;
+    uint32_t retainedMeshes = 0;  // split nodes' meshes kept for merging back
+    uint64_t retainedBytes  = 0;
+
+    // Patch meshes generated since startup, on workers or by compute
+    uint64_t patchesGenerated = 0;
+};
+
+// One line per frame. A path ending in ".csv" gets a header row and comma-separated
+// values; anything else gets one JSON object per line. Each line also carries the
+// wall time of the frame it came from, so LOD churn lines up with frame time.
+class LodStatsWriter {
+public:
+    LodStatsWriter() = default;
+    ~LodStatsWriter();
+
+    LodStatsWriter(const LodStatsWriter&) = delete;
+    LodStatsWriter& operator=(const LodStatsWriter&) = delete;
+
+    // False if the file could not be created
+    bool open(const std::string& path);
+    bool isOpen() const { return file_ != nullptr; }
+
+    // `frameMs`: duration of the whole frame whose update() produced `stats`.
+    // A frame already written is skipped.
+    void write(const LodStats& stats, double frameMs);
+    void close();
+
+private:
+    std::FILE* file_ = nullptr;
+    bool       csv_  = false;
+    uint64_t   lastFrame_ = 0;
+};
+
+} // namespace luna::scene
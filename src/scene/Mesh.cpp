@@ -1,4 +1,4 @@
-// About: Mesh implementation — creates vertex/index buffers and records draw commands.
+// About: Mesh implementation — creates vertex (and index) buffers and records draw commands.
 
 #include "scene/Mesh.h"
 #include "core/VulkanContext.h"
@@ -33,12 +33,28 @@ Mesh::Mesh(const luna::core::VulkanContext& ctx, VkCommandBuffer transferCmd,
         static_cast<VkDeviceSize>(indexCount) * sizeof(uint32_t), staging);
 }
 
-void Mesh::draw(VkCommandBuffer cmd) const {
+Mesh::Mesh(const luna::core::VulkanContext& ctx, const luna::core::CommandPool& cmdPool,
+           const void* vertexData, uint32_t vertexSize, uint32_t vertexCount)
+    : vertexCount_(vertexCount)
+{
+    vertexBuffer_ = luna::core::Buffer::createStatic(ctx, cmdPool,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertexData, vertexSize);
+}
+
+void Mesh::bind(VkCommandBuffer cmd) const {
     VkBuffer buffers[] = { vertexBuffer_.handle() };
     VkDeviceSize offsets[] = { 0 };
     vkCmdBindVertexBuffers(cmd, 0, 1, buffers, offsets);
-    vkCmdBindIndexBuffer(cmd, indexBuffer_.handle(), 0, VK_INDEX_TYPE_UINT32);
-    vkCmdDrawIndexed(cmd, indexCount_, 1, 0, 0, 0);
+    if (indexed())
+        vkCmdBindIndexBuffer(cmd, indexBuffer_.handle(), 0, VK_INDEX_TYPE_UINT32);
+}
+
+void Mesh::draw(VkCommandBuffer cmd) const {
+    bind(cmd);
+    if (indexed())
+        vkCmdDrawIndexed(cmd, indexCount_, 1, 0, 0, 0);
+    else
+        vkCmdDraw(cmd, vertexCount_, 1, 0, 0);
 }
 
 void Mesh::release() {
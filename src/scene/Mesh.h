@@ -1,4 +1,4 @@
-// About: Vertex/index buffer pair with draw command — owns GPU buffer lifetime.
+// About: Vertex buffer with optional index buffer and draw command — owns GPU buffer lifetime.
 
 #pragma once
 
@@ -26,15 +26,25 @@ public:
          const void* indexData,  uint32_t indexCount,
          luna::core::StagingBatch& staging);
 
+    // Non-indexed: vertices are drawn in order, so no index buffer is uploaded or bound
+    Mesh(const luna::core::VulkanContext& ctx, const luna::core::CommandPool& cmdPool,
+         const void* vertexData, uint32_t vertexSize, uint32_t vertexCount);
+
+    // Bind and draw everything: vkCmdDrawIndexed, or vkCmdDraw without indices
     void draw(VkCommandBuffer cmd) const;
+    // Bind the buffers only, for callers drawing ranges of a non-indexed mesh
+    void bind(VkCommandBuffer cmd) const;
     void release();
 
+    bool     indexed() const { return indexCount_ > 0; }
     uint32_t indexCount() const { return indexCount_; }
+    uint32_t vertexCount() const { return vertexCount_; }
 
 private:
     luna::core::Buffer vertexBuffer_;
     luna::core::Buffer indexBuffer_;
-    uint32_t indexCount_ = 0;
+    uint32_t indexCount_  = 0;
+    uint32_t vertexCount_ = 0;  // non-indexed meshes only
 };
 
 } // namespace luna::scene
@@ -0,0 +1,114 @@
+// About: PatchCache implementation — tile keys, LRU bookkeeping, budget enforcement.
+
+#include "scene/PatchCache.h"
+
+#include <cmath>
+#include <iterator>
+
+namespace luna::scene {
+
+PatchCache::PatchCache(size_t byteBudget, size_t slotBytes)
+    : byteBudget_(byteBudget), slotBytes_(slotBytes) {}
+
+uint64_t PatchCache::makeKey(int face, uint32_t depth, double u0, double v0) {
+    // Tile coordinates at this depth; u0/v0 are exact multiples of 2 / 2^depth
+    double tiles = static_cast<double>(1u << depth);
+    auto ix = static_cast<uint64_t>(std::lround((u0 + 1.0) * 0.5 * tiles));
+    auto iy = static_cast<uint64_t>(std::lround((v0 + 1.0) * 0.5 * tiles));
+    return (static_cast<uint64_t>(face) << 56) | (static_cast<uint64_t>(depth) << 48) |
+           (ix << 24) | iy;
+}
+
+void PatchCache::keyTile(uint64_t key, int& face, uint32_t& depth,
+                         double& u0, double& u1, double& v0, double& v1) {
+    face  = static_cast<int>(key >> 56);
+    depth = static_cast<uint32_t>((key >> 48) & 0xff);
+    double size = 2.0 / static_cast<double>(1u << depth);
+    u0 = static_cast<double>((key >> 24) & 0xffffff) * size - 1.0;
+    v0 = static_cast<double>(key & 0xffffff) * size - 1.0;
+    u1 = u0 + size;
+    v1 = v0 + size;
+}
+
+size_t PatchCache::costOf(const CachedPatch& patch) const {
+    return patch.mesh.vertices.size() * sizeof(ChunkVertex) + (patch.hasSlot() ? slotBytes_ : 0);
+}
+
+CachedPatch PatchCache::remove(std::list<Entry>::iterator it) {
+    bytesUsed_ -= costOf(it->patch);
+    if (it->patch.hasSlot()) slotCount_--;
+    CachedPatch patch = std::move(it->patch);
+    index_.erase(it->key);
+    lru_.erase(it);
+    return patch;
+}
+
+void PatchCache::insert(uint64_t key, CachedPatch&& patch, std::vector<CachedPatch>& evicted) {
+    if (auto found = index_.find(key); found != index_.end())
+        evicted.push_back(remove(found->second));
+    // Nothing worth keeping, or larger than the whole budget
+    size_t cost = costOf(patch);
+    if (cost == 0 || cost > byteBudget_) {
+        evicted.push_back(std::move(patch));
+        return;
+    }
+
+    lru_.push_front({key, std::move(patch)});
+    index_[key] = lru_.begin();
+    bytesUsed_ += cost;
+    if (lru_.front().patch.hasSlot()) slotCount_++;
+    trim(evicted);
+}
+
+bool PatchCache::take(uint64_t key, CachedPatch& out) {
+    auto found = index_.find(key);
+    if (found == index_.end()) {
+        misses_++;
+        return false;
+    }
+    hits_++;
+    out = remove(found->second);
+    return true;
+}
+
+bool PatchCache::evictSlot(CachedPatch& out) {
+    for (auto it = lru_.end(); it != lru_.begin();) {
+        --it;
+        if (!it->patch.hasSlot()) continue;
+
+        if (it->patch.mesh.vertices.empty()) {
+            out = remove(it);
+        } else {
+            // Demote to a CPU-only entry
+            out = CachedPatch{};
+            out.slot         = it->patch.slot;
+            out.uploadTicket = it->patch.uploadTicket;
+            it->patch.slot   = TerrainArena::INVALID_SLOT;
+            bytesUsed_ -= slotBytes_;
+            slotCount_--;
+        }
+        return true;
+    }
+    return false;
+}
+
+void PatchCache::setBudget(size_t byteBudget, std::vector<CachedPatch>& evicted) {
+    byteBudget_ = byteBudget;
+    trim(evicted);
+}
+
+void PatchCache::removeIf(const std::function<bool(uint64_t)>& stale,
+                          std::vector<CachedPatch>& removed) {
+    for (auto it = lru_.begin(); it != lru_.end();) {
+        auto next = std::next(it);
+        if (stale(it->key)) removed.push_back(remove(it));
+        it = next;
+    }
+}
+
+void PatchCache::trim(std::vector<CachedPatch>& evicted) {
+    while (bytesUsed_ > byteBudget_ && !lru_.empty())
+        evicted.push_back(remove(std::prev(lru_.end())));
+}
+
+} // namespace luna::scene
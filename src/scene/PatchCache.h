@@ -0,0 +1,87 @@
+// About: LRU cache of recently dropped terrain patches — CPU mesh data and/or arena slots.
+
+#pragma once
+
+#include "scene/ChunkGenerator.h"
+#include "scene/TerrainArena.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace luna::scene {
+
+// A patch that left the tree (merged away, replaced by its children, or cancelled
+// after generation). Either the generated vertices are kept, or the arena slot still
+// holding them is; `uploadTicket` is the transfer batch that filled the slot.
+struct CachedPatch {
+    ChunkMeshData mesh;
+    uint32_t      slot         = TerrainArena::INVALID_SLOT;
+    uint64_t      uploadTicket = 0;
+
+    bool hasSlot() const { return slot != TerrainArena::INVALID_SLOT; }
+};
+
+// Keyed by makeKey(face, depth, u0, v0), which names a quadtree tile exactly.
+// The budget counts vertex bytes plus `slotBytes` for each retained slot; inserting
+// past it evicts least-recently-used patches into the caller's list, which must
+// release their slots. A zero budget disables the cache.
+class PatchCache {
+public:
+    PatchCache(size_t byteBudget, size_t slotBytes);
+
+    static uint64_t makeKey(int face, uint32_t depth, double u0, double v0);
+    // The tile a key names
+    static void keyTile(uint64_t key, int& face, uint32_t& depth,
+                        double& u0, double& u1, double& v0, double& v1);
+
+    // Take ownership of `patch`; replaces any entry with the same key
+    void insert(uint64_t key, CachedPatch&& patch, std::vector<CachedPatch>& evicted);
+
+    // On a hit, move the entry out and return true
+    bool take(uint64_t key, CachedPatch& out);
+
+    // Whether an entry exists, without counting a hit or a miss
+    bool contains(uint64_t key) const { return index_.count(key) != 0; }
+
+    // Give up the least-recently-used retained slot, keeping its vertices if any.
+    // Returns false when no cached patch holds a slot.
+    bool evictSlot(CachedPatch& out);
+
+    void setBudget(size_t byteBudget, std::vector<CachedPatch>& evicted);
+
+    // Move out every entry whose key `stale` accepts, e.g. once the terrain under
+    // it has changed; the caller releases their slots
+    void removeIf(const std::function<bool(uint64_t)>& stale, std::vector<CachedPatch>& removed);
+
+    size_t   bytesUsed() const  { return bytesUsed_; }
+    size_t   budget() const     { return byteBudget_; }
+    uint32_t entryCount() const { return static_cast<uint32_t>(lru_.size()); }
+    uint32_t slotCount() const  { return slotCount_; }
+    uint64_t hits() const       { return hits_; }
+    uint64_t misses() const     { return misses_; }
+
+private:
+    struct Entry {
+        uint64_t    key;
+        CachedPatch patch;
+    };
+
+    size_t      costOf(const CachedPatch& patch) const;
+    void        trim(std::vector<CachedPatch>& evicted);
+    CachedPatch remove(std::list<Entry>::iterator it);
+
+    size_t byteBudget_;
+    size_t slotBytes_;
+    size_t bytesUsed_ = 0;
+    uint32_t slotCount_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+
+    std::list<Entry> lru_;  // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+};
+
+} // namespace luna::scene
@@ -0,0 +1,176 @@
+// About: PatchDiskCache implementation — offline patch generation, file writing and key lookup.
+
+#include "scene/PatchDiskCache.h"
+#include "scene/PatchCache.h"
+#include "util/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace luna::scene {
+
+namespace {
+
+constexpr char     MAGIC[4]  = {'L', 'P', 'C', '1'};
+constexpr uint64_t ALIGNMENT = 4096;
+
+// Vertices are written and mapped as raw bytes
+static_assert(std::is_trivially_copyable_v<ChunkVertex>);
+
+uint64_t alignUp(uint64_t v, uint64_t a) { return (v + a - 1) / a * a; }
+
+struct PatchTile {
+    uint64_t key;
+    int      face;
+    double   u0, u1, v0, v1;
+};
+
+} // anonymous namespace
+
+bool PatchDiskCache::open(const std::string& path, uint64_t terrainHash,
+                          double radius, uint32_t gridSize) {
+    close();
+    if (!std::filesystem::exists(path) || !file_.open(path)) return false;
+
+    const PatchDiskHeader& h = *header();
+    uint32_t vertices = gridSize * gridSize;
+    uint64_t patchBytes = uint64_t(vertices) * sizeof(ChunkVertex);
+    bool valid = file_.size() >= sizeof(PatchDiskHeader) &&
+                 std::memcmp(h.magic, MAGIC, 4) == 0 &&
+                 h.version == VERSION &&
+                 h.vertexStride == sizeof(ChunkVertex) &&
+                 h.entryOffset % alignof(PatchDiskEntry) == 0 &&
+                 h.dataOffset % alignof(ChunkVertex) == 0 &&
+                 h.entryOffset + h.entryCount * sizeof(PatchDiskEntry) <= file_.size() &&
+                 h.dataOffset + h.entryCount * patchBytes <= file_.size();
+    if (!valid) {
+        LOG_WARN("Patch cache %s is not a valid version %u file — ignored", path.c_str(), VERSION);
+        close();
+        return false;
+    }
+    if (h.terrainHash != terrainHash || h.radius != radius ||
+        h.gridSize != gridSize || h.verticesPerPatch != vertices) {
+        LOG_INFO("Patch cache %s was built for different terrain — ignored", path.c_str());
+        close();
+        return false;
+    }
+
+    LOG_INFO("Patch cache mapped: %llu patches to depth %u, %.1f MB, from %s",
+             static_cast<unsigned long long>(h.entryCount), h.maxDepth,
+             file_.size() / (1024.0 * 1024.0), path.c_str());
+    return true;
+}
+
+const ChunkVertex* PatchDiskCache::find(uint64_t key, glm::dvec3& worldCenter,
+                                        float& positionScale) const {
+    if (!isOpen()) return nullptr;
+    const PatchDiskHeader& h = *header();
+    const auto* begin = reinterpret_cast<const PatchDiskEntry*>(file_.data() + h.entryOffset);
+    const auto* end   = begin + h.entryCount;
+    const auto* it = std::lower_bound(begin, end, key,
+        [](const PatchDiskEntry& e, uint64_t k) { return e.key < k; });
+    if (it == end || it->key != key) return nullptr;
+
+    worldCenter = glm::dvec3(it->worldCenter[0], it->worldCenter[1], it->worldCenter[2]);
+    positionScale = it->positionScale;
+    size_t offset = h.dataOffset + static_cast<size_t>(it - begin) * h.verticesPerPatch * sizeof(ChunkVertex);
+    return reinterpret_cast<const ChunkVertex*>(file_.data() + offset);
+}
+
+bool PatchDiskCache::build(const std::string& path, uint64_t terrainHash, double radius,
+                           uint32_t gridSize, uint32_t maxDepth, const std::atomic<bool>& cancel) {
+    // Every tile of every face down to maxDepth, UV bounds exactly as the quadtree
+    // derives them (dyadic fractions, so halving reproduces them bit for bit)
+    std::vector<PatchTile> tiles;
+    for (int face = 0; face < 6; face++) {
+        for (uint32_t depth = 0; depth <= maxDepth; depth++) {
+            uint32_t n = 1u << depth;
+            for (uint32_t iy = 0; iy < n; iy++) {
+                for (uint32_t ix = 0; ix < n; ix++) {
+                    PatchTile t;
+                    t.face = face;
+                    t.u0 = -1.0 + 2.0 * ix / n;
+                    t.u1 = -1.0 + 2.0 * (ix + 1) / n;
+                    t.v0 = -1.0 + 2.0 * iy / n;
+                    t.v1 = -1.0 + 2.0 * (iy + 1) / n;
+                    t.key = PatchCache::makeKey(face, depth, t.u0, t.v0);
+                    tiles.push_back(t);
+                }
+            }
+        }
+    }
+    std::sort(tiles.begin(), tiles.end(),
+              [](const PatchTile& a, const PatchTile& b) { return a.key < b.key; });
+
+    PatchDiskHeader header{};
+    std::memcpy(header.magic, MAGIC, 4);
+    header.version          = VERSION;
+    header.terrainHash      = terrainHash;
+    header.radius           = radius;
+    header.gridSize         = gridSize;
+    header.verticesPerPatch = gridSize * gridSize;
+    header.vertexStride     = sizeof(ChunkVertex);
+    header.maxDepth         = maxDepth;
+    header.entryCount       = tiles.size();
+    header.entryOffset      = sizeof(PatchDiskHeader);
+    header.dataOffset       = alignUp(header.entryOffset + tiles.size() * sizeof(PatchDiskEntry), ALIGNMENT);
+
+    std::error_code ec;
+    std::filesystem::path target(path);
+    if (target.has_parent_path())
+        std::filesystem::create_directories(target.parent_path(), ec);
+    std::string temp = path + ".tmp";
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LOG_WARN("Cannot create patch cache %s", temp.c_str());
+        return false;
+    }
+
+    // Entries are only known after generation; write the vertex data first
+    std::vector<PatchDiskEntry> entries(tiles.size());
+    size_t patchBytes = size_t(header.verticesPerPatch) * sizeof(ChunkVertex);
+    out.seekp(static_cast<std::streamoff>(header.dataOffset));
+    // One buffer for every patch, generated into in place
+    std::vector<ChunkVertex> vertices(header.verticesPerPatch);
+    for (size_t k = 0; k < tiles.size() && out; k++) {
+        if (cancel.load(std::memory_order_relaxed)) {
+            out.close();
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        const PatchTile& t = tiles[k];
+        ChunkPlacement mesh = ChunkGenerator::generate(t.face, t.u0, t.u1, t.v0, t.v1, radius,
+                                                       gridSize, vertices.data());
+        entries[k].key = t.key;
+        entries[k].worldCenter[0] = mesh.worldCenter.x;
+        entries[k].worldCenter[1] = mesh.worldCenter.y;
+        entries[k].worldCenter[2] = mesh.worldCenter.z;
+        entries[k].positionScale  = mesh.positionScale;
+        out.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(patchBytes));
+    }
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(PatchDiskEntry)));
+    out.close();
+    if (!out) {
+        LOG_WARN("Failed writing patch cache %s", temp.c_str());
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+
+    std::filesystem::rename(temp, target, ec);
+    if (ec) {
+        LOG_WARN("Cannot replace patch cache %s: %s", path.c_str(), ec.message().c_str());
+        return false;
+    }
+    LOG_INFO("Patch cache written: %zu patches to depth %u, %s", tiles.size(), maxDepth, path.c_str());
+    return true;
+}
+
+} // namespace luna::scene
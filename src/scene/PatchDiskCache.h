@@ -0,0 +1,75 @@
+// About: Precomputed patch vertex file — memory-mapped, versioned, keyed by terrain content hash.
+
+#pragma once
+
+#include "scene/ChunkGenerator.h"
+#include "util/MappedFile.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace luna::scene {
+
+// File layout: header, then an entry per patch sorted by PatchCache::makeKey, then
+// (page aligned) every patch's vertices back to back in entry order. All patches
+// have the same vertex count, so entry k's vertices sit at dataOffset + k·stride.
+struct PatchDiskHeader {
+    char     magic[4];          // "LPC1"
+    uint32_t version;           // PatchDiskCache::VERSION
+    uint64_t terrainHash;       // sim::terrainContentHash() the patches were built from
+    double   radius;
+    uint32_t gridSize;
+    uint32_t verticesPerPatch;
+    uint32_t vertexStride;      // sizeof(ChunkVertex)
+    uint32_t maxDepth;
+    uint64_t entryCount;
+    uint64_t entryOffset;
+    uint64_t dataOffset;
+};
+static_assert(sizeof(PatchDiskHeader) == 64);
+
+struct PatchDiskEntry {
+    uint64_t key;
+    double   worldCenter[3];
+    float    positionScale;
+    uint32_t _pad;
+};
+static_assert(sizeof(PatchDiskEntry) == 40);
+
+// Serves every patch down to maxDepth without generating it: find() returns the
+// vertices in place, so uploads copy from the mapped pages straight into staging.
+class PatchDiskCache {
+public:
+    // Bump whenever ChunkGenerator's output changes for the same terrain
+    static constexpr uint32_t VERSION = 4;
+
+    // Map `path` and check it was built for these parameters. Returns false (the
+    // cache stays closed) when the file is missing, truncated or stale.
+    bool open(const std::string& path, uint64_t terrainHash, double radius, uint32_t gridSize);
+    void close() { file_.close(); }
+
+    // Generate all patches of depth 0..maxDepth from the loaded terrain and write
+    // them to `path` (via a temporary file, so readers never see a partial one).
+    // Returns false if writing fails or `cancel` becomes true.
+    static bool build(const std::string& path, uint64_t terrainHash, double radius,
+                      uint32_t gridSize, uint32_t maxDepth, const std::atomic<bool>& cancel);
+
+    // Vertices of the patch with this key (verticesPerPatch() of them), or nullptr.
+    // Valid while the cache stays open.
+    const ChunkVertex* find(uint64_t key, glm::dvec3& worldCenter, float& positionScale) const;
+
+    bool     isOpen() const { return file_.isOpen(); }
+    uint32_t maxDepth() const { return isOpen() ? header()->maxDepth : 0; }
+    uint32_t verticesPerPatch() const { return isOpen() ? header()->verticesPerPatch : 0; }
+    size_t   entryCount() const { return isOpen() ? header()->entryCount : 0; }
+
+private:
+    const PatchDiskHeader* header() const {
+        return reinterpret_cast<const PatchDiskHeader*>(file_.data());
+    }
+
+    luna::util::MappedFile file_;
+};
+
+} // namespace luna::scene
@@ -0,0 +1,81 @@
+// About: QuadtreePool implementation — sibling block allocation and reuse.
+
+#include "scene/QuadtreePool.h"
+#include "scene/TerrainArena.h"
+
+namespace luna::scene {
+
+NodeId QuadtreePool::allocateSiblings() {
+    NodeId first;
+    if (!freeBlocks_.empty()) {
+        first = freeBlocks_.back();
+        freeBlocks_.pop_back();
+    } else {
+        first = capacity();
+        uint32_t size = first + 4;
+        worldCenter_.resize(size);
+        boundingRadius_.resize(size);
+        positionScale_.resize(size);
+        morph_.resize(size);
+        edgeMorph_.resize(size);
+        stitch_.resize(size);
+        depth_.resize(size);
+        flags_.resize(size);
+        firstChild_.resize(size);
+        slot_.resize(size);
+        stableTravel_.resize(size);
+        stableFrame_.resize(size);
+        subtreeLeaves_.resize(size);
+        subtreeDepth_.resize(size);
+        info_.resize(size);
+    }
+    for (NodeId n = first; n < first + 4; n++)
+        resetNode(n);
+    return first;
+}
+
+void QuadtreePool::freeSiblings(NodeId first) {
+    // Reset now so dropped jobs release their shared state immediately
+    for (NodeId n = first; n < first + 4; n++)
+        resetNode(n);
+    freeBlocks_.push_back(first);
+}
+
+void QuadtreePool::resetNode(NodeId n) {
+    worldCenter_[n]    = glm::dvec3(0.0);
+    boundingRadius_[n] = 0.0;
+    positionScale_[n]  = 1.0f;
+    morph_[n]          = 0.0f;
+    edgeMorph_[n]      = glm::vec4(0.0f);
+    stitch_[n]         = 0;
+    depth_[n]          = 0;
+    flags_[n]          = 0;
+    firstChild_[n]     = INVALID_NODE;
+    slot_[n]           = TerrainArena::INVALID_SLOT;
+    stableTravel_[n]   = 0.0;  // visited by the next walk
+    stableFrame_[n]    = 0;
+    subtreeLeaves_[n]  = 1;
+    subtreeDepth_[n]   = 0;
+    info_[n]           = NodeInfo{};
+}
+
+void QuadtreePool::clear() {
+    worldCenter_.clear();
+    boundingRadius_.clear();
+    positionScale_.clear();
+    morph_.clear();
+    edgeMorph_.clear();
+    stitch_.clear();
+    depth_.clear();
+    flags_.clear();
+    firstChild_.clear();
+    slot_.clear();
+    stableTravel_.clear();
+    stableFrame_.clear();
+    subtreeLeaves_.clear();
+    subtreeDepth_.clear();
+    info_.clear();
+    freeBlocks_.clear();
+}
+
+} // namespace luna::scene
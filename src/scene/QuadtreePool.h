@@ -0,0 +1,119 @@
+// About: Flat quadtree node storage — sibling blocks of four, index links, SoA traversal fields.
+
+#pragma once
+
+#include "util/Math.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace luna::scene {
+
+struct ChunkJob;
+
+using NodeId = uint32_t;
+inline constexpr NodeId INVALID_NODE = UINT32_MAX;
+
+// Node state only read when a node changes: split/merge requests and installs
+struct NodeInfo {
+    int    faceIndex = 0;
+    double u0 = 0.0, u1 = 0.0, v0 = 0.0, v1 = 0.0;
+
+    // In-flight generation: children for a pending split, or this node's own
+    // mesh for a pending merge. The node keeps drawing as-is until they land.
+    std::array<std::shared_ptr<ChunkJob>, 4> pendingChildren;
+    std::shared_ptr<ChunkJob>                pendingMesh;
+};
+
+// Nodes live in parallel arrays indexed by NodeId. The four children of a node are
+// always allocated together, so a node stores only the id of its first child and
+// sibling i is `firstChild + i`. The fields a full traversal touches every frame
+// are kept in their own arrays; everything else sits in NodeInfo.
+// Ids stay valid until their block is freed, but references into the arrays are
+// invalidated by allocateSiblings().
+class QuadtreePool {
+public:
+    enum Flags : uint8_t {
+        SPLIT_PENDING   = 1 << 0,  // info.pendingChildren are set
+        MERGE_PENDING   = 1 << 1,  // info.pendingMesh is set
+        SPLIT_FORCED    = 1 << 2,  // the pending split keeps a neighbour's split 2:1 restricted
+        REFRESH_PENDING = 1 << 3,  // a leaf drawn from stale heights; info.pendingMesh, once set, replaces it
+    };
+
+    // Allocate four contiguous, reset nodes and return the first id
+    NodeId allocateSiblings();
+
+    // Return a block from allocateSiblings() to the pool; its jobs are dropped
+    void freeSiblings(NodeId first);
+
+    bool isLeaf(NodeId n) const { return firstChild_[n] == INVALID_NODE; }
+
+    glm::dvec3& worldCenter(NodeId n)    { return worldCenter_[n]; }
+    double&     boundingRadius(NodeId n) { return boundingRadius_[n]; }
+    float&      positionScale(NodeId n)  { return positionScale_[n]; }
+    float&      morph(NodeId n)          { return morph_[n]; }
+    glm::vec4&  edgeMorph(NodeId n)      { return edgeMorph_[n]; }
+    uint8_t&    stitch(NodeId n)         { return stitch_[n]; }
+    uint8_t&    depth(NodeId n)          { return depth_[n]; }
+    uint8_t&    flags(NodeId n)          { return flags_[n]; }
+    NodeId&     firstChild(NodeId n)     { return firstChild_[n]; }
+    uint32_t&   slot(NodeId n)           { return slot_[n]; }
+    double&     stableTravel(NodeId n)   { return stableTravel_[n]; }
+    uint32_t&   stableFrame(NodeId n)    { return stableFrame_[n]; }
+    uint32_t&   subtreeLeaves(NodeId n)  { return subtreeLeaves_[n]; }
+    uint8_t&    subtreeDepth(NodeId n)   { return subtreeDepth_[n]; }
+    NodeInfo&   info(NodeId n)           { return info_[n]; }
+
+    const glm::dvec3& worldCenter(NodeId n) const    { return worldCenter_[n]; }
+    double            boundingRadius(NodeId n) const { return boundingRadius_[n]; }
+    float             positionScale(NodeId n) const  { return positionScale_[n]; }
+    float             morph(NodeId n) const          { return morph_[n]; }
+    const glm::vec4&  edgeMorph(NodeId n) const      { return edgeMorph_[n]; }
+    uint8_t           stitch(NodeId n) const         { return stitch_[n]; }
+    uint8_t           depth(NodeId n) const          { return depth_[n]; }
+    uint8_t           flags(NodeId n) const          { return flags_[n]; }
+    NodeId            firstChild(NodeId n) const     { return firstChild_[n]; }
+    uint32_t          slot(NodeId n) const           { return slot_[n]; }
+    double            stableTravel(NodeId n) const   { return stableTravel_[n]; }
+    uint32_t          stableFrame(NodeId n) const    { return stableFrame_[n]; }
+    uint32_t          subtreeLeaves(NodeId n) const  { return subtreeLeaves_[n]; }
+    uint8_t           subtreeDepth(NodeId n) const   { return subtreeDepth_[n]; }
+    const NodeInfo&   info(NodeId n) const           { return info_[n]; }
+
+    uint32_t liveCount() const { return capacity() - static_cast<uint32_t>(freeBlocks_.size()) * 4; }
+    uint32_t capacity() const  { return static_cast<uint32_t>(firstChild_.size()); }
+
+    // Drop every node and job
+    void clear();
+
+private:
+    void resetNode(NodeId n);
+
+    // Hot: read by every LOD and draw traversal
+    std::vector<glm::dvec3> worldCenter_;
+    std::vector<double>     boundingRadius_;
+    std::vector<float>      positionScale_;  // dequantisation scale of the slot's vertices
+    std::vector<float>      morph_;          // 0: own shape, 1: parent's shape (geomorph)
+    std::vector<glm::vec4>  edgeMorph_;      // per edge, shared with the neighbour across it
+    std::vector<uint8_t>    stitch_;         // PatchEdge bits of edges with a coarser neighbour
+    std::vector<uint8_t>    depth_;
+    std::vector<uint8_t>    flags_;
+    std::vector<NodeId>     firstChild_;
+    std::vector<uint32_t>   slot_;      // geometry in the terrain arena
+
+    // Incremental LOD walk: the subtree needs no visit while the camera's path
+    // length stays below stableTravel and the frame counter below stableFrame.
+    // Its leaf count and deepest leaf stand in for it meanwhile.
+    std::vector<double>     stableTravel_;
+    std::vector<uint32_t>   stableFrame_;
+    std::vector<uint32_t>   subtreeLeaves_;
+    std::vector<uint8_t>    subtreeDepth_;
+
+    // Cold
+    std::vector<NodeInfo>   info_;
+
+    std::vector<NodeId>     freeBlocks_;  // first ids of freed sibling blocks
+};
+
+} // namespace luna::scene
@@ -1,4 +1,4 @@
-// About: Generates random star directions on the unit sphere and uploads as point mesh.
+// About: Generates random star directions on the unit sphere and uploads as a non-indexed point mesh.
 
 #include "scene/Starfield.h"
 
@@ -20,7 +20,6 @@ Starfield::Starfield(const luna::core::VulkanContext& ctx,
     std::uniform_real_distribution<float> uniform01(0.0f, 1.0f);
 
     std::vector<StarVertex> vertices(starCount);
-    std::vector<uint32_t> indices(starCount);
 
     for (uint32_t i = 0; i < starCount; i++) {
         // Uniform random point on unit sphere (spherical coordinates)
@@ -36,15 +35,13 @@ Starfield::Starfield(const luna::core::VulkanContext& ctx,
         // Random brightness with bias toward dim stars (more realistic distribution)
         float r = uniform01(rng);
         vertices[i].brightness = r * r * r;  // cubic falloff: mostly dim, few bright
-
-        indices[i] = i;
     }
 
+    // Points are drawn in vertex order, so identity indices would only cost a buffer
     mesh_ = Mesh(ctx, cmdPool,
                  vertices.data(),
                  static_cast<uint32_t>(vertices.size() * sizeof(StarVertex)),
-                 indices.data(),
-                 static_cast<uint32_t>(indices.size()));
+                 starCount);
 }
 
 void Starfield::draw(VkCommandBuffer cmd, VkPipelineLayout layout,
@@ -0,0 +1,150 @@
+// About: TerrainArena implementation — slot free list, staged or in-place slot writes, slot draws.
+
+#include "scene/TerrainArena.h"
+#include "core/VulkanContext.h"
+#include "util/Log.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace luna::scene {
+
+TerrainArena::TerrainArena(const luna::core::VulkanContext& ctx, uint32_t slotCount,
+                           uint32_t verticesPerSlot, uint32_t indexCount,
+                           VkBufferUsageFlags extraVertexUsage)
+    : slotCount_(slotCount), verticesPerSlot_(verticesPerSlot), indexCount_(indexCount)
+{
+    if (verticesPerSlot > UINT16_MAX + 1u)
+        throw std::runtime_error("Terrain patch too large for 16-bit indices");
+
+    VkDeviceSize vertexBytes = static_cast<VkDeviceSize>(slotCount) * verticesPerSlot * sizeof(ChunkVertex);
+    VkDeviceSize indexBytes  = static_cast<VkDeviceSize>(indexCount) * sizeof(uint16_t);
+    VkDeviceSize centerBytes = static_cast<VkDeviceSize>(slotCount) * sizeof(PatchCenter);
+    VkBufferUsageFlags vertexUsage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | extraVertexUsage;
+
+    // All three direct or none, so each upload path covers the whole slot
+    vertexBuffer_ = luna::core::Buffer::createDirect(ctx, vertexUsage, vertexBytes);
+    if (vertexBuffer_.handle()) {
+        indexBuffer_  = luna::core::Buffer::createDirect(ctx, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexBytes);
+        centerBuffer_ = luna::core::Buffer::createDirect(ctx, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, centerBytes);
+    }
+    if (vertexBuffer_.handle() && indexBuffer_.handle() && centerBuffer_.handle()) {
+        vertices_ = static_cast<ChunkVertex*>(vertexBuffer_.map());
+        centers_  = static_cast<PatchCenter*>(centerBuffer_.map());
+    }
+    if (!isDirect()) {
+        vertexBuffer_ = luna::core::Buffer::createDeviceLocal(ctx, vertexUsage, vertexBytes);
+        indexBuffer_  = luna::core::Buffer::createDeviceLocal(ctx, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexBytes);
+        centerBuffer_ = luna::core::Buffer::createDeviceLocal(ctx, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, centerBytes);
+    }
+
+    // Hand out low slots first so the live range stays compact
+    freeSlots_.reserve(slotCount);
+    for (uint32_t i = slotCount; i > 0; i--)
+        freeSlots_.push_back(i - 1);
+
+    LOG_INFO("Terrain arena: %u slots, %.1f MB, %s", slotCount,
+             static_cast<double>(vertexBytes + indexBytes + centerBytes) / (1024.0 * 1024.0),
+             isDirect() ? "written in place" : "staged");
+}
+
+uint32_t TerrainArena::allocate() {
+    if (freeSlots_.empty()) return INVALID_SLOT;
+    uint32_t slot = freeSlots_.back();
+    freeSlots_.pop_back();
+    return slot;
+}
+
+void TerrainArena::free(uint32_t slot) {
+    if (slot != INVALID_SLOT) freeSlots_.push_back(slot);
+}
+
+void TerrainArena::uploadIndices(VkCommandBuffer transferCmd, luna::core::StagingBatch& staging,
+                                 const std::vector<uint16_t>& indices) {
+    if (indices.size() != indexCount_)
+        throw std::runtime_error("Patch topology does not match terrain arena index count");
+    if (isDirect()) {
+        std::memcpy(indexBuffer_.map(), indices.data(), indices.size() * sizeof(uint16_t));
+        return;
+    }
+    indexBuffer_.recordUpload(transferCmd, staging, indices.data(),
+                              static_cast<VkDeviceSize>(indices.size()) * sizeof(uint16_t), 0);
+}
+
+void TerrainArena::upload(uint32_t slot, VkCommandBuffer transferCmd,
+                          luna::core::StagingBatch& staging,
+                          const ChunkVertex* vertices, uint32_t vertexCount,
+                          const glm::dvec3& center) {
+    if (vertexCount > verticesPerSlot_)
+        throw std::runtime_error("Patch does not match terrain arena slot size");
+
+    vertexBuffer_.recordUpload(transferCmd, staging, vertices,
+                               static_cast<VkDeviceSize>(vertexCount) * sizeof(ChunkVertex),
+                               static_cast<VkDeviceSize>(slot) * verticesPerSlot_ * sizeof(ChunkVertex));
+    uploadCenter(slot, transferCmd, staging, center);
+}
+
+ChunkVertex* TerrainArena::stageVertices(uint32_t slot, VkCommandBuffer transferCmd,
+                                         luna::core::StagingBatch& staging) {
+    VkBufferCopy copy{};
+    copy.size      = static_cast<VkDeviceSize>(verticesPerSlot_) * sizeof(ChunkVertex);
+    copy.srcOffset = staging.reserve(copy.size);
+    copy.dstOffset = static_cast<VkDeviceSize>(slot) * verticesPerSlot_ * sizeof(ChunkVertex);
+    vkCmdCopyBuffer(transferCmd, staging.handle, vertexBuffer_.handle(), 1, &copy);
+    return static_cast<ChunkVertex*>(staging.at(copy.srcOffset));
+}
+
+void TerrainArena::copyVertices(uint32_t slot, VkCommandBuffer transferCmd, VkBuffer src,
+                                VkDeviceSize srcOffset) {
+    VkBufferCopy copy{};
+    copy.srcOffset = srcOffset;
+    copy.dstOffset = static_cast<VkDeviceSize>(slot) * verticesPerSlot_ * sizeof(ChunkVertex);
+    copy.size      = static_cast<VkDeviceSize>(verticesPerSlot_) * sizeof(ChunkVertex);
+    vkCmdCopyBuffer(transferCmd, src, vertexBuffer_.handle(), 1, &copy);
+}
+
+void TerrainArena::uploadCenter(uint32_t slot, VkCommandBuffer transferCmd,
+                                luna::core::StagingBatch& staging, const glm::dvec3& center) {
+    glm::vec3 high, low;
+    luna::util::splitDouble(center, high, low);
+    PatchCenter entry{glm::vec4(high, 0.0f), glm::vec4(low, 0.0f)};
+    centerBuffer_.recordUpload(transferCmd, staging, &entry, sizeof(PatchCenter),
+                               static_cast<VkDeviceSize>(slot) * sizeof(PatchCenter));
+}
+
+void TerrainArena::write(uint32_t slot, const ChunkVertex* vertices, uint32_t vertexCount,
+                         const glm::dvec3& center) {
+    if (vertexCount > verticesPerSlot_)
+        throw std::runtime_error("Patch does not match terrain arena slot size");
+    std::memcpy(slotVertices(slot), vertices, static_cast<size_t>(vertexCount) * sizeof(ChunkVertex));
+    writeCenter(slot, center);
+}
+
+void TerrainArena::writeCenter(uint32_t slot, const glm::dvec3& center) {
+    glm::vec3 high, low;
+    luna::util::splitDouble(center, high, low);
+    centers_[slot] = PatchCenter{glm::vec4(high, 0.0f), glm::vec4(low, 0.0f)};
+}
+
+void TerrainArena::bind(VkCommandBuffer cmd) const {
+    VkBuffer buffers[] = { vertexBuffer_.handle() };
+    VkDeviceSize offsets[] = { 0 };
+    vkCmdBindVertexBuffers(cmd, 0, 1, buffers, offsets);
+    vkCmdBindIndexBuffer(cmd, indexBuffer_.handle(), 0, VK_INDEX_TYPE_UINT16);
+}
+
+void TerrainArena::drawSlot(VkCommandBuffer cmd, uint32_t slot, const IndexRange& indices,
+                            uint32_t firstInstance) const {
+    vkCmdDrawIndexed(cmd, indices.count, 1, indices.first,
+                     static_cast<int32_t>(slot * verticesPerSlot_), firstInstance);
+}
+
+void TerrainArena::release() {
+    vertices_ = nullptr;
+    centers_  = nullptr;
+    vertexBuffer_.release();
+    indexBuffer_.release();
+    centerBuffer_.release();
+}
+
+} // namespace luna::scene
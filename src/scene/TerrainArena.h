@@ -0,0 +1,115 @@
+// About: Fixed-slot geometry arena — one vertex buffer of patch slots, their centres, and the shared patch index buffer.
+
+#pragma once
+
+#include "core/Buffer.h"
+#include "scene/ChunkGenerator.h"
+#include "util/Math.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+namespace luna::core {
+class VulkanContext;
+}
+
+namespace luna::scene {
+
+// Matches PatchCenter in shaders/terrain.vert, terrain_indirect.vert and
+// terrain_cull.comp (std430). A slot's world-space centre as a float pair whose
+// sum keeps double precision (luna::util::splitDouble); w is unused.
+struct PatchCenter {
+    glm::vec4 high;
+    glm::vec4 low;
+};
+static_assert(sizeof(PatchCenter) == 32);
+
+// Every cubesphere patch has the same vertex count and the same topology, so the
+// vertex buffer is split into equal slots addressed by index and a single 16-bit
+// index buffer, holding every stitch variant, serves all of them. Draws select a
+// slot through vertexOffset and a variant through its index range, so both buffers
+// are bound once per frame.
+//
+// Each slot's world-space centre sits in a device-local storage buffer beside its
+// vertices. It is written in the same transfer batch as the slot, so it changes
+// only when a patch is created; shaders subtract the camera from it per frame.
+//
+// Where the GPU has a large enough device-local heap the host can map (resizable
+// BAR, unified memory), all three buffers live there and slots are written in
+// place: write(), writeCenter() and slotVertices() replace the staged upload calls,
+// and nothing goes through the transfer queue. The host writes land before the
+// next frame's queue submit, which makes them visible to it, and a slot is only
+// rewritten after retiring, when no frame in flight draws it.
+class TerrainArena {
+public:
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+    // extraVertexUsage adds usage to the vertex buffer, e.g. STORAGE_BUFFER so a
+    // compute pass can write slots in place
+    TerrainArena(const luna::core::VulkanContext& ctx, uint32_t slotCount,
+                 uint32_t verticesPerSlot, uint32_t indexCount,
+                 VkBufferUsageFlags extraVertexUsage = 0);
+
+    // Slots are written by the host instead of uploaded
+    bool isDirect() const { return vertices_ != nullptr; }
+
+    // Record the copy of the shared patch topologies (ChunkGenerator::buildIndices).
+    // A direct arena writes them at once and leaves the batch untouched.
+    void uploadIndices(VkCommandBuffer transferCmd, luna::core::StagingBatch& staging,
+                       const std::vector<uint16_t>& indices);
+
+    // Returns INVALID_SLOT when the arena is full
+    uint32_t allocate();
+    void     free(uint32_t slot);
+
+    uint32_t slotCount() const { return slotCount_; }
+    uint32_t freeCount() const { return static_cast<uint32_t>(freeSlots_.size()); }
+    VkBuffer vertexBuffer() const { return vertexBuffer_.handle(); }
+    VkBuffer centerBuffer() const { return centerBuffer_.handle(); }
+
+    // Record the copy of one patch's vertices and world-space centre into `slot`
+    void upload(uint32_t slot, VkCommandBuffer transferCmd, luna::core::StagingBatch& staging,
+                const ChunkVertex* vertices, uint32_t vertexCount, const glm::dvec3& center);
+    // Reserve staging for a full slot of vertices and record their copy into `slot`.
+    // The caller writes the vertices to the returned memory before the batch is
+    // submitted, e.g. by generating the patch straight into it.
+    ChunkVertex* stageVertices(uint32_t slot, VkCommandBuffer transferCmd,
+                               luna::core::StagingBatch& staging);
+    // Record a copy of a slot's worth of vertices already in staging memory, e.g. a
+    // StagingSlots region a worker generated into
+    void copyVertices(uint32_t slot, VkCommandBuffer transferCmd, VkBuffer src,
+                      VkDeviceSize srcOffset);
+    // Record the copy of the centre alone, for slots whose vertices a compute pass writes
+    void uploadCenter(uint32_t slot, VkCommandBuffer transferCmd, luna::core::StagingBatch& staging,
+                      const glm::dvec3& center);
+
+    // Direct arenas only: the upload calls above as host writes into the slot
+    void write(uint32_t slot, const ChunkVertex* vertices, uint32_t vertexCount,
+               const glm::dvec3& center);
+    void writeCenter(uint32_t slot, const glm::dvec3& center);
+    // A slot's mapped vertices, e.g. to generate a patch straight into VRAM
+    ChunkVertex* slotVertices(uint32_t slot) const {
+        return vertices_ + static_cast<size_t>(slot) * verticesPerSlot_;
+    }
+
+    void bind(VkCommandBuffer cmd) const;
+    // firstInstance lets the vertex shader find the draw's per-patch record
+    void drawSlot(VkCommandBuffer cmd, uint32_t slot, const IndexRange& indices,
+                  uint32_t firstInstance) const;
+
+    void release();
+
+private:
+    uint32_t slotCount_;
+    uint32_t verticesPerSlot_;
+    uint32_t indexCount_;
+
+    luna::core::Buffer    vertexBuffer_;
+    luna::core::Buffer    indexBuffer_;
+    luna::core::Buffer    centerBuffer_;
+    ChunkVertex*          vertices_ = nullptr;  // mapped vertex buffer of a direct arena
+    PatchCenter*          centers_  = nullptr;
+    std::vector<uint32_t> freeSlots_;
+};
+
+} // namespace luna::scene
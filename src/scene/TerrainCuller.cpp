@@ -0,0 +1,150 @@
+// About: TerrainCuller implementation — per-frame buffers, cull dispatch, barriers, indirect draws.
+
+#include "scene/TerrainCuller.h"
+#include "core/VulkanContext.h"
+#include "util/Log.h"
+
+namespace luna::scene {
+
+namespace {
+
+// Push constant layout must match shaders/terrain_cull.comp
+struct CullPC {
+    glm::vec4 frustumPlanes[6];
+    glm::vec3 cameraHigh;      // world-space camera, split by luna::util::splitDouble
+    float     occluderRadius;
+    glm::vec3 cameraLow;
+    uint32_t  patchCount;
+};
+static_assert(sizeof(CullPC) <= 128, "Cull push constants exceed the guaranteed minimum");
+
+constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+
+} // anonymous namespace
+
+bool TerrainCuller::isSupported(const luna::core::VulkanContext& ctx) {
+    const auto& f = ctx.enabledFeatures();
+    return f.multiDrawIndirect && f.drawIndirectFirstInstance;
+}
+
+TerrainCuller::TerrainCuller(const luna::core::VulkanContext& ctx, uint32_t maxPatches,
+                             VkBuffer patchCenters)
+    : ctx_(ctx), maxPatches_(maxPatches),
+      drawIndirectCount_(ctx.drawIndexedIndirectCount()),
+      cullSetLayout_(ctx, {
+          luna::core::DescriptorSetLayout::storageBuffer(0, VK_SHADER_STAGE_COMPUTE_BIT),
+          luna::core::DescriptorSetLayout::storageBuffer(1, VK_SHADER_STAGE_COMPUTE_BIT),
+          luna::core::DescriptorSetLayout::storageBuffer(2, VK_SHADER_STAGE_COMPUTE_BIT),
+          luna::core::DescriptorSetLayout::storageBuffer(3, VK_SHADER_STAGE_COMPUTE_BIT),
+      }),
+      drawSetLayout_(ctx, {
+          luna::core::DescriptorSetLayout::storageBuffer(0, VK_SHADER_STAGE_VERTEX_BIT),
+      }),
+      pool_(ctx, 2 * luna::core::MAX_FRAMES_IN_FLIGHT, {
+          {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5 * luna::core::MAX_FRAMES_IN_FLIGHT},
+      }),
+      cullPipeline_(luna::core::Pipeline::ComputeBuilder(ctx)
+                        .setShader("shaders/terrain_cull.comp.spv")
+                        .addDescriptorSetLayout(cullSetLayout_.handle())
+                        .setPushConstantSize(sizeof(CullPC))
+                        .build())
+{
+    VkDeviceSize recordBytes = static_cast<VkDeviceSize>(maxPatches) * sizeof(PatchRecord);
+    VkDeviceSize drawBytes   = static_cast<VkDeviceSize>(maxPatches) * sizeof(VkDrawIndexedIndirectCommand);
+
+    for (auto& frame : frames_) {
+        frame.records = luna::core::Buffer::createDynamic(ctx, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                          recordBytes);
+        frame.mapped  = static_cast<PatchRecord*>(frame.records.map());
+        frame.draws   = luna::core::Buffer::createDeviceLocal(ctx,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, drawBytes);
+        frame.count   = luna::core::Buffer::createDeviceLocal(ctx,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, sizeof(uint32_t));
+
+        frame.cullSet = pool_.allocate(cullSetLayout_.handle());
+        luna::core::writeStorageBuffer(ctx.device(), frame.cullSet, 0, frame.records.handle());
+        luna::core::writeStorageBuffer(ctx.device(), frame.cullSet, 1, frame.draws.handle());
+        luna::core::writeStorageBuffer(ctx.device(), frame.cullSet, 2, frame.count.handle());
+        luna::core::writeStorageBuffer(ctx.device(), frame.cullSet, 3, patchCenters);
+
+        frame.drawSet = pool_.allocate(drawSetLayout_.handle());
+        luna::core::writeStorageBuffer(ctx.device(), frame.drawSet, 0, frame.records.handle());
+    }
+
+    LOG_INFO("GPU-driven terrain culling ready (%s)",
+             drawIndirectCount_ ? "draw indirect count" : "fixed-count indirect");
+}
+
+void TerrainCuller::recordCull(VkCommandBuffer cmd, uint32_t frame, uint32_t patchCount,
+                               const glm::vec4 frustumPlanes[6], const glm::dvec3& cameraPos,
+                               float occluderRadius) {
+    FrameResources& fr = frames_[frame];
+
+    // The shader always appends. Without a count buffer the fixed-count draw reads
+    // patchCount commands, so the ones past the visible set are zeroed to no-ops.
+    vkCmdFillBuffer(cmd, fr.count.handle(), 0, sizeof(uint32_t), 0);
+    if (!drawIndirectCount_ && patchCount > 0)
+        vkCmdFillBuffer(cmd, fr.draws.handle(), 0,
+                        static_cast<VkDeviceSize>(patchCount) * sizeof(VkDrawIndexedIndirectCommand), 0);
+
+    VkMemoryBarrier clearBarrier{};
+    clearBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+                               | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    if (patchCount > 0) {
+        CullPC pc{};
+        for (int i = 0; i < 6; i++) pc.frustumPlanes[i] = frustumPlanes[i];
+        luna::util::splitDouble(cameraPos, pc.cameraHigh, pc.cameraLow);
+        pc.occluderRadius = occluderRadius;
+        pc.patchCount     = patchCount;
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline_.handle());
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline_.layout(),
+                                0, 1, &fr.cullSet, 0, nullptr);
+        vkCmdPushConstants(cmd, cullPipeline_.layout(), VK_SHADER_STAGE_COMPUTE_BIT,
+                           0, sizeof(CullPC), &pc);
+        vkCmdDispatch(cmd, (patchCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+    }
+
+    // Draw commands and count are consumed by the indirect draw in the render pass
+    VkMemoryBarrier drawBarrier{};
+    drawBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         0, 1, &drawBarrier, 0, nullptr, 0, nullptr);
+}
+
+void TerrainCuller::draw(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t frame,
+                         uint32_t patchCount) const {
+    if (patchCount == 0) return;
+    const FrameResources& fr = frames_[frame];
+
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
+                            1, 1, &fr.drawSet, 0, nullptr);
+
+    if (drawIndirectCount_) {
+        drawIndirectCount_(cmd, fr.draws.handle(), 0, fr.count.handle(), 0,
+                           patchCount, sizeof(VkDrawIndexedIndirectCommand));
+    } else {
+        vkCmdDrawIndexedIndirect(cmd, fr.draws.handle(), 0, patchCount,
+                                 sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
+
+void TerrainCuller::release() {
+    for (auto& frame : frames_) {
+        frame.records.release();
+        frame.draws.release();
+        frame.count.release();
+        frame.mapped = nullptr;
+    }
+}
+
+} // namespace luna::scene
@@ -0,0 +1,90 @@
+// About: GPU-driven terrain culling — patch record SSBO, cull compute pass, indirect draws.
+
+#pragma once
+
+#include "core/Buffer.h"
+#include "core/Descriptors.h"
+#include "core/Pipeline.h"
+#include "core/Sync.h"
+#include "util/Math.h"
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+
+namespace luna::core {
+class VulkanContext;
+}
+
+namespace luna::scene {
+
+// Matches PatchRecord in shaders/terrain_cull.comp, terrain_indirect.vert and
+// terrain.vert (std430). The CPU-culled path writes the same records into its frame ring.
+// Nothing in a record depends on the camera: the patch centre is the slot's
+// TerrainArena PatchCenter, made camera-relative in the shaders.
+struct PatchRecord {
+    uint32_t  slot;           // arena slot: indexes TerrainArena's centre buffer
+    float     boundingRadius;
+    int32_t   vertexOffset;   // first vertex of the patch's arena slot
+    float     positionScale;  // dequantises the slot's ChunkVertex positions
+    float     morph;          // geomorph factor toward the parent's shape
+    uint32_t  indexRange;     // firstIndex | indexCount << 16 of the patch's stitch variant
+    uint32_t  _pad[2];
+    glm::vec4 edgeMorph;      // geomorph factor of each edge's vertices (PatchEdge order)
+};
+static_assert(sizeof(PatchRecord) == 48);
+
+// The CPU writes one PatchRecord per active leaf into a per-frame host-visible
+// SSBO. recordCull() dispatches terrain_cull.comp, which frustum- and horizon-tests
+// each record and appends VkDrawIndexedIndirectCommands for the record's index range; draw() consumes them with
+// vkCmdDrawIndexedIndirectCount when VK_KHR_draw_indirect_count is present, or a
+// fixed-count vkCmdDrawIndexedIndirect over a command buffer cleared to no-op draws otherwise.
+// The camera reaches the shader as a high/low float pair once per dispatch.
+class TerrainCuller {
+public:
+    // patchCenters is TerrainArena::centerBuffer(), which records index by slot
+    TerrainCuller(const luna::core::VulkanContext& ctx, uint32_t maxPatches, VkBuffer patchCenters);
+
+    // Requires multiDrawIndirect and drawIndirectFirstInstance
+    static bool isSupported(const luna::core::VulkanContext& ctx);
+
+    uint32_t     maxPatches() const { return maxPatches_; }
+    PatchRecord* records(uint32_t frame) { return frames_[frame].mapped; }
+
+    // Set 1 of the indirect terrain pipeline (patch records, vertex stage); set 0 is
+    // CubesphereBody::frameSetLayout()
+    VkDescriptorSetLayout drawSetLayout() const { return drawSetLayout_.handle(); }
+
+    // Record the cull dispatch. Must be outside a render pass.
+    void recordCull(VkCommandBuffer cmd, uint32_t frame, uint32_t patchCount,
+                    const glm::vec4 frustumPlanes[6], const glm::dvec3& cameraPos,
+                    float occluderRadius);
+
+    // Record the indirect draws. Pipeline, vertex and index buffers must be bound.
+    void draw(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t frame,
+              uint32_t patchCount) const;
+
+    void release();
+
+private:
+    struct FrameResources {
+        luna::core::Buffer records;
+        luna::core::Buffer draws;
+        luna::core::Buffer count;
+        PatchRecord*       mapped  = nullptr;
+        VkDescriptorSet    cullSet = VK_NULL_HANDLE;
+        VkDescriptorSet    drawSet = VK_NULL_HANDLE;
+    };
+
+    const luna::core::VulkanContext&     ctx_;
+    uint32_t                             maxPatches_;
+    PFN_vkCmdDrawIndexedIndirectCountKHR drawIndirectCount_;
+
+    luna::core::DescriptorSetLayout cullSetLayout_;
+    luna::core::DescriptorSetLayout drawSetLayout_;
+    luna::core::DescriptorPool      pool_;
+    luna::core::Pipeline            cullPipeline_;
+
+    std::array<FrameResources, luna::core::MAX_FRAMES_IN_FLIGHT> frames_;
+};
+
+} // namespace luna::scene
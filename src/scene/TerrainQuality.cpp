@@ -0,0 +1,165 @@
+// About: TerrainQuality presets, config file parsing and validation, and the QualityController.
+
+#include "scene/TerrainQuality.h"
+#include "util/Log.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace luna::scene {
+
+namespace {
+
+TerrainQuality makePreset(uint32_t grid, double split, uint32_t splits, uint32_t batch,
+                          double minSplit, double maxSplit) {
+    TerrainQuality q;
+    q.patchGrid         = grid;
+    q.splitThreshold    = split;
+    q.mergeThreshold    = split * 0.5;
+    q.maxSplitsPerFrame = splits;
+    q.meshesPerBatch    = batch;
+    q.minSplitThreshold = minSplit;
+    q.maxSplitThreshold = maxSplit;
+    return q;
+}
+
+} // anonymous namespace
+
+bool TerrainQuality::sanitize() {
+    TerrainQuality defaults;
+    bool ok = true;
+    auto fix = [&ok](const char* what) {
+        LOG_WARN("Terrain quality: %s", what);
+        ok = false;
+    };
+
+    if (patchGrid < MIN_PATCH_GRID || patchGrid > MAX_PATCH_GRID) {
+        fix("patch_grid must be within [5, 27]");
+        patchGrid = std::clamp(patchGrid, MIN_PATCH_GRID, MAX_PATCH_GRID);
+    }
+    if (patchGrid % 2 == 0) {
+        fix("patch_grid must be odd");
+        patchGrid++;
+    }
+    if (!(splitThreshold > 0.0)) {
+        fix("split_threshold must be positive");
+        splitThreshold = defaults.splitThreshold;
+    }
+    if (!(mergeThreshold > 0.0) || mergeThreshold >= splitThreshold) {
+        fix("merge_threshold must be positive and below split_threshold");
+        mergeThreshold = splitThreshold * 0.5;
+    }
+    // A split takes four meshes at once
+    if (maxSplitsPerFrame < 4) {
+        fix("max_splits_per_frame must be at least 4");
+        maxSplitsPerFrame = 4;
+    }
+    if (meshesPerBatch == 0) {
+        fix("meshes_per_batch must be at least 1");
+        meshesPerBatch = 1;
+    }
+    if (!(lodBudgetMs > 0.0)) {
+        fix("lod_budget_ms must be positive");
+        lodBudgetMs = defaults.lodBudgetMs;
+    }
+    if (!(targetFrameMs >= 0.0)) {
+        fix("target_frame_ms must not be negative");
+        targetFrameMs = 0.0;
+    }
+    if (!(minSplitThreshold > 0.0) || maxSplitThreshold < minSplitThreshold) {
+        fix("split threshold bounds must be positive and ordered");
+        minSplitThreshold = std::min(defaults.minSplitThreshold, splitThreshold);
+        maxSplitThreshold = std::max(defaults.maxSplitThreshold, splitThreshold);
+    }
+    return ok;
+}
+
+bool qualityPreset(const std::string& name, TerrainQuality& quality) {
+    // Integrated GPUs: coarser terrain, fewer meshes in flight
+    if (name == "low")
+        quality = makePreset(17, 10.0, 16, 256, 6.0, 32.0);
+    else if (name == "medium")
+        quality = TerrainQuality{};
+    else if (name == "high")
+        quality = makePreset(17, 4.0, 48, 512, 2.0, 16.0);
+    // Fewer, denser patches: less per-node overhead for the same triangle budget
+    else if (name == "ultra")
+        quality = makePreset(25, 3.0, 64, 1024, 1.5, 12.0);
+    else
+        return false;
+    return true;
+}
+
+bool loadQualityConfig(const std::string& path, TerrainQuality& quality) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    TerrainQuality q = quality;
+    std::string line;
+    for (uint32_t lineNo = 1; std::getline(in, line); lineNo++) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream ls(line);
+        std::string key;
+        if (!(ls >> key)) continue;
+
+        bool ok = true;
+        if (key == "preset") {
+            std::string name;
+            ok = (ls >> name) && qualityPreset(name, q);
+        } else if (key == "patch_grid") {
+            ok = static_cast<bool>(ls >> q.patchGrid);
+        } else if (key == "split_threshold") {
+            ok = static_cast<bool>(ls >> q.splitThreshold);
+        } else if (key == "merge_threshold") {
+            ok = static_cast<bool>(ls >> q.mergeThreshold);
+        } else if (key == "max_splits_per_frame") {
+            ok = static_cast<bool>(ls >> q.maxSplitsPerFrame);
+        } else if (key == "meshes_per_batch") {
+            ok = static_cast<bool>(ls >> q.meshesPerBatch);
+        } else if (key == "lod_budget_ms") {
+            ok = static_cast<bool>(ls >> q.lodBudgetMs);
+        } else if (key == "retained_mesh_mb") {
+            ok = static_cast<bool>(ls >> q.retainedMeshMB);
+        } else if (key == "target_frame_ms") {
+            ok = static_cast<bool>(ls >> q.targetFrameMs);
+        } else if (key == "min_split_threshold") {
+            ok = static_cast<bool>(ls >> q.minSplitThreshold);
+        } else if (key == "max_split_threshold") {
+            ok = static_cast<bool>(ls >> q.maxSplitThreshold);
+        } else {
+            LOG_WARN("%s:%u: unknown key '%s'", path.c_str(), lineNo, key.c_str());
+            continue;
+        }
+        if (!ok) LOG_WARN("%s:%u: bad value for '%s'", path.c_str(), lineNo, key.c_str());
+    }
+    q.sanitize();
+    quality = q;
+    return true;
+}
+
+QualityController::QualityController(const TerrainQuality& quality)
+    : targetMs_(quality.targetFrameMs),
+      minThreshold_(quality.minSplitThreshold),
+      maxThreshold_(quality.maxSplitThreshold),
+      threshold_(quality.splitThreshold) {
+    if (enabled()) threshold_ = std::clamp(threshold_, minThreshold_, maxThreshold_);
+}
+
+bool QualityController::update(double frameMs) {
+    if (!enabled() || frameMs <= 0.0) return false;
+    averageMs_ = averageMs_ == 0.0 ? frameMs : averageMs_ + (frameMs - averageMs_) * SMOOTHING;
+    if (++frames_ < ADJUST_INTERVAL) return false;
+    frames_ = 0;
+
+    double next = threshold_;
+    if (averageMs_ > targetMs_ * OVER_BUDGET)
+        next = std::min(threshold_ * COARSEN_STEP, maxThreshold_);
+    else if (averageMs_ < targetMs_ * UNDER_BUDGET)
+        next = std::max(threshold_ / REFINE_STEP, minThreshold_);
+    if (next == threshold_) return false;
+    threshold_ = next;
+    return true;
+}
+
+} // namespace luna::scene
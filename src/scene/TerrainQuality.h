@@ -0,0 +1,93 @@
+// About: Runtime terrain LOD settings — named presets, a config file loader and an adaptive split threshold.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace luna::scene {
+
+// What CubesphereBody used to fix at compile time. The patch grid and batch size
+// are read at construction; the split threshold may change every frame.
+struct TerrainQuality {
+    // Vertices per patch edge: odd, so stitched edges can skip every other vertex
+    uint32_t patchGrid         = 17;
+    // Projected error in pixels above which a leaf splits, and below which four
+    // leaf children merge back. Geomorphing starts children of a fresh split at
+    // their parent's shape, which they have at about half its error, so the
+    // merge threshold is normally half the split threshold.
+    double   splitThreshold    = 6.0;
+    double   mergeThreshold    = 3.0;
+    // Cap on splits requested (and children uploaded), four meshes each, in an
+    // unscaled frame: load on the workers and the transfer queue
+    uint32_t maxSplitsPerFrame = 32;
+    // Meshes recorded into one transfer batch before it is submitted
+    uint32_t meshesPerBatch    = 512;
+    // Render-thread time per unscaled frame for installing, uploading and
+    // requesting splits and merges; work left over waits for the next frame
+    double   lodBudgetMs       = 2.0;
+    // Vertex memory in MiB for keeping split nodes' meshes, so merging back needs
+    // no generation or upload; 0 keeps none
+    uint32_t retainedMeshMB    = 0;
+
+    // Frame time QualityController holds by moving the split threshold between
+    // these bounds; 0 keeps the threshold fixed
+    double   targetFrameMs     = 0.0;
+    double   minSplitThreshold = 3.0;
+    double   maxSplitThreshold = 24.0;
+
+    // buildIndices() stays within 16-bit indices up to this grid
+    static constexpr uint32_t MIN_PATCH_GRID = 5;
+    static constexpr uint32_t MAX_PATCH_GRID = 27;
+
+    // Replace out-of-range values with the nearest usable ones, with a warning.
+    // Returns false if anything had to change.
+    bool sanitize();
+};
+
+// "low", "medium" (the defaults), "high" or "ultra". False for any other name.
+bool qualityPreset(const std::string& name, TerrainQuality& quality);
+
+// Line-based, '#' comments, one "<key> <value>" per line. "preset <name>" resets
+// every setting to that preset, so it belongs first; see assets/quality.txt for
+// the keys. Unknown keys and bad values are skipped with a warning. Returns false
+// if the file cannot be opened, leaving `quality` as it was.
+bool loadQualityConfig(const std::string& path, TerrainQuality& quality);
+
+// Holds the frame time near TerrainQuality::targetFrameMs by scaling the split
+// threshold: coarser terrain when frames run long, finer again when there is
+// headroom. Fed one frame cost per frame; changes happen at most every
+// ADJUST_INTERVAL frames, so one slow frame (a stall, a cache rebuild) does not
+// throw away detail, and in small steps, since each one changes the tree over the
+// following frames.
+class QualityController {
+public:
+    static constexpr uint32_t ADJUST_INTERVAL = 30;
+    static constexpr double   SMOOTHING       = 0.1;   // weight of a new frame in the average
+    static constexpr double   OVER_BUDGET     = 1.05;  // coarsen above this fraction of the target
+    static constexpr double   UNDER_BUDGET    = 0.85;  // refine below it
+    static constexpr double   COARSEN_STEP    = 1.15;
+    static constexpr double   REFINE_STEP     = 1.05;  // slower, so it settles rather than oscillates
+
+    explicit QualityController(const TerrainQuality& quality);
+
+    bool enabled() const { return targetMs_ > 0.0; }
+
+    // Account for one frame's cost in milliseconds: the busier of the CPU (time
+    // not spent waiting on a fence or the swapchain) and the GPU. Returns true when
+    // splitThreshold() changed.
+    bool update(double frameMs);
+
+    double splitThreshold() const { return threshold_; }
+    double averageMs() const { return averageMs_; }
+
+private:
+    double   targetMs_;
+    double   minThreshold_;
+    double   maxThreshold_;
+    double   threshold_;
+    double   averageMs_ = 0.0;
+    uint32_t frames_    = 0;
+};
+
+} // namespace luna::scene
@@ -0,0 +1,180 @@
+// About: Flight recording implementation — frame capture and apply, buffered writer, loader and sampler.
+
+#include "sim/FlightRecording.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace luna::sim {
+
+namespace {
+
+void store(double out[3], const glm::dvec3& v) {
+    out[0] = v.x; out[1] = v.y; out[2] = v.z;
+}
+
+void store(float out[3], const glm::dvec3& v) {
+    out[0] = static_cast<float>(v.x);
+    out[1] = static_cast<float>(v.y);
+    out[2] = static_cast<float>(v.z);
+}
+
+void store(float out[4], const glm::dquat& q) {
+    out[0] = static_cast<float>(q.w);
+    out[1] = static_cast<float>(q.x);
+    out[2] = static_cast<float>(q.y);
+    out[3] = static_cast<float>(q.z);
+}
+
+glm::dvec3 vec(const double v[3]) { return {v[0], v[1], v[2]}; }
+glm::dvec3 vec(const float v[3])  { return {v[0], v[1], v[2]}; }
+glm::dquat quat(const float q[4]) { return glm::normalize(glm::dquat(q[0], q[1], q[2], q[3])); }
+
+template <typename T, size_t N>
+void lerpArray(T (&out)[N], const T (&a)[N], const T (&b)[N], double t) {
+    for (size_t i = 0; i < N; i++)
+        out[i] = static_cast<T>(a[i] + (b[i] - a[i]) * t);
+}
+
+} // anonymous namespace
+
+FlightFrame captureFrame(double wallDt, const SimState& state, const SimControls& controls,
+                         const glm::dvec3& cameraPosition, const glm::dquat& cameraOrientation,
+                         uint8_t flags) {
+    FlightFrame f{};
+    f.wallDt      = wallDt;
+    f.missionTime = state.missionTime;
+    store(f.position, state.position);
+    store(f.velocity, state.velocity);
+    store(f.cameraPosition, cameraPosition);
+    store(f.orientation, state.orientation);
+    store(f.angularVelocity, state.angularVelocity);
+    store(f.cameraOrientation, cameraOrientation);
+    f.fuelMass        = static_cast<float>(state.fuelMass);
+    f.throttle        = static_cast<float>(state.throttle);
+    f.altitude        = static_cast<float>(state.altitude);
+    f.surfaceSpeed    = static_cast<float>(state.surfaceSpeed);
+    f.verticalSpeed   = static_cast<float>(state.verticalSpeed);
+    f.controlThrottle = static_cast<float>(controls.throttle);
+    store(f.controlTorque, controls.torqueInput);
+    f.timeWarp        = static_cast<float>(controls.timeWarp);
+    f.phase           = static_cast<uint8_t>(state.phase);
+    f.flags           = flags;
+    return f;
+}
+
+void applyFrame(const FlightFrame& f, SimState& state, SimControls& controls,
+                glm::dvec3& cameraPosition, glm::dquat& cameraOrientation) {
+    state.missionTime     = f.missionTime;
+    state.position        = vec(f.position);
+    state.velocity        = vec(f.velocity);
+    state.orientation     = quat(f.orientation);
+    state.angularVelocity = vec(f.angularVelocity);
+    state.fuelMass        = f.fuelMass;
+    state.throttle        = f.throttle;
+    state.torqueInput     = vec(f.controlTorque);
+    state.altitude        = f.altitude;
+    state.surfaceSpeed    = f.surfaceSpeed;
+    state.verticalSpeed   = f.verticalSpeed;
+    state.phase           = static_cast<FlightPhase>(f.phase);
+
+    controls.throttle    = f.controlThrottle;
+    controls.torqueInput = vec(f.controlTorque);
+    controls.timeWarp    = f.timeWarp;
+
+    cameraPosition    = vec(f.cameraPosition);
+    cameraOrientation = quat(f.cameraOrientation);
+}
+
+FlightRecorder::~FlightRecorder() {
+    close();
+}
+
+bool FlightRecorder::open(const std::string& path) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) return false;
+
+    FlightRecordingHeader header{};
+    std::memcpy(header.magic, "LFR1", 4);
+    header.version   = FlightRecording::VERSION;
+    header.frameSize = sizeof(FlightFrame);
+    std::fwrite(&header, sizeof(header), 1, file_);
+    frameCount_ = 0;
+    return true;
+}
+
+void FlightRecorder::append(const FlightFrame& frame) {
+    if (!file_) return;
+    std::fwrite(&frame, sizeof(frame), 1, file_);
+    frameCount_++;
+}
+
+void FlightRecorder::close() {
+    if (file_) std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool FlightRecording::load(const std::string& path) {
+    frames_.clear();
+    times_.clear();
+
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    auto fileSize = static_cast<size_t>(in.tellg());
+    in.seekg(0);
+
+    FlightRecordingHeader header{};
+    if (fileSize < sizeof(header) ||
+        !in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "LFR1", 4) != 0 || header.version != VERSION ||
+        header.frameSize != sizeof(FlightFrame))
+        return false;
+
+    // A trailing partial frame is what a crash mid-write leaves; drop it
+    frames_.resize((fileSize - sizeof(header)) / sizeof(FlightFrame));
+    in.read(reinterpret_cast<char*>(frames_.data()),
+            static_cast<std::streamsize>(frames_.size() * sizeof(FlightFrame)));
+    if (!in || frames_.empty()) {
+        frames_.clear();
+        return false;
+    }
+
+    // The first frame's wallDt reaches back before the recording started
+    times_.resize(frames_.size());
+    times_[0] = 0.0;
+    for (size_t i = 1; i < frames_.size(); i++)
+        times_[i] = times_[i - 1] + frames_[i].wallDt;
+    return true;
+}
+
+FlightFrame FlightRecording::sample(double time) const {
+    if (frames_.empty()) return {};
+    if (time <= 0.0) return frames_.front();
+    if (time >= times_.back()) return frames_.back();
+
+    size_t i = static_cast<size_t>(std::upper_bound(times_.begin(), times_.end(), time) - times_.begin()) - 1;
+    const FlightFrame& a = frames_[i];
+    const FlightFrame& b = frames_[i + 1];
+    double span = times_[i + 1] - times_[i];
+    double t = span > 0.0 ? (time - times_[i]) / span : 0.0;
+
+    FlightFrame f = a;
+    f.wallDt      = 0.0;
+    f.missionTime = a.missionTime + (b.missionTime - a.missionTime) * t;
+    lerpArray(f.position, a.position, b.position, t);
+    lerpArray(f.velocity, a.velocity, b.velocity, t);
+    lerpArray(f.cameraPosition, a.cameraPosition, b.cameraPosition, t);
+    lerpArray(f.angularVelocity, a.angularVelocity, b.angularVelocity, t);
+    store(f.orientation, glm::slerp(quat(a.orientation), quat(b.orientation), t));
+    store(f.cameraOrientation, glm::slerp(quat(a.cameraOrientation), quat(b.cameraOrientation), t));
+    f.fuelMass      = static_cast<float>(a.fuelMass + (b.fuelMass - a.fuelMass) * t);
+    f.throttle      = static_cast<float>(a.throttle + (b.throttle - a.throttle) * t);
+    f.altitude      = static_cast<float>(a.altitude + (b.altitude - a.altitude) * t);
+    f.surfaceSpeed  = static_cast<float>(a.surfaceSpeed + (b.surfaceSpeed - a.surfaceSpeed) * t);
+    f.verticalSpeed = static_cast<float>(a.verticalSpeed + (b.verticalSpeed - a.verticalSpeed) * t);
+    return f;
+}
+
+} // namespace luna::sim
@@ -0,0 +1,109 @@
+// About: Flight recordings — per-frame state, camera pose and controls in a compact binary file.
+
+#pragma once
+
+#include "sim/PhysicsThread.h"
+#include "sim/SimState.h"
+#include "util/Math.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace luna::sim {
+
+// File layout: this header, then FlightFrames back to back until the end of the
+// file, so a recording cut short by a crash still loads up to its last whole frame.
+struct FlightRecordingHeader {
+    char     magic[4];    // "LFR1"
+    uint32_t version;     // FlightRecording::VERSION
+    uint32_t frameSize;   // sizeof(FlightFrame)
+    uint32_t _pad;
+};
+static_assert(sizeof(FlightRecordingHeader) == 16);
+
+// One rendered frame. Positions stay double (Moon-centred meters), the rest fit
+// in float; fields the simulation derives or holds constant are not stored.
+struct FlightFrame {
+    double   wallDt;              // wall seconds since the previous frame
+    double   missionTime;
+    double   position[3];
+    double   velocity[3];
+    double   cameraPosition[3];
+    float    orientation[4];      // w, x, y, z
+    float    angularVelocity[3];
+    float    cameraOrientation[4];
+    float    fuelMass;
+    float    throttle;            // achieved
+    float    altitude;
+    float    surfaceSpeed;
+    float    verticalSpeed;
+    float    controlThrottle;     // SimControls as the pilot left them this frame
+    float    controlTorque[3];
+    float    timeWarp;
+    uint8_t  phase;               // FlightPhase
+    uint8_t  flags;               // FLAG_*
+    uint16_t _pad;
+
+    static constexpr uint8_t FLAG_ATTACHED   = 1 << 0;  // camera rides the lander
+    static constexpr uint8_t FLAG_GPU_DRIVEN = 1 << 1;  // GPU-driven terrain drawing
+};
+static_assert(sizeof(FlightFrame) == 176);
+
+FlightFrame captureFrame(double wallDt, const SimState& state, const SimControls& controls,
+                         const glm::dvec3& cameraPosition, const glm::dquat& cameraOrientation,
+                         uint8_t flags);
+
+// The parts of `frame` that SimState, SimControls and the camera carry
+void applyFrame(const FlightFrame& frame, SimState& state, SimControls& controls,
+                glm::dvec3& cameraPosition, glm::dquat& cameraOrientation);
+
+// Appends frames to a new file. Writes are buffered; close() (or the destructor)
+// flushes them.
+class FlightRecorder {
+public:
+    FlightRecorder() = default;
+    ~FlightRecorder();
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    // False if the file could not be created
+    bool open(const std::string& path);
+    bool isOpen() const { return file_ != nullptr; }
+
+    void     append(const FlightFrame& frame);
+    uint64_t frameCount() const { return frameCount_; }
+    void     close();
+
+private:
+    std::FILE* file_       = nullptr;
+    uint64_t   frameCount_ = 0;
+};
+
+// A loaded recording, played back either frame by frame or sampled at any time
+class FlightRecording {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    // False when the file is missing, of another version, or holds no frames
+    bool load(const std::string& path);
+
+    size_t             size() const { return frames_.size(); }
+    const FlightFrame& operator[](size_t i) const { return frames_[i]; }
+
+    // Wall seconds from the first frame to the last, and to frame i
+    double duration() const { return times_.empty() ? 0.0 : times_.back(); }
+    double timeAt(size_t i) const { return times_[i]; }
+
+    // The frame `time` wall seconds after the first, clamped to the recording:
+    // positions, velocities and scalars interpolated, orientations slerped,
+    // controls and flags from the earlier frame. wallDt is left at 0.
+    FlightFrame sample(double time) const;
+
+private:
+    std::vector<FlightFrame> frames_;
+    std::vector<double>      times_;  // wall time of each frame, from the first
+};
+
+} // namespace luna::sim
@@ -0,0 +1,40 @@
+// About: Morton ordering helpers for the tiled heightmap format.
+
+#include "sim/HeightTiles.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace luna::sim {
+
+namespace {
+uint64_t spreadBits(uint32_t v) {
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8))  & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4))  & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2))  & 0x3333333333333333ull;
+    x = (x | (x << 1))  & 0x5555555555555555ull;
+    return x;
+}
+} // anonymous namespace
+
+uint64_t mortonEncode(uint32_t x, uint32_t y) {
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+std::vector<uint32_t> mortonRanks(uint32_t tilesX, uint32_t tilesY) {
+    uint32_t count = tilesX * tilesY;
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [tilesX](uint32_t a, uint32_t b) {
+        return mortonEncode(a % tilesX, a / tilesX) < mortonEncode(b % tilesX, b / tilesX);
+    });
+
+    std::vector<uint32_t> ranks(count);
+    for (uint32_t rank = 0; rank < count; rank++)
+        ranks[order[rank]] = rank;
+    return ranks;
+}
+
+} // namespace luna::sim
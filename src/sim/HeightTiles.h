@@ -0,0 +1,44 @@
+// About: On-disk layout of the tiled, memory-mappable heightmap format (.lht).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace luna::sim {
+
+// File layout, little-endian:
+//   HeightTileHeader
+//   uint64_t tileOffsets[tilesX * tilesY]   row-major tile id -> byte offset of its tile
+//   tiles, page aligned, in Morton (Z) order of (tx, ty)
+// A tile is tileSize² int16 texels in row-major order; height in meters is
+// texel * metersPerUnit. Edge tiles are padded by repeating the last row/column.
+// Morton order keeps tiles that are close on the Moon close in the file, so the
+// pages faulted in around a viewpoint are few and contiguous.
+struct HeightTileHeader {
+    char     magic[4];       // HEIGHT_TILE_MAGIC
+    uint32_t version;        // HEIGHT_TILE_VERSION
+    uint32_t width;          // texels, equirectangular, row 0 = north, column 0 = -180°
+    uint32_t height;
+    uint32_t tileShift;      // log2(tileSize)
+    uint32_t tilesX;
+    uint32_t tilesY;
+    float    metersPerUnit;
+    uint64_t indexOffset;
+    uint64_t dataOffset;
+};
+static_assert(sizeof(HeightTileHeader) == 48, "HeightTileHeader is a file format");
+
+inline constexpr char     HEIGHT_TILE_MAGIC[4]  = {'L', 'H', 'T', '1'};
+inline constexpr uint32_t HEIGHT_TILE_VERSION   = 1;
+inline constexpr size_t   HEIGHT_TILE_ALIGNMENT = 4096;
+
+// Interleave the bits of x and y (x in the even bits)
+uint64_t mortonEncode(uint32_t x, uint32_t y);
+
+// Position of every row-major tile id in Morton order, densely numbered so grids
+// that are not powers of two leave no holes in the file
+std::vector<uint32_t> mortonRanks(uint32_t tilesX, uint32_t tilesY);
+
+} // namespace luna::sim
@@ -1,187 +1,221 @@
-// About: Minimal TIFF parser for uncompressed float data + bilinear elevation sampling.
+// About: Heightmap loading (TIFF or tiled) and bilinear elevation sampling.
 
 #include "sim/Heightmap.h"
+#include "sim/TiffFile.h"
 #include "util/Log.h"
+#include "util/JobSystem.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
-#include <fstream>
 
 namespace luna::sim {
 
 namespace {
 
-// Reads uint16/uint32 from raw bytes with byte-order awareness
-struct TiffReader {
-    const uint8_t* buf;
-    size_t size;
-    bool littleEndian;
-
-    uint16_t u16(size_t off) const {
-        uint16_t v;
-        std::memcpy(&v, buf + off, 2);
-        if (!littleEndian) v = static_cast<uint16_t>((v >> 8) | (v << 8));
-        return v;
-    }
-
-    uint32_t u32(size_t off) const {
-        uint32_t v;
-        std::memcpy(&v, buf + off, 4);
-        if (!littleEndian) {
-            v = ((v >> 24) & 0xFF) | ((v >> 8) & 0xFF00) |
-                ((v << 8) & 0xFF0000) | ((v << 24) & 0xFF000000);
-        }
-        return v;
-    }
-
-    // Read IFD entry value — inline for count=1, else treat as offset
-    uint32_t ifdValue(size_t entry, uint16_t type) const {
-        if (type == 3 && u32(entry + 4) == 1) return u16(entry + 8); // SHORT
-        return u32(entry + 8);
-    }
-};
-
-void swapFloatBytes(std::vector<float>& data) {
-    for (float& v : data) {
-        uint32_t bits;
-        std::memcpy(&bits, &v, 4);
-        bits = ((bits >> 24) & 0xFF) | ((bits >> 8) & 0xFF00) |
-               ((bits << 8) & 0xFF0000) | ((bits << 24) & 0xFF000000);
-        std::memcpy(&v, &bits, 4);
+// FNV-1a over 64-bit words (tail bytes folded in singly); fast enough to cover a
+// whole in-memory map at load
+uint64_t hashBytes(const void* data, size_t size, uint64_t h = 0xcbf29ce484222325ull) {
+    constexpr uint64_t PRIME = 0x100000001b3ull;
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w;
+        std::memcpy(&w, bytes + i * 8, 8);
+        h = (h ^ w) * PRIME;
     }
+    for (size_t i = words * 8; i < size; i++)
+        h = (h ^ bytes[i]) * PRIME;
+    return h;
 }
 
 } // anonymous namespace
 
-bool Heightmap::load(const std::string& path) {
-    std::ifstream file(path, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        LOG_WARN("Heightmap not found: %s", path.c_str());
-        return false;
+bool Heightmap::load(const std::string& path, bool parallelDecode) {
+    // Tiled files are recognised by their magic, anything else is treated as TIFF
+    {
+        luna::util::MappedFile probe;
+        if (!probe.open(path)) {
+            LOG_WARN("Heightmap not found: %s", path.c_str());
+            return false;
+        }
+        if (probe.size() >= sizeof(HeightTileHeader) &&
+            std::memcmp(probe.data(), HEIGHT_TILE_MAGIC, 4) == 0) {
+            tiles_ = std::move(probe);
+            return loadTiles(path);
+        }
     }
+    return loadTiff(path, parallelDecode);
+}
 
-    auto fileSize = static_cast<size_t>(file.tellg());
-    file.seekg(0);
-
-    std::vector<uint8_t> raw(fileSize);
-    file.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(fileSize));
-
-    if (fileSize < 8) {
-        LOG_ERROR("TIFF too small: %s", path.c_str());
+bool Heightmap::loadTiff(const std::string& path, bool parallelDecode) {
+    TiffFile tiff;
+    if (!tiff.open(path)) return false;
+
+    // Blocks decode straight out of the mapping into the level — no intermediate
+    // file buffer
+    luna::util::JobSystem* jobs = nullptr;
+    if (parallelDecode && tiff.height() > 1)
+        jobs = &luna::util::JobSystem::instance();
+    uint32_t threads = jobs ? jobs->workerCount() + 1 : 1;
+
+    levels_.assign(1, Level{});
+    Level& base = levels_[0];
+    base.width  = tiff.width();
+    base.height = tiff.height();
+    base.data.resize(static_cast<size_t>(base.width) * base.height);
+    auto start = std::chrono::steady_clock::now();
+    if (!tiff.readRows(0, base.height, base.data.data(), jobs)) {
+        LOG_ERROR("Heightmap decode failed: %s", path.c_str());
+        levels_.clear();
         return false;
     }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double decodedMB = base.data.size() * sizeof(float) / (1024.0 * 1024.0);
+    LOG_INFO("Heightmap decoded: %.1f MB from %.1f MB %s %s in %.0f ms on %u threads (%.0f MB/s)",
+             decodedMB, tiff.storedBytes() / (1024.0 * 1024.0), tiff.compressionName(),
+             tiff.isTiled() ? "tiles" : "strips", seconds * 1000.0, threads,
+             decodedMB / std::max(seconds, 1e-6));
+
+    contentHash_ = hashBytes(base.data.data(), base.data.size() * sizeof(float));
+    contentHash_ = hashBytes(&base.width, sizeof(base.width), contentHash_);
+    contentHash_ = hashBytes(&base.height, sizeof(base.height), contentHash_);
+    buildPyramid();
+    LOG_INFO("Heightmap loaded: %ux%u, %zu mip levels, from %s",
+             levels_[0].width, levels_[0].height, levels_.size(), path.c_str());
+    return true;
+}
 
-    TiffReader r{raw.data(), fileSize, false};
-
-    // Byte order marker
-    if (raw[0] == 'I' && raw[1] == 'I')
-        r.littleEndian = true;
-    else if (raw[0] == 'M' && raw[1] == 'M')
-        r.littleEndian = false;
-    else {
-        LOG_ERROR("Invalid TIFF byte order: %s", path.c_str());
-        return false;
+void Heightmap::buildPyramid() {
+    // Halve until the map is too small to be worth a level. sample() addresses texel
+    // centres, so coarse texel i covers fine texels 2i and 2i+1 and is centred between
+    // them; a [1 3 3 1] tent keeps it there. Halving is exact only while both sizes
+    // are even, which also keeps each level at the size Vulkan gives that mip.
+    // Columns wrap (longitude), rows clamp (poles).
+    constexpr uint32_t MIN_LEVEL_HEIGHT = 16;
+    while (levels_.back().height / 2 >= MIN_LEVEL_HEIGHT &&
+           levels_.back().width % 2 == 0 && levels_.back().height % 2 == 0) {
+        const Level& fine = levels_.back();
+        Level coarse;
+        coarse.width  = fine.width / 2;
+        coarse.height = fine.height / 2;
+        coarse.data.resize(static_cast<size_t>(coarse.width) * coarse.height);
+
+        // Horizontal pass over every fine row, then vertical
+        std::vector<float> rows(static_cast<size_t>(coarse.width) * fine.height);
+        for (uint32_t y = 0; y < fine.height; y++) {
+            const float* src = fine.data.data() + static_cast<size_t>(y) * fine.width;
+            float* dst = rows.data() + static_cast<size_t>(y) * coarse.width;
+            for (uint32_t x = 0; x < coarse.width; x++) {
+                uint32_t c = 2 * x;
+                uint32_t l = c == 0 ? fine.width - 1 : c - 1;
+                uint32_t r = c + 2 == fine.width ? 0 : c + 2;
+                dst[x] = 0.125f * src[l] + 0.375f * src[c] + 0.375f * src[c + 1] + 0.125f * src[r];
+            }
+        }
+        for (uint32_t y = 0; y < coarse.height; y++) {
+            uint32_t c = 2 * y;
+            uint32_t u = c == 0 ? 0 : c - 1;
+            uint32_t d = std::min(c + 2, fine.height - 1);
+            const float* above = rows.data() + static_cast<size_t>(u) * coarse.width;
+            const float* upper = rows.data() + static_cast<size_t>(c) * coarse.width;
+            const float* lower = upper + coarse.width;
+            const float* below = rows.data() + static_cast<size_t>(d) * coarse.width;
+            float* dst = coarse.data.data() + static_cast<size_t>(y) * coarse.width;
+            for (uint32_t x = 0; x < coarse.width; x++)
+                dst[x] = 0.125f * above[x] + 0.375f * upper[x] + 0.375f * lower[x] + 0.125f * below[x];
+        }
+        levels_.push_back(std::move(coarse));
     }
+}
 
-    if (r.u16(2) != 42) {
-        LOG_ERROR("Invalid TIFF magic: %s", path.c_str());
-        return false;
+uint32_t Heightmap::levelForFootprint(double footprint) const {
+    uint32_t count = levelCount();
+    uint32_t chosen = 0;
+    for (uint32_t l = 1; l < count; l++) {
+        if (texelSpacing(l) > footprint) break;
+        chosen = l;
     }
+    return chosen;
+}
 
-    uint32_t ifdOff = r.u32(4);
-    uint16_t numEntries = r.u16(ifdOff);
-
-    uint32_t width = 0, height = 0;
-    uint32_t stripOffsetCount = 0;
-    uint32_t stripOffsetsValue = 0;
-    uint16_t stripOffsetType = 0;
-    uint32_t rowsPerStrip = 0;
-
-    for (uint16_t i = 0; i < numEntries; i++) {
-        size_t entry = ifdOff + 2 + i * 12;
-        uint16_t tag  = r.u16(entry);
-        uint16_t type = r.u16(entry + 2);
-        uint32_t count = r.u32(entry + 4);
-
-        switch (tag) {
-            case 256: width  = r.ifdValue(entry, type); break;
-            case 257: height = r.ifdValue(entry, type); break;
-            case 273: // StripOffsets
-                stripOffsetCount = count;
-                stripOffsetType  = type;
-                stripOffsetsValue = r.u32(entry + 8);
-                break;
-            case 278: rowsPerStrip = r.ifdValue(entry, type); break;
-            default: break;
-        }
-    }
+double Heightmap::texelSpacing(uint32_t levelIndex) const {
+    if (isTiled()) return M_PI / static_cast<double>(tileHeader()->height);
+    if (levels_.empty()) return M_PI;
+    return M_PI / static_cast<double>(level(levelIndex).height);
+}
 
-    if (width == 0 || height == 0) {
-        LOG_ERROR("TIFF missing dimensions: %s", path.c_str());
-        return false;
+bool Heightmap::loadTiles(const std::string& path) {
+    const HeightTileHeader& h = *tileHeader();
+    size_t tileBytes = (size_t(1) << (2 * h.tileShift)) * sizeof(int16_t);
+    size_t tileCount = size_t(h.tilesX) * h.tilesY;
+
+    bool valid = h.version == HEIGHT_TILE_VERSION && h.tileShift >= 4 && h.tileShift <= 12 &&
+                 h.width > 1 && h.height > 1 &&
+                 h.tilesX == ((h.width  + (1u << h.tileShift) - 1) >> h.tileShift) &&
+                 h.tilesY == ((h.height + (1u << h.tileShift) - 1) >> h.tileShift) &&
+                 h.indexOffset % alignof(uint64_t) == 0 &&
+                 h.indexOffset + tileCount * sizeof(uint64_t) <= tiles_.size() &&
+                 h.dataOffset + tileCount * tileBytes <= tiles_.size();
+    if (valid) {
+        const auto* index = reinterpret_cast<const uint64_t*>(tiles_.data() + h.indexOffset);
+        for (size_t t = 0; t < tileCount && valid; t++)
+            valid = index[t] % alignof(int16_t) == 0 && index[t] + tileBytes <= tiles_.size();
     }
-
-    width_  = width;
-    height_ = height;
-    data_.resize(static_cast<size_t>(width) * height);
-
-    if (stripOffsetCount <= 1) {
-        // Single strip — all data at one offset
-        uint32_t off = stripOffsetsValue;
-        std::memcpy(data_.data(), raw.data() + off,
-                    static_cast<size_t>(width) * height * sizeof(float));
-    } else {
-        // Multiple strips — offsets stored at stripOffsetsValue
-        uint32_t rowsRead = 0;
-        for (uint32_t s = 0; s < stripOffsetCount && rowsRead < height; s++) {
-            uint32_t off;
-            if (stripOffsetType == 3) // SHORT
-                off = r.u16(stripOffsetsValue + s * 2);
-            else
-                off = r.u32(stripOffsetsValue + s * 4);
-
-            uint32_t rows = std::min(rowsPerStrip, height - rowsRead);
-            std::memcpy(data_.data() + static_cast<size_t>(rowsRead) * width,
-                        raw.data() + off,
-                        static_cast<size_t>(rows) * width * sizeof(float));
-            rowsRead += rows;
-        }
+    if (!valid) {
+        LOG_ERROR("Invalid tiled heightmap header: %s", path.c_str());
+        tiles_.close();
+        return false;
     }
 
-    if (!r.littleEndian) swapFloatBytes(data_);
+    // Touches two tiles only: hashing all of them would page in the whole file
+    const auto* index = reinterpret_cast<const uint64_t*>(tiles_.data() + h.indexOffset);
+    contentHash_ = hashBytes(tiles_.data(), h.indexOffset + tileCount * sizeof(uint64_t));
+    contentHash_ = hashBytes(tiles_.data() + index[0], tileBytes, contentHash_);
+    contentHash_ = hashBytes(tiles_.data() + index[tileCount - 1], tileBytes, contentHash_);
 
-    LOG_INFO("Heightmap loaded: %ux%u from %s", width_, height_, path.c_str());
+    // Resident memory is whatever the sampled tiles fault in, not the file size
+    LOG_INFO("Tiled heightmap mapped: %ux%u, %ux%u tiles of %u, %.1f MB on disk, from %s",
+             h.width, h.height, h.tilesX, h.tilesY, 1u << h.tileShift,
+             tiles_.size() / (1024.0 * 1024.0), path.c_str());
     return true;
 }
 
-double Heightmap::sample(double lat, double lon) const {
-    if (data_.empty()) return 0.0;
+double Heightmap::sample(double lat, double lon, uint32_t levelIndex) const {
+    if (isTiled()) return sampleTiled(lat, lon);
+    if (levels_.empty()) return 0.0;
+    const Level& lv = level(levelIndex);
+    const uint32_t width  = lv.width;
+    const uint32_t height = lv.height;
 
-    // Equirectangular: row 0 = north pole, col 0 = -180°
-    double py = (0.5 - lat / M_PI) * (height_ - 1);
-    double px = (lon / (2.0 * M_PI) + 0.5) * (width_ - 1);
+    // Equirectangular, texel-centred: row 0 is the band nearest the north pole,
+    // column 0 the one just east of -180°
+    double py = (0.5 - lat / M_PI) * height - 0.5;
+    double px = (lon / (2.0 * M_PI) + 0.5) * width - 0.5;
 
     // Wrap longitude at seam
-    if (px < 0.0) px += width_;
-    else if (px >= width_) px -= width_;
+    if (px < 0.0) px += width;
+    else if (px >= width) px -= width;
 
     // Clamp latitude at poles
-    py = std::clamp(py, 0.0, static_cast<double>(height_ - 1));
+    py = std::clamp(py, 0.0, static_cast<double>(height - 1));
 
     // Bilinear interpolation
     int x0 = static_cast<int>(px);
     int y0 = static_cast<int>(py);
-    int x1 = (x0 + 1) % static_cast<int>(width_);
-    int y1 = std::min(y0 + 1, static_cast<int>(height_ - 1));
+    int x1 = (x0 + 1) % static_cast<int>(width);
+    int y1 = std::min(y0 + 1, static_cast<int>(height - 1));
 
     double fx = px - x0;
     double fy = py - y0;
 
-    double v00 = data_[y0 * width_ + x0];
-    double v10 = data_[y0 * width_ + x1];
-    double v01 = data_[y1 * width_ + x0];
-    double v11 = data_[y1 * width_ + x1];
+    size_t row0 = static_cast<size_t>(y0) * width;
+    size_t row1 = static_cast<size_t>(y1) * width;
+    double v00 = lv.data[row0 + x0];
+    double v10 = lv.data[row0 + x1];
+    double v01 = lv.data[row1 + x0];
+    double v11 = lv.data[row1 + x1];
 
     double top = v00 * (1.0 - fx) + v10 * fx;
     double bot = v01 * (1.0 - fx) + v11 * fx;
@@ -191,4 +225,27 @@ double Heightmap::sample(double lat, double lon) const {
     return value * 1000.0;
 }
 
+double Heightmap::sampleTiled(double lat, double lon) const {
+    // Same addressing as the float path; texels are already in meters
+    const HeightTileHeader& h = *tileHeader();
+    double py = (0.5 - lat / M_PI) * h.height - 0.5;
+    double px = (lon / (2.0 * M_PI) + 0.5) * h.width - 0.5;
+
+    if (px < 0.0) px += h.width;
+    else if (px >= h.width) px -= h.width;
+    py = std::clamp(py, 0.0, static_cast<double>(h.height - 1));
+
+    uint32_t x0 = static_cast<uint32_t>(px);
+    uint32_t y0 = static_cast<uint32_t>(py);
+    uint32_t x1 = x0 + 1 == h.width ? 0 : x0 + 1;
+    uint32_t y1 = std::min(y0 + 1, h.height - 1);
+
+    double fx = px - x0;
+    double fy = py - y0;
+
+    double top = tileTexel(h, x0, y0) * (1.0 - fx) + tileTexel(h, x1, y0) * fx;
+    double bot = tileTexel(h, x0, y1) * (1.0 - fx) + tileTexel(h, x1, y1) * fx;
+    return top * (1.0 - fy) + bot * fy;
+}
+
 } // namespace luna::sim
@@ -1,26 +1,101 @@
-// About: Minimal TIFF loader and bilinear sampler for NASA LOLA elevation data.
+// About: Heightmap loader and bilinear sampler — NASA LOLA TIFF in memory or mapped .lht tiles.
 
 #pragma once
 
+#include "sim/HeightTiles.h"
+#include "util/MappedFile.h"
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 
 namespace luna::sim {
 
+// Two backends behind one API: a float32 TIFF copied into memory (the 16 ppd LOLA
+// file), or a tiled .lht file (see HeightTiles.h) that stays memory-mapped, so only
+// the tiles actually sampled are ever paged in. load() picks by file contents.
+//
+// The float backend also builds a mip pyramid at load: each level halves the one
+// above with a [1 3 3 1] tent, so coarse quadtree patches can sample a level whose
+// texels match their vertex spacing instead of aliasing the full-resolution map.
+// Every level is addressed at texel centres, so a feature sits at the same lat/lon
+// at every level. The tiled backend has a single level.
 class Heightmap {
 public:
-    bool load(const std::string& path);
+    // parallelDecode spreads TIFF decoding over the JobSystem workers and the
+    // caller; otherwise it runs on the calling thread only
+    bool load(const std::string& path, bool parallelDecode = true);
 
     // Sample elevation at lat/lon (radians). Returns meters above reference sphere.
-    double sample(double lat, double lon) const;
+    // level 0 is full resolution; levels past the coarsest clamp to it.
+    double sample(double lat, double lon, uint32_t level = 0) const;
 
-    bool isLoaded() const { return !data_.empty(); }
+    // Sample n points at once (same result as sample(), narrowed to float). Uses an
+    // AVX2 or NEON kernel when the CPU has one; see HeightmapBatch.cpp.
+    void sampleMany(const double* lat, const double* lon, float* out, size_t n,
+                    uint32_t level = 0) const;
+
+    uint32_t levelCount() const { return isTiled() ? 1u : static_cast<uint32_t>(levels_.size()); }
+
+    // Coarsest level whose texel spacing (as latitude radians) is no wider than
+    // footprint — the spacing of the samples that will be taken from it
+    uint32_t levelForFootprint(double footprint) const;
+
+    // Latitude radians between a level's texel rows; levels past the coarsest clamp
+    double texelSpacing(uint32_t level) const;
+
+    // Name of the kernel sampleMany() dispatches to ("avx2", "neon" or "scalar")
+    static const char* batchKernelName();
+
+    // Fingerprint of the loaded data for keying derived caches. Covers every texel of
+    // the float backend; for tiled files, the header, index and first and last tile.
+    uint64_t contentHash() const { return contentHash_; }
+
+    // Fault the mapped tiles in ahead of sampling (no-op for the in-memory backend)
+    void prefault() const { tiles_.prefault(); }
+
+    bool isLoaded() const { return !levels_.empty() || tiles_.isOpen(); }
+    bool isTiled() const  { return tiles_.isOpen(); }
+
+    // Float backend, kilometers (as stored by LOLA). Level 0 is the source map.
+    // Read directly by GPU texture uploads; only valid when loaded and not tiled.
+    struct Level {
+        std::vector<float> data;
+        uint32_t width  = 0;
+        uint32_t height = 0;
+    };
+    const Level& level(uint32_t index) const {
+        return levels_[std::min<size_t>(index, levels_.size() - 1)];
+    }
 
 private:
-    std::vector<float> data_;
-    uint32_t width_  = 0;
-    uint32_t height_ = 0;
+    bool loadTiff(const std::string& path, bool parallelDecode);
+    bool loadTiles(const std::string& path);
+    void buildPyramid();
+
+    double sampleTiled(double lat, double lon) const;
+
+    // Everything tiled is addressed through the mapping, so moves need no fix-up
+    const HeightTileHeader* tileHeader() const {
+        return reinterpret_cast<const HeightTileHeader*>(tiles_.data());
+    }
+
+    // Tiled texel in meters
+    float tileTexel(const HeightTileHeader& h, uint32_t x, uint32_t y) const {
+        uint32_t mask = (1u << h.tileShift) - 1;
+        const auto* index = reinterpret_cast<const uint64_t*>(tiles_.data() + h.indexOffset);
+        uint64_t tile = index[size_t(y >> h.tileShift) * h.tilesX + (x >> h.tileShift)];
+        const auto* texels = reinterpret_cast<const int16_t*>(tiles_.data() + tile);
+        return texels[((y & mask) << h.tileShift) + (x & mask)] * h.metersPerUnit;
+    }
+
+    std::vector<Level> levels_;
+
+    // Tiled backend: header, index and tiles, read in place
+    luna::util::MappedFile tiles_;
+
+    uint64_t contentHash_ = 0;
 };
 
 } // namespace luna::sim
@@ -0,0 +1,227 @@
+// About: Batched heightmap sampling — scalar, AVX2 and NEON kernels with runtime dispatch.
+
+#include "sim/Heightmap.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LUNA_HEIGHTMAP_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define LUNA_HEIGHTMAP_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace luna::sim {
+
+namespace {
+
+struct Grid {
+    const float* data;
+    uint32_t     width;
+    uint32_t     height;
+};
+
+using BatchKernel = void (*)(const Grid&, const double*, const double*, float*, size_t);
+
+// Mirrors Heightmap::sample step for step, so every kernel's tail matches it exactly
+inline float sampleOne(const Grid& g, double lat, double lon) {
+    double py = (0.5 - lat / M_PI) * g.height - 0.5;
+    double px = (lon / (2.0 * M_PI) + 0.5) * g.width - 0.5;
+
+    if (px < 0.0) px += g.width;
+    else if (px >= g.width) px -= g.width;
+    py = std::clamp(py, 0.0, static_cast<double>(g.height - 1));
+
+    int x0 = static_cast<int>(px);
+    int y0 = static_cast<int>(py);
+    int x1 = (x0 + 1) % static_cast<int>(g.width);
+    int y1 = std::min(y0 + 1, static_cast<int>(g.height - 1));
+
+    double fx = px - x0;
+    double fy = py - y0;
+
+    size_t row0 = static_cast<size_t>(y0) * g.width;
+    size_t row1 = static_cast<size_t>(y1) * g.width;
+    double v00 = g.data[row0 + x0];
+    double v10 = g.data[row0 + x1];
+    double v01 = g.data[row1 + x0];
+    double v11 = g.data[row1 + x1];
+
+    double top = v00 * (1.0 - fx) + v10 * fx;
+    double bot = v01 * (1.0 - fx) + v11 * fx;
+    return static_cast<float>((top * (1.0 - fy) + bot * fy) * 1000.0);
+}
+
+void sampleScalar(const Grid& g, const double* lat, const double* lon, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        out[i] = sampleOne(g, lat[i], lon[i]);
+}
+
+#if LUNA_HEIGHTMAP_AVX2
+
+// Four points per iteration: index math in double/int lanes, texels via 64-bit gathers
+// (offsets exceed 32 bits for high-resolution maps). No FMA, so results match sample().
+__attribute__((target("avx2")))
+void sampleAvx2(const Grid& g, const double* lat, const double* lon, float* out, size_t n) {
+    const __m256d pi      = _mm256_set1_pd(M_PI);
+    const __m256d twoPi   = _mm256_set1_pd(2.0 * M_PI);
+    const __m256d half    = _mm256_set1_pd(0.5);
+    const __m256d one     = _mm256_set1_pd(1.0);
+    const __m256d zero    = _mm256_setzero_pd();
+    const __m256d kmToM   = _mm256_set1_pd(1000.0);
+    const __m256d widthD  = _mm256_set1_pd(static_cast<double>(g.width));
+    const __m256d heightD = _mm256_set1_pd(static_cast<double>(g.height));
+    const __m256d hMax    = _mm256_set1_pd(static_cast<double>(g.height - 1));
+    const __m128i widthI  = _mm_set1_epi32(static_cast<int>(g.width));
+    const __m128i hMaxI   = _mm_set1_epi32(static_cast<int>(g.height - 1));
+    const __m128i oneI    = _mm_set1_epi32(1);
+    const __m256i stride  = _mm256_set1_epi64x(g.width);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d la = _mm256_loadu_pd(lat + i);
+        __m256d lo = _mm256_loadu_pd(lon + i);
+
+        __m256d py = _mm256_sub_pd(_mm256_mul_pd(_mm256_sub_pd(half, _mm256_div_pd(la, pi)), heightD), half);
+        __m256d px = _mm256_sub_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_div_pd(lo, twoPi), half), widthD), half);
+
+        // Wrap longitude at the seam, clamp latitude at the poles
+        __m256d below = _mm256_cmp_pd(px, zero, _CMP_LT_OQ);
+        __m256d above = _mm256_cmp_pd(px, widthD, _CMP_GE_OQ);
+        px = _mm256_add_pd(px, _mm256_and_pd(below, widthD));
+        px = _mm256_sub_pd(px, _mm256_and_pd(above, widthD));
+        py = _mm256_min_pd(_mm256_max_pd(py, zero), hMax);
+
+        __m128i x0 = _mm256_cvttpd_epi32(px);
+        __m128i y0 = _mm256_cvttpd_epi32(py);
+        __m128i x1 = _mm_add_epi32(x0, oneI);
+        x1 = _mm_andnot_si128(_mm_cmpeq_epi32(x1, widthI), x1);
+        __m128i y1 = _mm_min_epi32(_mm_add_epi32(y0, oneI), hMaxI);
+
+        __m256d fx = _mm256_sub_pd(px, _mm256_cvtepi32_pd(x0));
+        __m256d fy = _mm256_sub_pd(py, _mm256_cvtepi32_pd(y0));
+
+        __m256i row0 = _mm256_mul_epu32(_mm256_cvtepi32_epi64(y0), stride);
+        __m256i row1 = _mm256_mul_epu32(_mm256_cvtepi32_epi64(y1), stride);
+        __m256i col0 = _mm256_cvtepi32_epi64(x0);
+        __m256i col1 = _mm256_cvtepi32_epi64(x1);
+
+        __m256d v00 = _mm256_cvtps_pd(_mm256_i64gather_ps(g.data, _mm256_add_epi64(row0, col0), 4));
+        __m256d v10 = _mm256_cvtps_pd(_mm256_i64gather_ps(g.data, _mm256_add_epi64(row0, col1), 4));
+        __m256d v01 = _mm256_cvtps_pd(_mm256_i64gather_ps(g.data, _mm256_add_epi64(row1, col0), 4));
+        __m256d v11 = _mm256_cvtps_pd(_mm256_i64gather_ps(g.data, _mm256_add_epi64(row1, col1), 4));
+
+        __m256d gx  = _mm256_sub_pd(one, fx);
+        __m256d top = _mm256_add_pd(_mm256_mul_pd(v00, gx), _mm256_mul_pd(v10, fx));
+        __m256d bot = _mm256_add_pd(_mm256_mul_pd(v01, gx), _mm256_mul_pd(v11, fx));
+        __m256d value = _mm256_add_pd(_mm256_mul_pd(top, _mm256_sub_pd(one, fy)),
+                                      _mm256_mul_pd(bot, fy));
+        _mm_storeu_ps(out + i, _mm256_cvtpd_ps(_mm256_mul_pd(value, kmToM)));
+    }
+    for (; i < n; i++)
+        out[i] = sampleOne(g, lat[i], lon[i]);
+}
+
+#endif // LUNA_HEIGHTMAP_AVX2
+
+#if LUNA_HEIGHTMAP_NEON
+
+// Two points per iteration. NEON has no gather, so only the texel loads are scalar.
+void sampleNeon(const Grid& g, const double* lat, const double* lon, float* out, size_t n) {
+    const float64x2_t pi      = vdupq_n_f64(M_PI);
+    const float64x2_t twoPi   = vdupq_n_f64(2.0 * M_PI);
+    const float64x2_t half    = vdupq_n_f64(0.5);
+    const float64x2_t one     = vdupq_n_f64(1.0);
+    const float64x2_t zero    = vdupq_n_f64(0.0);
+    const float64x2_t widthD  = vdupq_n_f64(static_cast<double>(g.width));
+    const float64x2_t heightD = vdupq_n_f64(static_cast<double>(g.height));
+    const float64x2_t hMax    = vdupq_n_f64(static_cast<double>(g.height - 1));
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t la = vld1q_f64(lat + i);
+        float64x2_t lo = vld1q_f64(lon + i);
+
+        float64x2_t py = vsubq_f64(vmulq_f64(vsubq_f64(half, vdivq_f64(la, pi)), heightD), half);
+        float64x2_t px = vsubq_f64(vmulq_f64(vaddq_f64(vdivq_f64(lo, twoPi), half), widthD), half);
+
+        px = vbslq_f64(vcltq_f64(px, zero), vaddq_f64(px, widthD), px);
+        px = vbslq_f64(vcgeq_f64(px, widthD), vsubq_f64(px, widthD), px);
+        py = vminq_f64(vmaxq_f64(py, zero), hMax);
+
+        int64x2_t x0 = vcvtq_s64_f64(px);
+        int64x2_t y0 = vcvtq_s64_f64(py);
+        float64x2_t fx = vsubq_f64(px, vcvtq_f64_s64(x0));
+        float64x2_t fy = vsubq_f64(py, vcvtq_f64_s64(y0));
+
+        double t00[2], t10[2], t01[2], t11[2];
+        for (int lane = 0; lane < 2; lane++) {
+            int64_t cx0 = lane ? vgetq_lane_s64(x0, 1) : vgetq_lane_s64(x0, 0);
+            int64_t cy0 = lane ? vgetq_lane_s64(y0, 1) : vgetq_lane_s64(y0, 0);
+            int64_t cx1 = cx0 + 1 == g.width ? 0 : cx0 + 1;
+            int64_t cy1 = std::min<int64_t>(cy0 + 1, g.height - 1);
+            size_t row0 = static_cast<size_t>(cy0) * g.width;
+            size_t row1 = static_cast<size_t>(cy1) * g.width;
+            t00[lane] = g.data[row0 + cx0];
+            t10[lane] = g.data[row0 + cx1];
+            t01[lane] = g.data[row1 + cx0];
+            t11[lane] = g.data[row1 + cx1];
+        }
+
+        float64x2_t gx  = vsubq_f64(one, fx);
+        float64x2_t top = vaddq_f64(vmulq_f64(vld1q_f64(t00), gx), vmulq_f64(vld1q_f64(t10), fx));
+        float64x2_t bot = vaddq_f64(vmulq_f64(vld1q_f64(t01), gx), vmulq_f64(vld1q_f64(t11), fx));
+        float64x2_t value = vaddq_f64(vmulq_f64(top, vsubq_f64(one, fy)), vmulq_f64(bot, fy));
+        vst1_f32(out + i, vcvt_f32_f64(vmulq_f64(value, vdupq_n_f64(1000.0))));
+    }
+    for (; i < n; i++)
+        out[i] = sampleOne(g, lat[i], lon[i]);
+}
+
+#endif // LUNA_HEIGHTMAP_NEON
+
+struct KernelChoice {
+    BatchKernel kernel;
+    const char* name;
+};
+
+KernelChoice selectKernel() {
+#if LUNA_HEIGHTMAP_AVX2
+    if (__builtin_cpu_supports("avx2")) return {sampleAvx2, "avx2"};
+#elif LUNA_HEIGHTMAP_NEON
+    return {sampleNeon, "neon"};
+#endif
+    return {sampleScalar, "scalar"};
+}
+
+const KernelChoice& kernelChoice() {
+    static const KernelChoice choice = selectKernel();
+    return choice;
+}
+
+} // anonymous namespace
+
+void Heightmap::sampleMany(const double* lat, const double* lon, float* out, size_t n,
+                           uint32_t levelIndex) const {
+    // Tiles can't be gathered across in vector lanes; the mapped backend stays scalar
+    if (isTiled()) {
+        for (size_t i = 0; i < n; i++)
+            out[i] = static_cast<float>(sampleTiled(lat[i], lon[i]));
+        return;
+    }
+    if (levels_.empty()) {
+        std::fill(out, out + n, 0.0f);
+        return;
+    }
+    const Level& lv = level(levelIndex);
+    Grid g{lv.data.data(), lv.width, lv.height};
+    kernelChoice().kernel(g, lat, lon, out, n);
+}
+
+const char* Heightmap::batchKernelName() {
+    return kernelChoice().name;
+}
+
+} // namespace luna::sim
@@ -0,0 +1,113 @@
+// About: Universal-variable Kepler propagation (Stumpff functions, Newton solve, f and g series).
+
+#include "sim/KeplerOrbit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace luna::sim {
+
+namespace {
+
+const double SQRT_MU = std::sqrt(luna::util::LUNAR_GM);
+
+// Stumpff functions C(z) and S(z), with series near z = 0 where both forms cancel
+void stumpff(double z, double& c, double& s) {
+    if (z > 1e-6) {
+        double sz = std::sqrt(z);
+        c = (1.0 - std::cos(sz)) / z;
+        s = (sz - std::sin(sz)) / (sz * z);
+    } else if (z < -1e-6) {
+        double sz = std::sqrt(-z);
+        c = (std::cosh(sz) - 1.0) / -z;
+        s = (std::sinh(sz) - sz) / (sz * -z);
+    } else {
+        c = 0.5 - z / 24.0 + z * z / 720.0;
+        s = 1.0 / 6.0 - z / 120.0 + z * z / 5040.0;
+    }
+}
+
+} // anonymous namespace
+
+KeplerOrbit::KeplerOrbit(const glm::dvec3& position, const glm::dvec3& velocity, double epoch)
+    : r0_(position), v0_(velocity), epoch_(epoch) {
+    const double mu = luna::util::LUNAR_GM;
+    r0Len_  = glm::length(position);
+    sigma0_ = glm::dot(position, velocity) / SQRT_MU;
+    alpha_  = 2.0 / r0Len_ - glm::dot(velocity, velocity) / mu;
+
+    glm::dvec3 h = glm::cross(position, velocity);
+    glm::dvec3 e = glm::cross(velocity, h) / mu - position / r0Len_;
+    eccentricity_ = glm::length(e);
+    periapsis_    = glm::dot(h, h) / mu / (1.0 + eccentricity_);
+}
+
+double KeplerOrbit::semiMajorAxis() const {
+    return alpha_ != 0.0 ? 1.0 / alpha_ : std::numeric_limits<double>::infinity();
+}
+
+double KeplerOrbit::period() const {
+    if (!isBound()) return std::numeric_limits<double>::infinity();
+    double a = 1.0 / alpha_;
+    return 2.0 * glm::pi<double>() * std::sqrt(a * a * a / luna::util::LUNAR_GM);
+}
+
+double KeplerOrbit::solveAnomaly(double dt, double& c, double& s) const {
+    // Initial guesses after Vallado, Fundamentals of Astrodynamics, Algorithm 8
+    double chi;
+    if (alpha_ > 1e-12) {
+        chi = SQRT_MU * alpha_ * dt;
+    } else if (alpha_ < -1e-12) {
+        double a    = 1.0 / alpha_;
+        double sign = dt < 0.0 ? -1.0 : 1.0;
+        double arg  = -2.0 * luna::util::LUNAR_GM * alpha_ * dt /
+                      (sigma0_ * SQRT_MU + sign * std::sqrt(-luna::util::LUNAR_GM * a) *
+                                               (1.0 - r0Len_ * alpha_));
+        chi = arg > 0.0 ? sign * std::sqrt(-a) * std::log(arg) : SQRT_MU * dt / r0Len_;
+    } else {
+        chi = SQRT_MU * dt / r0Len_;
+    }
+
+    // Newton on the universal Kepler equation; its derivative is the radius
+    for (int i = 0; i < 50; ++i) {
+        double chi2 = chi * chi;
+        double z    = alpha_ * chi2;
+        stumpff(z, c, s);
+        double r = chi2 * c + sigma0_ * chi * (1.0 - z * s) + r0Len_ * (1.0 - z * c);
+        double f = sigma0_ * chi2 * c + (1.0 - alpha_ * r0Len_) * chi2 * chi * s +
+                   r0Len_ * chi - SQRT_MU * dt;
+        double step = f / r;
+        chi -= step;
+        if (std::abs(step) < 1e-10 * std::max(1.0, std::abs(chi))) break;
+    }
+    stumpff(alpha_ * chi * chi, c, s);
+    return chi;
+}
+
+void KeplerOrbit::stateAt(double time, glm::dvec3& position, glm::dvec3& velocity) const {
+    double dt = time - epoch_;
+    // Whole revolutions change nothing; folding them out keeps the anomaly small
+    if (isBound()) dt = std::fmod(dt, period());
+
+    double c, s;
+    double chi  = solveAnomaly(dt, c, s);
+    double chi2 = chi * chi;
+
+    double f = 1.0 - chi2 * c / r0Len_;
+    double g = dt - chi2 * chi * s / SQRT_MU;
+    position = r0_ * f + v0_ * g;
+
+    double r    = glm::length(position);
+    double fdot = SQRT_MU / (r * r0Len_) * chi * (alpha_ * chi2 * s - 1.0);
+    double gdot = 1.0 - chi2 * c / r;
+    velocity = r0_ * fdot + v0_ * gdot;
+}
+
+glm::dvec3 KeplerOrbit::positionAt(double time) const {
+    glm::dvec3 position, velocity;
+    stateAt(time, position, velocity);
+    return position;
+}
+
+} // namespace luna::sim
@@ -0,0 +1,46 @@
+// About: Two-body conic around the Moon, propagated analytically with universal variables.
+
+#pragma once
+
+#include "util/Math.h"
+
+namespace luna::sim {
+
+// The orbit through one state vector under LUNAR_GM alone. stateAt() solves the
+// universal Kepler equation, so any time offset (elliptic, parabolic or
+// hyperbolic, forward or back) costs a few Newton iterations and never drifts.
+class KeplerOrbit {
+public:
+    KeplerOrbit() = default;
+    KeplerOrbit(const glm::dvec3& position, const glm::dvec3& velocity, double epoch);
+
+    double epoch()           const { return epoch_; }
+    double eccentricity()    const { return eccentricity_; }
+    double periapsisRadius() const { return periapsis_; }
+    bool   isBound()         const { return alpha_ > 0.0; }
+
+    // Negative for hyperbolic orbits, infinite for parabolic ones
+    double semiMajorAxis() const;
+
+    // Seconds per revolution, or infinity when unbound
+    double period() const;
+
+    // Position and velocity at mission time `time`
+    void       stateAt(double time, glm::dvec3& position, glm::dvec3& velocity) const;
+    glm::dvec3 positionAt(double time) const;
+
+private:
+    // Universal anomaly at dt seconds past the epoch, with its Stumpff terms
+    double solveAnomaly(double dt, double& c, double& s) const;
+
+    glm::dvec3 r0_{0.0};
+    glm::dvec3 v0_{0.0};
+    double     epoch_        = 0.0;
+    double     r0Len_        = 0.0;
+    double     sigma0_       = 0.0;  // dot(r0, v0) / sqrt(GM)
+    double     alpha_        = 0.0;  // 1 / semi-major axis
+    double     eccentricity_ = 0.0;
+    double     periapsis_    = 0.0;
+};
+
+} // namespace luna::sim
@@ -0,0 +1,85 @@
+// About: Tangent-plane frame, coverage test and bilinear lookups for LocalTerrain.
+
+#include "sim/LocalTerrain.h"
+
+#include <algorithm>
+
+namespace luna::sim {
+
+namespace {
+constexpr double HALF = (LocalTerrain::GRID - 1) * 0.5;
+}
+
+double LocalTerrain::spacingFor(double altitude) {
+    // The field spans about twice the altitude, so the terrain in view of the
+    // vehicle is always inside it
+    return std::clamp(altitude / HALF, MIN_SPACING, MAX_SPACING);
+}
+
+void LocalTerrain::setFrame(const glm::dvec3& up, double spacing) {
+    up_      = up;
+    origin_  = up * luna::util::LUNAR_RADIUS;
+    // Any tangent basis works; avoid the polar axis when it is nearly parallel to up
+    glm::dvec3 ref = (std::abs(up.y) < 0.9) ? glm::dvec3(0.0, 1.0, 0.0) : glm::dvec3(1.0, 0.0, 0.0);
+    axisU_   = glm::normalize(glm::cross(ref, up));
+    axisV_   = glm::cross(up, axisU_);
+    spacing_ = spacing;
+}
+
+glm::dvec3 LocalTerrain::nodeDirection(uint32_t i, uint32_t j) const {
+    glm::dvec3 p = origin_ + axisU_ * ((i - HALF) * spacing_) + axisV_ * ((j - HALF) * spacing_);
+    return glm::normalize(p);
+}
+
+bool LocalTerrain::covers(const glm::dvec3& position) const {
+    if (spacing_ <= 0.0) return false;
+
+    glm::dvec3 d = position - origin_;
+    double h = glm::dot(d, up_);
+    if (h < -luna::util::LUNAR_RADIUS) return false;  // other side of the Moon
+
+    double reach = spacing_ * HALF * 0.5;
+    if (std::abs(glm::dot(d, axisU_)) > reach || std::abs(glm::dot(d, axisV_)) > reach)
+        return false;
+
+    // Resample when the altitude has changed enough to want a spacing 4x off
+    double wanted = spacingFor(h);
+    return wanted > spacing_ * 0.25 && wanted < spacing_ * 4.0;
+}
+
+void LocalTerrain::locate(const glm::dvec3& position, double& u, double& v,
+                          glm::dvec3& offset) const {
+    offset = position - origin_;
+    u = std::clamp(glm::dot(offset, axisU_) / spacing_ + HALF, 0.0, double(GRID - 1));
+    v = std::clamp(glm::dot(offset, axisV_) / spacing_ + HALF, 0.0, double(GRID - 1));
+}
+
+double LocalTerrain::altitude(const glm::dvec3& position) const {
+    double u, v;
+    glm::dvec3 offset;
+    locate(position, u, v, offset);
+
+    uint32_t i = std::min(static_cast<uint32_t>(u), GRID - 2);
+    uint32_t j = std::min(static_cast<uint32_t>(v), GRID - 2);
+    double fu = u - i, fv = v - j;
+    const float* h = heights_.data() + j * GRID + i;
+    double ground = (h[0] * (1.0 - fu) + h[1] * fu) * (1.0 - fv) +
+                    (h[GRID] * (1.0 - fu) + h[GRID + 1] * fu) * fv;
+    return glm::dot(offset, up_) - ground;
+}
+
+glm::dvec3 LocalTerrain::normal(const glm::dvec3& position) const {
+    double u, v;
+    glm::dvec3 offset;
+    locate(position, u, v, offset);
+
+    uint32_t i = std::min(static_cast<uint32_t>(u), GRID - 2);
+    uint32_t j = std::min(static_cast<uint32_t>(v), GRID - 2);
+    double fu = u - i, fv = v - j;
+    const float* h = heights_.data() + j * GRID + i;
+    double dhdu = ((h[1] - h[0]) * (1.0 - fv) + (h[GRID + 1] - h[GRID]) * fv) / spacing_;
+    double dhdv = ((h[GRID] - h[0]) * (1.0 - fu) + (h[GRID + 1] - h[1]) * fu) / spacing_;
+    return glm::normalize(up_ - axisU_ * dhdu - axisV_ * dhdv);
+}
+
+} // namespace luna::sim
@@ -0,0 +1,83 @@
+// About: Cached tangent-plane heightfield around a vehicle for trig-free altitude and contact queries.
+
+#pragma once
+
+#include "util/Math.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace luna::sim {
+
+// A GRID x GRID heightfield of the surface under one point, in that point's
+// tangent plane. Each node stores how far the true surface (curvature included)
+// lies above the plane, so a query is a projection and a bilinear lookup. The
+// field is resampled only when the vehicle leaves its inner half or its altitude
+// calls for a different node spacing: a few kilometres between nodes in orbit,
+// down to a few metres near the ground, or when the terrain itself has changed.
+class LocalTerrain {
+public:
+    static constexpr uint32_t GRID        = 17;
+    static constexpr double   MIN_SPACING = 4.0;     // m, near the ground
+    static constexpr double   MAX_SPACING = 2000.0;  // m, about a 16 ppd texel
+
+    // Resample around `position` unless the field still covers it and was sampled
+    // at terrain generation `generation` (terrainGeneration(), for the shared
+    // terrain). Returns true when it resampled. `terrain` is (lat, lon) →
+    // elevation above LUNAR_RADIUS.
+    template <typename TerrainFn>
+    bool update(const glm::dvec3& position, TerrainFn& terrain, uint64_t generation = 0);
+
+    bool covers(const glm::dvec3& position) const;
+
+    // Height of `position` above the surface, along the field's up axis.
+    // Negative below ground. Requires update() around the position first.
+    double altitude(const glm::dvec3& position) const;
+
+    // World-space surface normal under `position`
+    glm::dvec3 normal(const glm::dvec3& position) const;
+
+    // Forget the field; the next update() resamples
+    void invalidate() { spacing_ = 0.0; }
+
+private:
+    static double spacingFor(double altitude);
+
+    void       setFrame(const glm::dvec3& up, double spacing);
+    glm::dvec3 nodeDirection(uint32_t i, uint32_t j) const;
+
+    // Continuous node coordinates of `position` (clamped into the field) and its
+    // offset from the plane origin
+    void locate(const glm::dvec3& position, double& u, double& v, glm::dvec3& offset) const;
+
+    glm::dvec3 origin_{0.0};  // up_ * LUNAR_RADIUS
+    glm::dvec3 up_{0.0};
+    glm::dvec3 axisU_{0.0};   // node i direction
+    glm::dvec3 axisV_{0.0};   // node j direction
+    double     spacing_ = 0.0;
+    uint64_t   generation_ = 0;
+    std::array<float, GRID * GRID> heights_{};  // surface height above the plane
+};
+
+template <typename TerrainFn>
+bool LocalTerrain::update(const glm::dvec3& position, TerrainFn& terrain, uint64_t generation) {
+    if (generation == generation_ && covers(position)) return false;
+    generation_ = generation;
+
+    double r = glm::length(position);
+    glm::dvec3 up = (r > 1.0) ? position / r : glm::dvec3(1.0, 0.0, 0.0);
+    setFrame(up, spacingFor(r - luna::util::LUNAR_RADIUS));
+
+    for (uint32_t j = 0; j < GRID; ++j) {
+        for (uint32_t i = 0; i < GRID; ++i) {
+            glm::dvec3 dir = nodeDirection(i, j);
+            double lat = std::asin(glm::clamp(dir.y, -1.0, 1.0));
+            double lon = std::atan2(dir.z, dir.x);
+            glm::dvec3 surface = dir * (luna::util::LUNAR_RADIUS + terrain(lat, lon));
+            heights_[j * GRID + i] = static_cast<float>(glm::dot(surface - origin_, up_));
+        }
+    }
+    return true;
+}
+
+} // namespace luna::sim
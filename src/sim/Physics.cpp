@@ -1,126 +1,180 @@
-// About: Semi-implicit Euler integration for 6DOF lunar lander physics.
+// About: Semi-implicit Euler, velocity Verlet and RK4 integration, plus analytic coasting, for 6DOF lander physics.
 
 #include "sim/Physics.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace luna::sim {
 
-void Physics::setTerrainQuery(std::function<double(double, double)> fn) {
-    terrainQuery_ = std::move(fn);
-}
-
-glm::dvec3 Physics::computeGravity(const glm::dvec3& position) const {
-    double r = glm::length(position);
-    if (r < 1.0) return glm::dvec3(0.0);
-    glm::dvec3 dir = position / r;
-    return -dir * (luna::util::LUNAR_GM / (r * r));
-}
+namespace {
 
-glm::dvec3 Physics::computeThrust(const SimState& state) const {
-    if (state.throttle <= 0.0 || state.fuelMass <= 0.0)
-        return glm::dvec3(0.0);
+constexpr double G0 = 9.80665;  // standard gravity for Isp
 
-    // Thrust along lander's local +Y axis (body frame → world)
-    glm::dvec3 thrustDir = state.orientation * glm::dvec3(0.0, 1.0, 0.0);
-    double force = state.throttle * state.maxThrust;
-    return thrustDir * (force / state.totalMass());
+// Point-mass gravity, branch-free so the batched loops vectorize
+inline glm::dvec3 gravityAt(const glm::dvec3& position) {
+    double r2 = glm::dot(position, position);
+    double r  = std::sqrt(r2);
+    double k  = -luna::util::LUNAR_GM / std::max(r2 * r, 1.0);
+    return (r < 1.0) ? glm::dvec3(0.0) : position * k;
 }
 
-void Physics::consumeFuel(SimState& state, double dt) const {
-    if (state.throttle <= 0.0 || state.fuelMass <= 0.0) return;
-
-    double massFlow = state.throttle * state.maxThrust / (state.specificImpulse * G0);
-    state.fuelMass -= massFlow * dt;
-    if (state.fuelMass < 0.0) state.fuelMass = 0.0;
+// Thrust along the lander's local +Y axis (body frame → world), over the current mass
+inline glm::dvec3 thrustAccel(const glm::dquat& orientation, double throttle, double fuelMass,
+                              double dryMass, double maxThrust) {
+    double force = (throttle > 0.0 && fuelMass > 0.0) ? throttle * maxThrust : 0.0;
+    return orientation * glm::dvec3(0.0, 1.0, 0.0) * (force / (dryMass + fuelMass));
 }
 
-void Physics::deriveFlightData(SimState& state) const {
-    double r = glm::length(state.position);
-    glm::dvec3 radialDir = (r > 1.0) ? state.position / r : glm::dvec3(1.0, 0.0, 0.0);
-
-    // Vertical speed (positive = moving away from Moon center)
-    state.verticalSpeed = glm::dot(state.velocity, radialDir);
-
-    // Surface speed (tangential component)
-    glm::dvec3 tangential = state.velocity - radialDir * state.verticalSpeed;
-    state.surfaceSpeed = glm::length(tangential);
+inline double burnFuel(double fuelMass, double throttle, double massFlowPerThrottle, double dt) {
+    double massFlow = (fuelMass > 0.0) ? throttle * massFlowPerThrottle : 0.0;
+    return std::max(fuelMass - massFlow * dt, 0.0);
+}
 
-    // Altitude above terrain
-    double lat = std::asin(glm::clamp(radialDir.y, -1.0, 1.0));
-    double lon = std::atan2(radialDir.z, radialDir.x);
-    double terrainElev = terrainQuery_ ? terrainQuery_(lat, lon) : 0.0;
-    state.altitude = r - luna::util::LUNAR_RADIUS - terrainElev;
+// Advance position and velocity by dt under gravity plus a constant thrust acceleration
+template <Integrator I>
+inline void translate(glm::dvec3& p, glm::dvec3& v, const glm::dvec3& thrust, double dt) {
+    if constexpr (I == Integrator::SemiImplicitEuler) {
+        // Velocity first, then position with the new velocity
+        v += (gravityAt(p) + thrust) * dt;
+        p += v * dt;
+    } else if constexpr (I == Integrator::VelocityVerlet) {
+        glm::dvec3 a0 = gravityAt(p) + thrust;
+        p += (v + a0 * (0.5 * dt)) * dt;
+        v += (a0 + gravityAt(p) + thrust) * (0.5 * dt);
+    } else {
+        double h = 0.5 * dt;
+        glm::dvec3 a1 = gravityAt(p) + thrust;
+        glm::dvec3 v2 = v + a1 * h;
+        glm::dvec3 a2 = gravityAt(p + v * h) + thrust;
+        glm::dvec3 v3 = v + a2 * h;
+        glm::dvec3 a3 = gravityAt(p + v2 * h) + thrust;
+        glm::dvec3 v4 = v + a3 * dt;
+        glm::dvec3 a4 = gravityAt(p + v3 * dt) + thrust;
+        p += (v + (v2 + v3) * 2.0 + v4) * (dt / 6.0);
+        v += (a1 + (a2 + a3) * 2.0 + a4) * (dt / 6.0);
+    }
 }
 
-void Physics::checkCollision(SimState& state) const {
-    if (state.altitude > 0.0) return;
-    if (state.phase == FlightPhase::Landed || state.phase == FlightPhase::Crashed) return;
+// Orientation integration: q' = q + 0.5 * dt * omega * q
+inline void rotate(glm::dquat& orientation, glm::dvec3& angularVelocity,
+                   const glm::dvec3& torque, double dt) {
+    angularVelocity += torque * dt;
+    glm::dquat spin(0.0, angularVelocity.x, angularVelocity.y, angularVelocity.z);
+    orientation = glm::normalize(orientation + 0.5 * dt * spin * orientation);
+}
 
-    // Clamp position to surface
-    double r = glm::length(state.position);
-    glm::dvec3 radialDir = state.position / r;
-    double lat = std::asin(glm::clamp(radialDir.y, -1.0, 1.0));
-    double lon = std::atan2(radialDir.z, radialDir.x);
-    double terrainElev = terrainQuery_ ? terrainQuery_(lat, lon) : 0.0;
-    double surfaceR = luna::util::LUNAR_RADIUS + terrainElev;
+// One pass over every vehicle of the batch. Inactive vehicles step by zero, which
+// leaves them unchanged, so the loop body has no early exit.
+template <Integrator I>
+void integrateLanes(SimBatch& b, double dt) {
+    const double massFlowPerThrottle = b.maxThrust / (b.specificImpulse * G0);
+    const size_t n = b.size();
+    for (size_t i = 0; i < n; ++i) {
+        const double h = b.active[i] ? dt : 0.0;
+
+        glm::dquat q(b.qw[i], b.qx[i], b.qy[i], b.qz[i]);
+        glm::dvec3 p(b.px[i], b.py[i], b.pz[i]);
+        glm::dvec3 v(b.vx[i], b.vy[i], b.vz[i]);
+        glm::dvec3 w(b.wx[i], b.wy[i], b.wz[i]);
+
+        glm::dvec3 thrust = thrustAccel(q, b.throttle[i], b.fuelMass[i], b.dryMass, b.maxThrust);
+        translate<I>(p, v, thrust, h);
+        rotate(q, w, glm::dvec3(b.tx[i], b.ty[i], b.tz[i]), h);
+
+        b.px[i] = p.x; b.py[i] = p.y; b.pz[i] = p.z;
+        b.vx[i] = v.x; b.vy[i] = v.y; b.vz[i] = v.z;
+        b.qw[i] = q.w; b.qx[i] = q.x; b.qy[i] = q.y; b.qz[i] = q.z;
+        b.wx[i] = w.x; b.wy[i] = w.y; b.wz[i] = w.z;
+        b.fuelMass[i] = burnFuel(b.fuelMass[i], b.throttle[i], massFlowPerThrottle, h);
+        b.missionTime[i] += h;
+    }
+}
 
-    state.position = radialDir * surfaceR;
-    state.altitude = 0.0;
+} // namespace
 
-    // Check landing criteria
-    bool safeLanding = (std::abs(state.verticalSpeed) < LANDING_SPEED) &&
-                       (state.surfaceSpeed < LANDING_HORIZ_SPEED);
+void Physics::setTerrainQuery(std::function<double(double, double)> fn,
+                              std::function<uint64_t()> generation) {
+    terrainQuery_      = std::move(fn);
+    terrainGeneration_ = std::move(generation);
+}
 
-    if (safeLanding) {
-        state.phase = FlightPhase::Landed;
+double Physics::step(SimState& state, double dt) {
+    auto terrain = [this](double lat, double lon) {
+        return terrainQuery_ ? terrainQuery_(lat, lon) : 0.0;
+    };
+    uint64_t generation = terrainGeneration_ ? terrainGeneration_() : 0;
+
+    const KeplerOrbit* coast = nullptr;
+    if (isCoasting(state)) {
+        if (!coastValid_ || state.position != coastPosition_ ||
+            state.velocity != coastVelocity_ || state.missionTime != coastTime_) {
+            coastOrbit_ = KeplerOrbit(state.position, state.velocity, state.missionTime);
+            coastValid_ = true;
+        }
+        coast = &coastOrbit_;
     } else {
-        state.phase = FlightPhase::Crashed;
+        coastValid_ = false;
     }
 
-    state.velocity = glm::dvec3(0.0);
-    state.angularVelocity = glm::dvec3(0.0);
+    double taken = stepWith(state, dt, coast, [&](const glm::dvec3& position, double,
+                                                  const glm::dvec3&) {
+        localTerrain_.update(position, terrain, generation);
+        return localTerrain_.altitude(position);
+    });
+    coastPosition_ = state.position;
+    coastVelocity_ = state.velocity;
+    coastTime_     = state.missionTime;
+    return taken;
 }
 
-void Physics::step(SimState& state, double dt) {
-    if (state.phase == FlightPhase::Landed || state.phase == FlightPhase::Crashed)
-        return;
-
-    // Clamp dt to prevent instability from frame spikes
-    dt = glm::min(dt, 0.05);
-
+void Physics::integrate(SimState& state, double dt, const KeplerOrbit* coast) const {
     state.missionTime += dt;
 
-    // Semi-implicit Euler: update velocity first, then position
-    glm::dvec3 gravity = computeGravity(state.position);
-    glm::dvec3 thrustAccel = computeThrust(state);
-
-    state.velocity += (gravity + thrustAccel) * dt;
-    state.position += state.velocity * dt;
+    if (coast) {
+        coast->stateAt(state.missionTime, state.position, state.velocity);
+        // Turn by the whole angle about the rate axis: a coast step can be long
+        state.angularVelocity += state.torqueInput * dt;
+        double rate = glm::length(state.angularVelocity);
+        if (rate > 1e-12) {
+            state.orientation = glm::normalize(
+                glm::angleAxis(rate * dt, state.angularVelocity / rate) * state.orientation);
+        }
+        return;
+    }
 
-    // Orientation integration: q' = q + 0.5 * dt * omega * q
-    if (glm::length(state.angularVelocity + state.torqueInput) > 1e-10) {
-        glm::dvec3 angVel = state.angularVelocity + state.torqueInput * dt;
-        state.angularVelocity = angVel;
-        glm::dquat spin(0.0, angVel.x, angVel.y, angVel.z);
-        state.orientation += 0.5 * dt * spin * state.orientation;
-        state.orientation = glm::normalize(state.orientation);
+    glm::dvec3 thrust = thrustAccel(state.orientation, state.throttle, state.fuelMass,
+                                    state.dryMass, state.maxThrust);
+    switch (integrator_) {
+    case Integrator::SemiImplicitEuler:
+        translate<Integrator::SemiImplicitEuler>(state.position, state.velocity, thrust, dt);
+        break;
+    case Integrator::VelocityVerlet:
+        translate<Integrator::VelocityVerlet>(state.position, state.velocity, thrust, dt);
+        break;
+    case Integrator::RK4:
+        translate<Integrator::RK4>(state.position, state.velocity, thrust, dt);
+        break;
     }
 
-    consumeFuel(state, dt);
-    deriveFlightData(state);
-    checkCollision(state);
-
-    // Update flight phase based on altitude and throttle
-    if (state.phase != FlightPhase::Landed && state.phase != FlightPhase::Crashed) {
-        if (state.throttle > 0.0) {
-            state.phase = (state.altitude < 1000.0) ? FlightPhase::Terminal
-                                                     : FlightPhase::PoweredDescent;
-        } else if (state.verticalSpeed < -1.0) {
-            state.phase = FlightPhase::Descent;
-        } else {
-            state.phase = FlightPhase::Orbit;
-        }
+    if (glm::length(state.angularVelocity + state.torqueInput) > 1e-10)
+        rotate(state.orientation, state.angularVelocity, state.torqueInput, dt);
+
+    state.fuelMass = burnFuel(state.fuelMass, state.throttle,
+                              state.maxThrust / (state.specificImpulse * G0), dt);
+}
+
+void Physics::integrateBatch(SimBatch& batch, double dt) const {
+    switch (integrator_) {
+    case Integrator::SemiImplicitEuler:
+        integrateLanes<Integrator::SemiImplicitEuler>(batch, dt);
+        break;
+    case Integrator::VelocityVerlet:
+        integrateLanes<Integrator::VelocityVerlet>(batch, dt);
+        break;
+    case Integrator::RK4:
+        integrateLanes<Integrator::RK4>(batch, dt);
+        break;
     }
 }
 
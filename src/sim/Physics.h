@@ -2,30 +2,217 @@
 
 #pragma once
 
+#include "sim/KeplerOrbit.h"
+#include "sim/LocalTerrain.h"
+#include "sim/SimBatch.h"
 #include "sim/SimState.h"
+#include "sim/TerrainQuery.h"
+#include <cmath>
+#include <cstddef>
 #include <functional>
 
 namespace luna::sim {
 
+// Translational integration scheme. Attitude always takes the first-order
+// quaternion update, and thrust is held constant across a step.
+enum class Integrator {
+    SemiImplicitEuler,  // one gravity evaluation per step (real-time default)
+    VelocityVerlet,     // two, second order and symplectic
+    RK4,                // four, fourth order
+};
+
 class Physics {
 public:
-    void step(SimState& state, double dt);
+    void setIntegrator(Integrator integrator) { integrator_ = integrator; }
+    Integrator integrator() const { return integrator_; }
+
+    // Step one vehicle against the terrain set with setTerrainQuery, through a
+    // LocalTerrain cache this Physics owns. Under thrust dt is clamped to 50 ms to
+    // ride out frame spikes. With the engine off the vehicle coasts: translation
+    // is evaluated on a KeplerOrbit built once from the state, so there is no
+    // integration drift, and dt is clamped only while that orbit can reach the
+    // terrain. A single call can then cover hours of time warp at the cost of one
+    // Kepler solve. Returns the time actually stepped.
+    double step(SimState& state, double dt);
+
+    // Numerically integrated step() against `terrain`, any callable (lat, lon) →
+    // elevation above LUNAR_RADIUS in meters. As a template parameter it inlines
+    // into the step. Samples the terrain directly, once per step.
+    template <typename TerrainFn>
+    void step(SimState& state, double dt, TerrainFn&& terrain) const;
+
+    // Numerically integrated step() with altitude and contact answered by `local`,
+    // which samples `terrain` only when it has to move or `generation` changes.
+    // The caller owns `generation` and bumps it whenever the heights `terrain`
+    // returns change: terrainGeneration() for the shared terrain.
+    template <typename TerrainFn>
+    void step(SimState& state, double dt, LocalTerrain& local, TerrainFn&& terrain,
+              uint64_t generation = 0) const;
+
+    // Whether step() takes the analytic coast path for this state
+    static bool isCoasting(const SimState& state) {
+        return state.throttle <= 0.0 || state.fuelMass <= 0.0;
+    }
 
-    // Terrain height query: (lat, lon) → elevation above LUNAR_RADIUS in meters
-    void setTerrainQuery(std::function<double(double, double)> fn);
+    // Step every vehicle of `batch` by dt (not clamped). Gravity, thrust, fuel and
+    // attitude run as loops over the arrays; only the terrain contact pass takes
+    // one vehicle at a time, through each vehicle's LocalTerrain. Landed and
+    // crashed vehicles stay put. `generation` is as for step() with a LocalTerrain.
+    template <typename TerrainFn>
+    void stepBatch(SimBatch& batch, double dt, TerrainFn&& terrain,
+                   uint64_t generation = 0) const;
+
+    // Terrain height query: (lat, lon) → elevation above LUNAR_RADIUS in meters.
+    // `generation`, if set, changes whenever the query's heights do
+    // (terrainGeneration for sampleTerrainHeight), so the cached field resamples.
+    void setTerrainQuery(std::function<double(double, double)> fn,
+                         std::function<uint64_t()> generation = {});
 
 private:
-    glm::dvec3 computeGravity(const glm::dvec3& position) const;
-    glm::dvec3 computeThrust(const SimState& state) const;
-    void consumeFuel(SimState& state, double dt) const;
-    void deriveFlightData(SimState& state) const;
-    void checkCollision(SimState& state) const;
+    struct FlightData {
+        FlightPhase phase;
+        double      altitude;
+        double      verticalSpeed;
+        double      surfaceSpeed;
+    };
+
+    // Everything up to the terrain: mission time, translation, attitude and fuel.
+    // With `coast`, translation comes from the orbit and attitude turns exactly.
+    void integrate(SimState& state, double dt, const KeplerOrbit* coast) const;
+    void integrateBatch(SimBatch& batch, double dt) const;
+
+    template <typename AltitudeFn>
+    double stepWith(SimState& state, double dt, const KeplerOrbit* coast,
+                    AltitudeFn&& altitudeAt) const;
+
+    // Derive flight data from the integrated position and velocity, resolve terrain
+    // contact and pick the flight phase. altitudeAt(position, r, radialDir) gives
+    // the height above the terrain. Returns true on touchdown, after which the
+    // vehicle is clamped to the surface with zero velocity.
+    template <typename AltitudeFn>
+    static bool resolveSurface(glm::dvec3& position, glm::dvec3& velocity, double throttle,
+                               FlightData& flight, AltitudeFn& altitudeAt);
 
     std::function<double(double, double)> terrainQuery_;
+    std::function<uint64_t()>             terrainGeneration_;
+    LocalTerrain localTerrain_;
+    Integrator integrator_ = Integrator::SemiImplicitEuler;
+
+    // The orbit step() coasts on. Kept while each step starts exactly where the
+    // previous coast step ended; a burn or an outside change to the state rebuilds it.
+    KeplerOrbit coastOrbit_;
+    bool        coastValid_ = false;
+    glm::dvec3  coastPosition_{0.0};
+    glm::dvec3  coastVelocity_{0.0};
+    double      coastTime_ = 0.0;
 
-    static constexpr double G0 = 9.80665;             // standard gravity for Isp
     static constexpr double LANDING_SPEED = 4.0;       // max safe landing vertical speed (m/s)
     static constexpr double LANDING_HORIZ_SPEED = 2.0; // max safe landing horizontal speed (m/s)
 };
 
+template <typename TerrainFn>
+void Physics::step(SimState& state, double dt, TerrainFn&& terrain) const {
+    stepWith(state, dt, nullptr, [&](const glm::dvec3&, double r, const glm::dvec3& radialDir) {
+        double lat = std::asin(glm::clamp(radialDir.y, -1.0, 1.0));
+        double lon = std::atan2(radialDir.z, radialDir.x);
+        return r - luna::util::LUNAR_RADIUS - terrain(lat, lon);
+    });
+}
+
+template <typename TerrainFn>
+void Physics::step(SimState& state, double dt, LocalTerrain& local, TerrainFn&& terrain,
+                   uint64_t generation) const {
+    stepWith(state, dt, nullptr, [&](const glm::dvec3& position, double, const glm::dvec3&) {
+        local.update(position, terrain, generation);
+        return local.altitude(position);
+    });
+}
+
+template <typename AltitudeFn>
+double Physics::stepWith(SimState& state, double dt, const KeplerOrbit* coast,
+                         AltitudeFn&& altitudeAt) const {
+    if (state.phase == FlightPhase::Landed || state.phase == FlightPhase::Crashed)
+        return 0.0;
+
+    // Long steps only on an orbit that can't reach the ground, which contact
+    // detection would otherwise step straight through
+    if (!coast || coast->periapsisRadius() < luna::util::LUNAR_RADIUS + MAX_TERRAIN_HEIGHT)
+        dt = glm::min(dt, 0.05);
+    integrate(state, dt, coast);
+
+    FlightData flight{state.phase, 0.0, 0.0, 0.0};
+    if (resolveSurface(state.position, state.velocity, state.throttle, flight, altitudeAt))
+        state.angularVelocity = glm::dvec3(0.0);
+    state.phase         = flight.phase;
+    state.altitude      = flight.altitude;
+    state.verticalSpeed = flight.verticalSpeed;
+    state.surfaceSpeed  = flight.surfaceSpeed;
+    return dt;
+}
+
+template <typename TerrainFn>
+void Physics::stepBatch(SimBatch& batch, double dt, TerrainFn&& terrain,
+                        uint64_t generation) const {
+    integrateBatch(batch, dt);
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (!batch.active[i]) continue;
+
+        LocalTerrain& local = batch.surface[i];
+        auto altitudeAt = [&](const glm::dvec3& position, double, const glm::dvec3&) {
+            local.update(position, terrain, generation);
+            return local.altitude(position);
+        };
+        glm::dvec3 position(batch.px[i], batch.py[i], batch.pz[i]);
+        glm::dvec3 velocity(batch.vx[i], batch.vy[i], batch.vz[i]);
+        FlightData flight{batch.phase[i], 0.0, 0.0, 0.0};
+        if (resolveSurface(position, velocity, batch.throttle[i], flight, altitudeAt)) {
+            batch.px[i] = position.x;
+            batch.py[i] = position.y;
+            batch.pz[i] = position.z;
+            batch.vx[i] = batch.vy[i] = batch.vz[i] = 0.0;
+            batch.wx[i] = batch.wy[i] = batch.wz[i] = 0.0;
+            batch.active[i] = 0;
+        }
+        batch.phase[i]         = flight.phase;
+        batch.altitude[i]      = flight.altitude;
+        batch.verticalSpeed[i] = flight.verticalSpeed;
+        batch.surfaceSpeed[i]  = flight.surfaceSpeed;
+    }
+}
+
+template <typename AltitudeFn>
+bool Physics::resolveSurface(glm::dvec3& position, glm::dvec3& velocity, double throttle,
+                             FlightData& flight, AltitudeFn& altitudeAt) {
+    double r = glm::length(position);
+    glm::dvec3 radialDir = (r > 1.0) ? position / r : glm::dvec3(1.0, 0.0, 0.0);
+
+    // Vertical speed (positive = moving away from Moon center) and tangential speed
+    flight.verticalSpeed = glm::dot(velocity, radialDir);
+    flight.surfaceSpeed  = glm::length(velocity - radialDir * flight.verticalSpeed);
+
+    flight.altitude = altitudeAt(position, r, radialDir);
+
+    if (flight.altitude <= 0.0) {
+        // Clamp to the surface and judge the landing
+        bool safeLanding = (std::abs(flight.verticalSpeed) < LANDING_SPEED) &&
+                           (flight.surfaceSpeed < LANDING_HORIZ_SPEED);
+        flight.phase = safeLanding ? FlightPhase::Landed : FlightPhase::Crashed;
+        position = radialDir * (r - flight.altitude);
+        flight.altitude = 0.0;
+        velocity = glm::dvec3(0.0);
+        return true;
+    }
+
+    if (throttle > 0.0) {
+        flight.phase = (flight.altitude < 1000.0) ? FlightPhase::Terminal
+                                                  : FlightPhase::PoweredDescent;
+    } else if (flight.verticalSpeed < -1.0) {
+        flight.phase = FlightPhase::Descent;
+    } else {
+        flight.phase = FlightPhase::Orbit;
+    }
+    return false;
+}
+
 } // namespace luna::sim
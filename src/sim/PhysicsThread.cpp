@@ -0,0 +1,116 @@
+// About: PhysicsThread implementation — accumulator loop, snapshot publishing, interpolation.
+
+#include "sim/PhysicsThread.h"
+
+#include <algorithm>
+
+namespace luna::sim {
+
+SimState interpolateState(const SimState& a, const SimState& b, double t) {
+    SimState s        = b;
+    s.position        = glm::mix(a.position, b.position, t);
+    s.velocity        = glm::mix(a.velocity, b.velocity, t);
+    s.orientation     = glm::slerp(a.orientation, b.orientation, t);
+    s.angularVelocity = glm::mix(a.angularVelocity, b.angularVelocity, t);
+    return s;
+}
+
+PhysicsThread::PhysicsThread(Physics physics, const SimState& initial, double stepRate)
+    : physics_(std::move(physics)),
+      stepSeconds_(1.0 / stepRate),
+      snapshots_(SimSnapshot{initial, initial, 0.0, 0.0})
+{
+    thread_ = std::thread([this, initial] { run(initial); });
+}
+
+PhysicsThread::~PhysicsThread() {
+    stop();
+}
+
+void PhysicsThread::stop() {
+    stopping_.store(true, std::memory_order_relaxed);
+    if (thread_.joinable()) thread_.join();
+}
+
+double PhysicsThread::now() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+}
+
+void PhysicsThread::setControls(const SimControls& controls) {
+    controls_.writeSlot() = controls;
+    controls_.publish();
+}
+
+SimState PhysicsThread::sample() {
+    snapshots_.update();
+    const SimSnapshot& s = snapshots_.read();
+    if (s.interval <= 0.0) return s.current;
+    // Display one batch behind the clock, so there is always a later state to blend
+    // toward: `previous` is due at time - interval, and the display time is now - interval
+    double t = (now() - s.time) / s.interval;
+    return interpolateState(s.previous, s.current, std::clamp(t, 0.0, 1.0));
+}
+
+void PhysicsThread::run(SimState state) {
+    double   simTime = 0.0;  // clock time the current state is due at
+    double   warp    = 1.0;
+    double   windowStart     = 0.0;
+    double   windowSimulated = 0.0;
+    auto     wake = std::chrono::steady_clock::now();
+
+    while (!stopping_.load(std::memory_order_relaxed)) {
+        if (controls_.update()) {
+            state.throttle    = controls_.read().throttle;
+            state.torqueInput = controls_.read().torqueInput;
+            warp = std::clamp(controls_.read().timeWarp, 1.0, MAX_WARP);
+        }
+
+        double clock = now();
+        if (clock - simTime > MAX_CATCH_UP)
+            simTime = clock - MAX_CATCH_UP;
+
+        // Each step of dt simulated seconds moves the clock on by dt / warp
+        SimState previous   = state;
+        double   batchStart = simTime;
+        double   deadline   = clock + stepSeconds_ * MAX_WORK_FRACTION;
+        uint32_t steps      = 0;
+        while (simTime + stepSeconds_ / warp <= clock) {
+            // A coast is exact over any interval: take everything owed at once
+            double dt    = Physics::isCoasting(state) ? (clock - simTime) * warp : stepSeconds_;
+            double taken = physics_.step(state, dt);
+            if (taken <= 0.0) {
+                // Landed or crashed: nothing moves, so nothing is behind
+                windowSimulated += (clock - simTime) * warp;
+                simTime = clock;
+                break;
+            }
+            simTime += taken / warp;
+            windowSimulated += taken;
+            // Reading the clock costs about as much as a step; check it now and then
+            if (++steps % 64 == 0 && now() > deadline) break;
+        }
+
+        if (simTime > batchStart) {
+            SimSnapshot& snapshot = snapshots_.writeSlot();
+            snapshot.previous = previous;
+            snapshot.current  = state;
+            snapshot.time     = simTime;
+            snapshot.interval = simTime - batchStart;
+            snapshots_.publish();
+        }
+
+        if (clock - windowStart >= WARP_WINDOW) {
+            achievedWarp_.store(windowSimulated / (clock - windowStart), std::memory_order_relaxed);
+            windowStart     = clock;
+            windowSimulated = 0.0;
+        }
+
+        wake += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(stepSeconds_));
+        auto current = std::chrono::steady_clock::now();
+        if (wake < current) wake = current;
+        std::this_thread::sleep_until(wake);
+    }
+}
+
+} // namespace luna::sim
@@ -0,0 +1,94 @@
+// About: Fixed-rate physics on a dedicated thread, publishing interpolable SimState snapshots.
+
+#pragma once
+
+#include "sim/Physics.h"
+#include "sim/SimState.h"
+#include "util/TripleBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace luna::sim {
+
+// Pilot inputs the render thread hands to the simulation each frame
+struct SimControls {
+    double     throttle = 0.0;   // 0.0–1.0
+    glm::dvec3 torqueInput{0.0}; // body-frame torque command (rad/s^2)
+    double     timeWarp = 1.0;   // simulated seconds per wall second
+};
+
+// The states at the start and end of the latest batch of steps, so the reader can
+// interpolate between them. `time` is when `current` is due on the PhysicsThread
+// clock; `previous` is `interval` wall seconds earlier.
+struct SimSnapshot {
+    SimState previous;
+    SimState current;
+    double   time     = 0.0;
+    double   interval = 0.0;
+};
+
+// State a fraction t of the way from a to b: position, velocity and attitude are
+// blended, everything else (fuel, phase, flight data) is taken from b
+SimState interpolateState(const SimState& a, const SimState& b, double t);
+
+// Steps Physics at a fixed rate from an accumulator of wall time, independent of
+// the frame rate, and publishes a snapshot after every batch of steps through a
+// triple buffer. The render thread pushes controls and samples an interpolated
+// state one step in the past, so motion stays smooth at any frame rate. When the
+// thread falls more than MAX_CATCH_UP behind (debugger, suspend), the excess time
+// is dropped instead of being simulated in a burst.
+//
+// Under time warp the clock advances SimControls::timeWarp simulated seconds per
+// wall second. Powered flight is still sub-stepped at the fixed rate, as many
+// steps as fit in MAX_WORK_FRACTION of each wake-up; a coast takes everything
+// owed in one analytic Physics::step. Whatever cannot be simulated in time is
+// dropped like a stall, and achievedWarp() reports the rate actually kept.
+class PhysicsThread {
+public:
+    static constexpr double STEP_RATE    = 1000.0;  // Hz
+    static constexpr double MAX_CATCH_UP = 0.1;     // wall seconds of lag before time is dropped
+    static constexpr double MAX_WARP     = 100000.0;
+
+    // Share of a wake-up period spent stepping before the rest is left for later
+    static constexpr double MAX_WORK_FRACTION = 0.8;
+    // Wall seconds achievedWarp() averages over
+    static constexpr double WARP_WINDOW  = 0.5;
+
+    // Starts the thread. `physics` should already have its terrain query set.
+    PhysicsThread(Physics physics, const SimState& initial, double stepRate = STEP_RATE);
+    ~PhysicsThread();
+
+    PhysicsThread(const PhysicsThread&) = delete;
+    PhysicsThread& operator=(const PhysicsThread&) = delete;
+
+    // Render thread: controls apply from the next step on
+    void setControls(const SimControls& controls);
+
+    // Render thread: the state to display now
+    SimState sample();
+
+    // Simulated seconds per wall second over the last WARP_WINDOW; below the
+    // requested warp when steps could not keep up
+    double achievedWarp() const { return achievedWarp_.load(std::memory_order_relaxed); }
+
+    // Join the thread; the last published state stays available. Safe to call twice.
+    void stop();
+
+private:
+    void   run(SimState state);
+    double now() const;
+
+    Physics physics_;
+    double  stepSeconds_;
+
+    luna::util::TripleBuffer<SimSnapshot> snapshots_;
+    luna::util::TripleBuffer<SimControls> controls_;
+
+    std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+    std::atomic<double> achievedWarp_{1.0};
+    std::atomic<bool>   stopping_{false};
+    std::thread         thread_;
+};
+
+} // namespace luna::sim
@@ -0,0 +1,77 @@
+// About: SimBatch construction and conversion to and from SimState.
+
+#include "sim/SimBatch.h"
+
+namespace luna::sim {
+
+SimBatch::SimBatch(size_t n, const SimState& initial)
+    : dryMass(initial.dryMass)
+    , specificImpulse(initial.specificImpulse)
+    , maxThrust(initial.maxThrust) {
+    resize(n, initial);
+}
+
+void SimBatch::resize(size_t n, const SimState& initial) {
+    size_t old = size();
+    for (auto* field : {&px, &py, &pz, &vx, &vy, &vz, &qw, &qx, &qy, &qz,
+                        &wx, &wy, &wz, &tx, &ty, &tz, &fuelMass, &throttle,
+                        &altitude, &surfaceSpeed, &verticalSpeed, &missionTime}) {
+        field->resize(n);
+    }
+    phase.resize(n);
+    active.resize(n);
+    surface.resize(n);
+    for (size_t i = old; i < n; ++i) store(i, initial);
+}
+
+void SimBatch::store(size_t i, const SimState& state) {
+    px[i] = state.position.x;
+    py[i] = state.position.y;
+    pz[i] = state.position.z;
+    vx[i] = state.velocity.x;
+    vy[i] = state.velocity.y;
+    vz[i] = state.velocity.z;
+    qw[i] = state.orientation.w;
+    qx[i] = state.orientation.x;
+    qy[i] = state.orientation.y;
+    qz[i] = state.orientation.z;
+    wx[i] = state.angularVelocity.x;
+    wy[i] = state.angularVelocity.y;
+    wz[i] = state.angularVelocity.z;
+    tx[i] = state.torqueInput.x;
+    ty[i] = state.torqueInput.y;
+    tz[i] = state.torqueInput.z;
+    fuelMass[i] = state.fuelMass;
+    throttle[i] = state.throttle;
+
+    phase[i]  = state.phase;
+    active[i] = state.phase != FlightPhase::Landed && state.phase != FlightPhase::Crashed;
+    altitude[i]      = state.altitude;
+    surfaceSpeed[i]  = state.surfaceSpeed;
+    verticalSpeed[i] = state.verticalSpeed;
+    missionTime[i]   = state.missionTime;
+    surface[i].invalidate();
+}
+
+SimState SimBatch::load(size_t i) const {
+    SimState state;
+    state.position        = glm::dvec3(px[i], py[i], pz[i]);
+    state.velocity        = glm::dvec3(vx[i], vy[i], vz[i]);
+    state.orientation     = glm::dquat(qw[i], qx[i], qy[i], qz[i]);
+    state.angularVelocity = glm::dvec3(wx[i], wy[i], wz[i]);
+    state.torqueInput     = glm::dvec3(tx[i], ty[i], tz[i]);
+    state.dryMass         = dryMass;
+    state.fuelMass        = fuelMass[i];
+    state.specificImpulse = specificImpulse;
+    state.maxThrust       = maxThrust;
+    state.throttle        = throttle[i];
+
+    state.phase         = phase[i];
+    state.altitude      = altitude[i];
+    state.surfaceSpeed  = surfaceSpeed[i];
+    state.verticalSpeed = verticalSpeed[i];
+    state.missionTime   = missionTime[i];
+    return state;
+}
+
+} // namespace luna::sim
@@ -0,0 +1,53 @@
+// About: Structure-of-arrays lander states for stepping many trajectories at once.
+
+#pragma once
+
+#include "sim/LocalTerrain.h"
+#include "sim/SimState.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace luna::sim {
+
+// N vehicles stored field by field, for Physics::stepBatch. Vehicle i is element i
+// of every array. The vehicle constants are shared by the whole batch; a dispersion
+// study perturbs initial conditions, not the airframe.
+struct SimBatch {
+    std::vector<double> px, py, pz;      // position (m, Moon-centered)
+    std::vector<double> vx, vy, vz;      // velocity (m/s)
+    std::vector<double> qw, qx, qy, qz;  // body-to-world orientation
+    std::vector<double> wx, wy, wz;      // angular velocity (rad/s)
+    std::vector<double> tx, ty, tz;      // torque command (rad/s^2)
+    std::vector<double> fuelMass;
+    std::vector<double> throttle;
+
+    std::vector<FlightPhase>  phase;
+    std::vector<uint8_t>      active;    // cleared on landing or crashing
+    std::vector<double>       altitude;
+    std::vector<double>       surfaceSpeed;
+    std::vector<double>       verticalSpeed;
+    std::vector<double>       missionTime;
+    std::vector<LocalTerrain> surface;   // per-vehicle terrain cache (~1.3 KB each)
+
+    double dryMass         = 85000.0;
+    double specificImpulse = 380.0;
+    double maxThrust       = 4400000.0;
+
+    SimBatch() = default;
+
+    // n copies of `initial`, which also supplies the vehicle constants
+    SimBatch(size_t n, const SimState& initial);
+
+    size_t size() const { return px.size(); }
+
+    // New vehicles are copies of `initial`
+    void resize(size_t n, const SimState& initial);
+
+    // Copy vehicle i in or out. store() ignores the state's vehicle constants and
+    // drops the vehicle's terrain cache.
+    void     store(size_t i, const SimState& state);
+    SimState load(size_t i) const;
+};
+
+} // namespace luna::sim
@@ -0,0 +1,280 @@
+// About: TerrainLayers implementation — snapshot publishing, LRU eviction and feathered blending.
+
+#include "sim/TerrainLayers.h"
+#include "util/Log.h"
+#include "util/Math.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace luna::sim {
+
+namespace {
+
+// Fraction of the region box, at each border, over which it fades into the base
+constexpr double FEATHER = 0.05;
+
+double wrapAngle(double a) {
+    while (a > M_PI)   a -= 2.0 * M_PI;
+    while (a < -M_PI)  a += 2.0 * M_PI;
+    return a;
+}
+
+// Arc distance in meters from (lat, lon) to the nearest point of the region box,
+// approximated by clamping to the box in lat/lon
+double distanceToRegion(const TerrainRegion& r, double lat, double lon) {
+    double clampedLat = std::clamp(lat, r.latMin, r.latMax);
+    double clampedLon = lon;
+    if (lon < r.lonMin || lon > r.lonMax) {
+        double toMin = std::fabs(wrapAngle(lon - r.lonMin));
+        double toMax = std::fabs(wrapAngle(lon - r.lonMax));
+        clampedLon = toMin < toMax ? r.lonMin : r.lonMax;
+    }
+    double cosArc = std::sin(lat) * std::sin(clampedLat) +
+                    std::cos(lat) * std::cos(clampedLat) * std::cos(lon - clampedLon);
+    return std::acos(std::clamp(cosArc, -1.0, 1.0)) * luna::util::LUNAR_RADIUS;
+}
+
+} // anonymous namespace
+
+TerrainLayers::TerrainLayers() = default;
+
+TerrainLayers::~TerrainLayers() {
+    cancelLoads();
+}
+
+void TerrainLayers::cancelLoads() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loadEpoch_++;
+    }
+    // With loads outstanding the job system exists; without, it is not created at exit
+    if (!loads_.isDone())
+        luna::util::JobSystem::instance().wait(loads_);
+}
+
+bool TerrainLayers::loadBase(const std::string& path) {
+    return base_.load(path);
+}
+
+void TerrainLayers::addRegion(const TerrainRegion& region) {
+    if (!(region.latMin < region.latMax) || !(region.lonMin < region.lonMax) ||
+        region.lonMin < -M_PI || region.lonMax > M_PI) {
+        LOG_WARN("Terrain region %s has invalid bounds — ignored", region.path.c_str());
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    regions_.push_back(region);
+    state_.push_back(RegionState::Unloaded);
+    lastWanted_.push_back(0);
+}
+
+void TerrainLayers::reset() {
+    // Queued loads return at once; a running one finishes before its state goes
+    cancelLoads();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    regions_.clear();
+    state_.clear();
+    lastWanted_.clear();
+    focusTick_ = 0;
+    resident_  = std::make_shared<const ResidentSet>();
+    base_ = Heightmap{};
+    changedLocked({-0.5 * M_PI, 0.5 * M_PI, -M_PI, M_PI});
+}
+
+void TerrainLayers::setFocus(double lat, double lon) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    focusTick_++;
+    for (uint32_t i = 0; i < regions_.size(); i++) {
+        if (distanceToRegion(regions_[i], lat, lon) > regions_[i].loadDistance) continue;
+        lastWanted_[i] = focusTick_;
+        if (state_[i] == RegionState::Unloaded) {
+            state_[i] = RegionState::Loading;
+            luna::util::JobSystem::instance().submit([this, i, epoch = loadEpoch_] {
+                loadRegion(i, epoch);
+            }, luna::util::JobPriority::Background, &loads_);
+        }
+    }
+}
+
+void TerrainLayers::loadRegion(uint32_t index, uint64_t epoch) {
+    auto resident = std::make_shared<Resident>();
+    resident->region = index;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (epoch != loadEpoch_) return;
+        resident->bounds = regions_[index];
+    }
+    const std::string& path = resident->bounds.path;
+
+    // All disk work happens here, off the lock: map, then fault every page in so
+    // samplers on the render and physics threads only ever hit memory
+    // Decoded by this job alone, leaving the other workers to the frame
+    bool ok = resident->map.load(path, false);
+    if (ok) resident->map.prefault();
+
+    // Evicted maps are freed when this goes out of scope, after the lock is released
+    std::vector<std::shared_ptr<const Resident>> dropped;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (epoch != loadEpoch_) return;  // reset() since; the layers it loaded for are gone
+    if (!ok) {
+        state_[index] = RegionState::Failed;
+        LOG_WARN("Terrain region %s failed to load — base layer only", path.c_str());
+        return;
+    }
+    auto next = std::make_shared<ResidentSet>(*resident_);
+    next->push_back(std::move(resident));
+    resident_ = std::move(next);
+    state_[index] = RegionState::Resident;
+    changedLocked(boxOf(regions_[index]));
+    LOG_INFO("Terrain region resident: %s", path.c_str());
+    evictLocked(dropped);
+}
+
+void TerrainLayers::evictLocked(std::vector<std::shared_ptr<const Resident>>& dropped) {
+    while (resident_->size() > MAX_RESIDENT_REGIONS) {
+        // Least recently wanted region that is not wanted right now
+        size_t victim = resident_->size();
+        for (size_t k = 0; k < resident_->size(); k++) {
+            uint32_t r = (*resident_)[k]->region;
+            if (lastWanted_[r] == focusTick_) continue;
+            if (victim == resident_->size() ||
+                lastWanted_[r] < lastWanted_[(*resident_)[victim]->region])
+                victim = k;
+        }
+        if (victim == resident_->size()) return;  // everything resident is in range
+
+        auto next = std::make_shared<ResidentSet>(*resident_);
+        uint32_t r = (*next)[victim]->region;
+        dropped.push_back((*next)[victim]);
+        next->erase(next->begin() + static_cast<std::ptrdiff_t>(victim));
+        resident_ = std::move(next);
+        state_[r] = RegionState::Unloaded;
+        changedLocked(boxOf(regions_[r]));
+        // Samplers still holding an older snapshot keep the map alive until they finish
+        LOG_INFO("Terrain region evicted: %s", regions_[r].path.c_str());
+    }
+}
+
+TerrainBox TerrainLayers::boxOf(const TerrainRegion& region) {
+    return {region.latMin, region.latMax, region.lonMin, region.lonMax};
+}
+
+void TerrainLayers::changedLocked(const TerrainBox& box) {
+    if (changes_.size() == MAX_CHANGES) changes_.erase(changes_.begin());
+    uint64_t generation = generation_.load(std::memory_order_relaxed) + 1;
+    changes_.emplace_back(generation, box);
+    generation_.store(generation, std::memory_order_release);
+}
+
+uint64_t TerrainLayers::changesSince(uint64_t since, std::vector<TerrainBox>& boxes) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t current = generation_.load(std::memory_order_relaxed);
+    if (since >= current) return current;
+    // Older changes have been forgotten: anything may have changed
+    if (changes_.empty() || changes_.front().first > since + 1) {
+        boxes.push_back({-0.5 * M_PI, 0.5 * M_PI, -M_PI, M_PI});
+        return current;
+    }
+    for (const auto& [generation, box] : changes_)
+        if (generation > since) boxes.push_back(box);
+    return current;
+}
+
+void TerrainLayers::regionBoxes(std::vector<TerrainBox>& boxes) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const TerrainRegion& region : regions_)
+        boxes.push_back(boxOf(region));
+}
+
+std::shared_ptr<const TerrainLayers::ResidentSet> TerrainLayers::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resident_;
+}
+
+size_t TerrainLayers::residentRegionCount() const {
+    return snapshot()->size();
+}
+
+size_t TerrainLayers::regionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return regions_.size();
+}
+
+uint32_t TerrainLayers::regionLevel(const Resident& res, uint32_t level) const {
+    if (level == 0) return 0;
+    // The region's rows span its latitude range the way a global map's span π
+    double footprint = base_.texelSpacing(level) * M_PI / (res.bounds.latMax - res.bounds.latMin);
+    return res.map.levelForFootprint(footprint);
+}
+
+bool TerrainLayers::toRegion(const TerrainRegion& r, double lat, double lon,
+                             double& regionLat, double& regionLon, double& weight) {
+    if (lat < r.latMin || lat > r.latMax || lon < r.lonMin || lon > r.lonMax) return false;
+
+    // Normalised box coordinates, then the lat/lon that Heightmap's global
+    // equirectangular addressing maps to the same texel of the region file
+    double s = (lon - r.lonMin) / (r.lonMax - r.lonMin);
+    double t = (r.latMax - lat) / (r.latMax - r.latMin);
+    regionLon = (s - 0.5) * 2.0 * M_PI;
+    regionLat = (0.5 - t) * M_PI;
+
+    // A box spanning all longitudes has no east/west border to fade across
+    double edge = std::min(t, 1.0 - t);
+    if (r.lonMax - r.lonMin < 2.0 * M_PI - 1e-9)
+        edge = std::min(edge, std::min(s, 1.0 - s));
+    weight = std::min(edge / FEATHER, 1.0);
+    return weight > 0.0;
+}
+
+double TerrainLayers::sample(double lat, double lon, uint32_t level) const {
+    double h = base_.isLoaded() ? base_.sample(lat, lon, level) : 0.0;
+
+    auto set = snapshot();
+    for (const auto& res : *set) {
+        double rLat, rLon, w;
+        if (!toRegion(res->bounds, lat, lon, rLat, rLon, w)) continue;
+        h += (res->map.sample(rLat, rLon, regionLevel(*res, level)) - h) * w;
+    }
+    return h;
+}
+
+void TerrainLayers::sampleMany(const double* lat, const double* lon, float* out, size_t n,
+                               uint32_t level) const {
+    base_.sampleMany(lat, lon, out, n, level);  // zero-fills when not loaded
+
+    auto set = snapshot();
+    if (set->empty()) return;
+
+    // Points inside each region are gathered and sampled as one batch of their own
+    thread_local std::vector<uint32_t> index;
+    thread_local std::vector<double>   regionLat, regionLon, weight;
+    thread_local std::vector<float>    value;
+    for (const auto& res : *set) {
+        const TerrainRegion& r = res->bounds;
+        index.clear();
+        regionLat.clear();
+        regionLon.clear();
+        weight.clear();
+        for (size_t i = 0; i < n; i++) {
+            double rLat, rLon, w;
+            if (!toRegion(r, lat[i], lon[i], rLat, rLon, w)) continue;
+            index.push_back(static_cast<uint32_t>(i));
+            regionLat.push_back(rLat);
+            regionLon.push_back(rLon);
+            weight.push_back(w);
+        }
+        if (index.empty()) continue;
+
+        value.resize(index.size());
+        res->map.sampleMany(regionLat.data(), regionLon.data(), value.data(), index.size(),
+                            regionLevel(*res, level));
+        for (size_t k = 0; k < index.size(); k++) {
+            float& h = out[index[k]];
+            h += static_cast<float>((value[k] - h) * weight[k]);
+        }
+    }
+}
+
+} // namespace luna::sim
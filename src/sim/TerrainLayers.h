@@ -0,0 +1,123 @@
+// About: Layered terrain — a global base heightmap plus regional overlays streamed by background jobs.
+
+#pragma once
+
+#include "sim/Heightmap.h"
+#include "sim/TerrainQuery.h"
+#include "util/JobSystem.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace luna::sim {
+
+// A high-resolution heightmap covering a lat/lon box (radians). The file is any
+// format Heightmap::load accepts; its rows span latMax→latMin and its columns
+// lonMin→lonMax, which must not cross the ±180° seam (a polar cap uses the full
+// -π..π range). loadDistance is how close to the box, in meters along the surface,
+// the focus must come before the region is streamed in.
+struct TerrainRegion {
+    std::string path;
+    double      latMin = 0.0, latMax = 0.0;
+    double      lonMin = 0.0, lonMax = 0.0;
+    double      loadDistance = 200'000.0;
+};
+
+// The base layer is loaded up front and never changes. Regions are loaded by a
+// Background job on the shared JobSystem when setFocus() comes within range, pre-faulted, then
+// published as an immutable snapshot; samplers copy the snapshot pointer under a
+// brief lock and never wait on disk. Until a region is resident its area samples
+// the base. Regions out of range stay cached until MAX_RESIDENT_REGIONS forces the
+// least recently wanted one out. Every change to the resident set bumps
+// generation() and records the region's box, so meshes, caches and height fields
+// built from the old heights can be found and rebuilt.
+class TerrainLayers {
+public:
+    TerrainLayers();
+    ~TerrainLayers();
+
+    TerrainLayers(const TerrainLayers&) = delete;
+    TerrainLayers& operator=(const TerrainLayers&) = delete;
+
+    bool loadBase(const std::string& path);
+    void addRegion(const TerrainRegion& region);
+
+    // Cancel queued region loads, wait for running ones, and drop every layer
+    void reset();
+
+    // Called once per frame with the point detail is needed around. Non-blocking.
+    void setFocus(double lat, double lon);
+
+    // Meters above the reference sphere. `level` is a base mip level; inside a
+    // region the overlay is sampled at the region level whose texels are no wider
+    // than that base level's, so every level sees the overlay at a matching filter
+    // and patches pinned at level 0 meet their coarser interiors without a step.
+    double sample(double lat, double lon, uint32_t level) const;
+    void   sampleMany(const double* lat, const double* lon, float* out, size_t n,
+                      uint32_t level) const;
+
+    uint32_t levelForFootprint(double footprint) const { return base_.levelForFootprint(footprint); }
+    bool     isLoaded() const { return base_.isLoaded(); }
+    uint64_t baseContentHash() const { return base_.contentHash(); }
+    const Heightmap& base() const { return base_; }
+    size_t   residentRegionCount() const;
+    size_t   regionCount() const;
+    void     regionBoxes(std::vector<TerrainBox>& boxes) const;
+
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+    // Boxes changed after generation `since`, appended oldest first; returns the
+    // current generation
+    uint64_t changesSince(uint64_t since, std::vector<TerrainBox>& boxes) const;
+
+    static constexpr size_t MAX_RESIDENT_REGIONS = 4;
+    // Changes remembered for changesSince(); a caller further behind gets the globe
+    static constexpr size_t MAX_CHANGES = 16;
+
+private:
+    struct Resident {
+        uint32_t      region;
+        TerrainRegion bounds;  // copied so samplers never read regions_
+        Heightmap     map;
+    };
+    using ResidentSet = std::vector<std::shared_ptr<const Resident>>;
+
+    enum class RegionState : uint8_t { Unloaded, Loading, Resident, Failed };
+
+    std::shared_ptr<const ResidentSet> snapshot() const;
+    void loadRegion(uint32_t index, uint64_t epoch);  // a job; gives up once reset() moved epoch on
+    void cancelLoads();
+    void evictLocked(std::vector<std::shared_ptr<const Resident>>& dropped);
+    // Record that heights inside `box` changed, once the snapshot has been swapped
+    void changedLocked(const TerrainBox& box);
+    static TerrainBox boxOf(const TerrainRegion& region);
+
+    // Region mip level matching base level `level`; level 0 is full resolution in both
+    uint32_t regionLevel(const Resident& res, uint32_t level) const;
+
+    // Map lat/lon into the region's own addressing; weight fades to 0 at the border
+    static bool toRegion(const TerrainRegion& r, double lat, double lon,
+                         double& regionLat, double& regionLon, double& weight);
+
+    Heightmap base_;
+
+    mutable std::mutex                 mutex_;
+    std::vector<TerrainRegion>         regions_;
+    std::vector<RegionState>           state_;
+    std::vector<uint64_t>              lastWanted_;  // focus tick the region was last in range
+    uint64_t                           focusTick_ = 0;
+    uint64_t                           loadEpoch_ = 0;  // bumped by reset(): queued loads go stale
+    std::shared_ptr<const ResidentSet> resident_ = std::make_shared<const ResidentSet>();
+    // Written under mutex_; read without it by generation()
+    std::atomic<uint64_t>                           generation_{0};
+    std::vector<std::pair<uint64_t, TerrainBox>>    changes_;  // oldest first, MAX_CHANGES at most
+
+    // Region loads queued or running; waited for before the state they touch goes
+    luna::util::JobCounter loads_;
+};
+
+} // namespace luna::sim
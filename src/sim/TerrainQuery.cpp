@@ -1,17 +1,20 @@
-// About: Lunar heightmap query — delegates to Heightmap TIFF loader, falls back to flat if absent.
+// About: Lunar heightmap query — delegates to the layered terrain service, flat if data is absent.
 
 #include "sim/TerrainQuery.h"
-#include "sim/Heightmap.h"
+#include "sim/TerrainLayers.h"
 #include "util/Log.h"
 
 #include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
 
 namespace luna::sim {
 
-static Heightmap s_heightmap;
+static TerrainLayers s_layers;
 
 bool initTerrain(const std::string& path) {
-    if (!s_heightmap.load(path)) {
+    if (!s_layers.loadBase(path)) {
         LOG_WARN("Terrain data not available — using flat sphere");
         return false;
     }
@@ -19,12 +22,106 @@ bool initTerrain(const std::string& path) {
 }
 
 void shutdownTerrain() {
-    s_heightmap = Heightmap{};
+    s_layers.reset();
+}
+
+void addTerrainRegion(const TerrainRegion& region) {
+    s_layers.addRegion(region);
+}
+
+size_t loadTerrainRegions(const std::string& manifestPath) {
+    std::ifstream file(manifestPath);
+    if (!file) return 0;
+
+    std::filesystem::path dir = std::filesystem::path(manifestPath).parent_path();
+    size_t added = 0;
+    std::string line;
+    for (uint32_t lineNo = 1; std::getline(file, line); lineNo++) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream in(line);
+        std::string path;
+        if (!(in >> path)) continue;
+
+        double latMin, latMax, lonMin, lonMax, loadKm = 200.0;
+        if (!(in >> latMin >> latMax >> lonMin >> lonMax)) {
+            LOG_WARN("%s:%u: expected <path> <latMin> <latMax> <lonMin> <lonMax> [loadKm]",
+                     manifestPath.c_str(), lineNo);
+            continue;
+        }
+        in >> loadKm;
+
+        constexpr double DEG = M_PI / 180.0;
+        TerrainRegion region;
+        region.path = std::filesystem::path(path).is_absolute() ? path : (dir / path).string();
+        region.latMin = latMin * DEG;
+        region.latMax = latMax * DEG;
+        region.lonMin = lonMin * DEG;
+        region.lonMax = lonMax * DEG;
+        region.loadDistance = loadKm * 1000.0;
+        s_layers.addRegion(region);
+        added++;
+    }
+    LOG_INFO("Terrain regions: %zu listed in %s", added, manifestPath.c_str());
+    return added;
+}
+
+size_t terrainRegionCount() {
+    return s_layers.regionCount();
+}
+
+void terrainRegionBoxes(std::vector<TerrainBox>& boxes) {
+    s_layers.regionBoxes(boxes);
+}
+
+uint64_t terrainGeneration() {
+    return s_layers.generation();
+}
+
+uint64_t terrainChangesSince(uint64_t since, std::vector<TerrainBox>& boxes) {
+    return s_layers.changesSince(since, boxes);
+}
+
+void setTerrainFocus(const glm::dvec3& moonPos) {
+    double lat, lon;
+    glm::dvec3 dir = glm::normalize(moonPos);
+    directionsToLatLon(&dir, &lat, &lon, 1);
+    s_layers.setFocus(lat, lon);
 }
 
 double sampleTerrainHeight(double lat, double lon) {
-    if (!s_heightmap.isLoaded()) return 0.0;
-    return s_heightmap.sample(lat, lon);
+    if (!s_layers.isLoaded()) return 0.0;
+    return s_layers.sample(lat, lon, 0);
+}
+
+double sampleTerrainHeightAtLevel(double lat, double lon, uint32_t level) {
+    if (!s_layers.isLoaded()) return 0.0;
+    return s_layers.sample(lat, lon, level);
+}
+
+void sampleTerrainHeights(const double* lat, const double* lon, float* out, size_t n,
+                          uint32_t level) {
+    s_layers.sampleMany(lat, lon, out, n, level);  // zero-fills when not loaded
+}
+
+uint32_t terrainLevelForFootprint(double footprint) {
+    return s_layers.levelForFootprint(footprint);
+}
+
+uint64_t terrainContentHash() {
+    return s_layers.baseContentHash();
+}
+
+const Heightmap& terrainBaseLayer() {
+    return s_layers.base();
+}
+
+void directionsToLatLon(const glm::dvec3* dirs, double* lat, double* lon, size_t n) {
+    // Split into two passes over flat arrays so each loop is a single libm
+    // function the compiler can map to a vector variant where one exists
+    for (size_t i = 0; i < n; i++)
+        lat[i] = std::asin(glm::clamp(dirs[i].y, -1.0, 1.0));
+    for (size_t i = 0; i < n; i++)
+        lon[i] = std::atan2(dirs[i].z, dirs[i].x);
 }
 
 glm::dvec3 latLonToCartesian(double lat, double lon, double radius) {
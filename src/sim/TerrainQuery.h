@@ -3,19 +3,81 @@
 #pragma once
 
 #include "util/Math.h"
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace luna::sim {
 
-// Load LOLA heightmap from TIFF. Returns false if file missing (graceful fallback to flat).
+// Upper bound on terrain elevation above LUNAR_RADIUS: the highest point on the
+// Moon is about 10.8 km up. An orbit whose periapsis clears it can't hit the ground.
+constexpr double MAX_TERRAIN_HEIGHT = 11000.0;
+
+class Heightmap;       // sim/Heightmap.h
+struct TerrainRegion;  // sim/TerrainLayers.h
+
+// A lat/lon box in radians, lonMin..lonMax not crossing the ±180° seam
+struct TerrainBox {
+    double latMin = 0.0, latMax = 0.0;
+    double lonMin = 0.0, lonMax = 0.0;
+};
+
+// Load the global base heightmap (TIFF or .lht). Returns false if file missing
+// (graceful fallback to flat).
 bool initTerrain(const std::string& path);
 
-// Free heightmap memory.
+// Free heightmap memory and stop region streaming.
 void shutdownTerrain();
 
+// Register a regional high-resolution overlay; it streams in near the focus
+void addTerrainRegion(const TerrainRegion& region);
+
+// Register every region listed in a manifest: one per line,
+// "<path> <latMin> <latMax> <lonMin> <lonMax> [loadKm]" in degrees, '#' comments.
+// Relative paths resolve against the manifest's directory. Returns regions added.
+size_t loadTerrainRegions(const std::string& manifestPath);
+
+// Regional overlays registered, resident or not. Only CPU patch meshes draw them.
+size_t terrainRegionCount();
+
+// Boxes of every registered region, resident or not
+void terrainRegionBoxes(std::vector<TerrainBox>& boxes);
+
+// Bumped each time a region becomes resident or is evicted, so anything built from
+// sampled heights can tell it is out of date. Lock-free.
+uint64_t terrainGeneration();
+
+// Append the boxes whose heights changed after generation `since`, and return the
+// current generation. More changes than are remembered report the whole globe.
+uint64_t terrainChangesSince(uint64_t since, std::vector<TerrainBox>& boxes);
+
+// Moon-centred position detail is wanted around (the lander); call once per frame
+void setTerrainFocus(const glm::dvec3& moonPos);
+
 // Returns elevation above LUNAR_RADIUS in meters at the given lat/lon (radians)
 double sampleTerrainHeight(double lat, double lon);
 
+// sampleTerrainHeight from a heightmap mip level (0 = full resolution)
+double sampleTerrainHeightAtLevel(double lat, double lon, uint32_t level);
+
+// Batched sampleTerrainHeight for n points, as float meters. Prefer this for
+// grids and rows — it runs the heightmap's SIMD kernel.
+void sampleTerrainHeights(const double* lat, const double* lon, float* out, size_t n,
+                          uint32_t level = 0);
+
+// Mip level matched to samples spaced footprint radians apart
+uint32_t terrainLevelForFootprint(double footprint);
+
+// Fingerprint of the base heightmap, for keying caches of derived data (0 if flat)
+uint64_t terrainContentHash();
+
+// The global base layer, without regional overlays (for uploading it to the GPU)
+const Heightmap& terrainBaseLayer();
+
+// Unit sphere directions (Y is the polar axis) to lat/lon in radians, n at a time
+void directionsToLatLon(const glm::dvec3* dirs, double* lat, double* lon, size_t n);
+
 // Convert lat/lon/elevation to Moon-centered XYZ (IAU_MOON frame)
 glm::dvec3 latLonToCartesian(double lat, double lon, double radius);
 
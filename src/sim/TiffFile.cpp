@@ -0,0 +1,477 @@
+// About: TiffFile implementation — IFD parsing, strip/tile lookup, LZW and Deflate decoding, predictors.
+
+#include "sim/TiffFile.h"
+#include "util/Log.h"
+#include "util/JobSystem.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <functional>
+
+namespace luna::sim {
+
+namespace {
+
+constexpr uint32_t COMPRESSION_NONE         = 1;
+constexpr uint32_t COMPRESSION_LZW          = 5;
+constexpr uint32_t COMPRESSION_DEFLATE      = 8;
+constexpr uint32_t COMPRESSION_DEFLATE_OLD  = 32946;
+
+constexpr uint32_t PREDICTOR_NONE           = 1;
+constexpr uint32_t PREDICTOR_HORIZONTAL     = 2;
+constexpr uint32_t PREDICTOR_FLOATING_POINT = 3;
+
+// Uncompressed strips are split into jobs of this many rows, so a single-strip
+// file still spreads over the workers
+constexpr uint32_t ROWS_PER_COPY_JOB = 64;
+
+uint32_t swap32(uint32_t v) {
+    return ((v >> 24) & 0xFF) | ((v >> 8) & 0xFF00) |
+           ((v << 8) & 0xFF0000) | ((v << 24) & 0xFF000000);
+}
+
+// Reads uint16/uint32 from raw bytes with byte-order awareness
+struct TiffReader {
+    const uint8_t* buf;
+    size_t size;
+    bool littleEndian;
+
+    uint16_t u16(size_t off) const {
+        uint16_t v;
+        std::memcpy(&v, buf + off, 2);
+        if (!littleEndian) v = static_cast<uint16_t>((v >> 8) | (v << 8));
+        return v;
+    }
+
+    uint32_t u32(size_t off) const {
+        uint32_t v;
+        std::memcpy(&v, buf + off, 4);
+        return littleEndian ? v : swap32(v);
+    }
+
+    // Read IFD entry value — inline for count=1, else treat as offset
+    uint32_t ifdValue(size_t entry, uint16_t type) const {
+        if (type == 3 && u32(entry + 4) == 1) return u16(entry + 8); // SHORT
+        return u32(entry + 8);
+    }
+
+    // SHORT or LONG array of an IFD entry; stored inline when it fits in 4 bytes.
+    // False if the array lies outside the file.
+    bool ifdArray(size_t entry, std::vector<uint64_t>& out) const {
+        uint16_t type  = u16(entry + 2);
+        uint32_t count = u32(entry + 4);
+        size_t   width = type == 3 ? 2 : 4;
+        size_t   at    = count * width <= 4 ? entry + 8 : u32(entry + 8);
+        if (at + count * width > size) return false;
+        out.resize(count);
+        for (uint32_t i = 0; i < count; i++)
+            out[i] = width == 2 ? u16(at + i * 2) : u32(at + i * 4);
+        return true;
+    }
+};
+
+// TIFF LZW: MSB-first codes of 9 to 12 bits, 256 = clear, 257 = end, and the code
+// width grows one code early. Returns the bytes written, at most `capacity`.
+size_t lzwDecode(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+    constexpr uint32_t CLEAR = 256, END = 257, FIRST = 258, MAX_CODES = 4096;
+    struct Entry {
+        uint16_t prefix;
+        uint16_t length;
+        uint8_t  last;
+        uint8_t  first;
+    };
+    Entry table[MAX_CODES];
+    for (uint32_t c = 0; c < 256; c++)
+        table[c] = {0, 1, static_cast<uint8_t>(c), static_cast<uint8_t>(c)};
+
+    size_t   written  = 0;
+    size_t   bitPos   = 0;
+    size_t   bitCount = size * 8;
+    uint32_t width    = 9;
+    uint32_t next     = FIRST;
+    uint32_t prev     = MAX_CODES;  // none since the last clear
+
+    // Writes a code's string back to front; false once the output is full
+    auto emit = [&](uint32_t code) {
+        size_t length = table[code].length;
+        if (written + length > capacity) length = capacity - written;
+        uint32_t c = code;
+        for (size_t skip = table[code].length - length; skip > 0; skip--)
+            c = table[c].prefix;
+        for (size_t i = length; i > 0; i--) {
+            dst[written + i - 1] = table[c].last;
+            c = table[c].prefix;
+        }
+        written += length;
+        return written < capacity;
+    };
+
+    while (bitPos + width <= bitCount) {
+        uint32_t code = 0;
+        for (uint32_t b = 0; b < width; b++, bitPos++)
+            code = (code << 1) | ((src[bitPos >> 3] >> (7 - (bitPos & 7))) & 1);
+
+        if (code == END) break;
+        if (code == CLEAR) {
+            width = 9;
+            next  = FIRST;
+            prev  = MAX_CODES;
+            continue;
+        }
+        if (prev == MAX_CODES) {
+            if (code >= 256) break;  // only a literal may follow a clear
+            if (!emit(code)) break;
+            prev = code;
+            continue;
+        }
+        if (code > next || (code == next && next == MAX_CODES)) break;  // corrupt
+
+        // The new entry is prev + the first byte of this code's string, which for
+        // the not-yet-defined code (code == next) is prev's own first byte
+        uint8_t first = code < next ? table[code].first : table[prev].first;
+        if (next < MAX_CODES) {
+            table[next] = {static_cast<uint16_t>(prev),
+                           static_cast<uint16_t>(table[prev].length + 1), first, table[prev].first};
+            next++;
+        }
+        if (!emit(code)) break;
+        prev = code;
+        if (next + 1 >= (1u << width) && width < 12) width++;
+    }
+    return written;
+}
+
+// zlib-wrapped Deflate, as TIFF stores it; true only if it fills `capacity` exactly
+bool inflateBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+    z_stream zs{};
+    if (inflateInit(&zs) != Z_OK) return false;
+    zs.next_in   = const_cast<Bytef*>(src);
+    zs.avail_in  = static_cast<uInt>(size);
+    zs.next_out  = dst;
+    zs.avail_out = static_cast<uInt>(capacity);
+    int rc = inflate(&zs, Z_FINISH);
+    bool ok = (rc == Z_STREAM_END || rc == Z_BUF_ERROR || rc == Z_OK) && zs.avail_out == 0;
+    inflateEnd(&zs);
+    return ok;
+}
+
+// Undo the predictor over `rows` rows of `width` 32-bit texels, leaving native-order
+// values. `scratch` holds one row for the floating-point predictor.
+void undoPredictor(uint8_t* data, uint32_t width, uint32_t rows, uint32_t predictor,
+                   bool littleEndian, std::vector<uint8_t>& scratch) {
+    constexpr bool NATIVE_LITTLE = std::endian::native == std::endian::little;
+    size_t rowBytes = size_t(width) * 4;
+
+    if (predictor == PREDICTOR_FLOATING_POINT) {
+        // Each row is four byte planes, most significant first, byte-differenced as
+        // a whole; the file's byte order plays no part
+        scratch.resize(rowBytes);
+        for (uint32_t r = 0; r < rows; r++) {
+            uint8_t* row = data + r * rowBytes;
+            for (size_t i = 1; i < rowBytes; i++)
+                row[i] = static_cast<uint8_t>(row[i] + row[i - 1]);
+            std::memcpy(scratch.data(), row, rowBytes);
+            for (uint32_t x = 0; x < width; x++) {
+                uint32_t v = uint32_t(scratch[x]) << 24 | uint32_t(scratch[width + x]) << 16 |
+                             uint32_t(scratch[2 * width + x]) << 8 | scratch[3 * width + x];
+                std::memcpy(row + x * 4, &v, 4);
+            }
+        }
+        return;
+    }
+
+    if (littleEndian != NATIVE_LITTLE) {
+        for (size_t i = 0; i < size_t(width) * rows; i++) {
+            uint32_t v;
+            std::memcpy(&v, data + i * 4, 4);
+            v = swap32(v);
+            std::memcpy(data + i * 4, &v, 4);
+        }
+    }
+    if (predictor == PREDICTOR_HORIZONTAL) {
+        for (uint32_t r = 0; r < rows; r++) {
+            uint8_t* row = data + r * rowBytes;
+            uint32_t acc;
+            std::memcpy(&acc, row, 4);
+            for (uint32_t x = 1; x < width; x++) {
+                uint32_t d;
+                std::memcpy(&d, row + x * 4, 4);
+                acc += d;
+                std::memcpy(row + x * 4, &acc, 4);
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+bool TiffFile::open(const std::string& path) {
+    if (!file_.open(path, luna::util::MapAccess::Sequential)) return false;
+
+    const uint8_t* raw = file_.data();
+    size_t fileSize = file_.size();
+    if (fileSize < 8) {
+        LOG_ERROR("TIFF too small: %s", path.c_str());
+        return false;
+    }
+
+    TiffReader r{raw, fileSize, false};
+
+    // Byte order marker
+    if (raw[0] == 'I' && raw[1] == 'I')
+        r.littleEndian = true;
+    else if (raw[0] == 'M' && raw[1] == 'M')
+        r.littleEndian = false;
+    else {
+        LOG_ERROR("Invalid TIFF byte order: %s", path.c_str());
+        return false;
+    }
+    littleEndian_ = r.littleEndian;
+
+    if (r.u16(2) != 42) {
+        LOG_ERROR("Invalid TIFF magic: %s", path.c_str());
+        return false;
+    }
+
+    uint32_t ifdOff = r.u32(4);
+    if (size_t(ifdOff) + 2 > fileSize) {
+        LOG_ERROR("TIFF IFD out of range: %s", path.c_str());
+        return false;
+    }
+    uint16_t numEntries = r.u16(ifdOff);
+    if (ifdOff + 2 + size_t(numEntries) * 12 > fileSize) {
+        LOG_ERROR("TIFF IFD truncated: %s", path.c_str());
+        return false;
+    }
+
+    uint32_t bitsPerSample = 32, sampleFormat = 3, samplesPerPixel = 1;
+    uint32_t rowsPerStrip = 0, tileWidth = 0, tileHeight = 0;
+    compression_ = COMPRESSION_NONE;
+    predictor_   = PREDICTOR_NONE;
+    tiled_       = false;
+    blockOffsets_.clear();
+    blockBytes_.clear();
+    bool arraysOk = true;
+
+    for (uint16_t i = 0; i < numEntries; i++) {
+        size_t entry = ifdOff + 2 + i * 12;
+        uint16_t tag  = r.u16(entry);
+        uint16_t type = r.u16(entry + 2);
+
+        switch (tag) {
+            case 256: width_  = r.ifdValue(entry, type); break;
+            case 257: height_ = r.ifdValue(entry, type); break;
+            case 258: bitsPerSample = r.ifdValue(entry, type); break;
+            case 259: compression_ = r.ifdValue(entry, type); break;
+            case 273: // StripOffsets
+            case 324: // TileOffsets
+                arraysOk &= r.ifdArray(entry, blockOffsets_);
+                tiled_ = tag == 324;
+                break;
+            case 277: samplesPerPixel = r.ifdValue(entry, type); break;
+            case 278: rowsPerStrip = r.ifdValue(entry, type); break;
+            case 279: // StripByteCounts
+            case 325: // TileByteCounts
+                arraysOk &= r.ifdArray(entry, blockBytes_);
+                break;
+            case 317: predictor_  = r.ifdValue(entry, type); break;
+            case 322: tileWidth   = r.ifdValue(entry, type); break;
+            case 323: tileHeight  = r.ifdValue(entry, type); break;
+            case 339: sampleFormat = r.ifdValue(entry, type); break;
+            default: break;
+        }
+    }
+
+    if (width_ == 0 || height_ == 0) {
+        LOG_ERROR("TIFF missing dimensions: %s", path.c_str());
+        return false;
+    }
+    if (bitsPerSample != 32 || sampleFormat != 3 || samplesPerPixel != 1) {
+        LOG_ERROR("TIFF must be single-channel float32 (bits %u, format %u, samples %u): %s",
+                  bitsPerSample, sampleFormat, samplesPerPixel, path.c_str());
+        return false;
+    }
+    if (compression_ != COMPRESSION_NONE && compression_ != COMPRESSION_LZW &&
+        compression_ != COMPRESSION_DEFLATE && compression_ != COMPRESSION_DEFLATE_OLD) {
+        LOG_ERROR("TIFF compression %u not supported (none, LZW or Deflate): %s",
+                  compression_, path.c_str());
+        return false;
+    }
+    if (predictor_ < PREDICTOR_NONE || predictor_ > PREDICTOR_FLOATING_POINT) {
+        LOG_ERROR("TIFF predictor %u not supported: %s", predictor_, path.c_str());
+        return false;
+    }
+    if (!arraysOk || blockOffsets_.empty()) {
+        LOG_ERROR("TIFF block tables missing or out of range: %s", path.c_str());
+        return false;
+    }
+
+    uint32_t blocksDown;
+    if (tiled_) {
+        // The spec asks for multiples of 16; any size decodes, zero does not
+        if (tileWidth == 0 || tileHeight == 0) {
+            LOG_ERROR("TIFF tiles missing dimensions: %s", path.c_str());
+            return false;
+        }
+        blockWidth_   = tileWidth;
+        blockHeight_  = tileHeight;
+        blocksAcross_ = (width_ + tileWidth - 1) / tileWidth;
+        blocksDown    = (height_ + tileHeight - 1) / tileHeight;
+    } else {
+        if (blockOffsets_.size() <= 1 || rowsPerStrip == 0 || rowsPerStrip > height_)
+            rowsPerStrip = height_;
+        blockWidth_   = width_;
+        blockHeight_  = rowsPerStrip;
+        blocksAcross_ = 1;
+        blocksDown    = (height_ + rowsPerStrip - 1) / rowsPerStrip;
+    }
+    size_t blocks = size_t(blocksAcross_) * blocksDown;
+    if (blockOffsets_.size() < blocks) {
+        LOG_ERROR("TIFF has too few %s: %s", tiled_ ? "tiles" : "strips", path.c_str());
+        return false;
+    }
+    blockOffsets_.resize(blocks);
+
+    // Uncompressed writers sometimes leave out the byte counts; the size is implied
+    if (blockBytes_.size() < blocks) {
+        if (compression_ != COMPRESSION_NONE) {
+            LOG_ERROR("TIFF byte counts missing: %s", path.c_str());
+            return false;
+        }
+        blockBytes_.resize(blocks);
+        for (uint32_t b = 0; b < blocks; b++)
+            blockBytes_[b] = size_t(blockWidth_) * blockRows(b) * sizeof(float);
+    }
+    blockBytes_.resize(blocks);
+
+    for (uint32_t b = 0; b < blocks; b++) {
+        size_t expected = size_t(blockWidth_) * blockRows(b) * sizeof(float);
+        if (compression_ == COMPRESSION_NONE) blockBytes_[b] = std::max<uint64_t>(blockBytes_[b], expected);
+        if (blockOffsets_[b] + blockBytes_[b] > fileSize) {
+            LOG_ERROR("TIFF %s %u out of range: %s", tiled_ ? "tile" : "strip", b, path.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* TiffFile::compressionName() const {
+    switch (compression_) {
+        case COMPRESSION_LZW:         return "LZW";
+        case COMPRESSION_DEFLATE:
+        case COMPRESSION_DEFLATE_OLD: return "Deflate";
+        default:                      return "uncompressed";
+    }
+}
+
+uint64_t TiffFile::storedBytes() const {
+    uint64_t total = 0;
+    for (uint64_t bytes : blockBytes_) total += bytes;
+    return total;
+}
+
+uint32_t TiffFile::blockRows(uint32_t index) const {
+    // Tiles are always stored whole; the last strip only holds the rows left
+    if (tiled_) return blockHeight_;
+    uint32_t firstRow = index * blockHeight_;
+    return std::min(blockHeight_, height_ - firstRow);
+}
+
+bool TiffFile::decodeBlock(uint32_t index, uint8_t* dst) const {
+    thread_local std::vector<uint8_t> rowScratch;
+
+    size_t         bytes = size_t(blockWidth_) * blockRows(index) * sizeof(float);
+    const uint8_t* src   = file_.data() + blockOffsets_[index];
+    size_t         size  = blockBytes_[index];
+
+    bool ok = true;
+    switch (compression_) {
+        case COMPRESSION_LZW:
+            ok = lzwDecode(src, size, dst, bytes) == bytes;
+            break;
+        case COMPRESSION_DEFLATE:
+        case COMPRESSION_DEFLATE_OLD:
+            ok = inflateBlock(src, size, dst, bytes);
+            break;
+        default:
+            std::memcpy(dst, src, bytes);
+            break;
+    }
+    if (!ok) {
+        LOG_ERROR("Corrupt %s TIFF %s %u", compressionName(), tiled_ ? "tile" : "strip", index);
+        return false;
+    }
+    undoPredictor(dst, blockWidth_, blockRows(index), predictor_, littleEndian_, rowScratch);
+    return true;
+}
+
+bool TiffFile::readRows(uint32_t y0, uint32_t rows, float* out,
+                        luna::util::JobSystem* jobs) const {
+    if (rows == 0) return true;
+    uint32_t yEnd = std::min(y0 + rows, height_);
+    auto forEach = [jobs](uint32_t count, const std::function<void(uint32_t)>& fn) {
+        if (jobs) jobs->parallelFor(count, fn);
+        else for (uint32_t i = 0; i < count; i++) fn(i);
+    };
+
+    // Plain strips: rows are copied out of the mapping in bands, no block scratch
+    if (compression_ == COMPRESSION_NONE && predictor_ == PREDICTOR_NONE && !tiled_) {
+        uint32_t bands = (yEnd - y0 + ROWS_PER_COPY_JOB - 1) / ROWS_PER_COPY_JOB;
+        forEach(bands, [&](uint32_t band) {
+            std::vector<uint8_t> unused;
+            uint32_t first = y0 + band * ROWS_PER_COPY_JOB;
+            uint32_t last  = std::min(first + ROWS_PER_COPY_JOB, yEnd);
+            for (uint32_t y = first; y < last; y++) {
+                uint32_t strip = y / blockHeight_;
+                size_t offset = blockOffsets_[strip] +
+                                size_t(y - strip * blockHeight_) * width_ * sizeof(float);
+                auto* dst = reinterpret_cast<uint8_t*>(out + size_t(y - y0) * width_);
+                std::memcpy(dst, file_.data() + offset, size_t(width_) * sizeof(float));
+                undoPredictor(dst, width_, 1, PREDICTOR_NONE, littleEndian_, unused);
+            }
+        });
+        return true;
+    }
+
+    uint32_t firstDown = y0 / blockHeight_;
+    uint32_t lastDown  = (yEnd - 1) / blockHeight_;
+    uint32_t count     = (lastDown - firstDown + 1) * blocksAcross_;
+    std::atomic<bool> failed{false};
+
+    forEach(count, [&](uint32_t job) {
+        thread_local std::vector<uint8_t> blockScratch;
+        uint32_t index    = firstDown * blocksAcross_ + job;
+        uint32_t bx       = index % blocksAcross_;
+        uint32_t firstRow = (index / blocksAcross_) * blockHeight_;
+        uint32_t rowsHere = blockRows(index);
+
+        // A strip wholly inside the range decodes straight into its rows of `out`
+        if (!tiled_ && firstRow >= y0 && firstRow + rowsHere <= yEnd) {
+            if (!decodeBlock(index, reinterpret_cast<uint8_t*>(out + size_t(firstRow - y0) * width_)))
+                failed.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        blockScratch.resize(size_t(blockWidth_) * rowsHere * sizeof(float));
+        if (!decodeBlock(index, blockScratch.data())) {
+            failed.store(true, std::memory_order_relaxed);
+            return;
+        }
+        // Clip to the requested rows and, for edge tiles, the image width
+        uint32_t x0   = bx * blockWidth_;
+        uint32_t cols = std::min(blockWidth_, width_ - x0);
+        uint32_t from = std::max(firstRow, y0);
+        uint32_t to   = std::min(firstRow + rowsHere, yEnd);
+        for (uint32_t y = from; y < to; y++)
+            std::memcpy(out + size_t(y - y0) * width_ + x0,
+                        blockScratch.data() + size_t(y - firstRow) * blockWidth_ * sizeof(float),
+                        size_t(cols) * sizeof(float));
+    });
+    return !failed.load();
+}
+
+} // namespace luna::sim
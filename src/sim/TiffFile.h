@@ -0,0 +1,66 @@
+// About: Memory-mapped reader for single-channel float32 GeoTIFF — strips or tiles, uncompressed, LZW or Deflate.
+
+#pragma once
+
+#include "util/MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace luna::util { class JobSystem; }
+
+namespace luna::sim {
+
+// Parses the first IFD only. Data is read straight out of the mapping, so opening
+// a file costs only its header and blocks page in as they are decoded.
+//
+// A block is a strip (full rows, tags 273/278/279) or a tile (tags 322-325).
+// Compressed blocks decode independently, so readRows() hands them to the job
+// system, each worker inflating into the destination rows (strips) or a per-thread
+// scratch tile that is then copied out. Supported: compression 1 (none), 5 (LZW)
+// and 8/32946 (Deflate), each with predictor 1 (none), 2 (horizontal) or 3
+// (floating point).
+class TiffFile {
+public:
+    bool open(const std::string& path);
+
+    uint32_t width() const  { return width_; }
+    uint32_t height() const { return height_; }
+
+    bool        isTiled() const { return tiled_; }
+    uint32_t    blockCount() const { return static_cast<uint32_t>(blockOffsets_.size()); }
+    const char* compressionName() const;
+
+    // Bytes of block data in the file (compressed size), for throughput reports
+    uint64_t storedBytes() const;
+
+    // Decode rows [y0, y0 + rows) into `out` (rows * width() floats) in native byte
+    // order. The blocks covering them are spread over `jobs` and the calling thread,
+    // or decoded serially without one. Returns false, having logged, if a block is
+    // corrupt; `out` is then partly written.
+    bool readRows(uint32_t y0, uint32_t rows, float* out,
+                  luna::util::JobSystem* jobs = nullptr) const;
+
+private:
+    // Block `index` into `dst` as stored: blockWidth_ * blockRows(index) texels,
+    // native byte order, predictor undone
+    bool decodeBlock(uint32_t index, uint8_t* dst) const;
+    uint32_t blockRows(uint32_t index) const;
+
+    luna::util::MappedFile file_;
+    bool                   littleEndian_ = true;
+    uint32_t               width_        = 0;
+    uint32_t               height_       = 0;
+    uint32_t               compression_  = 1;
+    uint32_t               predictor_    = 1;
+
+    // Strips are blocks one image row wide and RowsPerStrip tall; the last may be short
+    bool                   tiled_        = false;
+    uint32_t               blockWidth_   = 0;
+    uint32_t               blockHeight_  = 0;
+    uint32_t               blocksAcross_ = 1;
+    std::vector<uint64_t>  blockOffsets_;
+    std::vector<uint64_t>  blockBytes_;
+};
+
+} // namespace luna::sim
@@ -0,0 +1,342 @@
+// About: TrajectoryPredictor worker — divergence checks, adaptive RK4 burns, Kepler coasts, sampling.
+
+#include "sim/TrajectoryPredictor.h"
+#include "sim/TerrainQuery.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace luna::sim {
+
+namespace {
+
+constexpr double G0          = 9.80665;  // standard gravity for Isp
+constexpr double TOLERANCE   = 0.01;     // m of position error per burn step
+constexpr double MIN_STEP    = 1e-3;     // s
+constexpr double MAX_STEP    = 20.0;     // s
+
+// How far a new state may be from the plan before it no longer counts as on it
+constexpr double POSITION_SLACK = 25.0;  // m
+constexpr double VELOCITY_SLACK = 0.1;   // m/s
+
+glm::dvec3 gravityAt(const glm::dvec3& p) {
+    double r = glm::length(p);
+    return p * (-luna::util::LUNAR_GM / (r * r * r));
+}
+
+} // anonymous namespace
+
+bool Trajectory::positionAt(double time, glm::dvec3& position) const {
+    if (times.empty() || time < times.front() || time > times.back()) return false;
+    auto next = std::upper_bound(times.begin(), times.end(), time);
+    if (next == times.end()) {
+        position = points.back();
+        return true;
+    }
+    size_t i = static_cast<size_t>(next - times.begin());
+    double t = (time - times[i - 1]) / (times[i] - times[i - 1]);
+    position = glm::mix(points[i - 1], points[i], t);
+    return true;
+}
+
+TrajectoryPredictor::TrajectoryPredictor(std::function<double(double, double)> terrain)
+    : terrain_(std::move(terrain)) {
+    thread_ = std::thread([this] { run(); });
+}
+
+TrajectoryPredictor::~TrajectoryPredictor() {
+    stop();
+}
+
+void TrajectoryPredictor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+void TrajectoryPredictor::update(const SimState& state) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_    = state;
+        hasPending_ = true;
+    }
+    wake_.notify_one();
+}
+
+const Trajectory& TrajectoryPredictor::latest() {
+    results_.update();
+    return results_.read();
+}
+
+void TrajectoryPredictor::run() {
+    for (;;) {
+        SimState state;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return hasPending_ || stopping_; });
+            if (stopping_) return;
+            state       = pending_;
+            hasPending_ = false;
+        }
+
+        Trajectory& out = results_.writeSlot();
+        if (state.phase == FlightPhase::Landed || state.phase == FlightPhase::Crashed) {
+            plan_.valid = false;
+            out.points.clear();
+            out.times.clear();
+            out.startTime = out.endTime = state.missionTime;
+            out.impact = false;
+        } else {
+            if (follows(state))
+                advance(state.missionTime);
+            else
+                replan(state);
+            sample(state.missionTime, out);
+        }
+        results_.publish();
+    }
+}
+
+bool TrajectoryPredictor::follows(const SimState& state) const {
+    if (!plan_.valid) return false;
+    const SimState& origin = plan_.origin;
+    if (std::abs(state.throttle - origin.throttle) > 1e-4) return false;
+
+    // Attitude only matters while the plan is burning: 1 mrad of change replans
+    bool burning = !plan_.powered.empty() && state.missionTime < plan_.powered.back().time;
+    if (burning && std::abs(glm::dot(state.orientation, origin.orientation)) < std::cos(0.5e-3))
+        return false;
+
+    glm::dvec3 position, velocity;
+    if (!stateAt(state.missionTime, position, velocity)) return false;
+    return glm::length(position - state.position) < POSITION_SLACK &&
+           glm::length(velocity - state.velocity) < VELOCITY_SLACK;
+}
+
+void TrajectoryPredictor::replan(const SimState& state) {
+    plan_ = Plan{};
+    plan_.valid  = true;
+    plan_.origin = state;
+
+    Sample start{state.missionTime, state.position, state.velocity, state.fuelMass};
+    if (state.throttle > 0.0 && state.fuelMass > 0.0) {
+        plan_.powered.push_back(start);
+        extendBurn(state.missionTime + POWERED_HORIZON);
+    } else {
+        startCoast(start);
+    }
+}
+
+void TrajectoryPredictor::advance(double now) {
+    // Keep the sample at or before now, so stateAt(now) still interpolates
+    auto& powered = plan_.powered;
+    if (!powered.empty()) {
+        auto past = std::upper_bound(powered.begin(), powered.end(), now,
+                                     [](double t, const Sample& s) { return t < s.time; });
+        if (past == powered.end() && plan_.hasCoast)
+            powered.clear();
+        else if (past - powered.begin() > 1)
+            powered.erase(powered.begin(), past - 1);
+    }
+
+    if (!plan_.burnDone && !powered.empty()) {
+        if (powered.back().time < now + POWERED_HORIZON * 0.5)
+            extendBurn(now + POWERED_HORIZON);
+    } else if (plan_.hasCoast && !plan_.impact) {
+        double until = now + coastHorizon();
+        if (until > plan_.endTime && !findCoastImpact(plan_.endTime, until))
+            plan_.endTime = until;
+    }
+}
+
+void TrajectoryPredictor::extendBurn(double until) {
+    const SimState& o     = plan_.origin;
+    const glm::dvec3 axis = o.orientation * glm::dvec3(0.0, 1.0, 0.0);
+    const double force    = o.throttle * o.maxThrust;
+    const double massFlow = force / (o.specificImpulse * G0);
+
+    // Classic RK4 on position, velocity and fuel, thrust held along the planned axis
+    auto rk4 = [&](const Sample& y, double h) {
+        auto accel = [&](const glm::dvec3& p, double fuel) {
+            return gravityAt(p) + axis * (force / (o.dryMass + fuel));
+        };
+        glm::dvec3 a1 = accel(y.position, y.fuelMass);
+        glm::dvec3 v2 = y.velocity + a1 * (0.5 * h);
+        glm::dvec3 a2 = accel(y.position + y.velocity * (0.5 * h), y.fuelMass - massFlow * 0.5 * h);
+        glm::dvec3 v3 = y.velocity + a2 * (0.5 * h);
+        glm::dvec3 a3 = accel(y.position + v2 * (0.5 * h), y.fuelMass - massFlow * 0.5 * h);
+        glm::dvec3 v4 = y.velocity + a3 * h;
+        glm::dvec3 a4 = accel(y.position + v3 * h, y.fuelMass - massFlow * h);
+        Sample next;
+        next.time     = y.time + h;
+        next.position = y.position + (y.velocity + (v2 + v3) * 2.0 + v4) * (h / 6.0);
+        next.velocity = y.velocity + (a1 + (a2 + a3) * 2.0 + a4) * (h / 6.0);
+        next.fuelMass = y.fuelMass - massFlow * h;
+        return next;
+    };
+
+    auto& powered = plan_.powered;
+    double h = plan_.step;
+    while (powered.back().time < until) {
+        const Sample y = powered.back();
+        double burnLeft = y.fuelMass / massFlow;
+        if (burnLeft < 1e-9) {
+            plan_.burnDone = true;
+            startCoast(y);
+            return;
+        }
+        bool   burnout = h >= burnLeft;
+        double step    = burnout ? burnLeft : h;
+
+        // Step doubling: the gap between one step and two half steps estimates the error
+        Sample full = rk4(y, step);
+        Sample half = rk4(rk4(y, 0.5 * step), 0.5 * step);
+        double err  = glm::length(half.position - full.position) / 15.0;
+        double grow = 0.9 * std::pow(TOLERANCE / std::max(err, 1e-12), 0.2);
+        if (err > TOLERANCE && step > MIN_STEP) {
+            h = std::max(step * std::max(grow, 0.2), MIN_STEP);
+            continue;
+        }
+
+        if (altitudeOf(half.position) <= 0.0) {
+            // Bisect for the moment of contact inside this step
+            double lo = 0.0, hi = step;
+            for (int i = 0; i < 30; ++i) {
+                double mid = 0.5 * (lo + hi);
+                if (altitudeOf(rk4(y, mid).position) <= 0.0) hi = mid;
+                else lo = mid;
+            }
+            powered.push_back(rk4(y, hi));
+            plan_.burnDone = true;
+            plan_.impact   = true;
+            plan_.endTime  = powered.back().time;
+            return;
+        }
+
+        if (burnout) half.fuelMass = 0.0;
+        powered.push_back(half);
+        if (burnout) {
+            plan_.burnDone = true;
+            startCoast(half);
+            return;
+        }
+        h = std::min(step * std::min(grow, 2.0), MAX_STEP);
+    }
+    plan_.step    = h;
+    plan_.endTime = powered.back().time;
+}
+
+double TrajectoryPredictor::coastHorizon() const {
+    return plan_.coast.isBound() ? std::min(plan_.coast.period(), COAST_HORIZON) : COAST_HORIZON;
+}
+
+void TrajectoryPredictor::startCoast(const Sample& from) {
+    plan_.coast    = KeplerOrbit(from.position, from.velocity, from.time);
+    plan_.hasCoast = true;
+    plan_.endTime  = from.time + coastHorizon();
+    findCoastImpact(from.time, plan_.endTime);
+}
+
+bool TrajectoryPredictor::findCoastImpact(double from, double to) {
+    if (plan_.coast.periapsisRadius() > luna::util::LUNAR_RADIUS + MAX_TERRAIN_HEIGHT) return false;
+
+    double step = std::clamp((to - from) / 2000.0, 0.5, 10.0);
+    double prev = from;
+    while (prev < to) {
+        double t = std::min(prev + step, to);
+        if (altitudeOf(plan_.coast.positionAt(t)) <= 0.0) {
+            double lo = prev, hi = t;
+            for (int i = 0; i < 40; ++i) {
+                double mid = 0.5 * (lo + hi);
+                if (altitudeOf(plan_.coast.positionAt(mid)) <= 0.0) hi = mid;
+                else lo = mid;
+            }
+            plan_.endTime = hi;
+            plan_.impact  = true;
+            return true;
+        }
+        prev = t;
+    }
+    return false;
+}
+
+bool TrajectoryPredictor::stateAt(double time, glm::dvec3& position, glm::dvec3& velocity) const {
+    if (time > plan_.endTime) return false;
+
+    const auto& powered = plan_.powered;
+    if (!powered.empty() && time <= powered.back().time) {
+        if (time < powered.front().time) return false;
+        auto next = std::upper_bound(powered.begin(), powered.end(), time,
+                                     [](double t, const Sample& s) { return t < s.time; });
+        if (next == powered.end()) {
+            position = powered.back().position;
+            velocity = powered.back().velocity;
+            return true;
+        }
+        // Cubic Hermite between the bracketing samples, from their positions and velocities
+        const Sample& a = *(next - 1);
+        const Sample& b = *next;
+        double h = b.time - a.time;
+        double s = (time - a.time) / h, s2 = s * s, s3 = s2 * s;
+        position = a.position * (2.0 * s3 - 3.0 * s2 + 1.0) + a.velocity * (h * (s3 - 2.0 * s2 + s)) +
+                   b.position * (3.0 * s2 - 2.0 * s3) + b.velocity * (h * (s3 - s2));
+        velocity = (a.position - b.position) * ((6.0 * s2 - 6.0 * s) / h) +
+                   a.velocity * (3.0 * s2 - 4.0 * s + 1.0) + b.velocity * (3.0 * s2 - 2.0 * s);
+        return true;
+    }
+    if (!plan_.hasCoast || time < plan_.coast.epoch()) return false;
+    plan_.coast.stateAt(time, position, velocity);
+    return true;
+}
+
+void TrajectoryPredictor::sample(double from, Trajectory& out) const {
+    out.points.clear();
+    out.times.clear();
+    out.startTime = from;
+    out.endTime   = std::max(plan_.endTime, from);
+    out.impact    = plan_.impact;
+
+    // A quarter of the points at least for each part present, the rest by duration
+    double total      = out.endTime - from;
+    double poweredEnd = plan_.powered.empty() ? from
+                                              : std::clamp(plan_.powered.back().time, from, out.endTime);
+    uint32_t poweredCount = 0;
+    if (poweredEnd > from) {
+        poweredCount = MAX_POINTS;
+        if (plan_.hasCoast) {
+            double share = (poweredEnd - from) / total;
+            poweredCount = std::clamp(static_cast<uint32_t>(share * MAX_POINTS),
+                                      MAX_POINTS / 4, MAX_POINTS * 3 / 4);
+        }
+    }
+    uint32_t coastCount = plan_.hasCoast ? MAX_POINTS - poweredCount : 0;
+
+    if (poweredCount > 0) appendSpan(from, poweredEnd, poweredCount, coastCount == 0, out);
+    if (coastCount > 0)   appendSpan(poweredEnd, out.endTime, coastCount, true, out);
+}
+
+void TrajectoryPredictor::appendSpan(double from, double to, uint32_t count, bool closed,
+                                     Trajectory& out) const {
+    double divisor = closed ? std::max(count - 1, 1u) : count;
+    for (uint32_t i = 0; i < count; ++i) {
+        glm::dvec3 position, velocity;
+        double     time = from + (to - from) * (i / divisor);
+        if (stateAt(time, position, velocity)) {
+            out.points.push_back(position);
+            out.times.push_back(time);
+        }
+    }
+}
+
+double TrajectoryPredictor::altitudeOf(const glm::dvec3& position) const {
+    double r = glm::length(position);
+    glm::dvec3 dir = position / r;
+    double lat = std::asin(glm::clamp(dir.y, -1.0, 1.0));
+    double lon = std::atan2(dir.z, dir.x);
+    return r - luna::util::LUNAR_RADIUS - (terrain_ ? terrain_(lat, lon) : 0.0);
+}
+
+} // namespace luna::sim
@@ -0,0 +1,117 @@
+// About: Background trajectory prediction — adaptive powered arcs, Kepler coast arcs, incremental reuse.
+
+#pragma once
+
+#include "sim/KeplerOrbit.h"
+#include "sim/SimState.h"
+#include "util/TripleBuffer.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace luna::sim {
+
+// A predicted path, sampled for drawing
+struct Trajectory {
+    std::vector<glm::dvec3> points;             // Moon-centered, from the predicted state on
+    std::vector<double>     times;              // mission time of each point
+    double                  startTime = 0.0;    // mission time of points.front()
+    double                  endTime   = 0.0;    // mission time of points.back()
+    bool                    impact    = false;  // the path ends on the surface
+
+    // Position at a mission time, interpolated between the bracketing points.
+    // False outside [startTime, endTime].
+    bool positionAt(double time, glm::dvec3& position) const;
+};
+
+// Integrates the current state forward on a worker thread, holding the present
+// throttle and attitude. A burn is integrated with adaptive RK4 until fuel runs
+// out, the vehicle hits the terrain or the horizon is reached; from there, or
+// from the start when coasting, the path is a KeplerOrbit evaluated analytically.
+// The worker keeps its last plan. A new state that still lies on it, with the
+// same controls, only trims the past and extends the far end; a control change
+// or drift away from the plan re-propagates from the present.
+class TrajectoryPredictor {
+public:
+    static constexpr uint32_t MAX_POINTS      = 512;
+    static constexpr double   POWERED_HORIZON = 900.0;    // seconds of burn looked ahead
+    static constexpr double   COAST_HORIZON   = 21600.0;  // at most this much of an orbit
+
+    // `terrain` is (lat, lon) → elevation above LUNAR_RADIUS, called from the worker
+    explicit TrajectoryPredictor(std::function<double(double, double)> terrain);
+    ~TrajectoryPredictor();
+
+    TrajectoryPredictor(const TrajectoryPredictor&) = delete;
+    TrajectoryPredictor& operator=(const TrajectoryPredictor&) = delete;
+
+    // Render thread: predict from this state. Returns at once; the worker takes
+    // only the latest state when it gets to it.
+    void update(const SimState& state);
+
+    // Render thread: the latest finished prediction
+    const Trajectory& latest();
+
+    // Join the worker. Safe to call twice.
+    void stop();
+
+private:
+    // One accepted integrator step: mission time, state, fuel
+    struct Sample {
+        double     time;
+        glm::dvec3 position;
+        glm::dvec3 velocity;
+        double     fuelMass;
+    };
+
+    // Everything the last prediction assumed and produced
+    struct Plan {
+        bool                valid = false;
+        SimState            origin;            // state it was planned from (controls, vehicle)
+        std::vector<Sample> powered;           // dense burn samples; empty when coasting
+        bool                burnDone = false;  // powered arc ended by burnout or impact
+        double              step     = 1.0;    // next adaptive step size
+        KeplerOrbit         coast;             // after the burn, or from the start
+        bool                hasCoast = false;
+        double              endTime  = 0.0;
+        bool                impact   = false;
+    };
+
+    void run();
+
+    // Whether `state` lies on the current plan with the controls it assumed
+    bool follows(const SimState& state) const;
+
+    // Re-propagate from `state`
+    void replan(const SimState& state);
+
+    // Trim the plan to `now` and push its far end out to the horizon again
+    void advance(double now);
+
+    void extendBurn(double until);
+    void startCoast(const Sample& from);
+    bool findCoastImpact(double from, double to);
+    double coastHorizon() const;
+
+    bool stateAt(double time, glm::dvec3& position, glm::dvec3& velocity) const;
+    void sample(double from, Trajectory& out) const;
+    void appendSpan(double from, double to, uint32_t count, bool closed, Trajectory& out) const;
+
+    double altitudeOf(const glm::dvec3& position) const;
+
+    std::function<double(double, double)> terrain_;
+    Plan                                  plan_;  // worker thread only
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    SimState                pending_;
+    bool                    hasPending_ = false;
+    bool                    stopping_   = false;
+
+    luna::util::TripleBuffer<Trajectory> results_;
+    std::thread                          thread_;
+};
+
+} // namespace luna::sim
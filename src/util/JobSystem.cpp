@@ -0,0 +1,364 @@
+// About: JobSystem implementation — Chase-Lev worker deques, bounded MPMC submit queues, atomic waits.
+
+#include "util/JobSystem.h"
+
+#include <algorithm>
+#include <array>
+#include <thread>
+
+namespace luna::util {
+
+namespace {
+
+// Keeps the deque and queue indices written by different threads on their own lines
+constexpr size_t CACHE_LINE = 64;
+
+// Slots per shared queue. A full queue makes submit() run jobs until one frees.
+constexpr size_t SHARED_QUEUE_CAPACITY = 4096;
+
+// Initial slots per worker deque; it doubles when full
+constexpr int64_t DEQUE_CAPACITY = 256;
+
+// Empty searches before an idle worker sleeps: cheap enough to cover the gap
+// between the slices of one parallelFor
+constexpr uint32_t SPIN_ROUNDS = 64;
+
+// Which pool, if any, the current thread works for
+thread_local const JobSystem* tlsOwner = nullptr;
+thread_local uint32_t         tlsIndex = 0;
+
+// Chase-Lev work-stealing deque (Lê et al., "Correct and Efficient Work-Stealing for
+// Weak Memory Models", 2013). Only the owning worker calls push() and pop(); any
+// thread may steal(). Rings replaced by growth are kept until the deque goes away,
+// since a thief may still be reading one.
+class WorkDeque {
+public:
+    WorkDeque() {
+        rings_.push_back(std::make_unique<Ring>(DEQUE_CAPACITY));
+        ring_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    void push(T* item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Ring* ring = ring_.load(std::memory_order_relaxed);
+        if (b - t > ring->capacity - 1) ring = grow(ring, t, b);
+        ring->put(b, item);
+        // Publishes the item (and what it points to) to thieves acquiring bottom_
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    template <typename T>
+    T* pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Ring* ring = ring_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        void* item = ring->get(b);
+        if (t == b) {
+            // Last item: race thieves for it
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed))
+                item = nullptr;
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return static_cast<T*>(item);
+    }
+
+    template <typename T>
+    T* steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+        void* item = ring_.load(std::memory_order_acquire)->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed))
+            return nullptr;  // lost to the owner or another thief
+        return static_cast<T*>(item);
+    }
+
+    size_t size() const {
+        int64_t n = bottom_.load(std::memory_order_relaxed) - top_.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+private:
+    struct Ring {
+        explicit Ring(int64_t cap) : capacity(cap), items(new std::atomic<void*>[cap]) {}
+        void* get(int64_t i) const     { return items[i & (capacity - 1)].load(std::memory_order_relaxed); }
+        void  put(int64_t i, void* v)  { items[i & (capacity - 1)].store(v, std::memory_order_relaxed); }
+
+        int64_t                               capacity;  // power of two
+        std::unique_ptr<std::atomic<void*>[]> items;
+    };
+
+    Ring* grow(Ring* old, int64_t t, int64_t b) {
+        rings_.push_back(std::make_unique<Ring>(old->capacity * 2));
+        Ring* ring = rings_.back().get();
+        for (int64_t i = t; i < b; i++) ring->put(i, old->get(i));
+        ring_.store(ring, std::memory_order_release);
+        return ring;
+    }
+
+    alignas(CACHE_LINE) std::atomic<int64_t> top_{0};
+    alignas(CACHE_LINE) std::atomic<int64_t> bottom_{0};
+    std::atomic<Ring*>                       ring_{nullptr};
+    std::vector<std::unique_ptr<Ring>>       rings_;  // owner only
+};
+
+} // anonymous namespace
+
+struct JobSystem::Job {
+    std::function<void()> fn;
+    JobCounter*           counter;
+};
+
+struct JobSystem::Worker {
+    std::thread                           thread;
+    std::array<WorkDeque, PRIORITY_COUNT> deques;
+};
+
+// Bounded multi-producer multi-consumer queue (Vyukov): each cell's sequence
+// number says whether it is free for the producer at that position or holds an
+// item for the consumer there, so both sides claim cells with one CAS.
+struct JobSystem::SharedQueue {
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Job*                job;
+    };
+
+    SharedQueue() : cells(new Cell[SHARED_QUEUE_CAPACITY]) {
+        for (size_t i = 0; i < SHARED_QUEUE_CAPACITY; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(Job* job) {
+        size_t pos = enqueue.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & (SHARED_QUEUE_CAPACITY - 1)];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.job = job;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    Job* pop() {
+        size_t pos = dequeue.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & (SHARED_QUEUE_CAPACITY - 1)];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    Job* job = cell.job;
+                    cell.sequence.store(pos + SHARED_QUEUE_CAPACITY, std::memory_order_release);
+                    return job;
+                }
+            } else if (diff < 0) {
+                return nullptr;  // empty
+            } else {
+                pos = dequeue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t size() const {
+        size_t e = enqueue.load(std::memory_order_relaxed);
+        size_t d = dequeue.load(std::memory_order_relaxed);
+        return e > d ? e - d : 0;
+    }
+
+    std::unique_ptr<Cell[]>                 cells;
+    alignas(CACHE_LINE) std::atomic<size_t> enqueue{0};
+    alignas(CACHE_LINE) std::atomic<size_t> dequeue{0};
+};
+
+JobSystem::JobSystem(uint32_t workerCount) {
+    static_assert((SHARED_QUEUE_CAPACITY & (SHARED_QUEUE_CAPACITY - 1)) == 0);
+    if (workerCount == 0) {
+        uint32_t hw = std::thread::hardware_concurrency();
+        workerCount = std::max(1u, hw > 1 ? hw - 1 : 1u);
+    }
+    for (uint32_t p = 0; p < PRIORITY_COUNT; p++)
+        shared_.push_back(std::make_unique<SharedQueue>());
+
+    // Every deque exists before any worker can try to steal from it
+    workers_.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++)
+        workers_.push_back(std::make_unique<Worker>());
+    for (uint32_t i = 0; i < workerCount; i++)
+        workers_[i]->thread = std::thread([this, i] { workerLoop(i); });
+}
+
+JobSystem::~JobSystem() {
+    shutdown();
+}
+
+JobSystem& JobSystem::instance() {
+    static JobSystem jobs;
+    return jobs;
+}
+
+void JobSystem::submit(std::function<void()> fn, JobPriority priority, JobCounter* counter) {
+    if (stopping_.load(std::memory_order_acquire)) return;
+    if (counter) counter->pending_.fetch_add(1, std::memory_order_relaxed);
+    Job* job = new Job{std::move(fn), counter};
+
+    auto p = static_cast<uint32_t>(priority);
+    if (tlsOwner == this) {
+        workers_[tlsIndex]->deques[p].push(job);
+    } else {
+        // Back-pressure: a full queue is worked off by the submitter itself
+        while (!shared_[p]->push(job)) {
+            if (Job* other = findJob(workerCount(), JobPriority::Background)) run(other);
+            else std::this_thread::yield();
+        }
+    }
+    wake();
+}
+
+void JobSystem::wake() {
+    // A worker reads the epoch before its last search, so a change after that
+    // search makes its wait return at once; notifying is only needed for sleepers
+    wakeEpoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) > 0)
+        wakeEpoch_.notify_one();
+}
+
+void JobSystem::wait(const JobCounter& counter) {
+    bool worker = tlsOwner == this;
+    uint32_t self = worker ? tlsIndex : workerCount();
+    JobPriority help = worker ? JobPriority::Background : JobPriority::Frame;
+    for (;;) {
+        uint32_t pending = counter.pending_.load(std::memory_order_acquire);
+        if (pending == 0) return;
+        if (Job* job = findJob(self, help)) {
+            run(job);
+            continue;
+        }
+        counter.pending_.wait(pending, std::memory_order_acquire);
+    }
+}
+
+void JobSystem::parallelFor(uint32_t count, const std::function<void(uint32_t)>& fn,
+                            JobPriority priority) {
+    if (count == 0) return;
+
+    // Helper jobs may start after the loop is over, so they share the counters
+    // instead of pointing into this frame; once every index is taken they never touch fn
+    struct State {
+        std::atomic<uint32_t> next{0};
+        std::atomic<uint32_t> done{0};
+    };
+    auto state = std::make_shared<State>();
+    auto body = [state, count, fn = &fn] {
+        for (uint32_t i; (i = state->next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            (*fn)(i);
+            if (state->done.fetch_add(1, std::memory_order_acq_rel) + 1 == count)
+                state->done.notify_all();
+        }
+    };
+
+    uint32_t helpers = std::min(count - 1, workerCount());
+    for (uint32_t i = 0; i < helpers; i++)
+        submit(body, priority);
+    body();
+
+    for (uint32_t done; (done = state->done.load(std::memory_order_acquire)) != count;)
+        state->done.wait(done, std::memory_order_acquire);
+}
+
+void JobSystem::shutdown() {
+    if (workers_.empty()) return;
+    stopping_.store(true, std::memory_order_release);
+    wakeEpoch_.fetch_add(1, std::memory_order_seq_cst);
+    wakeEpoch_.notify_all();
+    for (auto& w : workers_)
+        if (w->thread.joinable()) w->thread.join();
+
+    // Nothing runs any more; whatever is left is dropped, and its counters released
+    for (auto& w : workers_)
+        for (auto& deque : w->deques)
+            while (Job* job = deque.pop<Job>()) drop(job);
+    for (auto& queue : shared_)
+        while (Job* job = queue->pop()) drop(job);
+    workers_.clear();
+}
+
+size_t JobSystem::queuedCount(JobPriority priority) const {
+    auto p = static_cast<uint32_t>(priority);
+    size_t n = shared_[p]->size();
+    for (const auto& w : workers_) n += w->deques[p].size();
+    return n;
+}
+
+JobSystem::Job* JobSystem::findJob(uint32_t self, JobPriority maxPriority) {
+    uint32_t workers = workerCount();
+    for (uint32_t p = 0; p <= static_cast<uint32_t>(maxPriority); p++) {
+        if (self < workers)
+            if (Job* job = workers_[self]->deques[p].pop<Job>()) return job;
+        if (Job* job = shared_[p]->pop()) return job;
+        // Steal starting past ourselves, so thieves spread over the victims
+        for (uint32_t k = 1; k <= workers; k++) {
+            uint32_t victim = (self + k) % workers;
+            if (victim == self) continue;
+            if (Job* job = workers_[victim]->deques[p].steal<Job>()) return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::run(Job* job) {
+    job->fn();
+    drop(job);
+}
+
+void JobSystem::drop(Job* job) {
+    if (JobCounter* counter = job->counter) {
+        if (counter->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            counter->pending_.notify_all();
+    }
+    delete job;
+}
+
+void JobSystem::workerLoop(uint32_t index) {
+    tlsOwner = this;
+    tlsIndex = index;
+    uint32_t idle = 0;
+    for (;;) {
+        uint32_t epoch = wakeEpoch_.load(std::memory_order_seq_cst);
+        if (stopping_.load(std::memory_order_acquire)) return;
+        if (Job* job = findJob(index, JobPriority::Background)) {
+            run(job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < SPIN_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        wakeEpoch_.wait(epoch, std::memory_order_seq_cst);
+        sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+        idle = 0;
+    }
+}
+
+} // namespace luna::util
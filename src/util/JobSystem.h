@@ -0,0 +1,107 @@
+// About: Work-stealing job scheduler shared by every subsystem — priorities, counters, helping waits.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace luna::util {
+
+// Workers always take the most urgent job they can find
+enum class JobPriority : uint8_t {
+    Frame,       // the frame waits on it: slice recording, parallelFor
+    Normal,      // needed soon: patch generation for a requested split
+    Background,  // worth doing ahead of time, never ahead of the above: prefetch, IO
+};
+
+// Counts a group of jobs still to finish, like a fence for CPU work. submit()
+// increments it and the job decrements it once it has run, or been dropped by
+// shutdown(). JobSystem::wait() blocks until it reaches zero. Must outlive its jobs.
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool     isDone()  const { return pending_.load(std::memory_order_acquire) == 0; }
+    uint32_t pending() const { return pending_.load(std::memory_order_relaxed); }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> pending_{0};
+};
+
+// A fixed set of worker threads, each with a lock-free deque per priority (Chase-Lev:
+// the owner pushes and pops at the bottom, others steal from the top). Jobs
+// submitted from a worker go to its own deque; jobs from any other thread go to a
+// bounded lock-free queue per priority that every worker drains. An idle worker
+// looks through its deque, the shared queue and then the other workers' deques,
+// most urgent priority first, and sleeps on an atomic wait when all are empty.
+//
+// One process-wide instance(), sized to all cores but one, serves terrain
+// generation, heightmap decoding, region IO and slice recording. Threads with a
+// loop of their own (physics, trajectory prediction) stay dedicated threads.
+class JobSystem {
+public:
+    // workerCount = 0 picks hardware_concurrency() - 1, leaving a core for the render thread
+    explicit JobSystem(uint32_t workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Created on first use and joined at exit
+    static JobSystem& instance();
+
+    // Queue a job. With a counter, the job is counted until it has run. Dropped
+    // after shutdown().
+    void submit(std::function<void()> job, JobPriority priority = JobPriority::Normal,
+                JobCounter* counter = nullptr);
+
+    // Block until `counter` reaches zero. The caller runs queued jobs meanwhile:
+    // Frame jobs only from outside the pool, so a wait is never held up by a long
+    // generation job, and any job from a worker, which keeps nested waits from
+    // starving the pool.
+    void wait(const JobCounter& counter);
+
+    // Run fn(i) for every i in [0, count) on the workers and the calling thread, and
+    // return once all calls have finished. The caller takes indices too, so this
+    // completes even when every worker is busy with other jobs.
+    void parallelFor(uint32_t count, const std::function<void(uint32_t)>& fn,
+                     JobPriority priority = JobPriority::Frame);
+
+    // Join the workers once their running jobs return, then drop every queued job,
+    // releasing its counter. Call once nothing submits any more; safe to call twice.
+    void shutdown();
+
+    uint32_t workerCount() const { return static_cast<uint32_t>(workers_.size()); }
+    // Approximate: jobs queued at `priority` and not yet started
+    size_t   queuedCount(JobPriority priority) const;
+
+private:
+    struct Job;
+    struct Worker;
+    struct SharedQueue;
+
+    static constexpr uint32_t PRIORITY_COUNT = 3;
+
+    void workerLoop(uint32_t index);
+    // Most urgent job no less urgent than `maxPriority`; self is the caller's worker
+    // index, or workerCount() from outside the pool
+    Job* findJob(uint32_t self, JobPriority maxPriority);
+    void run(Job* job);
+    void drop(Job* job);  // release the counter and free the job without running it
+    void wake();
+
+    std::vector<std::unique_ptr<Worker>>      workers_;
+    std::vector<std::unique_ptr<SharedQueue>> shared_;  // one per priority
+    std::atomic<uint32_t>                     wakeEpoch_{0};
+    std::atomic<uint32_t>                     sleepers_{0};
+    std::atomic<bool>                         stopping_{false};
+};
+
+} // namespace luna::util
@@ -0,0 +1,56 @@
+// About: LinearArena implementation — aligned bumps over chained blocks, coalesced on reset.
+
+#include "util/LinearArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace luna::util {
+
+LinearArena::LinearArena(size_t blockSize)
+    : blockSize_(std::max<size_t>(blockSize, 1024)) {}
+
+void* LinearArena::allocate(size_t size, size_t alignment) {
+    // Try the current block, then any later one kept from an earlier cycle
+    for (; current_ < blocks_.size(); current_++, offset_ = 0) {
+        Block& block = blocks_[current_];
+        auto base = reinterpret_cast<uintptr_t>(block.data.get());
+        size_t start = ((base + offset_ + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+        if (start + size <= block.size) {
+            offset_ = start + size;
+            used_ += size;
+            return block.data.get() + start;
+        }
+    }
+
+    // new[] of std::byte aligns to max_align_t; the padding covers anything stricter
+    Block block;
+    block.size = std::max(blockSize_, size + alignment);
+    block.data.reset(new std::byte[block.size]);  // left uninitialised
+    blocks_.push_back(std::move(block));
+    current_ = blocks_.size() - 1;
+    offset_  = 0;
+    return allocate(size, alignment);
+}
+
+void LinearArena::reset() {
+    if (blocks_.size() > 1) {
+        size_t total = capacity();
+        blocks_.clear();
+        Block block;
+        block.size = total;
+        block.data.reset(new std::byte[total]);
+        blocks_.push_back(std::move(block));
+    }
+    current_ = 0;
+    offset_  = 0;
+    used_    = 0;
+}
+
+size_t LinearArena::capacity() const {
+    size_t total = 0;
+    for (const Block& block : blocks_) total += block.size;
+    return total;
+}
+
+} // namespace luna::util
@@ -0,0 +1,85 @@
+// About: Bump allocator for short-lived data — per-frame lists and per-worker scratch, freed at once by reset().
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace luna::util {
+
+// Allocation is a pointer bump inside the current block; nothing is freed until
+// reset(), which rewinds the whole arena. When a cycle outgrew the first block the
+// arena chains more, and the next reset() folds them into one block of the combined
+// size, so after a few cycles a steady workload allocates from a single block and
+// never touches the heap. Not thread-safe: one arena per frame or per thread.
+class LinearArena {
+public:
+    explicit LinearArena(size_t blockSize = 64 * 1024);
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    // Never null: grows by a block when the current one is full
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // Uninitialised storage for `count` objects that need no destructor
+    template <typename T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "reset() runs no destructors");
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Invalidate every allocation. Keeps the memory for the next cycle.
+    void reset();
+
+    size_t used()     const { return used_; }      // bytes handed out since reset()
+    size_t capacity() const;                       // bytes held across all blocks
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t                       size = 0;
+    };
+
+    std::vector<Block> blocks_;
+    size_t             blockSize_;
+    size_t             current_ = 0;  // block being bumped
+    size_t             offset_  = 0;  // within blocks_[current_]
+    size_t             used_    = 0;
+};
+
+// std::allocator over a LinearArena. deallocate() is a no-op, so a container's
+// growth leaves its old storage behind until reset() — reserve() what is known.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(LinearArena& arena) : arena_(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    LinearArena* arena() const { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena(); }
+
+private:
+    LinearArena* arena_;
+};
+
+// A vector whose storage comes from an arena; must not outlive the arena's next reset()
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+template <typename T>
+ArenaVector<T> makeArenaVector(LinearArena& arena) {
+    return ArenaVector<T>(ArenaAllocator<T>(arena));
+}
+
+} // namespace luna::util
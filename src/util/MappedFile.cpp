@@ -0,0 +1,134 @@
+// About: MappedFile implementation — mmap/madvise on POSIX, file mappings on Windows.
+
+#include "util/MappedFile.h"
+#include "util/Log.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace luna::util {
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(other.data_), size_(other.size_)
+#ifdef _WIN32
+    , file_(other.file_), mapping_(other.mapping_)
+#endif
+{
+    other.data_ = nullptr;
+    other.size_ = 0;
+#ifdef _WIN32
+    other.file_    = nullptr;
+    other.mapping_ = nullptr;
+#endif
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+#ifdef _WIN32
+        std::swap(file_, other.file_);
+        std::swap(mapping_, other.mapping_);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path, MapAccess access) {
+    close();
+    DWORD flags = access == MapAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_WARN("Cannot open %s", path.c_str());
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        LOG_WARN("Cannot map empty file %s", path.c_str());
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        LOG_ERROR("Failed to map %s", path.c_str());
+        return false;
+    }
+    file_    = file;
+    mapping_ = mapping;
+    data_    = static_cast<const uint8_t*>(view);
+    size_    = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_)    UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(static_cast<HANDLE>(mapping_));
+    if (file_)    CloseHandle(static_cast<HANDLE>(file_));
+    data_ = nullptr;
+    size_ = 0;
+    file_ = mapping_ = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, MapAccess access) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_WARN("Cannot open %s", path.c_str());
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        LOG_WARN("Cannot map empty file %s", path.c_str());
+        return false;
+    }
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps the file referenced
+    if (addr == MAP_FAILED) {
+        LOG_ERROR("Failed to map %s", path.c_str());
+        return false;
+    }
+    madvise(addr, static_cast<size_t>(st.st_size),
+            access == MapAccess::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    data_ = static_cast<const uint8_t*>(addr);
+    size_ = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#endif
+
+void MappedFile::prefault() const {
+    constexpr size_t PAGE = 4096;
+    volatile uint8_t sink = 0;
+    for (size_t offset = 0; offset < size_; offset += PAGE)
+        sink = sink + data_[offset];
+}
+
+} // namespace luna::util
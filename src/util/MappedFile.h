@@ -0,0 +1,45 @@
+// About: Read-only memory-mapped file — pages fault in on first touch.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace luna::util {
+
+// How the mapping will be read; forwarded to the OS as a paging hint
+enum class MapAccess { Sequential, Random };
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Map the whole file. Returns false (and logs) if it cannot be opened or mapped.
+    bool open(const std::string& path, MapAccess access = MapAccess::Random);
+    void close();
+
+    // Touch one byte per page so later reads don't fault to disk. Blocking; meant
+    // for loader threads. The OS may still reclaim the pages under memory pressure.
+    void prefault() const;
+
+    const uint8_t* data() const { return data_; }
+    size_t         size() const { return size_; }
+    bool           isOpen() const { return data_ != nullptr; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t         size_ = 0;
+#ifdef _WIN32
+    void* file_    = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace luna::util
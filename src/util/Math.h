@@ -23,4 +23,12 @@ constexpr double LUNAR_GM = 4.9028695e12;   // m^3/s^2
 
 using dquat = glm::dquat;
 
+// Split a double position into a float pair whose sum keeps its precision. Shaders
+// subtract the high and the low parts separately, so a camera-relative offset
+// stays exact at Moon-scale distances without double arithmetic on the GPU.
+inline void splitDouble(const dvec3& v, glm::vec3& high, glm::vec3& low) {
+    high = glm::vec3(v);
+    low  = glm::vec3(v - dvec3(high));
+}
+
 } // namespace luna::util
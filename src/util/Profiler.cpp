@@ -0,0 +1,181 @@
+// About: Profiler implementation — mutex-guarded frame ring and Chrome trace JSON writer.
+
+#include "util/Profiler.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace luna::util {
+
+namespace {
+
+// Names are literals from our own code, but keep the JSON valid regardless
+void writeJsonString(std::FILE* f, const char* s) {
+    std::fputc('"', f);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') std::fputc('\\', f);
+        if (static_cast<unsigned char>(*s) >= 0x20) std::fputc(*s, f);
+    }
+    std::fputc('"', f);
+}
+
+} // anonymous namespace
+
+double FrameProfile::eventMs(const char* name) const {
+    double seconds = 0.0;
+    for (const auto& e : events)
+        if (std::strcmp(e.name, name) == 0) seconds += e.duration;
+    return seconds * 1000.0;
+}
+
+double FrameProfile::counter(const char* name) const {
+    for (const auto& c : counters)
+        if (std::strcmp(c.name, name) == 0) return c.value;
+    return 0.0;
+}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : frames_(HISTORY) {}
+
+double Profiler::now() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch_).count();
+}
+
+uint64_t Profiler::beginFrame() {
+    double   t     = now();
+    uint32_t track = threadTrack();
+    std::lock_guard<std::mutex> lock(mutex_);
+    frameTrack_ = track;
+    if (current_ > 0) {
+        FrameProfile& done = frames_[current_ % HISTORY];
+        done.duration = t - done.start;
+    }
+    current_++;
+    FrameProfile& next = frames_[current_ % HISTORY];
+    next.frame    = current_;
+    next.start    = t;
+    next.duration = 0.0;
+    next.events.clear();
+    next.counters.clear();
+    return current_;
+}
+
+uint64_t Profiler::currentFrame() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_;
+}
+
+uint32_t Profiler::threadTrack() {
+    thread_local uint32_t track = nextTrack_.fetch_add(1, std::memory_order_relaxed);
+    return track;
+}
+
+FrameProfile* Profiler::frameLocked(uint64_t frame) {
+    if (frame == 0 || frame > current_) return nullptr;
+    FrameProfile& profile = frames_[frame % HISTORY];
+    return profile.frame == frame ? &profile : nullptr;
+}
+
+void Profiler::record(const char* name, double start, double duration) {
+    uint32_t track = threadTrack();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (FrameProfile* frame = frameLocked(current_))
+        frame->events.push_back({name, track, start, duration});
+}
+
+void Profiler::recordFor(uint64_t frame, const char* name, uint32_t track,
+                         double start, double duration) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (FrameProfile* profile = frameLocked(frame))
+        profile->events.push_back({name, track, start, duration});
+}
+
+void Profiler::counter(const char* name, double value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    setCounterLocked(current_, name, value);
+}
+
+void Profiler::counterFor(uint64_t frameNumber, const char* name, double value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    setCounterLocked(frameNumber, name, value);
+}
+
+void Profiler::setCounterLocked(uint64_t frameNumber, const char* name, double value) {
+    FrameProfile* frame = frameLocked(frameNumber);
+    if (!frame) return;
+    for (auto& c : frame->counters) {
+        if (std::strcmp(c.name, name) == 0) {
+            c.value = value;
+            return;
+        }
+    }
+    frame->counters.push_back({name, value});
+}
+
+void Profiler::nameThread(const char* name) {
+    uint32_t track = threadTrack();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (trackNames_.size() <= track) trackNames_.resize(track + 1);
+    trackNames_[track] = name;
+}
+
+FrameProfile Profiler::lastFrame() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_ < 2) return {};
+    return frames_[(current_ - 1) % HISTORY];
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    auto separator = [&] {
+        if (!first) std::fprintf(f, ",\n");
+        first = false;
+    };
+
+    for (uint32_t track = 0; track < trackNames_.size(); ++track) {
+        if (trackNames_[track].empty()) continue;
+        separator();
+        std::fprintf(f, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", track);
+        writeJsonString(f, trackNames_[track].c_str());
+        std::fprintf(f, "}}");
+    }
+    separator();
+    std::fprintf(f, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}",
+                 GPU_TRACK);
+
+    // Completed frames only, oldest first; timestamps in microseconds
+    uint64_t oldest = current_ > HISTORY ? current_ - HISTORY + 1 : 1;
+    for (uint64_t n = oldest; n < current_; ++n) {
+        const FrameProfile& frame = frames_[n % HISTORY];
+        if (frame.frame != n) continue;
+        separator();
+        std::fprintf(f, "{\"ph\":\"X\",\"name\":\"frame %llu\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     static_cast<unsigned long long>(n), frameTrack_, frame.start * 1e6, frame.duration * 1e6);
+        for (const auto& e : frame.events) {
+            separator();
+            std::fprintf(f, "{\"ph\":\"X\",\"name\":");
+            writeJsonString(f, e.name);
+            std::fprintf(f, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         e.track, e.start * 1e6, e.duration * 1e6);
+        }
+        for (const auto& c : frame.counters) {
+            separator();
+            std::fprintf(f, "{\"ph\":\"C\",\"name\":");
+            writeJsonString(f, c.name);
+            std::fprintf(f, ",\"pid\":1,\"ts\":%.3f,\"args\":{\"value\":%.6g}}", frame.start * 1e6, c.value);
+        }
+    }
+    std::fprintf(f, "\n]}\n");
+    return std::fclose(f) == 0;
+}
+
+} // namespace luna::util
@@ -0,0 +1,120 @@
+// About: Frame profiler — scoped CPU timers, late GPU intervals, a per-frame ring and Chrome trace export.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace luna::util {
+
+// One timed interval. Names are not copied: pass string literals.
+struct ProfileEvent {
+    const char* name;
+    uint32_t    track;     // Profiler thread index, or Profiler::GPU_TRACK
+    double      start;     // seconds since the profiler was created
+    double      duration;  // seconds
+};
+
+struct ProfileCounter {
+    const char* name;
+    double      value;
+};
+
+// Everything recorded for one frame, from its beginFrame() to the next
+struct FrameProfile {
+    uint64_t                    frame    = 0;
+    double                      start    = 0.0;
+    double                      duration = 0.0;
+    std::vector<ProfileEvent>   events;
+    std::vector<ProfileCounter> counters;
+
+    // Summed duration of the events called `name`, in milliseconds
+    double eventMs(const char* name) const;
+    // Value last set for `name`, or 0
+    double counter(const char* name) const;
+};
+
+// Process-wide, like Log. The render thread calls beginFrame() once per frame;
+// any thread may record intervals and counters into the frame in progress, and
+// intervals measured later (GPU timestamps) go to the frame they belong to while
+// it is still among the last HISTORY. Recording takes a mutex, so scopes belong
+// around work of tens of microseconds or more, not in inner loops.
+class Profiler {
+public:
+    static constexpr uint32_t HISTORY   = 300;  // frames kept, 5 s at 60 Hz
+    static constexpr uint32_t GPU_TRACK = 0xFFFFFFFFu;
+
+    static Profiler& instance();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Seconds since the profiler was created
+    double now() const;
+
+    // Render thread: close the frame in progress and open the next. Returns its number.
+    uint64_t beginFrame();
+    uint64_t currentFrame() const;
+
+    // Any thread: add to the frame in progress
+    void record(const char* name, double start, double duration);
+    void counter(const char* name, double value);
+
+    // Add to an earlier frame; dropped once the frame has left the history
+    void recordFor(uint64_t frame, const char* name, uint32_t track, double start, double duration);
+    void counterFor(uint64_t frame, const char* name, double value);
+
+    // Label the calling thread's track in exported traces
+    void nameThread(const char* name);
+
+    // Copy of the most recent completed frame
+    FrameProfile lastFrame() const;
+
+    // Write the history as Chrome trace event JSON, which chrome://tracing and
+    // ui.perfetto.dev open. Returns false if the file could not be written.
+    bool writeChromeTrace(const std::string& path) const;
+
+private:
+    Profiler();
+
+    uint32_t      threadTrack();
+    FrameProfile* frameLocked(uint64_t frame);
+    void          setCounterLocked(uint64_t frame, const char* name, double value);
+
+    std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now();
+
+    mutable std::mutex        mutex_;
+    std::vector<FrameProfile> frames_;       // ring of HISTORY, indexed by frame % HISTORY
+    uint64_t                  current_ = 0;  // frame in progress; 0 before the first beginFrame()
+    uint32_t                  frameTrack_ = 0;  // track of the thread calling beginFrame()
+    std::vector<std::string>  trackNames_;
+    std::atomic<uint32_t>     nextTrack_{0};
+};
+
+// Records the time from construction to destruction on the calling thread's track
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : name_(name), start_(Profiler::instance().now()) {}
+    ~ProfileScope() {
+        Profiler& profiler = Profiler::instance();
+        profiler.record(name_, start_, profiler.now() - start_);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name_;
+    double      start_;
+};
+
+} // namespace luna::util
+
+#define LUNA_PROFILE_CONCAT_(a, b) a##b
+#define LUNA_PROFILE_CONCAT(a, b)  LUNA_PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ::luna::util::ProfileScope LUNA_PROFILE_CONCAT(profileScope_, __LINE__)(name)
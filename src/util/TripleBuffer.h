@@ -0,0 +1,52 @@
+// About: Lock-free single-producer single-consumer triple buffer for handing off the latest value.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace luna::util {
+
+// Three slots: the writer owns one, the reader owns one, and the third is the
+// latest published value. publish() and update() swap a slot with the published
+// one in a single atomic exchange, so neither side ever waits and the reader
+// always sees a complete value. Intermediate values the reader did not pick up
+// are dropped. One writer thread and one reader thread only.
+template <typename T>
+class TripleBuffer {
+public:
+    explicit TripleBuffer(const T& initial = T{}) { slots_.fill(initial); }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer: fill this slot, then publish() it
+    T&   writeSlot() { return slots_[back_]; }
+    void publish() {
+        uint8_t previous = middle_.exchange(static_cast<uint8_t>(back_ | FRESH),
+                                            std::memory_order_acq_rel);
+        back_ = previous & INDEX;
+    }
+
+    // Reader: take the latest published value, if any arrived since the last call.
+    // Returns false and keeps the current value otherwise.
+    bool update() {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH)) return false;
+        uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & INDEX;
+        return true;
+    }
+    const T& read() const { return slots_[front_]; }
+
+private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4;  // set in middle_ until the reader takes it
+
+    std::array<T, 3>                 slots_;
+    uint8_t                          back_  = 0;  // writer's slot
+    alignas(64) std::atomic<uint8_t> middle_{1};  // published slot | FRESH
+    alignas(64) uint8_t              front_ = 2;  // reader's slot
+};
+
+} // namespace luna::util
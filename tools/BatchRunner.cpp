@@ -0,0 +1,357 @@
+// About: Headless batch runner — steps many lander scenarios in parallel and writes their outcomes.
+
+#include "sim/Physics.h"
+#include "sim/SimBatch.h"
+#include "sim/TerrainQuery.h"
+#include "util/Log.h"
+#include "util/JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace luna::sim;
+
+namespace {
+
+// Vehicles stepped together per job. Large enough to keep the SoA loops long,
+// small enough that a scenario with a few thousand runs spreads over every core.
+constexpr uint32_t CHUNK_RUNS = 256;
+
+void usage() {
+    std::fprintf(stderr,
+        "usage: luna_batch <scenarios.txt> <output> [options]\n"
+        "  --format csv|bin          output format (default csv)\n"
+        "  --dt S                    step in seconds (default 0.01)\n"
+        "  --integrator euler|verlet|rk4   (default rk4)\n"
+        "  --terrain PATH            heightmap to land on (default flat sphere)\n"
+        "  --threads N               worker threads (default: all cores but one)\n");
+}
+
+// Control held over [start, end) of mission time; throttle uses value.x
+struct Segment {
+    double     start;
+    double     end;
+    glm::dvec3 value;
+};
+
+struct Scenario {
+    std::string          name;
+    SimState             initial;
+    std::vector<Segment> burns;
+    std::vector<Segment> torques;
+    double               duration      = 600.0;
+    uint32_t             runs          = 1;
+    double               positionSigma = 0.0;  // m, per axis
+    double               velocitySigma = 0.0;  // m/s, per axis
+    uint64_t             seed          = 1;
+};
+
+// One row of output per run. The binary file is a ResultHeader followed by these.
+struct RunResult {
+    uint32_t scenario;
+    uint32_t run;
+    uint32_t phase;     // FlightPhase
+    uint32_t reserved;
+    double   time;      // mission time at touchdown, or when the run timed out
+    double   altitude;
+    double   verticalSpeed;
+    double   surfaceSpeed;
+    double   fuelMass;
+    double   lat;       // degrees
+    double   lon;
+};
+static_assert(sizeof(RunResult) == 72);
+
+struct ResultHeader {
+    char     magic[4];  // "LBR1"
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t scenarioCount;
+    uint64_t recordCount;
+};
+
+// Value of the last segment covering t, or zero
+glm::dvec3 scheduleAt(const std::vector<Segment>& segments, double t) {
+    glm::dvec3 value(0.0);
+    for (const Segment& s : segments)
+        if (t >= s.start && t < s.end) value = s.value;
+    return value;
+}
+
+const char* phaseName(FlightPhase phase) {
+    switch (phase) {
+    case FlightPhase::Orbit:          return "orbit";
+    case FlightPhase::Descent:        return "descent";
+    case FlightPhase::PoweredDescent: return "powered_descent";
+    case FlightPhase::Terminal:       return "terminal";
+    case FlightPhase::Landed:         return "landed";
+    case FlightPhase::Crashed:        return "crashed";
+    }
+    return "unknown";
+}
+
+// Line-based, '#' comments. "scenario <name>" starts a scenario and every line up
+// to the next one configures it; see README.md for the keywords.
+bool parseScenarios(const std::string& path, std::vector<Scenario>& scenarios) {
+    std::ifstream in(path);
+    if (!in) {
+        LOG_ERROR("Cannot open %s", path.c_str());
+        return false;
+    }
+
+    std::string line;
+    size_t lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream ls(line);
+        std::string key;
+        if (!(ls >> key)) continue;
+
+        if (key == "scenario") {
+            Scenario s;
+            ls >> s.name;
+            if (s.name.empty()) s.name = "scenario" + std::to_string(scenarios.size());
+            scenarios.push_back(std::move(s));
+            continue;
+        }
+        if (scenarios.empty()) {
+            LOG_ERROR("%s:%zu: '%s' before the first scenario", path.c_str(), lineNo, key.c_str());
+            return false;
+        }
+
+        Scenario& s = scenarios.back();
+        SimState& st = s.initial;
+        bool ok = true;
+        if (key == "orbit") {
+            // Circular equatorial orbit at this altitude, as luna3d starts
+            double altitude = 0.0;
+            ok = static_cast<bool>(ls >> altitude);
+            double r = luna::util::LUNAR_RADIUS + altitude;
+            st.position = glm::dvec3(0.0, -r, 0.0);
+            st.velocity = glm::dvec3(std::sqrt(luna::util::LUNAR_GM / r), 0.0, 0.0);
+        } else if (key == "position") {
+            ok = static_cast<bool>(ls >> st.position.x >> st.position.y >> st.position.z);
+        } else if (key == "velocity") {
+            ok = static_cast<bool>(ls >> st.velocity.x >> st.velocity.y >> st.velocity.z);
+        } else if (key == "attitude") {
+            ok = static_cast<bool>(ls >> st.orientation.w >> st.orientation.x
+                                      >> st.orientation.y >> st.orientation.z);
+            st.orientation = glm::normalize(st.orientation);
+        } else if (key == "spin") {
+            ok = static_cast<bool>(ls >> st.angularVelocity.x >> st.angularVelocity.y
+                                      >> st.angularVelocity.z);
+        } else if (key == "fuel") {
+            ok = static_cast<bool>(ls >> st.fuelMass);
+        } else if (key == "burn") {
+            Segment seg{};
+            ok = static_cast<bool>(ls >> seg.start >> seg.end >> seg.value.x);
+            seg.value.x = glm::clamp(seg.value.x, 0.0, 1.0);
+            s.burns.push_back(seg);
+        } else if (key == "torque") {
+            Segment seg{};
+            ok = static_cast<bool>(ls >> seg.start >> seg.end >> seg.value.x >> seg.value.y
+                                      >> seg.value.z);
+            s.torques.push_back(seg);
+        } else if (key == "duration") {
+            ok = static_cast<bool>(ls >> s.duration);
+        } else if (key == "runs") {
+            ok = static_cast<bool>(ls >> s.runs) && s.runs > 0;
+        } else if (key == "disperse") {
+            ok = static_cast<bool>(ls >> s.positionSigma >> s.velocitySigma);
+            uint64_t seed = 0;
+            if (ls >> seed) s.seed = seed;  // optional
+        } else {
+            LOG_ERROR("%s:%zu: unknown keyword '%s'", path.c_str(), lineNo, key.c_str());
+            return false;
+        }
+        if (!ok) {
+            LOG_ERROR("%s:%zu: bad arguments to '%s'", path.c_str(), lineNo, key.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Step runs [first, first + count) of a scenario to touchdown or timeout
+void runChunk(const Physics& physics, const Scenario& s, uint32_t scenarioIndex,
+              uint32_t first, uint32_t count, double dt, RunResult* out) {
+    SimBatch batch(count, s.initial);
+    for (uint32_t i = 0; i < count; ++i) {
+        // Seeded per run, so a run's dispersion doesn't depend on the chunking
+        std::mt19937_64 rng(s.seed * 0x9E3779B97F4A7C15ull + first + i);
+        std::normal_distribution<double> dp(0.0, s.positionSigma), dv(0.0, s.velocitySigma);
+        if (s.positionSigma > 0.0) {
+            batch.px[i] += dp(rng);
+            batch.py[i] += dp(rng);
+            batch.pz[i] += dp(rng);
+        }
+        if (s.velocitySigma > 0.0) {
+            batch.vx[i] += dv(rng);
+            batch.vy[i] += dv(rng);
+            batch.vz[i] += dv(rng);
+        }
+    }
+
+    auto terrain = [](double lat, double lon) { return sampleTerrainHeight(lat, lon); };
+    const double start = s.initial.missionTime;
+    for (double t = start; t < start + s.duration; t += dt) {
+        double throttle   = scheduleAt(s.burns, t).x;
+        glm::dvec3 torque = scheduleAt(s.torques, t);
+        std::fill(batch.throttle.begin(), batch.throttle.end(), throttle);
+        std::fill(batch.tx.begin(), batch.tx.end(), torque.x);
+        std::fill(batch.ty.begin(), batch.ty.end(), torque.y);
+        std::fill(batch.tz.begin(), batch.tz.end(), torque.z);
+
+        physics.stepBatch(batch, dt, terrain, terrainGeneration());
+        if (std::none_of(batch.active.begin(), batch.active.end(), [](uint8_t a) { return a; }))
+            break;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        glm::dvec3 dir = glm::normalize(glm::dvec3(batch.px[i], batch.py[i], batch.pz[i]));
+        RunResult& r = out[i];
+        r.scenario      = scenarioIndex;
+        r.run           = first + i;
+        r.phase         = static_cast<uint32_t>(batch.phase[i]);
+        r.reserved      = 0;
+        r.time          = batch.missionTime[i];
+        r.altitude      = batch.altitude[i];
+        r.verticalSpeed = batch.verticalSpeed[i];
+        r.surfaceSpeed  = batch.surfaceSpeed[i];
+        r.fuelMass      = batch.fuelMass[i];
+        r.lat           = glm::degrees(std::asin(glm::clamp(dir.y, -1.0, 1.0)));
+        r.lon           = glm::degrees(std::atan2(dir.z, dir.x));
+    }
+}
+
+bool writeCsv(const std::string& path, const std::vector<Scenario>& scenarios,
+              const std::vector<RunResult>& results) {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "scenario,run,phase,time,altitude,vertical_speed,surface_speed,fuel,lat,lon\n");
+    for (const RunResult& r : results) {
+        std::fprintf(f, "%s,%u,%s,%.3f,%.3f,%.4f,%.4f,%.1f,%.6f,%.6f\n",
+                     scenarios[r.scenario].name.c_str(), r.run,
+                     phaseName(static_cast<FlightPhase>(r.phase)), r.time, r.altitude,
+                     r.verticalSpeed, r.surfaceSpeed, r.fuelMass, r.lat, r.lon);
+    }
+    return std::fclose(f) == 0;
+}
+
+bool writeBinary(const std::string& path, const std::vector<Scenario>& scenarios,
+                 const std::vector<RunResult>& results) {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    ResultHeader header{};
+    std::memcpy(header.magic, "LBR1", 4);
+    header.version       = 1;
+    header.recordSize    = sizeof(RunResult);
+    header.scenarioCount = static_cast<uint32_t>(scenarios.size());
+    header.recordCount   = results.size();
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+              std::fwrite(results.data(), sizeof(RunResult), results.size(), f) == results.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    luna::util::Log::init();
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    std::string input = argv[1], output = argv[2];
+    std::string format = "csv", terrainPath;
+    double dt = 0.01;
+    uint32_t threads = 0;
+    Integrator integrator = Integrator::RK4;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string opt = argv[i], val = argv[i + 1];
+        if (opt == "--format")       format = val;
+        else if (opt == "--dt")      dt = std::strtod(val.c_str(), nullptr);
+        else if (opt == "--terrain") terrainPath = val;
+        else if (opt == "--threads") threads = static_cast<uint32_t>(std::strtoul(val.c_str(), nullptr, 10));
+        else if (opt == "--integrator") {
+            if (val == "euler")       integrator = Integrator::SemiImplicitEuler;
+            else if (val == "verlet") integrator = Integrator::VelocityVerlet;
+            else if (val == "rk4")    integrator = Integrator::RK4;
+            else { usage(); return 1; }
+        } else { usage(); return 1; }
+    }
+    if (dt <= 0.0 || (format != "csv" && format != "bin")) {
+        usage();
+        return 1;
+    }
+
+    std::vector<Scenario> scenarios;
+    if (!parseScenarios(input, scenarios)) return 1;
+    if (scenarios.empty()) {
+        LOG_ERROR("%s has no scenarios", input.c_str());
+        return 1;
+    }
+    if (!terrainPath.empty()) initTerrain(terrainPath);
+
+    Physics physics;
+    physics.setIntegrator(integrator);
+
+    // Results are laid out scenario by scenario, run by run; each job fills its own range
+    struct Job {
+        uint32_t scenario, first, count;
+        size_t   offset;
+    };
+    std::vector<Job> jobs;
+    size_t total = 0;
+    for (uint32_t s = 0; s < scenarios.size(); ++s) {
+        for (uint32_t first = 0; first < scenarios[s].runs; first += CHUNK_RUNS) {
+            uint32_t count = std::min(CHUNK_RUNS, scenarios[s].runs - first);
+            jobs.push_back({s, first, count, total});
+            total += count;
+        }
+    }
+    std::vector<RunResult> results(total);
+
+    LOG_INFO("Running %zu trajectories from %zu scenarios (dt %.4f s)", total, scenarios.size(), dt);
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        luna::util::JobSystem pool(threads);
+        std::atomic<uint32_t> finished{0};
+        pool.parallelFor(static_cast<uint32_t>(jobs.size()), [&](uint32_t j) {
+            const Job& job = jobs[j];
+            runChunk(physics, scenarios[job.scenario], job.scenario, job.first, job.count, dt,
+                     results.data() + job.offset);
+            uint32_t done = finished.fetch_add(1) + 1;
+            if (done % 64 == 0) LOG_INFO("  %u / %zu jobs", done, jobs.size());
+        });
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    size_t landed = 0, crashed = 0;
+    for (const RunResult& r : results) {
+        landed  += r.phase == static_cast<uint32_t>(FlightPhase::Landed);
+        crashed += r.phase == static_cast<uint32_t>(FlightPhase::Crashed);
+    }
+    LOG_INFO("Done in %.2f s: %zu landed, %zu crashed, %zu still flying", seconds, landed,
+             crashed, total - landed - crashed);
+
+    bool written = format == "csv" ? writeCsv(output, scenarios, results)
+                                   : writeBinary(output, scenarios, results);
+    shutdownTerrain();
+    if (!written) {
+        LOG_ERROR("Write failed: %s", output.c_str());
+        return 1;
+    }
+    LOG_INFO("Wrote %s", output.c_str());
+    return 0;
+}
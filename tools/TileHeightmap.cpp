@@ -0,0 +1,137 @@
+// About: Offline converter from a float32 GeoTIFF heightmap to the tiled .lht format.
+
+#include "sim/HeightTiles.h"
+#include "sim/TiffFile.h"
+#include "util/Log.h"
+#include "util/JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace luna::sim;
+
+namespace {
+
+void usage() {
+    std::fprintf(stderr,
+        "usage: luna_tile_heightmap <input.tif> <output.lht> [options]\n"
+        "  --tile N       tile edge in texels, power of two (default 256)\n"
+        "  --units km|m   units of the input samples (default km, as LOLA/SLDEM)\n"
+        "  --step M       meters per stored int16 step (default 0.5)\n");
+}
+
+size_t alignUp(size_t v, size_t a) { return (v + a - 1) / a * a; }
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    luna::util::Log::init();
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    std::string input = argv[1], output = argv[2];
+    uint32_t tileSize = 256;
+    double unitsToMeters = 1000.0;
+    float metersPerUnit = 0.5f;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string opt = argv[i];
+        if (opt == "--tile")       tileSize = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (opt == "--units") unitsToMeters = std::strcmp(argv[i + 1], "m") == 0 ? 1.0 : 1000.0;
+        else if (opt == "--step")  metersPerUnit = std::strtof(argv[i + 1], nullptr);
+        else { usage(); return 1; }
+    }
+    if (tileSize < 16 || tileSize > 4096 || (tileSize & (tileSize - 1)) != 0 || metersPerUnit <= 0.0f) {
+        usage();
+        return 1;
+    }
+
+    TiffFile tiff;
+    if (!tiff.open(input)) return 1;
+
+    HeightTileHeader header{};
+    std::memcpy(header.magic, HEIGHT_TILE_MAGIC, 4);
+    header.version       = HEIGHT_TILE_VERSION;
+    header.width         = tiff.width();
+    header.height        = tiff.height();
+    header.tileShift     = static_cast<uint32_t>(std::log2(tileSize));
+    header.tilesX        = (header.width + tileSize - 1) / tileSize;
+    header.tilesY        = (header.height + tileSize - 1) / tileSize;
+    header.metersPerUnit = metersPerUnit;
+
+    size_t tileCount = size_t(header.tilesX) * header.tilesY;
+    size_t tileBytes = size_t(tileSize) * tileSize * sizeof(int16_t);
+    header.indexOffset = sizeof(HeightTileHeader);
+    header.dataOffset  = alignUp(header.indexOffset + tileCount * sizeof(uint64_t), HEIGHT_TILE_ALIGNMENT);
+
+    std::vector<uint32_t> ranks = mortonRanks(header.tilesX, header.tilesY);
+    std::vector<uint64_t> index(tileCount);
+    for (size_t t = 0; t < tileCount; t++)
+        index[t] = header.dataOffset + size_t(ranks[t]) * alignUp(tileBytes, HEIGHT_TILE_ALIGNMENT);
+
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LOG_ERROR("Cannot create %s", output.c_str());
+        return 1;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(index.data()),
+              static_cast<std::streamsize>(index.size() * sizeof(uint64_t)));
+
+    LOG_INFO("Tiling %ux%u into %ux%u tiles of %u (%.1f MB)", header.width, header.height,
+             header.tilesX, header.tilesY, tileSize,
+             (header.dataOffset + tileCount * alignUp(tileBytes, HEIGHT_TILE_ALIGNMENT)) / (1024.0 * 1024.0));
+
+    // One band of tile rows at a time: the source is read sequentially (its blocks
+    // decoded across the job system) and each tile is written to its Morton slot.
+    // Out-of-range texels repeat the edge.
+    luna::util::JobSystem& jobs = luna::util::JobSystem::instance();
+    std::vector<float>   band(size_t(tileSize) * header.width);
+    std::vector<int16_t> tile(size_t(tileSize) * tileSize);
+    uint32_t clipped = 0;
+    double decodeSeconds = 0.0;
+    for (uint32_t ty = 0; ty < header.tilesY; ty++) {
+        uint32_t rows = std::min(tileSize, header.height - ty * tileSize);
+        auto start = std::chrono::steady_clock::now();
+        if (!tiff.readRows(ty * tileSize, rows, band.data(), &jobs)) return 1;
+        decodeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (uint32_t r = rows; r < tileSize; r++)
+            std::copy_n(band.data() + size_t(rows - 1) * header.width, header.width,
+                        band.data() + size_t(r) * header.width);
+        for (uint32_t tx = 0; tx < header.tilesX; tx++) {
+            for (uint32_t r = 0; r < tileSize; r++) {
+                const float* row = band.data() + size_t(r) * header.width;
+                for (uint32_t c = 0; c < tileSize; c++) {
+                    uint32_t x = std::min(tx * tileSize + c, header.width - 1);
+                    double q = std::round(row[x] * unitsToMeters / metersPerUnit);
+                    if (q < -32768.0 || q > 32767.0) clipped++;
+                    tile[size_t(r) * tileSize + c] = static_cast<int16_t>(std::clamp(q, -32768.0, 32767.0));
+                }
+            }
+            out.seekp(static_cast<std::streamoff>(index[size_t(ty) * header.tilesX + tx]));
+            out.write(reinterpret_cast<const char*>(tile.data()), static_cast<std::streamsize>(tileBytes));
+        }
+        if ((ty + 1) % 16 == 0 || ty + 1 == header.tilesY)
+            LOG_INFO("  %u / %u tile rows", ty + 1, header.tilesY);
+    }
+
+    double decodedMB = double(header.width) * header.height * sizeof(float) / (1024.0 * 1024.0);
+    LOG_INFO("Decoded %.1f MB of %s %s in %.0f ms on %u threads (%.0f MB/s)", decodedMB,
+             tiff.compressionName(), tiff.isTiled() ? "tiles" : "strips", decodeSeconds * 1000.0,
+             jobs.workerCount() + 1, decodedMB / std::max(decodeSeconds, 1e-6));
+    if (clipped > 0)
+        LOG_WARN("%u texels clipped to int16 — increase --step", clipped);
+    if (!out) {
+        LOG_ERROR("Write failed: %s", output.c_str());
+        return 1;
+    }
+    LOG_INFO("Wrote %s", output.c_str());
+    return 0;
+}